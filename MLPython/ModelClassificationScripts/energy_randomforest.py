@@ -4,6 +4,8 @@ from sklearn.ensemble import RandomForestRegressor
 from sklearn.model_selection import train_test_split
 from sklearn.metrics import mean_squared_error, r2_score
 from joblib import dump
+from skl2onnx import convert_sklearn
+from skl2onnx.common.data_types import FloatTensorType
 
 # Load the dataset
 df = pd.read_csv("../raw_features.csv")
@@ -33,6 +35,12 @@ model.fit(X_train, y_train)
 # Save the trained model to disk to be used in extract_groove_features.py
 dump(model, "models/energy_random_forest.joblib")
 
+# ONNX copy for the plugin's feature model graph (Source/FeatureModelGraph.cpp), same feature order
+initial_type = [('float_input', FloatTensorType([None, len(features)]))]
+onnx_model = convert_sklearn(model, initial_types=initial_type)
+with open("models/energy_random_forest.onnx", "wb") as f:
+    f.write(onnx_model.SerializeToString())
+
 # Predict
 y_pred = model.predict(X_test)
 
@@ -5,6 +5,8 @@ from sklearn.model_selection import train_test_split, GridSearchCV
 from sklearn.ensemble import RandomForestRegressor
 from sklearn.metrics import mean_squared_error, r2_score
 from joblib import dump
+from skl2onnx import convert_sklearn
+from skl2onnx.common.data_types import FloatTensorType
 import numpy as np
 
 # Load dataset — make sure it has swing labels (0 to 1 float or continuous)
@@ -89,4 +91,11 @@ for f, imp in sorted(zip(features, importances), key=lambda x: x[1], reverse=Tru
 # Ensure models directory exists before saving
 os.makedirs("models", exist_ok=True)
 dump(model, "models/swing_random_forest.joblib")
-print("Model saved to models/swing_random_forest.joblib")
\ No newline at end of file
+print("Model saved to models/swing_random_forest.joblib")
+
+# ONNX copy for the plugin's feature model graph (Source/FeatureModelGraph.cpp), same feature order
+initial_type = [('float_input', FloatTensorType([None, len(features)]))]
+onnx_model = convert_sklearn(model, initial_types=initial_type)
+with open("models/swing_random_forest.onnx", "wb") as f:
+    f.write(onnx_model.SerializeToString())
+print("Model exported to models/swing_random_forest.onnx")
\ No newline at end of file
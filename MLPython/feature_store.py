@@ -0,0 +1,77 @@
+# feature_store.py
+# Reads the columnar feature stores (.aafs) written by the AamatiAugment and
+# AamatiSynthesize tools into a pandas DataFrame. Categorical columns such as
+# primary_mood come back as their names. The layout is described in
+# Source/FeatureStore.h.
+
+import struct
+import sys
+
+import numpy as np
+import pandas as pd
+
+FILE_MAGIC = b'AAFS'
+BLOCK_MAGIC = b'ROWS'
+VERSION = 1
+
+
+def _read_string(data, offset):
+    (length,) = struct.unpack_from('<H', data, offset)
+    offset += 2
+    return data[offset:offset + length].decode('utf-8'), offset + length
+
+
+def read_feature_store(path, columns=None):
+    with open(path, 'rb') as f:
+        data = f.read()
+
+    if data[:4] != FILE_MAGIC:
+        raise ValueError(f"{path} is not a feature store")
+    version, num_columns = struct.unpack_from('<II', data, 4)
+    if version != VERSION:
+        raise ValueError(f"Unsupported feature store version {version}")
+
+    offset = 12
+    names, categories = [], []
+    for _ in range(num_columns):
+        name, offset = _read_string(data, offset)
+        (num_categories,) = struct.unpack_from('<I', data, offset)
+        offset += 4
+        labels = []
+        for _ in range(num_categories):
+            label, offset = _read_string(data, offset)
+            labels.append(label)
+        names.append(name)
+        categories.append(labels)
+
+    # Each block holds its rows one column at a time; a block cut short is ignored
+    chunks = [[] for _ in names]
+    while offset + 8 <= len(data) and data[offset:offset + 4] == BLOCK_MAGIC:
+        (rows,) = struct.unpack_from('<I', data, offset + 4)
+        offset += 8
+        if offset + rows * num_columns * 4 > len(data):
+            break
+        block = np.frombuffer(data, dtype='<f4', count=rows * num_columns, offset=offset)
+        for i, column in enumerate(block.reshape(num_columns, rows)):
+            chunks[i].append(column)
+        offset += rows * num_columns * 4
+
+    frame = {}
+    for name, labels, chunk in zip(names, categories, chunks):
+        if columns is not None and name not in columns:
+            continue
+        values = np.concatenate(chunk) if chunk else np.empty(0, dtype=np.float32)
+        if labels:
+            frame[name] = pd.Categorical.from_codes(values.astype(np.int64), categories=labels)
+        else:
+            frame[name] = values
+    return pd.DataFrame(frame)
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 2:
+        print("Usage: python feature_store.py <store.aafs>")
+        sys.exit(2)
+    table = read_feature_store(sys.argv[1])
+    print(f"{len(table)} rows")
+    print(table.describe(include='all').transpose())
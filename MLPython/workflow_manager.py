@@ -62,6 +62,10 @@ def check_duplicates():
 def format_midis():
     """Format MIDI files for compliance"""
     print("🔧 Formatting MIDI files...")
+    # The native tool (built with AAMATI_BUILD_TOOLS) does the same job in parallel
+    native_tool = shutil.which("AamatiMidiCompliance")
+    if native_tool:
+        return run_command(f'"{native_tool}" MusicGroovesMIDI/NewMIDIs MusicGroovesMIDI/FixedMIDIs', "MIDI formatting")
     return run_command("python3 fixed_midi_compliance.py", "MIDI formatting")
 
 def extract_features(interactive=True, max_files=None):
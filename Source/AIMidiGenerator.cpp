@@ -1,4 +1,22 @@
 #include "AIMidiGenerator.h"
+#include "Arpeggiator.h"
+#include "MotifEngine.h"
+
+#include <algorithm>
+
+namespace
+{
+    // Drum fills play at 60 + 40 * energy, so energy changes map their velocities by this ratio
+    float getEnergyLevel(float energy)
+    {
+        return 60.0f + 40.0f * juce::jlimit(0.0f, 1.0f, energy);
+    }
+    
+    float getTempoOrDefault(float tempo)
+    {
+        return tempo > 0.0f ? tempo : 120.0f;
+    }
+}
 
 AIMidiGenerator::AIMidiGenerator() : random(juce::Time::currentTimeMillis())
 {
@@ -30,75 +48,75 @@ void AIMidiGenerator::initializeHybridMoods()
     // Define 30+ hybrid mood combinations with their characteristics
     
     // Single mood intensifications (same mood repeated)
-    hybridMoods["romantic-romantic"] = {"romantic", "romantic", {0.5f, 0.5f}, "deep-romance"};
-    hybridMoods["dreamy-dreamy"] = {"dreamy", "dreamy", {0.5f, 0.5f}, "ethereal-bliss"};
-    hybridMoods["chill-chill"] = {"chill", "chill", {0.5f, 0.5f}, "zen-calm"};
-    hybridMoods["energetic-energetic"] = {"energetic", "energetic", {0.5f, 0.5f}, "pure-energy"};
-    hybridMoods["suspenseful-suspenseful"] = {"suspenseful", "suspenseful", {0.5f, 0.5f}, "deep-tension"};
-    hybridMoods["uplifting-uplifting"] = {"uplifting", "uplifting", {0.5f, 0.5f}, "pure-joy"};
-    hybridMoods["ominous-ominous"] = {"ominous", "ominous", {0.5f, 0.5f}, "dark-abyss"};
-    hybridMoods["gritty-gritty"] = {"gritty", "gritty", {0.5f, 0.5f}, "raw-power"};
-    hybridMoods["frantic-frantic"] = {"frantic", "frantic", {0.5f, 0.5f}, "pure-chaos"};
-    hybridMoods["focused-focused"] = {"focused", "focused", {0.5f, 0.5f}, "laser-precision"};
+    hybridMoods["romantic-romantic"] = {{"romantic", "romantic"}, {0.5f, 0.5f}, "deep-romance"};
+    hybridMoods["dreamy-dreamy"] = {{"dreamy", "dreamy"}, {0.5f, 0.5f}, "ethereal-bliss"};
+    hybridMoods["chill-chill"] = {{"chill", "chill"}, {0.5f, 0.5f}, "zen-calm"};
+    hybridMoods["energetic-energetic"] = {{"energetic", "energetic"}, {0.5f, 0.5f}, "pure-energy"};
+    hybridMoods["suspenseful-suspenseful"] = {{"suspenseful", "suspenseful"}, {0.5f, 0.5f}, "deep-tension"};
+    hybridMoods["uplifting-uplifting"] = {{"uplifting", "uplifting"}, {0.5f, 0.5f}, "pure-joy"};
+    hybridMoods["ominous-ominous"] = {{"ominous", "ominous"}, {0.5f, 0.5f}, "dark-abyss"};
+    hybridMoods["gritty-gritty"] = {{"gritty", "gritty"}, {0.5f, 0.5f}, "raw-power"};
+    hybridMoods["frantic-frantic"] = {{"frantic", "frantic"}, {0.5f, 0.5f}, "pure-chaos"};
+    hybridMoods["focused-focused"] = {{"focused", "focused"}, {0.5f, 0.5f}, "laser-precision"};
     
     // Triple same mood intensifications
-    hybridMoods["romantic-romantic-romantic"] = {"romantic", "romantic", "romantic", {0.33f, 0.33f, 0.34f}, "passionate-storm"};
-    hybridMoods["dreamy-dreamy-dreamy"] = {"dreamy", "dreamy", "dreamy", {0.33f, 0.33f, 0.34f}, "cosmic-drift"};
-    hybridMoods["chill-chill-chill"] = {"chill", "chill", "chill", {0.33f, 0.33f, 0.34f}, "meditative-trance"};
-    hybridMoods["energetic-energetic-energetic"] = {"energetic", "energetic", "energetic", {0.33f, 0.33f, 0.34f}, "explosive-force"};
-    hybridMoods["suspenseful-suspenseful-suspenseful"] = {"suspenseful", "suspenseful", "suspenseful", {0.33f, 0.33f, 0.34f}, "paralyzing-dread"};
+    hybridMoods["romantic-romantic-romantic"] = {{"romantic", "romantic", "romantic"}, {0.33f, 0.33f, 0.34f}, "passionate-storm"};
+    hybridMoods["dreamy-dreamy-dreamy"] = {{"dreamy", "dreamy", "dreamy"}, {0.33f, 0.33f, 0.34f}, "cosmic-drift"};
+    hybridMoods["chill-chill-chill"] = {{"chill", "chill", "chill"}, {0.33f, 0.33f, 0.34f}, "meditative-trance"};
+    hybridMoods["energetic-energetic-energetic"] = {{"energetic", "energetic", "energetic"}, {0.33f, 0.33f, 0.34f}, "explosive-force"};
+    hybridMoods["suspenseful-suspenseful-suspenseful"] = {{"suspenseful", "suspenseful", "suspenseful"}, {0.33f, 0.33f, 0.34f}, "paralyzing-dread"};
     
     // Dual combinations
-    hybridMoods["chill-energetic"] = {"chill", "energetic", {0.7f, 0.3f}, "relaxed-energy"};
-    hybridMoods["energetic-chill"] = {"energetic", "chill", {0.6f, 0.4f}, "controlled-energy"};
-    hybridMoods["suspenseful-uplifting"] = {"suspenseful", "uplifting", {0.6f, 0.4f}, "building-tension"};
-    hybridMoods["uplifting-suspenseful"] = {"uplifting", "suspenseful", {0.7f, 0.3f}, "hopeful-tension"};
-    hybridMoods["ominous-romantic"] = {"ominous", "romantic", {0.5f, 0.5f}, "dark-romance"};
-    hybridMoods["romantic-ominous"] = {"romantic", "ominous", {0.6f, 0.4f}, "melancholic"};
-    hybridMoods["gritty-dreamy"] = {"gritty", "dreamy", {0.4f, 0.6f}, "ethereal-grit"};
-    hybridMoods["dreamy-gritty"] = {"dreamy", "gritty", {0.7f, 0.3f}, "soft-edge"};
-    hybridMoods["frantic-focused"] = {"frantic", "focused", {0.3f, 0.7f}, "controlled-chaos"};
-    hybridMoods["focused-frantic"] = {"focused", "frantic", {0.6f, 0.4f}, "intense-precision"};
+    hybridMoods["chill-energetic"] = {{"chill", "energetic"}, {0.7f, 0.3f}, "relaxed-energy"};
+    hybridMoods["energetic-chill"] = {{"energetic", "chill"}, {0.6f, 0.4f}, "controlled-energy"};
+    hybridMoods["suspenseful-uplifting"] = {{"suspenseful", "uplifting"}, {0.6f, 0.4f}, "building-tension"};
+    hybridMoods["uplifting-suspenseful"] = {{"uplifting", "suspenseful"}, {0.7f, 0.3f}, "hopeful-tension"};
+    hybridMoods["ominous-romantic"] = {{"ominous", "romantic"}, {0.5f, 0.5f}, "dark-romance"};
+    hybridMoods["romantic-ominous"] = {{"romantic", "ominous"}, {0.6f, 0.4f}, "melancholic"};
+    hybridMoods["gritty-dreamy"] = {{"gritty", "dreamy"}, {0.4f, 0.6f}, "ethereal-grit"};
+    hybridMoods["dreamy-gritty"] = {{"dreamy", "gritty"}, {0.7f, 0.3f}, "soft-edge"};
+    hybridMoods["frantic-focused"] = {{"frantic", "focused"}, {0.3f, 0.7f}, "controlled-chaos"};
+    hybridMoods["focused-frantic"] = {{"focused", "frantic"}, {0.6f, 0.4f}, "intense-precision"};
     
     // Triple combinations
-    hybridMoods["chill-energetic-romantic"] = {"chill", "energetic", "romantic", {0.4f, 0.3f, 0.3f}, "passionate-calm"};
-    hybridMoods["suspenseful-uplifting-gritty"] = {"suspenseful", "uplifting", "gritty", {0.4f, 0.3f, 0.3f}, "raw-hope"};
-    hybridMoods["dreamy-ominous-focused"] = {"dreamy", "ominous", "focused", {0.4f, 0.3f, 0.3f}, "dark-clarity"};
-    hybridMoods["frantic-chill-uplifting"] = {"frantic", "chill", "uplifting", {0.3f, 0.4f, 0.3f}, "chaotic-peace"};
-    hybridMoods["romantic-gritty-suspenseful"] = {"romantic", "gritty", "suspenseful", {0.4f, 0.3f, 0.3f}, "passionate-tension"};
+    hybridMoods["chill-energetic-romantic"] = {{"chill", "energetic", "romantic"}, {0.4f, 0.3f, 0.3f}, "passionate-calm"};
+    hybridMoods["suspenseful-uplifting-gritty"] = {{"suspenseful", "uplifting", "gritty"}, {0.4f, 0.3f, 0.3f}, "raw-hope"};
+    hybridMoods["dreamy-ominous-focused"] = {{"dreamy", "ominous", "focused"}, {0.4f, 0.3f, 0.3f}, "dark-clarity"};
+    hybridMoods["frantic-chill-uplifting"] = {{"frantic", "chill", "uplifting"}, {0.3f, 0.4f, 0.3f}, "chaotic-peace"};
+    hybridMoods["romantic-gritty-suspenseful"] = {{"romantic", "gritty", "suspenseful"}, {0.4f, 0.3f, 0.3f}, "passionate-tension"};
     
     // Complex combinations
-    hybridMoods["energetic-uplifting-focused"] = {"energetic", "uplifting", "focused", {0.4f, 0.3f, 0.3f}, "driven-optimism"};
-    hybridMoods["chill-dreamy-romantic"] = {"chill", "dreamy", "romantic", {0.4f, 0.3f, 0.3f}, "ethereal-love"};
-    hybridMoods["ominous-suspenseful-gritty"] = {"ominous", "suspenseful", "gritty", {0.4f, 0.3f, 0.3f}, "dark-intensity"};
-    hybridMoods["frantic-energetic-gritty"] = {"frantic", "energetic", "gritty", {0.4f, 0.3f, 0.3f}, "raw-power"};
-    hybridMoods["uplifting-focused-romantic"] = {"uplifting", "focused", "romantic", {0.4f, 0.3f, 0.3f}, "inspired-love"};
+    hybridMoods["energetic-uplifting-focused"] = {{"energetic", "uplifting", "focused"}, {0.4f, 0.3f, 0.3f}, "driven-optimism"};
+    hybridMoods["chill-dreamy-romantic"] = {{"chill", "dreamy", "romantic"}, {0.4f, 0.3f, 0.3f}, "ethereal-love"};
+    hybridMoods["ominous-suspenseful-gritty"] = {{"ominous", "suspenseful", "gritty"}, {0.4f, 0.3f, 0.3f}, "dark-intensity"};
+    hybridMoods["frantic-energetic-gritty"] = {{"frantic", "energetic", "gritty"}, {0.4f, 0.3f, 0.3f}, "raw-power"};
+    hybridMoods["uplifting-focused-romantic"] = {{"uplifting", "focused", "romantic"}, {0.4f, 0.3f, 0.3f}, "inspired-love"};
     
     // Quadruple combinations
-    hybridMoods["chill-energetic-romantic-dreamy"] = {"chill", "energetic", "romantic", "dreamy", {0.3f, 0.25f, 0.25f, 0.2f}, "passionate-dream"};
-    hybridMoods["suspenseful-uplifting-gritty-focused"] = {"suspenseful", "uplifting", "gritty", "focused", {0.3f, 0.25f, 0.25f, 0.2f}, "intense-determination"};
-    hybridMoods["ominous-romantic-dreamy-chill"] = {"ominous", "romantic", "dreamy", "chill", {0.3f, 0.25f, 0.25f, 0.2f}, "dark-serenity"};
-    hybridMoods["frantic-energetic-gritty-uplifting"] = {"frantic", "energetic", "gritty", "uplifting", {0.3f, 0.25f, 0.25f, 0.2f}, "explosive-joy"};
-    hybridMoods["focused-suspenseful-romantic-chill"] = {"focused", "suspenseful", "romantic", "chill", {0.3f, 0.25f, 0.25f, 0.2f}, "controlled-passion"};
+    hybridMoods["chill-energetic-romantic-dreamy"] = {{"chill", "energetic", "romantic", "dreamy"}, {0.3f, 0.25f, 0.25f, 0.2f}, "passionate-dream"};
+    hybridMoods["suspenseful-uplifting-gritty-focused"] = {{"suspenseful", "uplifting", "gritty", "focused"}, {0.3f, 0.25f, 0.25f, 0.2f}, "intense-determination"};
+    hybridMoods["ominous-romantic-dreamy-chill"] = {{"ominous", "romantic", "dreamy", "chill"}, {0.3f, 0.25f, 0.25f, 0.2f}, "dark-serenity"};
+    hybridMoods["frantic-energetic-gritty-uplifting"] = {{"frantic", "energetic", "gritty", "uplifting"}, {0.3f, 0.25f, 0.25f, 0.2f}, "explosive-joy"};
+    hybridMoods["focused-suspenseful-romantic-chill"] = {{"focused", "suspenseful", "romantic", "chill"}, {0.3f, 0.25f, 0.25f, 0.2f}, "controlled-passion"};
     
     // Extreme combinations
-    hybridMoods["frantic-ominous-gritty-suspenseful"] = {"frantic", "ominous", "gritty", "suspenseful", {0.3f, 0.25f, 0.25f, 0.2f}, "apocalyptic-chaos"};
-    hybridMoods["dreamy-romantic-chill-uplifting"] = {"dreamy", "romantic", "chill", "uplifting", {0.3f, 0.25f, 0.25f, 0.2f}, "heavenly-bliss"};
-    hybridMoods["energetic-focused-uplifting-gritty"] = {"energetic", "focused", "uplifting", "gritty", {0.3f, 0.25f, 0.25f, 0.2f}, "unstoppable-force"};
-    hybridMoods["chill-dreamy-romantic-focused"] = {"chill", "dreamy", "romantic", "focused", {0.3f, 0.25f, 0.25f, 0.2f}, "meditative-love"};
-    hybridMoods["suspenseful-ominous-frantic-gritty"] = {"suspenseful", "ominous", "frantic", "gritty", {0.3f, 0.25f, 0.25f, 0.2f}, "nightmare-fuel"};
+    hybridMoods["frantic-ominous-gritty-suspenseful"] = {{"frantic", "ominous", "gritty", "suspenseful"}, {0.3f, 0.25f, 0.25f, 0.2f}, "apocalyptic-chaos"};
+    hybridMoods["dreamy-romantic-chill-uplifting"] = {{"dreamy", "romantic", "chill", "uplifting"}, {0.3f, 0.25f, 0.25f, 0.2f}, "heavenly-bliss"};
+    hybridMoods["energetic-focused-uplifting-gritty"] = {{"energetic", "focused", "uplifting", "gritty"}, {0.3f, 0.25f, 0.25f, 0.2f}, "unstoppable-force"};
+    hybridMoods["chill-dreamy-romantic-focused"] = {{"chill", "dreamy", "romantic", "focused"}, {0.3f, 0.25f, 0.25f, 0.2f}, "meditative-love"};
+    hybridMoods["suspenseful-ominous-frantic-gritty"] = {{"suspenseful", "ominous", "frantic", "gritty"}, {0.3f, 0.25f, 0.25f, 0.2f}, "nightmare-fuel"};
     
     // Balanced combinations
-    hybridMoods["all-balanced"] = {"chill", "energetic", "suspenseful", "uplifting", "ominous", "romantic", "gritty", "dreamy", "frantic", "focused", 
-                                 {0.1f, 0.1f, 0.1f, 0.1f, 0.1f, 0.1f, 0.1f, 0.1f, 0.1f, 0.1f}, "universal-harmony"};
-    hybridMoods["positive-spectrum"] = {"chill", "energetic", "uplifting", "romantic", "dreamy", "focused", 
-                                       {0.2f, 0.2f, 0.2f, 0.15f, 0.15f, 0.1f}, "pure-positivity"};
-    hybridMoods["dark-spectrum"] = {"suspenseful", "ominous", "gritty", "frantic", 
-                                   {0.3f, 0.3f, 0.2f, 0.2f}, "pure-darkness"};
-    hybridMoods["dynamic-spectrum"] = {"energetic", "frantic", "gritty", "uplifting", "focused", 
-                                      {0.25f, 0.2f, 0.2f, 0.2f, 0.15f}, "pure-energy"};
-    hybridMoods["serene-spectrum"] = {"chill", "dreamy", "romantic", "focused", 
-                                     {0.3f, 0.3f, 0.25f, 0.15f}, "pure-serenity"};
+    hybridMoods["all-balanced"] = {{"chill", "energetic", "suspenseful", "uplifting", "ominous", "romantic", "gritty", "dreamy", "frantic", "focused"},
+                                  {0.1f, 0.1f, 0.1f, 0.1f, 0.1f, 0.1f, 0.1f, 0.1f, 0.1f, 0.1f}, "universal-harmony"};
+    hybridMoods["positive-spectrum"] = {{"chill", "energetic", "uplifting", "romantic", "dreamy", "focused"},
+                                        {0.2f, 0.2f, 0.2f, 0.15f, 0.15f, 0.1f}, "pure-positivity"};
+    hybridMoods["dark-spectrum"] = {{"suspenseful", "ominous", "gritty", "frantic"},
+                                    {0.3f, 0.3f, 0.2f, 0.2f}, "pure-darkness"};
+    hybridMoods["dynamic-spectrum"] = {{"energetic", "frantic", "gritty", "uplifting", "focused"},
+                                       {0.25f, 0.2f, 0.2f, 0.2f, 0.15f}, "pure-energy"};
+    hybridMoods["serene-spectrum"] = {{"chill", "dreamy", "romantic", "focused"},
+                                      {0.3f, 0.3f, 0.25f, 0.15f}, "pure-serenity"};
 }
 
 void AIMidiGenerator::initializeInstrumentPresets()
@@ -133,40 +151,62 @@ void AIMidiGenerator::initializeInstrumentPresets()
     instrumentPresets[3] = synth;
 }
 
+void AIMidiGenerator::setRandomSeed(juce::int64 seed)
+{
+    random.setSeed(seed);
+    motifMemory = {};
+    motifMemoryKey.clear();
+}
+
 void AIMidiGenerator::setGenerationContext(const GenerationContext& context)
 {
+    lastContextChange = diffContexts(currentContext, context);
     currentContext = context;
 }
 
 AIMidiGenerator::GeneratedPattern AIMidiGenerator::generateMelody(double duration, int channel)
+{
+    // Develop the mood's motif with the context's energy and complexity
+    auto pattern = generateMotifMelody(duration, channel, currentContext.energy, currentContext.complexity);
+    pattern.patternType = "melody";
+    return pattern;
+}
+
+AIMidiGenerator::GeneratedPattern AIMidiGenerator::generateMotifMelody(double duration, int channel, float energy, float complexity)
 {
     GeneratedPattern pattern;
     pattern.patternType = "melody";
     pattern.duration = duration;
     
-    // Generate melody based on mood and context
-    int noteCount = static_cast<int>(duration * 4); // 4 notes per second
-    auto notes = generateMelodyNotes(noteCount, currentContext.key, currentContext.scale);
-    auto rhythm = generateMelodyRhythm(noteCount, currentContext.tempo);
-    auto velocities = generateMelodyVelocities(noteCount, currentContext.energy);
+    MotifEngine::Parameters parameters;
+    parameters.tonic = 60 + currentContext.key;
+    parameters.scaleMask = MotifEngine::getScaleMask(getScaleNotes(0, currentContext.scale));
+    parameters.energy = juce::jlimit(0.0f, 1.0f, energy);
+    parameters.complexity = juce::jlimit(0.0f, 1.0f, complexity);
+    parameters.tempo = currentContext.tempo;
+    MotifEngine engine(parameters);
+    
+    // Melodies keep developing the same motif until the mood or scale changes
+    const auto motifKey = currentContext.primaryMood + "|" + currentContext.scale;
+    if (motifMemoryKey != motifKey || motifMemory.length == 0)
+    {
+        motifMemory = engine.createMotif(random);
+        motifMemoryKey = motifKey;
+    }
     
-    double currentTime = 0.0;
-    for (size_t i = 0; i < notes.size() && i < rhythm.size() && i < velocities.size(); ++i)
+    std::vector<MotifEngine::Note> notes;
+    engine.buildPhrase(motifMemory, duration, random, notes);
+    
+    pattern.messages.reserve(notes.size() * 2);
+    for (const auto& note : notes)
     {
-        // Note on
-        juce::MidiMessage noteOn = juce::MidiMessage::noteOn(
-            channel, notes[i], static_cast<juce::uint8>(velocities[i]));
-        noteOn.setTimeStamp(currentTime);
+        juce::MidiMessage noteOn = juce::MidiMessage::noteOn(channel, note.noteNumber, static_cast<juce::uint8>(note.velocity));
+        noteOn.setTimeStamp(note.startTime);
         pattern.messages.push_back(noteOn);
         
-        // Note off
-        double noteDuration = rhythm[i] * (60.0 / currentContext.tempo);
-        juce::MidiMessage noteOff = juce::MidiMessage::noteOff(
-            channel, notes[i], static_cast<juce::uint8>(velocities[i]));
-        noteOff.setTimeStamp(currentTime + noteDuration);
+        juce::MidiMessage noteOff = juce::MidiMessage::noteOff(channel, note.noteNumber, static_cast<juce::uint8>(note.velocity));
+        noteOff.setTimeStamp(note.startTime + note.duration);
         pattern.messages.push_back(noteOff);
-        
-        currentTime += noteDuration * 0.8; // Slight overlap
     }
     
     pattern.confidence = 0.8f;
@@ -179,8 +219,9 @@ AIMidiGenerator::GeneratedPattern AIMidiGenerator::generateHarmony(double durati
     pattern.patternType = "harmony";
     pattern.duration = duration;
     
-    // Generate chord progression
-    int chordCount = static_cast<int>(duration); // One chord per second
+    // Generate chord progression at the input's harmonic rhythm (one chord per second by default)
+    const double chordSeconds = harmonyContext.secondsPerChord;
+    int chordCount = std::max(1, static_cast<int>(duration / chordSeconds));
     auto progression = generateChordProgression(chordCount, currentContext.key, currentContext.scale);
     
     double currentTime = 0.0;
@@ -197,8 +238,8 @@ AIMidiGenerator::GeneratedPattern AIMidiGenerator::generateHarmony(double durati
             pattern.messages.push_back(noteOn);
         }
         
-        // Release chord after 0.8 seconds
-        currentTime += 0.8;
+        // Release chord after 80% of its slot
+        currentTime += 0.8 * chordSeconds;
         for (int note : voicing)
         {
             juce::MidiMessage noteOff = juce::MidiMessage::noteOff(
@@ -207,7 +248,7 @@ AIMidiGenerator::GeneratedPattern AIMidiGenerator::generateHarmony(double durati
             pattern.messages.push_back(noteOff);
         }
         
-        currentTime += 0.2; // Gap between chords
+        currentTime += 0.2 * chordSeconds; // Gap between chords
     }
     
     pattern.confidence = 0.7f;
@@ -266,12 +307,44 @@ AIMidiGenerator::GeneratedPattern AIMidiGenerator::generateFill(double duration,
     }
 }
 
+AIMidiGenerator::GeneratedPattern AIMidiGenerator::generateArpeggio(double duration, int channel)
+{
+    return generateMoodArpeggio(currentContext.primaryMood, duration, channel);
+}
+
+AIMidiGenerator::GeneratedPattern AIMidiGenerator::generateMoodArpeggio(const std::string& mood, double duration, int channel)
+{
+    GeneratedPattern pattern;
+    pattern.patternType = "arpeggio";
+    pattern.duration = duration;
+    
+    // One chord per slot of the input's harmonic rhythm, as for generateHarmony()
+    const float tempo = currentContext.tempo > 0.0f ? currentContext.tempo : 120.0f;
+    const int chordCount = std::max(1, static_cast<int>(duration / harmonyContext.secondsPerChord));
+    auto progression = generateChordProgression(chordCount, currentContext.key, currentContext.scale);
+    for (auto& chord : progression)
+        chord = generateChordVoicing(chord, currentContext.key);
+    
+    auto settings = Arpeggiator::getMoodSettings(mood);
+    settings.seed = static_cast<std::uint32_t>(random.nextInt(0x7fffffff)) + 1u;
+    
+    Arpeggiator arpeggiator;
+    arpeggiator.setSettings(settings);
+    pattern.messages = arpeggiator.arpeggiate(progression, Arpeggiator::secondsToTicks(harmonyContext.secondsPerChord, tempo),
+                                              tempo, channel);
+    
+    pattern.confidence = 0.8f;
+    return pattern;
+}
+
 void AIMidiGenerator::generateRealTimeContent(std::vector<juce::MidiMessage>& output, double currentTime, double lookAhead)
 {
-    // Generate content based on current context and time
+    // Generate content based on current context and time. Live context updates that only move the tempo,
+    // energy or key adapt the cached pattern instead of generating a new one. Live content has always been
+    // notes only, so it carries no controller lanes.
     if (currentContext.primaryMood == "energetic")
     {
-        auto pattern = generateEnergeticPattern(lookAhead);
+        auto pattern = getContextPattern(lookAhead, "realtime", false);
         for (const auto& msg : pattern.messages)
         {
             output.push_back(msg);
@@ -279,7 +352,7 @@ void AIMidiGenerator::generateRealTimeContent(std::vector<juce::MidiMessage>& ou
     }
     else if (currentContext.primaryMood == "chill")
     {
-        auto pattern = generateChillPattern(lookAhead);
+        auto pattern = getContextPattern(lookAhead, "realtime", false);
         for (const auto& msg : pattern.messages)
         {
             output.push_back(msg);
@@ -290,30 +363,169 @@ void AIMidiGenerator::generateRealTimeContent(std::vector<juce::MidiMessage>& ou
 
 void AIMidiGenerator::updateContext(const GenerationContext& context)
 {
+    lastContextChange = diffContexts(currentContext, context);
     currentContext = context;
 }
 
+int AIMidiGenerator::diffContexts(const GenerationContext& from, const GenerationContext& to)
+{
+    int change = NoContextChange;
+    if (from.primaryMood != to.primaryMood || from.secondaryMood != to.secondaryMood || from.scale != to.scale
+        || from.complexity != to.complexity || from.timeSignature != to.timeSignature)
+        change |= StructuralChange;
+    if (getTempoOrDefault(from.tempo) != getTempoOrDefault(to.tempo))
+        change |= TimingChange;
+    if (from.energy != to.energy)
+        change |= VelocityChange;
+    if ((from.key - to.key) % 12 != 0)
+        change |= PitchSpaceChange;
+    return change;
+}
+
+bool AIMidiGenerator::adaptPattern(GeneratedPattern& pattern, const GenerationContext& from, const GenerationContext& to,
+                                   int drumChannel)
+{
+    int change = diffContexts(from, to);
+    
+    // Energy only sets drum fill velocities, and melodic fills ignore it. Melodies, drum patterns and the
+    // mood patterns also take note lengths, leaps and hits from it, so for them it means regenerating.
+    if ((change & VelocityChange) != 0)
+    {
+        if (pattern.patternType == "melodic_fill")
+            change &= ~VelocityChange;
+        else if (pattern.patternType != "drum_fill")
+            change |= StructuralChange;
+    }
+    
+    if ((change & StructuralChange) != 0)
+        return false;
+    
+    if ((change & TimingChange) != 0)
+        rescalePattern(pattern, getTempoOrDefault(from.tempo) / getTempoOrDefault(to.tempo));
+    if ((change & VelocityChange) != 0)
+        remapVelocities(pattern, from.energy, to.energy);
+    if ((change & PitchSpaceChange) != 0)
+    {
+        // The nearest way round: at most a tritone up or a fourth down
+        int semitones = ((to.key - from.key) % 12 + 12) % 12;
+        if (semitones > 6)
+            semitones -= 12;
+        transposePattern(pattern, semitones, drumChannel);
+    }
+    return true;
+}
+
+void AIMidiGenerator::rescalePattern(GeneratedPattern& pattern, double timeScale)
+{
+    for (auto& message : pattern.messages)
+        message.setTimeStamp(message.getTimeStamp() * timeScale);
+    pattern.duration *= timeScale;
+}
+
+void AIMidiGenerator::remapVelocities(GeneratedPattern& pattern, float fromEnergy, float toEnergy)
+{
+    const float ratio = getEnergyLevel(toEnergy) / getEnergyLevel(fromEnergy);
+    for (auto& message : pattern.messages)
+    {
+        if (message.isNoteOn())
+        {
+            const int velocity = juce::jlimit(1, 127, juce::roundToInt(message.getVelocity() * ratio));
+            message.setVelocity(static_cast<float>(velocity) / 127.0f);
+        }
+    }
+}
+
+void AIMidiGenerator::transposePattern(GeneratedPattern& pattern, int semitones, int drumChannel)
+{
+    for (auto& message : pattern.messages)
+    {
+        // Notes the shift would push out of range keep their pitch; the rule only looks at the note, so offs still match ons
+        if (!message.isNoteOnOrOff() || message.getChannel() % 16 == drumChannel)
+            continue;
+        const int shifted = message.getNoteNumber() + semitones;
+        if (shifted >= 0 && shifted <= 127)
+            message.setNoteNumber(shifted);
+    }
+}
+
+AIMidiGenerator::GeneratedPattern AIMidiGenerator::getContextPattern(double duration, const std::string& patternType,
+                                                                     bool withControllerLanes)
+{
+    const double beats = duration * getTempoOrDefault(currentContext.tempo) / 60.0;
+    
+    auto cached = patternCache.find(patternType);
+    if (cached != patternCache.end())
+    {
+        const auto& entry = cached->second;
+        const double cachedBeats = entry.pattern.duration * getTempoOrDefault(entry.context.tempo) / 60.0;
+        
+        // Always adapted from the pattern as generated, so repeated changes never compound rounding
+        auto pattern = entry.pattern;
+        if (std::abs(beats - cachedBeats) < 1.0e-6 * std::max(1.0, beats)
+            && adaptPattern(pattern, entry.context, currentContext))
+            return pattern;
+    }
+    
+    auto pattern = withControllerLanes ? generateMoodPattern(currentContext.primaryMood, duration, patternType)
+                                       : generateMoodNotes(currentContext.primaryMood, duration, patternType);
+    patternCache[patternType] = { currentContext, pattern };
+    return pattern;
+}
+
+void AIMidiGenerator::setHarmonyContext(const HarmonyContext& harmony)
+{
+    harmonyContext = harmony;
+    harmonyContext.secondsPerChord = juce::jlimit(0.25, 8.0, harmony.secondsPerChord);
+}
+
 AIMidiGenerator::GeneratedPattern AIMidiGenerator::generateMoodPattern(const std::string& mood, double duration, const std::string& patternType)
 {
-    if (mood == "chill") return generateChillPattern(duration);
-    if (mood == "energetic") return generateEnergeticPattern(duration);
-    if (mood == "suspenseful") return generateSuspensefulPattern(duration);
-    if (mood == "uplifting") return generateUpliftingPattern(duration);
-    if (mood == "ominous") return generateOminousPattern(duration);
-    if (mood == "romantic") return generateRomanticPattern(duration);
-    if (mood == "gritty") return generateGrittyPattern(duration);
-    if (mood == "dreamy") return generateDreamyPattern(duration);
-    if (mood == "frantic") return generateFranticPattern(duration);
-    if (mood == "focused") return generateFocusedPattern(duration);
-    
-    // Default pattern
+    auto pattern = generateMoodNotes(mood, duration, patternType);
+    
+    // The mood patterns play their lead on the first channel; moods without lanes get none
+    addControllerLanes(pattern, mood, 0);
+    return pattern;
+}
+
+AIMidiGenerator::GeneratedPattern AIMidiGenerator::generateMoodNotes(const std::string& mood, double duration, const std::string& patternType)
+{
     GeneratedPattern pattern;
-    pattern.patternType = patternType;
-    pattern.duration = duration;
-    pattern.confidence = 0.5f;
+    if (mood == "chill") pattern = generateChillPattern(duration);
+    else if (mood == "energetic") pattern = generateEnergeticPattern(duration);
+    else if (mood == "suspenseful") pattern = generateSuspensefulPattern(duration);
+    else if (mood == "uplifting") pattern = generateUpliftingPattern(duration);
+    else if (mood == "ominous") pattern = generateOminousPattern(duration);
+    else if (mood == "romantic") pattern = generateRomanticPattern(duration);
+    else if (mood == "gritty") pattern = generateGrittyPattern(duration);
+    else if (mood == "dreamy") pattern = generateDreamyPattern(duration);
+    else if (mood == "frantic") pattern = generateFranticPattern(duration);
+    else if (mood == "focused") pattern = generateFocusedPattern(duration);
+    else
+    {
+        // Default pattern
+        pattern.patternType = patternType;
+        pattern.duration = duration;
+        pattern.confidence = 0.5f;
+    }
     return pattern;
 }
 
+void AIMidiGenerator::addControllerLanes(GeneratedPattern& pattern, const std::string& mood, int channel)
+{
+    if (!controllerLanesEnabled)
+        return;
+    
+    for (const auto& lane : ControllerCurves::getMoodLanes(mood, pattern.duration, channel, currentContext.energy))
+    {
+        const auto messages = ControllerCurves::render(lane, pattern.duration, controllerTolerance);
+        pattern.messages.insert(pattern.messages.end(), messages.begin(), messages.end());
+    }
+    
+    // Lanes go in time order among the notes; a stable sort keeps each note-on ahead of its note-off
+    std::stable_sort(pattern.messages.begin(), pattern.messages.end(),
+                     [](const juce::MidiMessage& a, const juce::MidiMessage& b) { return a.getTimeStamp() < b.getTimeStamp(); });
+}
+
 // Enhanced hybrid mood system
 AIMidiGenerator::GeneratedPattern AIMidiGenerator::generateHybridPattern(const std::vector<std::string>& moods, const std::vector<float>& weights, double duration)
 {
@@ -489,6 +701,9 @@ AIMidiGenerator::GeneratedPattern AIMidiGenerator::blendPatterns(const std::vect
     
     if (totalWeight <= 0.0f) return patterns[0];
     
+    // Controller lanes would fight each other, so only the heaviest pattern keeps its own
+    const size_t dominant = static_cast<size_t>(std::distance(weights.begin(), std::max_element(weights.begin(), weights.end())));
+    
     // Create time-sorted message list
     std::vector<juce::MidiMessage> allMessages;
     
@@ -496,6 +711,9 @@ AIMidiGenerator::GeneratedPattern AIMidiGenerator::blendPatterns(const std::vect
         float normalizedWeight = weights[i] / totalWeight;
         
         for (const auto& message : patterns[i].messages) {
+            if ((message.isController() || message.isPitchWheel()) && i != dominant)
+                continue;
+            
             juce::MidiMessage weightedMessage = message;
             
             // Apply weight to velocity
@@ -545,6 +763,8 @@ std::vector<juce::MidiMessage> AIMidiGenerator::mergeOverlappingNotes(const std:
                 // Remove this note from active notes
                 activeNotes.erase(it);
             }
+        } else if (message.isController() || message.isPitchWheel()) {
+            mergedMessages.push_back(message);
         }
     }
     
@@ -834,31 +1054,9 @@ std::vector<AIMidiGenerator::InstrumentPreset> AIMidiGenerator::getRecommendedPr
 // Implementation of mood-specific pattern generation methods
 AIMidiGenerator::GeneratedPattern AIMidiGenerator::generateChillPattern(double duration)
 {
-    GeneratedPattern pattern;
+    // Relaxed, ambient line: a slow, simple motif in soft, long notes
+    auto pattern = generateMotifMelody(duration, 0, currentContext.energy * 0.4f, currentContext.complexity * 0.5f);
     pattern.patternType = "chill";
-    pattern.duration = duration;
-    
-    // Generate relaxed, ambient pattern
-    int noteCount = static_cast<int>(duration * 2); // Slower notes
-    double currentTime = 0.0;
-    
-    for (int i = 0; i < noteCount; ++i)
-    {
-        int note = 60 + random.nextInt(12); // Random notes in one octave
-        int velocity = 40 + random.nextInt(30); // Soft velocities
-        
-        juce::MidiMessage noteOn = juce::MidiMessage::noteOn(0, note, static_cast<juce::uint8>(velocity));
-        noteOn.setTimeStamp(currentTime);
-        pattern.messages.push_back(noteOn);
-        
-        juce::MidiMessage noteOff = juce::MidiMessage::noteOff(0, note, static_cast<juce::uint8>(velocity));
-        noteOff.setTimeStamp(currentTime + 1.0); // Long notes
-        pattern.messages.push_back(noteOff);
-        
-        currentTime += 0.5 + random.nextFloat() * 0.5; // Variable timing
-    }
-    
-    pattern.confidence = 0.8f;
     return pattern;
 }
 
@@ -934,38 +1132,9 @@ AIMidiGenerator::GeneratedPattern AIMidiGenerator::generateSuspensefulPattern(do
 
 AIMidiGenerator::GeneratedPattern AIMidiGenerator::generateUpliftingPattern(double duration)
 {
-    GeneratedPattern pattern;
+    // Ascending, bright figure: punchy rising sixteenths over the progression
+    auto pattern = generateMoodArpeggio("uplifting", duration, 0);
     pattern.patternType = "uplifting";
-    pattern.duration = duration;
-    
-    // Generate ascending, bright pattern
-    int noteCount = static_cast<int>(duration * 4); // Higher density
-    double currentTime = 0.0;
-    
-    for (int i = 0; i < noteCount; ++i)
-    {
-        // Ascending pattern with major scale
-        int scaleDegree = i % 7; // Major scale degrees
-        int octave = 4 + (i / 7); // Ascending octaves
-        int note = 60 + scaleDegree + (octave * 12); // C major scale
-        
-        // Bright, energetic velocities
-        int velocity = 70 + random.nextInt(30); // High velocity
-        
-        juce::MidiMessage noteOn = juce::MidiMessage::noteOn(0, note, static_cast<juce::uint8>(velocity));
-        noteOn.setTimeStamp(currentTime);
-        pattern.messages.push_back(noteOn);
-        
-        // Shorter, punchy notes
-        double noteLength = 0.2 + random.nextFloat() * 0.3; // 0.2-0.5 seconds
-        juce::MidiMessage noteOff = juce::MidiMessage::noteOff(0, note, static_cast<juce::uint8>(velocity));
-        noteOff.setTimeStamp(currentTime + noteLength);
-        pattern.messages.push_back(noteOff);
-        
-        // Regular, upbeat timing
-        currentTime += 0.25 + random.nextFloat() * 0.1; // Slight variation
-    }
-    
     pattern.confidence = 0.9f;
     return pattern;
 }
@@ -1018,43 +1187,10 @@ AIMidiGenerator::GeneratedPattern AIMidiGenerator::generateOminousPattern(double
 
 AIMidiGenerator::GeneratedPattern AIMidiGenerator::generateRomanticPattern(double duration)
 {
-    GeneratedPattern pattern;
+    // Flowing, lyrical line: a moderately paced motif with plenty of development
+    auto pattern = generateMotifMelody(duration, 0, 0.3f + currentContext.energy * 0.3f,
+                                       juce::jmax(0.6f, currentContext.complexity));
     pattern.patternType = "romantic";
-    pattern.duration = duration;
-    
-    // Generate flowing, lyrical pattern
-    int noteCount = static_cast<int>(duration * 3); // Moderate density
-    double currentTime = 0.0;
-    
-    for (int i = 0; i < noteCount; ++i)
-    {
-        // Romantic intervals (thirds, sixths)
-        int interval = (i % 2 == 0) ? 4 : 7; // Major third or perfect fifth
-        int baseNote = 60 + (i % 12);
-        int note = baseNote + interval;
-        note = juce::jlimit(48, 84, note);
-        
-        // Expressive velocities with crescendo/decrescendo
-        int baseVelocity = 60;
-        float crescendo = std::sin(currentTime * 2.0) * 0.3f; // Musical phrasing
-        int velocity = juce::jlimit(40, 80, static_cast<int>(baseVelocity + crescendo * 20));
-        
-        juce::MidiMessage noteOn = juce::MidiMessage::noteOn(0, note, static_cast<juce::uint8>(velocity));
-        noteOn.setTimeStamp(currentTime);
-        pattern.messages.push_back(noteOn);
-        
-        // Flowing note lengths
-        double noteLength = 0.4 + random.nextFloat() * 0.4; // 0.4-0.8 seconds
-        juce::MidiMessage noteOff = juce::MidiMessage::noteOff(0, note, static_cast<juce::uint8>(velocity));
-        noteOff.setTimeStamp(currentTime + noteLength);
-        pattern.messages.push_back(noteOff);
-        
-        // Rubato timing - slight tempo variations
-        double baseTime = 0.3;
-        double rubato = std::sin(currentTime * 1.5) * 0.1; // Subtle tempo variation
-        currentTime += baseTime + rubato;
-    }
-    
     pattern.confidence = 0.85f;
     return pattern;
 }
@@ -1110,41 +1246,9 @@ AIMidiGenerator::GeneratedPattern AIMidiGenerator::generateGrittyPattern(double
 
 AIMidiGenerator::GeneratedPattern AIMidiGenerator::generateDreamyPattern(double duration)
 {
-    GeneratedPattern pattern;
+    // Ethereal, floating figure: a soft, legato up-and-down arpeggio over the progression
+    auto pattern = generateMoodArpeggio("dreamy", duration, 0);
     pattern.patternType = "dreamy";
-    pattern.duration = duration;
-    
-    // Generate ethereal, floating pattern
-    int noteCount = static_cast<int>(duration * 2); // Low density
-    double currentTime = 0.0;
-    
-    for (int i = 0; i < noteCount; ++i)
-    {
-        // Use whole tone scale for dreamy effect
-        int wholeToneScale[] = {0, 2, 4, 6, 8, 10}; // Whole tone scale
-        int scaleIndex = i % 6;
-        int octave = 4 + (i / 6);
-        int note = 60 + wholeToneScale[scaleIndex] + (octave * 12);
-        note = juce::jlimit(48, 84, note);
-        
-        // Soft, floating velocities
-        int velocity = 40 + random.nextInt(25); // Low to medium velocity
-        
-        juce::MidiMessage noteOn = juce::MidiMessage::noteOn(0, note, static_cast<juce::uint8>(velocity));
-        noteOn.setTimeStamp(currentTime);
-        pattern.messages.push_back(noteOn);
-        
-        // Very long, sustained notes
-        double noteLength = 1.0 + random.nextFloat() * 1.0; // 1.0-2.0 seconds
-        juce::MidiMessage noteOff = juce::MidiMessage::noteOff(0, note, static_cast<juce::uint8>(velocity));
-        noteOff.setTimeStamp(currentTime + noteLength);
-        pattern.messages.push_back(noteOff);
-        
-        // Slow, floating timing
-        currentTime += 0.6 + random.nextFloat() * 0.4; // 0.6-1.0 seconds
-    }
-    
-    pattern.confidence = 0.8f;
     return pattern;
 }
 
@@ -1241,39 +1345,30 @@ std::vector<int> AIMidiGenerator::generateMelodyNotes(int length, int key, const
     return notes;
 }
 
-std::vector<double> AIMidiGenerator::generateMelodyRhythm(int length, float tempo)
-{
-    std::vector<double> rhythm;
-    
-    for (int i = 0; i < length; ++i)
-    {
-        // Generate rhythm based on tempo
-        double baseDuration = 60.0 / tempo; // Quarter note duration
-        double variation = 0.5 + random.nextFloat(); // 0.5 to 1.5 times base duration
-        rhythm.push_back(baseDuration * variation);
-    }
-    
-    return rhythm;
-}
-
-std::vector<int> AIMidiGenerator::generateMelodyVelocities(int length, float energy)
+std::vector<std::vector<int>> AIMidiGenerator::generateChordProgression(int length, int key, const std::string& scale)
 {
-    std::vector<int> velocities;
+    std::vector<std::vector<int>> progression;
     
-    for (int i = 0; i < length; ++i)
+    // Follow the chords recognised in the input, looping them in the order they were heard
+    if (!harmonyContext.chords.empty())
     {
-        int baseVelocity = static_cast<int>(40 + energy * 60); // 40-100 based on energy
-        int variation = random.nextInt(20) - 10; // ±10 variation
-        velocities.push_back(juce::jlimit(1, 127, baseVelocity + variation));
+        for (int i = 0; i < length; ++i)
+        {
+            const auto& pitchClasses = harmonyContext.chords[static_cast<size_t>(i) % harmonyContext.chords.size()];
+            std::vector<int> chord;
+            for (int pitchClass : pitchClasses)
+            {
+                // Stack upwards from the root
+                int note = pitchClass;
+                while (!chord.empty() && note <= chord.back())
+                    note += 12;
+                chord.push_back(note);
+            }
+            progression.push_back(chord);
+        }
+        return progression;
     }
     
-    return velocities;
-}
-
-std::vector<std::vector<int>> AIMidiGenerator::generateChordProgression(int length, int key, const std::string& scale)
-{
-    std::vector<std::vector<int>> progression;
-    
     // Simple chord progression based on key
     std::vector<int> chordRoots = {0, 2, 4, 5}; // I, iii, IV, V progression
     
@@ -1541,6 +1636,75 @@ float AIMidiGenerator::analyzePatternEnergy(const GeneratedPattern& pattern)
     return juce::jlimit(0.0f, 1.0f, averageVelocity / 127.0f);
 }
 
+void AIMidiGenerator::setMemoryLedger(MemoryLedger* ledger)
+{
+    libraryCharge.attach(ledger, MemoryLedger::Subsystem::PatternLibrary);
+    updateMemoryCharge();
+}
+
+size_t AIMidiGenerator::estimatePatternBytes(const GeneratedPattern& pattern)
+{
+    size_t bytes = sizeof(GeneratedPattern) + pattern.patternType.capacity();
+    bytes += pattern.messages.capacity() * sizeof(juce::MidiMessage);
+    
+    // Sysex and meta events keep their payload on the heap
+    for (const auto& message : pattern.messages)
+    {
+        if (message.getRawDataSize() > 8)
+            bytes += static_cast<size_t>(message.getRawDataSize());
+    }
+    
+    return bytes;
+}
+
+size_t AIMidiGenerator::estimateMemoryUsage() const
+{
+    // Map nodes cost roughly a key, a value and three pointers each
+    const size_t nodeOverhead = 3 * sizeof(void*);
+    size_t bytes = 0;
+    
+    for (const auto& library : patternLibraries)
+    {
+        bytes += nodeOverhead + library.first.capacity() + sizeof(library.second);
+        bytes += (library.second.capacity() - library.second.size()) * sizeof(GeneratedPattern);
+        for (const auto& pattern : library.second)
+            bytes += estimatePatternBytes(pattern);
+    }
+    
+    for (const auto& custom : customPatterns)
+        bytes += nodeOverhead + custom.first.capacity() + estimatePatternBytes(custom.second);
+    
+    for (const auto& hybrid : hybridMoods)
+    {
+        bytes += nodeOverhead + hybrid.first.capacity() + sizeof(HybridMood) + hybrid.second.description.capacity();
+        bytes += hybrid.second.moods.capacity() * sizeof(std::string) + hybrid.second.weights.capacity() * sizeof(float);
+    }
+    
+    for (const auto& preset : instrumentPresets)
+        bytes += nodeOverhead + sizeof(preset) + preset.second.parameters.size() * (nodeOverhead + sizeof(std::pair<std::string, float>));
+    
+    return bytes;
+}
+
+void AIMidiGenerator::trimPatternLibraries(size_t maxPatternsPerLibrary)
+{
+    // Drop the oldest patterns first; the newest reflect the current session
+    for (auto& library : patternLibraries)
+    {
+        auto& patterns = library.second;
+        if (patterns.size() > maxPatternsPerLibrary)
+            patterns.erase(patterns.begin(), patterns.begin() + static_cast<std::ptrdiff_t>(patterns.size() - maxPatternsPerLibrary));
+        patterns.shrink_to_fit();
+    }
+    
+    updateMemoryCharge();
+}
+
+void AIMidiGenerator::updateMemoryCharge()
+{
+    libraryCharge.setBytes(estimateMemoryUsage());
+}
+
 std::string AIMidiGenerator::classifyPatternType(const GeneratedPattern& pattern)
 {
     // Classify the type of pattern based on its characteristics
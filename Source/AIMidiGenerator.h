@@ -5,6 +5,9 @@
 #include <map>
 #include <string>
 #include <memory>
+#include "MemoryLedger.h"
+#include "MotifEngine.h"
+#include "ControllerCurves.h"
 
 /**
  * AI-Driven Real-time MIDI Generation System
@@ -26,6 +29,14 @@ public:
         double currentTime = 0.0;
     };
     
+    // Harmony heard in the input; while it holds chords, generated progressions follow them
+    struct HarmonyContext
+    {
+        std::vector<std::vector<int>> chords; // pitch classes, root first, oldest chord first
+        double secondsPerChord = 1.0;         // harmonic rhythm
+        float changeDensity = 0.0f;           // chord changes per beat, 0-1
+    };
+    
     struct GeneratedPattern
     {
         std::vector<juce::MidiMessage> messages;
@@ -34,6 +45,16 @@ public:
         std::string patternType = "melody";
     };
     
+    // How one context differs from another, as flags. Each kind of change has a cheaper remedy than regenerating.
+    enum ContextChange
+    {
+        NoContextChange = 0,
+        TimingChange = 1,       // tempo: rescale timestamps
+        VelocityChange = 2,     // energy: remap drum fill velocities; other patterns regenerate
+        PitchSpaceChange = 4,   // key: transpose melodic notes
+        StructuralChange = 8    // moods, scale, complexity or metre: regenerate
+    };
+    
     struct InstrumentPreset
     {
         int program = 0; // MIDI program number
@@ -55,19 +76,43 @@ public:
     
     // Main generation functions
     void setGenerationContext(const GenerationContext& context);
+    const GenerationContext& getGenerationContext() const { return currentContext; }
     GeneratedPattern generateMelody(double duration, int channel = 0);
     GeneratedPattern generateHarmony(double duration, int channel = 1);
     GeneratedPattern generateRhythm(double duration, int channel = 9); // Drum channel
     GeneratedPattern generateFill(double duration, int channel = 9);
     
+    // Arpeggiated figure over the chord progression, shaped by the current mood
+    GeneratedPattern generateArpeggio(double duration, int channel = 0);
+    
     // Real-time generation
     void generateRealTimeContent(std::vector<juce::MidiMessage>& output, double currentTime, double lookAhead = 1.0);
     void updateContext(const GenerationContext& context);
+    int getLastContextChange() const { return lastContextChange; }
+    void setHarmonyContext(const HarmonyContext& harmony);
+    const HarmonyContext& getHarmonyContext() const { return harmonyContext; }
     
     // Pattern generation based on mood
-    GeneratedPattern generateMoodPattern(const std::string& mood, double duration, const std::string& patternType);
+    GeneratedPattern generateMoodPattern(const std::string& mood, double duration, const std::string& patternType = "melody");
     GeneratedPattern generateTransitionPattern(const std::string& fromMood, const std::string& toMood, double duration);
     
+    // Mood pattern for the current context. The last pattern of the same type and length in beats is reused when
+    // the context has changed only in tempo, energy or key since it was generated; anything else generates anew.
+    GeneratedPattern getContextPattern(double duration, const std::string& patternType, bool withControllerLanes = true);
+    void clearPatternCache() { patternCache.clear(); }
+    void clearPatternCache(const std::string& patternType) { patternCache.erase(patternType); }
+    
+    // Context diffing; the time position is not part of a pattern's content and is ignored
+    static int diffContexts(const GenerationContext& from, const GenerationContext& to);
+    
+    // Brings a pattern generated under one context to another with the cheapest transforms that cover the change.
+    // Returns false, leaving the pattern alone, when the change is structural.
+    static bool adaptPattern(GeneratedPattern& pattern, const GenerationContext& from, const GenerationContext& to,
+                             int drumChannel = 9);
+    static void rescalePattern(GeneratedPattern& pattern, double timeScale);
+    static void remapVelocities(GeneratedPattern& pattern, float fromEnergy, float toEnergy);
+    static void transposePattern(GeneratedPattern& pattern, int semitones, int drumChannel = 9);
+    
     // Hybrid mood system
     GeneratedPattern generateHybridPattern(const std::vector<std::string>& moods, const std::vector<float>& weights, double duration);
     GeneratedPattern generatePredefinedHybrid(const std::string& hybridName, double duration);
@@ -103,25 +148,54 @@ public:
     void setCreativityLevel(float creativity) { creativityLevel = juce::jlimit(0.0f, 1.0f, creativity); }
     void setComplexityLevel(float complexity) { complexityLevel = juce::jlimit(0.0f, 1.0f, complexity); }
     
+    // Reseeds generation and forgets the remembered motif, so a seed always yields the same patterns
+    void setRandomSeed(juce::int64 seed);
+    
+    // CC and pitch-bend lanes on mood patterns; tolerance is the largest error, in controller steps, thinning may leave
+    void setControllerLanesEnabled(bool enabled) { controllerLanesEnabled = enabled; }
+    void setControllerTolerance(float steps) { controllerTolerance = juce::jmax(0.0f, steps); }
+    
     // Pattern management
     void loadPatternLibrary(const std::string& libraryPath);
     void savePatternLibrary(const std::string& libraryPath);
     void addCustomPattern(const std::string& name, const GeneratedPattern& pattern);
     
+    // Memory accounting: libraries are charged to the ledger's pattern library account
+    void setMemoryLedger(MemoryLedger* ledger);
+    size_t estimateMemoryUsage() const;
+    void trimPatternLibraries(size_t maxPatternsPerLibrary);
+    
 private:
     // Generation context
     GenerationContext currentContext;
+    HarmonyContext harmonyContext;
     std::map<int, InstrumentPreset> instrumentPresets;
     
     // Generation parameters
     float generationIntensity = 0.5f;
     float creativityLevel = 0.5f;
     float complexityLevel = 0.5f;
+    bool controllerLanesEnabled = true;
+    float controllerTolerance = 1.0f;
     
     // Pattern libraries
     std::map<std::string, std::vector<GeneratedPattern>> patternLibraries;
     std::map<std::string, GeneratedPattern> customPatterns;
     std::map<std::string, HybridMood> hybridMoods;
+    MemoryLedger::Charge libraryCharge;
+    
+    // Patterns as generated, by type, with the context they were generated under; callers get adapted copies
+    struct CachedPattern
+    {
+        GenerationContext context;
+        GeneratedPattern pattern;
+    };
+    std::map<std::string, CachedPattern> patternCache;
+    int lastContextChange = NoContextChange;
+    
+    // Motif that melodies develop, kept while the mood and scale stay the same
+    MotifEngine::Motif motifMemory;
+    std::string motifMemoryKey;
     
     // Random number generation
     juce::Random random;
@@ -133,8 +207,6 @@ private:
     
     // Melody generation
     std::vector<int> generateMelodyNotes(int length, int key, const std::string& scale);
-    std::vector<double> generateMelodyRhythm(int length, float tempo);
-    std::vector<int> generateMelodyVelocities(int length, float energy);
     
     // Harmony generation
     std::vector<std::vector<int>> generateChordProgression(int length, int key, const std::string& scale);
@@ -144,6 +216,18 @@ private:
     std::vector<double> generateRhythmPattern(int length, float complexity, const std::string& mood);
     std::vector<int> generateDrumPattern(int length, float energy, const std::string& mood);
     
+    // Motif-developed melody
+    GeneratedPattern generateMotifMelody(double duration, int channel, float energy, float complexity);
+    
+    // Arpeggio generation
+    GeneratedPattern generateMoodArpeggio(const std::string& mood, double duration, int channel);
+    
+    // The mood's notes alone; generateMoodPattern adds the expression lanes
+    GeneratedPattern generateMoodNotes(const std::string& mood, double duration, const std::string& patternType);
+    
+    // Expression lanes
+    void addControllerLanes(GeneratedPattern& pattern, const std::string& mood, int channel);
+    
     // Fill generation
     GeneratedPattern generateDrumFill(double duration, float energy);
     GeneratedPattern generateMelodicFill(double duration, int key, const std::string& scale);
@@ -166,6 +250,9 @@ private:
     bool isInScale(int note, int key, const std::string& scale);
     int getNoteInKey(int note, int key);
     
+    void updateMemoryCharge();
+    static size_t estimatePatternBytes(const GeneratedPattern& pattern);
+    
     // Pattern analysis
     float analyzePatternComplexity(const GeneratedPattern& pattern);
     float analyzePatternEnergy(const GeneratedPattern& pattern);
@@ -0,0 +1,199 @@
+#include "Arpeggiator.h"
+
+#include <algorithm>
+
+Arpeggiator::Arpeggiator()
+{
+    rebuildSequence();
+}
+
+void Arpeggiator::setSettings(const Settings& newSettings)
+{
+    settings = newSettings;
+    settings.octaves = juce::jlimit(1, maxOctaves, settings.octaves);
+    settings.stepTicks = std::max(1, settings.stepTicks);
+    settings.gate = juce::jlimit(0.05f, 1.0f, settings.gate);
+    settings.velocity = juce::jlimit(1, 127, settings.velocity);
+    rebuildSequence();
+}
+
+void Arpeggiator::setCustomSteps(const Step* steps, int numSteps)
+{
+    numCustomSteps = juce::jlimit(0, maxCustomSteps, numSteps);
+    std::copy(steps, steps + numCustomSteps, customSteps.begin());
+    rebuildSequence();
+}
+
+void Arpeggiator::setChord(const int* notes, int numNotes)
+{
+    chordSize = 0;
+    for (int i = 0; i < numNotes && chordSize < maxChordNotes; ++i)
+        if (notes[i] >= 0 && notes[i] <= 127)
+            chord[static_cast<size_t>(chordSize++)] = notes[i];
+
+    // Lowest first with doubled notes removed, so "up" means up whatever order the notes were held in
+    std::sort(chord.begin(), chord.begin() + chordSize);
+    chordSize = static_cast<int>(std::unique(chord.begin(), chord.begin() + chordSize) - chord.begin());
+    rebuildSequence();
+}
+
+std::vector<juce::MidiMessage> Arpeggiator::arpeggiate(const std::vector<std::vector<int>>& progression,
+                                                       std::int64_t ticksPerChord, float tempo, int channel)
+{
+    std::vector<juce::MidiMessage> messages;
+    const auto stepsPerChord = static_cast<size_t>(std::max<std::int64_t>(1, ticksPerChord / std::max(1, settings.stepTicks)));
+    messages.reserve(progression.size() * stepsPerChord * 2);
+
+    const auto emit = [&messages, tempo, channel](const Event& event)
+    {
+        auto message = event.velocity > 0
+                         ? juce::MidiMessage::noteOn(channel, event.note, static_cast<juce::uint8>(event.velocity))
+                         : juce::MidiMessage::noteOff(channel, event.note);
+        message.setTimeStamp(ticksToSeconds(event.tick, tempo));
+        messages.push_back(message);
+    };
+
+    // The batch figure starts on its own, whatever was last rendered live
+    noteSounding = false;
+    std::int64_t tick = 0;
+    for (const auto& notes : progression)
+    {
+        setChord(notes);
+        render(tick, tick + ticksPerChord, emit);
+        tick += ticksPerChord;
+    }
+    flush(tick, emit);
+    return messages;
+}
+
+Arpeggiator::Settings Arpeggiator::getMoodSettings(const std::string& mood)
+{
+    Settings moodSettings;
+    moodSettings.octaves = 2;
+
+    if (mood == "dreamy")
+    {
+        moodSettings.mode = Mode::UpDown;
+        moodSettings.stepTicks = ticksPerQuarter / 2;
+        moodSettings.gate = 1.0f;
+        moodSettings.velocity = 52;
+        moodSettings.accent = 0.1f;
+    }
+    else if (mood == "uplifting" || mood == "energetic" || mood == "frantic")
+    {
+        moodSettings.mode = Mode::Up;
+        moodSettings.gate = 0.6f;
+        moodSettings.velocity = 85;
+        moodSettings.accent = 0.2f;
+    }
+    else if (mood == "suspenseful" || mood == "ominous")
+    {
+        moodSettings.mode = Mode::RandomWalk;
+        moodSettings.octaves = 1;
+        moodSettings.velocity = 60;
+    }
+    else
+    {
+        moodSettings.mode = Mode::UpDown;
+        moodSettings.stepTicks = ticksPerQuarter / 2;
+    }
+    return moodSettings;
+}
+
+void Arpeggiator::rebuildSequence()
+{
+    sequenceLength = 0;
+    if (chordSize == 0)
+        return;
+
+    // Chord tones over the octave range, lowest first
+    std::array<std::uint8_t, maxChordNotes * maxOctaves> up {};
+    int upLength = 0;
+    for (int octave = 0; octave < settings.octaves; ++octave)
+        for (int i = 0; i < chordSize; ++i)
+        {
+            const int pitch = chord[static_cast<size_t>(i)] + 12 * octave;
+            if (pitch <= 127)
+                up[static_cast<size_t>(upLength++)] = static_cast<std::uint8_t>(pitch);
+        }
+
+    switch (settings.mode)
+    {
+        case Mode::Up:
+            std::copy(up.begin(), up.begin() + upLength, sequence.begin());
+            sequenceLength = upLength;
+            break;
+
+        case Mode::Down:
+            std::reverse_copy(up.begin(), up.begin() + upLength, sequence.begin());
+            sequenceLength = upLength;
+            break;
+
+        case Mode::UpDown:
+        {
+            // The top and bottom notes aren't repeated at the turns
+            std::copy(up.begin(), up.begin() + upLength, sequence.begin());
+            sequenceLength = upLength;
+            for (int i = upLength - 2; i > 0; --i)
+                sequence[static_cast<size_t>(sequenceLength++)] = up[static_cast<size_t>(i)];
+            break;
+        }
+
+        case Mode::RandomWalk:
+        {
+            // A fixed walk per chord, one chord tone up or down per step, turning back at the ends
+            std::uint32_t state = settings.seed != 0 ? settings.seed : 1u;
+            int position = 0;
+            for (int i = 0; i < maxSequence; ++i)
+            {
+                sequence[static_cast<size_t>(i)] = up[static_cast<size_t>(position)];
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+                if (upLength > 1)
+                {
+                    position += (state & 1u) != 0 ? 1 : -1;
+                    if (position < 0)
+                        position = 1;
+                    else if (position >= upLength)
+                        position = upLength - 2;
+                }
+            }
+            sequenceLength = maxSequence;
+            break;
+        }
+
+        case Mode::Custom:
+        {
+            for (int i = 0; i < numCustomSteps; ++i)
+            {
+                const auto& step = customSteps[static_cast<size_t>(i)];
+                auto& pitch = sequence[static_cast<size_t>(i)];
+                pitch = restPitch;
+                if (step.rest)
+                    continue;
+
+                // Tones past the top of the chord continue into the next octave, negative ones into the last
+                const int wraps = step.tone >= 0 ? step.tone / chordSize : -((chordSize - 1 - step.tone) / chordSize);
+                const int tone = step.tone - wraps * chordSize;
+                const int note = chord[static_cast<size_t>(tone)] + 12 * (wraps + step.octave);
+                if (note >= 0 && note <= 127)
+                    pitch = static_cast<std::uint8_t>(note);
+            }
+            sequenceLength = numCustomSteps;
+            break;
+        }
+    }
+}
+
+int Arpeggiator::getGateTicks() const
+{
+    return juce::jlimit(1, settings.stepTicks, juce::roundToInt(settings.gate * static_cast<float>(settings.stepTicks)));
+}
+
+int Arpeggiator::getVelocity(std::int64_t tick) const
+{
+    const bool onBeat = tick % ticksPerQuarter == 0;
+    const float velocity = static_cast<float>(settings.velocity) * (onBeat ? 1.0f + settings.accent : 1.0f);
+    return juce::jlimit(1, 127, juce::roundToInt(velocity));
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Arpeggiator
+ * Expands a chord into a repeating figure (up, down, up/down, random walk or
+ * a custom step table) on a tick grid. Setting a chord precomputes the whole
+ * pitch sequence for the mode and octave range. Emitting a note is then a
+ * table lookup at the step's index on the grid, so the figure stays locked to
+ * bar lines however it is rendered. All tables are fixed size, so render() can
+ * run on the audio thread as well as in batch generation.
+ */
+class Arpeggiator
+{
+public:
+    static constexpr int ticksPerQuarter = 960;
+    static constexpr int maxChordNotes = 8;
+    static constexpr int maxOctaves = 4;
+    static constexpr int maxCustomSteps = 32;
+    static constexpr int maxSequence = 2 * maxChordNotes * maxOctaves;
+
+    enum class Mode
+    {
+        Up,
+        Down,
+        UpDown,
+        RandomWalk,
+        Custom
+    };
+
+    // One step of a custom table: a chord tone (counting past the top wraps up an octave) or a rest
+    struct Step
+    {
+        int tone = 0;
+        int octave = 0;
+        bool rest = false;
+    };
+
+    struct Settings
+    {
+        Mode mode = Mode::Up;
+        int octaves = 1;                      // 1 to maxOctaves
+        int stepTicks = ticksPerQuarter / 4;  // sixteenth notes
+        float gate = 0.8f;                    // note length as a share of a step, up to 1
+        int velocity = 90;
+        float accent = 0.15f;                 // extra velocity share on the first step of each beat
+        std::uint32_t seed = 1;               // random walk
+    };
+
+    struct Event
+    {
+        std::int64_t tick = 0;
+        int note = 60;
+        int velocity = 0;   // 0 for a note-off
+    };
+
+    Arpeggiator();
+
+    // Both rebuild the pitch sequence for the current chord
+    void setSettings(const Settings& newSettings);
+    void setCustomSteps(const Step* steps, int numSteps);
+    const Settings& getSettings() const { return settings; }
+
+    // Held notes in any order; extra notes past maxChordNotes are ignored. An empty chord rests.
+    void setChord(const int* notes, int numNotes);
+    void setChord(const std::vector<int>& notes) { setChord(notes.data(), static_cast<int>(notes.size())); }
+    int getSequenceLength() const { return sequenceLength; }
+
+    /**
+     * Calls emit(const Event&) for every note-on and note-off with a tick in
+     * [fromTick, toTick), in order. Consecutive calls must cover consecutive
+     * ranges; a note started in one call is released in a later one with the
+     * pitch it started with, even if the chord has changed since.
+     */
+    template <typename Emit>
+    void render(std::int64_t fromTick, std::int64_t toTick, Emit&& emit);
+
+    // Releases a note still sounding at tick, then starts the next render from a clean state
+    template <typename Emit>
+    void flush(std::int64_t tick, Emit&& emit);
+
+    // Batch: each chord of the progression for ticksPerChord ticks; timestamps in seconds at tempo
+    std::vector<juce::MidiMessage> arpeggiate(const std::vector<std::vector<int>>& progression,
+                                              std::int64_t ticksPerChord, float tempo, int channel);
+
+    // Figure, range and feel each mood asks for
+    static Settings getMoodSettings(const std::string& mood);
+
+    static double ticksToSeconds(std::int64_t ticks, float tempo) { return static_cast<double>(ticks) * 60.0 / (tempo * ticksPerQuarter); }
+    static std::int64_t secondsToTicks(double seconds, float tempo) { return static_cast<std::int64_t>(seconds * tempo * ticksPerQuarter / 60.0); }
+
+private:
+    static constexpr std::uint8_t restPitch = 0xff;
+
+    void rebuildSequence();
+    int getGateTicks() const;
+    int getVelocity(std::int64_t tick) const;
+
+    Settings settings;
+    std::array<Step, maxCustomSteps> customSteps {};
+    int numCustomSteps = 0;
+
+    std::array<int, maxChordNotes> chord {};
+    int chordSize = 0;
+
+    // Pitch of each step of the figure, or restPitch
+    std::array<std::uint8_t, maxSequence> sequence {};
+    int sequenceLength = 0;
+
+    // The note started last and when it ends
+    bool noteSounding = false;
+    int soundingNote = 0;
+    std::int64_t noteOffTick = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Arpeggiator)
+};
+
+template <typename Emit>
+void Arpeggiator::render(std::int64_t fromTick, std::int64_t toTick, Emit&& emit)
+{
+    const std::int64_t stepTicks = std::max(1, settings.stepTicks);
+    std::int64_t step = (fromTick + stepTicks - 1) / stepTicks; // first step starting at or after fromTick
+    if (fromTick < 0)
+        step = fromTick / stepTicks;
+
+    for (std::int64_t onTick = step * stepTicks; onTick < toTick; ++step, onTick += stepTicks)
+    {
+        if (noteSounding && noteOffTick <= onTick)
+        {
+            emit(Event { noteOffTick, soundingNote, 0 });
+            noteSounding = false;
+        }
+
+        if (sequenceLength == 0)
+            continue;
+
+        // Steps before tick 0 are negative; floor-mod keeps them on the figure
+        const auto pitch = sequence[static_cast<size_t>(((step % sequenceLength) + sequenceLength) % sequenceLength)];
+        if (pitch == restPitch)
+            continue;
+
+        // Only after a switch to a shorter step can the last note still be sounding
+        if (noteSounding)
+        {
+            emit(Event { onTick, soundingNote, 0 });
+            noteSounding = false;
+        }
+
+        emit(Event { onTick, pitch, getVelocity(onTick) });
+        noteSounding = true;
+        soundingNote = pitch;
+        noteOffTick = onTick + getGateTicks();
+    }
+
+    if (noteSounding && noteOffTick < toTick)
+    {
+        emit(Event { noteOffTick, soundingNote, 0 });
+        noteSounding = false;
+    }
+}
+
+template <typename Emit>
+void Arpeggiator::flush(std::int64_t tick, Emit&& emit)
+{
+    if (noteSounding)
+        emit(Event { std::min(tick, noteOffTick), soundingNote, 0 });
+    noteSounding = false;
+}
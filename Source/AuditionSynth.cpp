@@ -0,0 +1,691 @@
+#include "AuditionSynth.h"
+#include "FastMath.h"
+#include "SimdKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    constexpr float voiceHeadroom = 0.25f;  // -12 dB per voice so dense patterns don't clip
+    constexpr float silenceLevel = 1.0e-4f;
+    constexpr float drumChokeSeconds = 0.02f;
+
+    // Polynomial residual that removes the aliasing step at a waveform discontinuity
+    inline float polyBlep(float t, float dt)
+    {
+        if (t < dt)
+        {
+            t /= dt;
+            return t + t - t * t - 1.0f;
+        }
+        if (t > 1.0f - dt)
+        {
+            t = (t - 1.0f) / dt;
+            return t * t + t + t + 1.0f;
+        }
+        return 0.0f;
+    }
+
+    inline float bandLimitedSaw(float phase, float increment)
+    {
+        return 2.0f * phase - 1.0f - polyBlep(phase, increment);
+    }
+
+    inline float bandLimitedSquare(float phase, float increment)
+    {
+        float value = phase < 0.5f ? 1.0f : -1.0f;
+        return value + polyBlep(phase, increment) - polyBlep(FastMath::wrapUnit(phase + 0.5f), increment);
+    }
+
+    // Leaky integral of the band-limited square; starts at -1 so a fresh voice has no DC step
+    inline float bandLimitedTriangle(float phase, float increment, float& state)
+    {
+        state = 0.9995f * state + 4.0f * increment * bandLimitedSquare(phase, increment);
+        return state;
+    }
+
+    inline float advancePhase(float phase, float increment)
+    {
+        phase += increment;
+        return phase >= 1.0f ? phase - 1.0f : phase;
+    }
+
+    inline float timeConstant(float seconds, double sampleRate)
+    {
+        return std::exp(-1.0f / std::max(1.0f, seconds * static_cast<float>(sampleRate)));
+    }
+}
+
+AuditionSynth::AuditionSynth(MemoryLedger* ledger)
+    : voiceScratch(TrackedAllocator<float>(ledger, MemoryLedger::Subsystem::Caches))
+{
+    for (auto& samples : drumSamples)
+        samples = TrackedVector<float>(TrackedAllocator<float>(ledger, MemoryLedger::Subsystem::Caches));
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        channelPrograms[static_cast<size_t>(channel)].store(0);
+        channelVolumes[static_cast<size_t>(channel)].store(0.8f);
+        channelPans[static_cast<size_t>(channel)].store(0.0f);
+    }
+}
+
+AuditionSynth::~AuditionSynth() {}
+
+void AuditionSynth::prepare(double newSampleRate, int maximumBlockSize, int numVoices)
+{
+    sampleRate = newSampleRate > 0.0 ? newSampleRate : 44100.0;
+    maxBlockSize = std::max(1, maximumBlockSize);
+    numVoicesInUse = juce::jlimit(1, maxVoices, numVoices);
+
+    voiceScratch.assign(static_cast<size_t>(maxBlockSize), 0.0f);
+    buildDrumKit();
+
+    for (auto& voice : voices)
+        voice = Voice();
+
+    nextStartOrder = 0;
+    numPendingEvents = 0;
+    outputLimiter.prepare(sampleRate);
+    eventFifo.reset();
+    playheadSamples.store(0);
+    activeVoiceCount.store(0);
+    stopRequested.store(false);
+}
+
+void AuditionSynth::setChannelPreset(int channel, const AIMidiGenerator::InstrumentPreset& preset)
+{
+    if (channel < 0 || channel >= numChannels)
+        return;
+
+    const auto index = static_cast<size_t>(channel);
+    channelPrograms[index].store(juce::jlimit(0, 127, preset.program));
+    channelVolumes[index].store(juce::jlimit(0.0f, 1.0f, preset.volume));
+    channelPans[index].store(juce::jlimit(-1.0f, 1.0f, preset.pan));
+}
+
+bool AuditionSynth::queuePattern(const AIMidiGenerator::GeneratedPattern& pattern, double startDelaySeconds)
+{
+    const std::int64_t start = playheadSamples.load()
+                             + static_cast<std::int64_t>(std::max(0.0, startDelaySeconds) * sampleRate);
+
+    const auto wanted = static_cast<int>(std::count_if(pattern.messages.begin(), pattern.messages.end(), isChannelMessage));
+
+    int start1 = 0, size1 = 0, start2 = 0, size2 = 0;
+    eventFifo.prepareToWrite(wanted, start1, size1, start2, size2);
+
+    int written = 0;
+    for (const auto& message : pattern.messages)
+    {
+        if (written == size1 + size2)
+            break;
+
+        if (!isChannelMessage(message))
+            continue;
+
+        const auto* raw = message.getRawData();
+
+        Event event;
+        event.samplePosition = start + static_cast<std::int64_t>(message.getTimeStamp() * sampleRate);
+        event.status = static_cast<std::uint8_t>(raw[0] & 0xf0);
+        // AIMidiGenerator numbers channels from 0 and hands them straight to juce::MidiMessage,
+        // which expects 1-16; getChannel() % 16 recovers the generator's own channel index
+        event.channel = static_cast<std::uint8_t>(message.getChannel() % numChannels);
+        event.data1 = raw[1];
+        event.data2 = message.getRawDataSize() > 2 ? raw[2] : 0;
+
+        const int slot = written < size1 ? start1 + written : start2 + (written - size1);
+        fifoEvents[static_cast<size_t>(slot)] = event;
+        ++written;
+    }
+
+    eventFifo.finishedWrite(written);
+    return written == wanted;
+}
+
+void AuditionSynth::renderNextBlock(juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& incomingMidi)
+{
+    const int numSamples = buffer.getNumSamples();
+    if (maxBlockSize == 0 || numSamples == 0 || buffer.getNumChannels() == 0)
+        return;
+
+    float* left = buffer.getWritePointer(0);
+    float* right = buffer.getNumChannels() > 1 ? buffer.getWritePointer(1) : left;
+    const std::int64_t blockStart = playheadSamples.load();
+
+    if (stopRequested.exchange(false))
+    {
+        releaseAll(false);
+        numPendingEvents = 0;
+        outputLimiter.reset();
+    }
+
+    // Move newly queued events and this block's MIDI into the pending list
+    bool addedEvents = false;
+    {
+        int start1 = 0, size1 = 0, start2 = 0, size2 = 0;
+        eventFifo.prepareToRead(eventQueueSize - numPendingEvents, start1, size1, start2, size2);
+        for (int i = 0; i < size1; ++i)
+            pendingEvents[static_cast<size_t>(numPendingEvents++)] = fifoEvents[static_cast<size_t>(start1 + i)];
+        for (int i = 0; i < size2; ++i)
+            pendingEvents[static_cast<size_t>(numPendingEvents++)] = fifoEvents[static_cast<size_t>(start2 + i)];
+        eventFifo.finishedRead(size1 + size2);
+        addedEvents = size1 + size2 > 0;
+    }
+
+    for (const auto metadata : incomingMidi)
+    {
+        if (numPendingEvents == eventQueueSize)
+            break;
+
+        const auto message = metadata.getMessage();
+        if (!isChannelMessage(message))
+            continue;
+
+        Event event;
+        event.samplePosition = blockStart + metadata.samplePosition;
+        event.status = static_cast<std::uint8_t>(message.getRawData()[0] & 0xf0);
+        event.channel = static_cast<std::uint8_t>(message.getChannel() - 1);
+        event.data1 = message.getRawData()[1];
+        event.data2 = message.getRawDataSize() > 2 ? message.getRawData()[2] : 0;
+        pendingEvents[static_cast<size_t>(numPendingEvents++)] = event;
+        addedEvents = true;
+    }
+
+    if (addedEvents)
+    {
+        // In-place sort, no allocation; note-offs go before note-ons at the same sample
+        std::sort(pendingEvents.begin(), pendingEvents.begin() + numPendingEvents, [](const Event& a, const Event& b)
+        {
+            return a.samplePosition < b.samplePosition
+                || (a.samplePosition == b.samplePosition && a.status < b.status);
+        });
+    }
+
+    updateChannelGains();
+    outputLimiter.beginBlock();
+
+    // Render in chunks that end at the next event or the scratch size
+    int rendered = 0;
+    int nextEvent = 0;
+    while (rendered < numSamples)
+    {
+        const std::int64_t now = blockStart + rendered;
+        while (nextEvent < numPendingEvents && pendingEvents[static_cast<size_t>(nextEvent)].samplePosition <= now)
+        {
+            const auto& due = pendingEvents[static_cast<size_t>(nextEvent++)];
+            outputLimiter.push({ due.samplePosition, due.status, due.channel, due.data1, due.data2 });
+        }
+
+        OutputLimiter::Event allowed;
+        while (outputLimiter.pop(now, allowed))
+        {
+            Event event;
+            event.samplePosition = allowed.time;
+            event.status = allowed.status;
+            event.channel = allowed.channel;
+            event.data1 = allowed.data1;
+            event.data2 = allowed.data2;
+            handleEvent(event);
+        }
+
+        int chunk = std::min(numSamples - rendered, maxBlockSize);
+        if (nextEvent < numPendingEvents)
+        {
+            const std::int64_t untilEvent = pendingEvents[static_cast<size_t>(nextEvent)].samplePosition - now;
+            chunk = static_cast<int>(std::min<std::int64_t>(chunk, untilEvent));
+        }
+
+        // Deferred events resume as soon as the rate allows
+        const std::int64_t limiterReady = outputLimiter.getNextReadyTime(now);
+        if (limiterReady > now)
+            chunk = static_cast<int>(std::min<std::int64_t>(chunk, limiterReady - now));
+
+        renderVoices(left + rendered, right + rendered, chunk);
+        rendered += chunk;
+    }
+
+    std::move(pendingEvents.begin() + nextEvent, pendingEvents.begin() + numPendingEvents, pendingEvents.begin());
+    numPendingEvents -= nextEvent;
+    playheadSamples.store(blockStart + numSamples);
+
+    int active = 0;
+    for (int i = 0; i < numVoicesInUse; ++i)
+        active += voices[static_cast<size_t>(i)].active ? 1 : 0;
+    activeVoiceCount.store(active);
+}
+
+void AuditionSynth::handleEvent(const Event& event)
+{
+    const int channel = event.channel;
+    const auto index = static_cast<size_t>(channel);
+
+    switch (event.status)
+    {
+        case 0x90:
+            if (event.data2 > 0)
+                startNote(channel, event.data1, event.data2);
+            else
+                stopNote(channel, event.data1);
+            break;
+
+        case 0x80:
+            stopNote(channel, event.data1);
+            break;
+
+        case 0xb0:
+            if (event.data1 == 7)
+                channelVolumes[index].store(static_cast<float>(event.data2) / 127.0f);
+            else if (event.data1 == 10)
+                channelPans[index].store(juce::jlimit(-1.0f, 1.0f, (static_cast<float>(event.data2) - 64.0f) / 63.0f));
+            else if (event.data1 == 120 || event.data1 == 123)
+                releaseAll(event.data1 == 120);
+            updateChannelGains();
+            break;
+
+        case 0xc0:
+            channelPrograms[index].store(event.data1);
+            break;
+
+        default:
+            break;
+    }
+}
+
+void AuditionSynth::startNote(int channel, int note, int velocity)
+{
+    const float velocityGain = voiceHeadroom * static_cast<float>(velocity * velocity) / (127.0f * 127.0f);
+
+    if (channel == drumChannel)
+    {
+        const DrumPiece piece = getDrumPiece(note);
+        if (piece == DrumPiece::None || drumSamples[static_cast<size_t>(piece)].empty())
+            return;
+
+        // A closed hat chokes any ringing open hat
+        if (piece == DrumPiece::ClosedHat)
+        {
+            for (int i = 0; i < numVoicesInUse; ++i)
+            {
+                auto& other = voices[static_cast<size_t>(i)];
+                if (other.active && other.piece == DrumPiece::OpenHat)
+                {
+                    other.releasing = true;
+                    other.releaseCoefficient = timeConstant(drumChokeSeconds, sampleRate);
+                }
+            }
+        }
+
+        Voice& voice = allocateVoice(channel, note);
+        voice.piece = piece;
+        voice.samplePosition = 0;
+        voice.level = 1.0f;
+        voice.velocityGain = velocityGain;
+        return;
+    }
+
+    const Patch& patch = getPatch(channelPrograms[static_cast<size_t>(channel)].load());
+    Voice& voice = allocateVoice(channel, note);
+
+    const float frequency = 440.0f * FastMath::exp2((static_cast<float>(note) - 69.0f) / 12.0f);
+    voice.piece = DrumPiece::None;
+    voice.waveform = patch.waveform;
+    voice.increment = std::min(0.45f, frequency / static_cast<float>(sampleRate));
+    voice.increment2 = patch.detune > 0.0f ? std::min(0.45f, voice.increment * (1.0f + patch.detune)) : 0.0f;
+    voice.velocityGain = velocityGain;
+
+    const float cutoff = std::min(patch.cutoffHz, 0.45f * static_cast<float>(sampleRate));
+    voice.filterCoefficient = 1.0f - std::exp(-FastMath::twoPi * cutoff / static_cast<float>(sampleRate));
+
+    voice.inAttack = true;
+    voice.attackStep = 1.0f / std::max(1.0f, patch.attackSeconds * static_cast<float>(sampleRate));
+    voice.decayCoefficient = timeConstant(patch.decaySeconds, sampleRate);
+    voice.sustainLevel = patch.sustainLevel;
+    voice.releaseCoefficient = timeConstant(patch.releaseSeconds, sampleRate);
+}
+
+void AuditionSynth::stopNote(int channel, int note)
+{
+    // Drum hits always play out
+    if (channel == drumChannel)
+        return;
+
+    for (int i = 0; i < numVoicesInUse; ++i)
+    {
+        auto& voice = voices[static_cast<size_t>(i)];
+        if (voice.active && !voice.releasing && voice.channel == channel && voice.note == note)
+        {
+            voice.releasing = true;
+            voice.inAttack = false;
+        }
+    }
+}
+
+void AuditionSynth::releaseAll(bool immediately)
+{
+    for (auto& voice : voices)
+    {
+        if (immediately)
+            voice.active = false;
+        voice.releasing = true;
+        voice.inAttack = false;
+    }
+}
+
+AuditionSynth::Voice& AuditionSynth::allocateVoice(int channel, int note)
+{
+    Voice* chosen = nullptr;
+    bool keepState = true;
+
+    // Retrigger the same note in place; the envelope restarts from its current level
+    for (int i = 0; i < numVoicesInUse && chosen == nullptr; ++i)
+    {
+        auto& voice = voices[static_cast<size_t>(i)];
+        if (voice.active && voice.channel == channel && voice.note == note)
+            chosen = &voice;
+    }
+
+    for (int i = 0; i < numVoicesInUse && chosen == nullptr; ++i)
+    {
+        auto& voice = voices[static_cast<size_t>(i)];
+        if (!voice.active)
+        {
+            chosen = &voice;
+            keepState = false;
+        }
+    }
+
+    // Steal the quietest releasing voice, otherwise the oldest
+    if (chosen == nullptr)
+    {
+        float quietest = std::numeric_limits<float>::max();
+        for (int i = 0; i < numVoicesInUse; ++i)
+        {
+            auto& voice = voices[static_cast<size_t>(i)];
+            if (voice.releasing && voice.level < quietest)
+            {
+                quietest = voice.level;
+                chosen = &voice;
+            }
+        }
+    }
+
+    if (chosen == nullptr)
+    {
+        chosen = &voices[0];
+        for (int i = 1; i < numVoicesInUse; ++i)
+            if (voices[static_cast<size_t>(i)].startOrder < chosen->startOrder)
+                chosen = &voices[static_cast<size_t>(i)];
+    }
+
+    if (!keepState)
+    {
+        *chosen = Voice();
+        chosen->triangleState = -1.0f;
+        chosen->triangleState2 = -1.0f;
+    }
+
+    chosen->active = true;
+    chosen->releasing = false;
+    chosen->channel = channel;
+    chosen->note = note;
+    chosen->startOrder = nextStartOrder++;
+    return *chosen;
+}
+
+void AuditionSynth::renderVoices(float* left, float* right, int numSamples)
+{
+    float* scratch = voiceScratch.data();
+    for (int i = 0; i < numVoicesInUse; ++i)
+    {
+        auto& voice = voices[static_cast<size_t>(i)];
+        if (!voice.active)
+            continue;
+
+        if (voice.piece != DrumPiece::None)
+            renderDrumVoice(voice, scratch, numSamples);
+        else
+            renderMelodicVoice(voice, scratch, numSamples);
+
+        const auto channel = static_cast<size_t>(voice.channel);
+        SimdKernels::panMix(scratch, left, right, static_cast<size_t>(numSamples), leftGains[channel], rightGains[channel]);
+    }
+}
+
+void AuditionSynth::renderMelodicVoice(Voice& voice, float* out, int numSamples)
+{
+    const bool dualOscillator = voice.increment2 > 0.0f;
+    const float oscillatorGain = dualOscillator ? 0.5f : 1.0f;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        float value = 0.0f;
+        switch (voice.waveform)
+        {
+            case Waveform::Sine:
+                value = FastMath::sin2Pi(voice.phase);
+                if (dualOscillator)
+                    value += FastMath::sin2Pi(voice.phase2);
+                break;
+            case Waveform::Triangle:
+                value = bandLimitedTriangle(voice.phase, voice.increment, voice.triangleState);
+                if (dualOscillator)
+                    value += bandLimitedTriangle(voice.phase2, voice.increment2, voice.triangleState2);
+                break;
+            case Waveform::Saw:
+                value = bandLimitedSaw(voice.phase, voice.increment);
+                if (dualOscillator)
+                    value += bandLimitedSaw(voice.phase2, voice.increment2);
+                break;
+            case Waveform::Square:
+                value = bandLimitedSquare(voice.phase, voice.increment);
+                if (dualOscillator)
+                    value += bandLimitedSquare(voice.phase2, voice.increment2);
+                break;
+        }
+
+        voice.phase = advancePhase(voice.phase, voice.increment);
+        voice.phase2 = advancePhase(voice.phase2, voice.increment2);
+
+        if (voice.releasing)
+        {
+            voice.level *= voice.releaseCoefficient;
+        }
+        else if (voice.inAttack)
+        {
+            voice.level += voice.attackStep;
+            if (voice.level >= 1.0f)
+            {
+                voice.level = 1.0f;
+                voice.inAttack = false;
+            }
+        }
+        else
+        {
+            voice.level = voice.sustainLevel + (voice.level - voice.sustainLevel) * voice.decayCoefficient;
+        }
+
+        voice.filterState += voice.filterCoefficient * (oscillatorGain * value - voice.filterState);
+        out[i] = voice.filterState * voice.level * voice.velocityGain;
+    }
+
+    // Finished once released, or once a percussive patch has decayed away
+    const bool fading = voice.releasing || (!voice.inAttack && voice.sustainLevel <= 0.0f);
+    if (fading && voice.level < silenceLevel)
+        voice.active = false;
+}
+
+void AuditionSynth::renderDrumVoice(Voice& voice, float* out, int numSamples)
+{
+    const auto& samples = drumSamples[static_cast<size_t>(voice.piece)];
+    const int remaining = static_cast<int>(samples.size()) - voice.samplePosition;
+    const int count = std::max(0, std::min(numSamples, remaining));
+    const float* source = samples.data() + voice.samplePosition;
+
+    if (voice.releasing)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            voice.level *= voice.releaseCoefficient;
+            out[i] = source[i] * voice.level * voice.velocityGain;
+        }
+    }
+    else
+    {
+        SimdKernels::affine(source, out, static_cast<size_t>(count), voice.velocityGain, 0.0f);
+    }
+
+    std::fill(out + count, out + numSamples, 0.0f);
+    voice.samplePosition += count;
+
+    if (voice.samplePosition >= static_cast<int>(samples.size()) || (voice.releasing && voice.level < silenceLevel))
+        voice.active = false;
+}
+
+void AuditionSynth::updateChannelGains()
+{
+    // Constant-power pan law
+    for (size_t channel = 0; channel < static_cast<size_t>(numChannels); ++channel)
+    {
+        const float volume = channelVolumes[channel].load();
+        const float angle = (channelPans[channel].load() + 1.0f) * 0.125f;  // 0..0.25 turns
+        leftGains[channel] = volume * FastMath::cos2Pi(angle);
+        rightGains[channel] = volume * FastMath::sin2Pi(angle);
+    }
+}
+
+void AuditionSynth::buildDrumKit()
+{
+    juce::Random noise(0x5eed);
+    const float rate = static_cast<float>(sampleRate);
+
+    auto render = [&](DrumPiece piece, float seconds, auto&& generator)
+    {
+        auto& samples = drumSamples[static_cast<size_t>(piece)];
+        samples.assign(static_cast<size_t>(seconds * rate), 0.0f);
+        float phase = 0.0f;
+        float highPassState = 0.0f;
+        float previous = 0.0f;
+        for (size_t i = 0; i < samples.size(); ++i)
+        {
+            const float t = static_cast<float>(i) / rate;
+            const float white = noise.nextFloat() * 2.0f - 1.0f;
+
+            // One-pole high-pass for the metallic and noisy pieces
+            highPassState = 0.7f * (highPassState + white - previous);
+            previous = white;
+
+            samples[i] = generator(t, phase, white, highPassState);
+        }
+    };
+
+    auto tone = [rate](float& phase, float frequency)
+    {
+        phase = FastMath::wrapUnit(phase + frequency / rate);
+        return FastMath::sin2Pi(phase);
+    };
+
+    render(DrumPiece::Kick, 0.5f, [&](float t, float& phase, float white, float)
+    {
+        const float frequency = 45.0f + 105.0f * std::exp(-t * 30.0f);
+        return tone(phase, frequency) * std::exp(-t * 7.0f) + 0.3f * white * std::exp(-t * 300.0f);
+    });
+
+    render(DrumPiece::Snare, 0.3f, [&](float t, float& phase, float white, float)
+    {
+        return 0.5f * tone(phase, 180.0f) * std::exp(-t * 20.0f) + 0.7f * white * std::exp(-t * 12.0f);
+    });
+
+    render(DrumPiece::Clap, 0.35f, [&](float t, float&, float, float bright)
+    {
+        float envelope = 0.5f * std::exp(-t * 12.0f);
+        for (float burst : {0.0f, 0.01f, 0.02f})
+            if (t >= burst)
+                envelope += std::exp(-(t - burst) * 150.0f);
+        return 0.8f * bright * envelope;
+    });
+
+    render(DrumPiece::Rim, 0.08f, [&](float t, float& phase, float white, float)
+    {
+        return tone(phase, 1700.0f) * std::exp(-t * 60.0f) + 0.3f * white * std::exp(-t * 200.0f);
+    });
+
+    render(DrumPiece::ClosedHat, 0.08f, [&](float t, float&, float, float bright)
+    {
+        return bright * std::exp(-t * 60.0f);
+    });
+
+    render(DrumPiece::OpenHat, 0.5f, [&](float t, float&, float, float bright)
+    {
+        return bright * std::exp(-t * 6.0f);
+    });
+
+    const std::pair<DrumPiece, float> toms[] = {
+        {DrumPiece::LowTom, 90.0f}, {DrumPiece::MidTom, 140.0f}, {DrumPiece::HighTom, 200.0f}};
+    for (const auto& tom : toms)
+    {
+        const float base = tom.second;
+        render(tom.first, 0.5f, [&](float t, float& phase, float, float)
+        {
+            return tone(phase, base * (1.0f + 0.5f * std::exp(-t * 20.0f))) * std::exp(-t * 8.0f);
+        });
+    }
+
+    render(DrumPiece::Crash, 1.5f, [&](float t, float&, float, float bright)
+    {
+        return 0.6f * bright * std::exp(-t * 2.5f);
+    });
+}
+
+bool AuditionSynth::isChannelMessage(const juce::MidiMessage& message)
+{
+    // Note, controller and program messages; everything the synth responds to has a data byte
+    const int status = message.getRawData()[0] & 0xf0;
+    return message.getRawDataSize() >= 2 && status >= 0x80 && status < 0xf0;
+}
+
+const AuditionSynth::Patch& AuditionSynth::getPatch(int program)
+{
+    // One patch per General MIDI family of eight programs
+    static const Patch patches[16] = {
+        {Waveform::Triangle, 0.002f, 1.20f, 0.00f, 0.30f, 5000.0f, 0.000f},  // piano
+        {Waveform::Sine,     0.001f, 0.60f, 0.00f, 0.20f, 8000.0f, 0.000f},  // chromatic percussion
+        {Waveform::Square,   0.005f, 0.10f, 1.00f, 0.05f, 3000.0f, 0.002f},  // organ
+        {Waveform::Saw,      0.002f, 0.80f, 0.20f, 0.20f, 2500.0f, 0.000f},  // guitar
+        {Waveform::Saw,      0.003f, 0.40f, 0.60f, 0.10f,  800.0f, 0.000f},  // bass
+        {Waveform::Saw,      0.150f, 0.50f, 0.80f, 0.40f, 4000.0f, 0.003f},  // strings
+        {Waveform::Saw,      0.150f, 0.50f, 0.80f, 0.40f, 3500.0f, 0.004f},  // ensemble
+        {Waveform::Saw,      0.030f, 0.30f, 0.80f, 0.15f, 2500.0f, 0.000f},  // brass
+        {Waveform::Square,   0.030f, 0.30f, 0.70f, 0.15f, 2000.0f, 0.000f},  // reed
+        {Waveform::Triangle, 0.040f, 0.30f, 0.80f, 0.20f, 4000.0f, 0.000f},  // pipe
+        {Waveform::Square,   0.005f, 0.20f, 0.80f, 0.15f, 6000.0f, 0.005f},  // synth lead
+        {Waveform::Saw,      0.400f, 1.00f, 0.70f, 1.00f, 2000.0f, 0.006f},  // synth pad
+        {Waveform::Saw,      0.200f, 1.00f, 0.50f, 0.80f, 3000.0f, 0.010f},  // synth effects
+        {Waveform::Triangle, 0.002f, 0.70f, 0.10f, 0.30f, 4000.0f, 0.000f},  // ethnic
+        {Waveform::Sine,     0.001f, 0.30f, 0.00f, 0.10f, 6000.0f, 0.000f},  // percussive
+        {Waveform::Saw,      0.050f, 0.50f, 0.50f, 0.50f, 5000.0f, 0.000f},  // sound effects
+    };
+    return patches[juce::jlimit(0, 127, program) / 8];
+}
+
+AuditionSynth::DrumPiece AuditionSynth::getDrumPiece(int note)
+{
+    switch (note)
+    {
+        case 35: case 36:                   return DrumPiece::Kick;
+        case 38: case 40:                   return DrumPiece::Snare;
+        case 39:                            return DrumPiece::Clap;
+        case 42: case 44:                   return DrumPiece::ClosedHat;
+        case 46: case 51: case 53: case 59: return DrumPiece::OpenHat;  // rides share the open hat
+        case 41: case 43:                   return DrumPiece::LowTom;
+        case 45: case 47:                   return DrumPiece::MidTom;
+        case 48: case 50:                   return DrumPiece::HighTom;
+        case 49: case 52: case 55: case 57: return DrumPiece::Crash;
+        default: break;
+    }
+
+    // Remaining General MIDI percussion (37, 54-81) falls back to the rim click
+    return note == 37 || (note >= 54 && note <= 81) ? DrumPiece::Rim : DrumPiece::None;
+}
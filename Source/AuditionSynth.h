@@ -0,0 +1,185 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include "AIMidiGenerator.h"
+#include "MemoryLedger.h"
+#include "OutputLimiter.h"
+
+/**
+ * Audition Synth
+ * Small polyphonic engine so generated patterns can be heard in the Standalone
+ * build without routing to an external synth. Melodic channels play PolyBLEP
+ * oscillators shaped by a patch chosen from the channel's General MIDI program
+ * family. The drum channel plays back a kit rendered once in prepare(). Voices
+ * come from a fixed pool and are stolen when it runs out. Events pass through
+ * an OutputLimiter first, which caps the sounding notes and the event rate the
+ * way a hardware synth on a MIDI cable would need. Each voice renders
+ * mono into a scratch block and is mixed to stereo by the SIMD panMix kernel.
+ * All memory is allocated in prepare(), so renderNextBlock() is realtime safe.
+ */
+class AuditionSynth
+{
+public:
+    static constexpr int maxVoices = 256;
+    static constexpr int defaultVoices = 64;
+    static constexpr int numChannels = 16;
+    static constexpr int drumChannel = 9;
+    static constexpr int eventQueueSize = 4096;
+
+    // Drum kit samples are charged to the ledger's cache account when one is given
+    explicit AuditionSynth(MemoryLedger* ledger = nullptr);
+    ~AuditionSynth();
+
+    // Message thread: renders the drum kit and sizes the voice pool
+    void prepare(double sampleRate, int maximumBlockSize, int numVoices = defaultVoices);
+
+    // Program, volume and pan for a channel (0-15); safe to call while rendering
+    void setChannelPreset(int channel, const AIMidiGenerator::InstrumentPreset& preset);
+
+    // Message thread: schedules a generated pattern to start startDelaySeconds from
+    // now. Returns false if the queue is full, in which case later events are dropped.
+    bool queuePattern(const AIMidiGenerator::GeneratedPattern& pattern, double startDelaySeconds = 0.0);
+
+    // Releases every voice and drops already scheduled events at the start of the next
+    // block; a pattern queued right after this call still plays
+    void stopAll() { stopRequested.store(true); }
+
+    // Audio thread: adds the synth to the first two channels of buffer and plays incoming MIDI
+    void renderNextBlock(juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& incomingMidi);
+
+    // Voice cap and event rate for everything the synth plays; its settings are safe to change while rendering
+    OutputLimiter& getOutputLimiter() { return outputLimiter; }
+
+    int getNumActiveVoices() const { return activeVoiceCount.load(); }
+    int getNumVoices() const { return numVoicesInUse; }
+
+    // Seconds rendered since prepare(); queuePattern() delays are measured from here
+    double getPlayheadSeconds() const { return static_cast<double>(playheadSamples.load()) / sampleRate; }
+
+private:
+    enum class Waveform : std::uint8_t
+    {
+        Sine,
+        Triangle,
+        Saw,
+        Square
+    };
+
+    // Per-family sound, indexed by program / 8
+    struct Patch
+    {
+        Waveform waveform;
+        float attackSeconds;
+        float decaySeconds;
+        float sustainLevel;
+        float releaseSeconds;
+        float cutoffHz;
+        float detune; // second oscillator ratio offset, 0 for a single oscillator
+    };
+
+    enum class DrumPiece : std::int8_t
+    {
+        None = -1,
+        Kick,
+        Snare,
+        Clap,
+        Rim,
+        ClosedHat,
+        OpenHat,
+        LowTom,
+        MidTom,
+        HighTom,
+        Crash,
+        NumPieces
+    };
+
+    static constexpr int numDrumPieces = static_cast<int>(DrumPiece::NumPieces);
+
+    struct Event
+    {
+        std::int64_t samplePosition = 0;
+        std::uint8_t status = 0; // high nibble only; the channel is kept separately
+        std::uint8_t channel = 0;
+        std::uint8_t data1 = 0;
+        std::uint8_t data2 = 0;
+    };
+
+    struct Voice
+    {
+        bool active = false;
+        bool releasing = false;
+        int channel = 0;
+        int note = 0;
+        std::uint64_t startOrder = 0;
+        float velocityGain = 0.0f;
+
+        // Oscillators
+        Waveform waveform = Waveform::Saw;
+        float phase = 0.0f;
+        float increment = 0.0f;
+        float phase2 = 0.0f;
+        float increment2 = 0.0f;
+        float triangleState = 0.0f;
+        float triangleState2 = 0.0f;
+        float filterState = 0.0f;
+        float filterCoefficient = 1.0f;
+
+        // Envelope: linear attack, then exponential decay and release
+        float level = 0.0f;
+        float attackStep = 1.0f;
+        float decayCoefficient = 0.0f;
+        float sustainLevel = 1.0f;
+        float releaseCoefficient = 0.0f;
+        bool inAttack = false;
+
+        // Drum playback
+        DrumPiece piece = DrumPiece::None;
+        int samplePosition = 0;
+    };
+
+    void handleEvent(const Event& event);
+    void startNote(int channel, int note, int velocity);
+    void stopNote(int channel, int note);
+    void releaseAll(bool immediately);
+    Voice& allocateVoice(int channel, int note);
+    void renderVoices(float* left, float* right, int numSamples);
+    void renderMelodicVoice(Voice& voice, float* out, int numSamples);
+    void renderDrumVoice(Voice& voice, float* out, int numSamples);
+    void updateChannelGains();
+
+    void buildDrumKit();
+    static const Patch& getPatch(int program);
+    static DrumPiece getDrumPiece(int note);
+    static bool isChannelMessage(const juce::MidiMessage& message);
+
+    double sampleRate = 44100.0;
+    int maxBlockSize = 0;
+    int numVoicesInUse = defaultVoices;
+
+    std::array<Voice, maxVoices> voices;
+    std::uint64_t nextStartOrder = 0;
+    std::atomic<int> activeVoiceCount { 0 };
+    TrackedVector<float> voiceScratch;
+    std::array<TrackedVector<float>, numDrumPieces> drumSamples;
+
+    // Channel state; presets are written from the message thread
+    std::array<std::atomic<int>, numChannels> channelPrograms;
+    std::array<std::atomic<float>, numChannels> channelVolumes;
+    std::array<std::atomic<float>, numChannels> channelPans;
+    std::array<float, numChannels> leftGains {};
+    std::array<float, numChannels> rightGains {};
+
+    // Single producer (message thread), single consumer (audio thread)
+    juce::AbstractFifo eventFifo { eventQueueSize };
+    std::array<Event, eventQueueSize> fifoEvents;
+    std::array<Event, eventQueueSize> pendingEvents;
+    int numPendingEvents = 0;
+    OutputLimiter outputLimiter;
+    std::atomic<std::int64_t> playheadSamples { 0 };
+    std::atomic<bool> stopRequested { false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AuditionSynth)
+};
@@ -0,0 +1,348 @@
+#include "ChordRecognizer.h"
+#include "FastMath.h"
+#include "NoteEvents.h"
+#include "SimdKernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Chroma covers G2 up to about B6; lower bins can't separate semitones at this window size
+    constexpr float chromaLowHz = 95.0f;
+    constexpr float chromaHighHz = 2000.0f;
+
+    // Frames quieter than this count as silence and match the no-chord state
+    constexpr float silenceThresholdDb = -60.0f;
+
+    // Sticky transition model: staying is cheap, any change pays the same price
+    constexpr float stayProbability = 0.9f;
+    constexpr float emissionSharpness = 20.0f;
+    const float logStay = std::log(stayProbability);
+    const float logChange = std::log((1.0f - stayProbability) / static_cast<float>(ChordRecognizer::numChords - 1));
+
+    const char* const pitchClassNames[] = {"C", "C#", "D", "Eb", "E", "F", "F#", "G", "Ab", "A", "Bb", "B"};
+    const char* const qualitySuffixes[] = {"", "m", "dim", "aug", "sus4", "7", "maj7", "m7"};
+
+    const std::vector<int>& getQualityIntervals(ChordRecognizer::Quality quality)
+    {
+        static const std::vector<int> intervals[] = {
+            {0, 4, 7},      // major
+            {0, 3, 7},      // minor
+            {0, 3, 6},      // diminished
+            {0, 4, 8},      // augmented
+            {0, 5, 7},      // suspended fourth
+            {0, 4, 7, 10},  // dominant seventh
+            {0, 4, 7, 11},  // major seventh
+            {0, 3, 7, 10}   // minor seventh
+        };
+        return intervals[static_cast<int>(quality)];
+    }
+}
+
+ChordRecognizer::ChordRecognizer(MemoryLedger* ledger)
+    : inputRing(TrackedAllocator<float>(ledger, MemoryLedger::Subsystem::AudioHistory)),
+      window(TrackedAllocator<float>(ledger, MemoryLedger::Subsystem::AudioHistory)),
+      fftBuffer(TrackedAllocator<float>(ledger, MemoryLedger::Subsystem::AudioHistory)),
+      magnitudes(TrackedAllocator<float>(ledger, MemoryLedger::Subsystem::AudioHistory)),
+      binPitchClass(TrackedAllocator<std::int8_t>(ledger, MemoryLedger::Subsystem::AudioHistory))
+{
+    buildTemplates();
+}
+
+ChordRecognizer::~ChordRecognizer() = default;
+
+void ChordRecognizer::buildTemplates()
+{
+    for (int root = 0; root < 12; ++root)
+    {
+        for (int q = 0; q < numQualities; ++q)
+        {
+            const int chord = root * numQualities + q;
+            const auto& intervals = getQualityIntervals(static_cast<Quality>(q));
+            const float weight = 1.0f / std::sqrt(static_cast<float>(intervals.size()));
+            for (int interval : intervals)
+                templates[static_cast<size_t>(((root + interval) % 12) * numChords + chord)] = weight;
+        }
+    }
+
+    // No chord matches a flat chroma best, which is what noise and silence look like
+    for (int pitchClass = 0; pitchClass < 12; ++pitchClass)
+        templates[static_cast<size_t>(pitchClass * numChords + noChord)] = 1.0f / std::sqrt(12.0f);
+}
+
+void ChordRecognizer::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate > 0.0 ? newSampleRate : 44100.0;
+
+    // About 170 ms: enough resolution to tell neighbouring semitones apart above G2
+    fftOrder = 0;
+    while ((1 << fftOrder) < static_cast<int>(sampleRate * 0.17))
+        ++fftOrder;
+    windowSize = 1 << fftOrder;
+    hopSize = windowSize / 2;
+
+    if (fft == nullptr || fft->getSize() != windowSize)
+        fft = std::make_unique<juce::dsp::FFT>(fftOrder);
+
+    inputRing.assign(static_cast<size_t>(windowSize), 0.0f);
+    window.resize(static_cast<size_t>(windowSize));
+    for (int i = 0; i < windowSize; ++i)
+        window[static_cast<size_t>(i)] = 0.5f - 0.5f * FastMath::cos2Pi(static_cast<float>(i) / static_cast<float>(windowSize));
+    fftBuffer.assign(static_cast<size_t>(2 * windowSize), 0.0f);
+
+    const int numBins = windowSize / 2 + 1;
+    magnitudes.assign(static_cast<size_t>(numBins), 0.0f);
+    binPitchClass.assign(static_cast<size_t>(numBins), -1);
+    for (int bin = 1; bin < numBins; ++bin)
+    {
+        const float frequency = static_cast<float>(bin * sampleRate / windowSize);
+        if (frequency < chromaLowHz || frequency > chromaHighHz)
+            continue;
+        const int note = juce::roundToInt(NoteEvents::frequencyToMidi(frequency));
+        binPitchClass[static_cast<size_t>(bin)] = static_cast<std::int8_t>(((note % 12) + 12) % 12);
+    }
+
+    reset();
+}
+
+void ChordRecognizer::reset()
+{
+    std::fill(inputRing.begin(), inputRing.end(), 0.0f);
+    ringPosition = 0;
+    samplesUntilHop = hopSize;
+    samplesBuffered = 0;
+    totalSamples = 0;
+
+    pathScores.fill(0.0f);
+    frameCount = 0;
+    settledChord = noChord;
+    settledStart = 0.0;
+    settledScoreSum = 0.0f;
+    settledFrames = 0;
+    currentChord.store(noChord);
+}
+
+void ChordRecognizer::process(const juce::AudioBuffer<float>& buffer)
+{
+    if (windowSize == 0)
+        return;
+
+    const int numChannels = buffer.getNumChannels();
+    const int numSamples = buffer.getNumSamples();
+    if (numChannels == 0)
+        return;
+
+    const float channelGain = 1.0f / static_cast<float>(numChannels);
+    int position = 0;
+
+    // Copy in runs that end at a hop or at the end of the ring, so each run is contiguous
+    while (position < numSamples)
+    {
+        const int run = std::min({ numSamples - position, samplesUntilHop, windowSize - ringPosition });
+        float* destination = inputRing.data() + ringPosition;
+
+        const float* first = buffer.getReadPointer(0, position);
+        for (int i = 0; i < run; ++i)
+            destination[i] = first[i] * channelGain;
+        for (int channel = 1; channel < numChannels; ++channel)
+        {
+            const float* source = buffer.getReadPointer(channel, position);
+            for (int i = 0; i < run; ++i)
+                destination[i] += source[i] * channelGain;
+        }
+
+        position += run;
+        totalSamples += run;
+        ringPosition = (ringPosition + run) % windowSize;
+        samplesBuffered = std::min(windowSize, samplesBuffered + run);
+        samplesUntilHop -= run;
+
+        if (samplesUntilHop == 0)
+        {
+            samplesUntilHop = hopSize;
+            if (samplesBuffered == windowSize)
+                analyseFrame();
+        }
+    }
+}
+
+void ChordRecognizer::analyseFrame()
+{
+    computeChroma();
+
+    // Cosine similarity against every template at once
+    SimdKernels::matrixVector(templates.data(), chroma.data(), scores.data(), numChords, 12);
+
+    advanceViterbi();
+}
+
+void ChordRecognizer::computeChroma()
+{
+    // Windowed frame, oldest sample first
+    float* frame = fftBuffer.data();
+    for (int i = 0; i < windowSize; ++i)
+        frame[i] = inputRing[static_cast<size_t>((ringPosition + i) % windowSize)] * window[static_cast<size_t>(i)];
+
+    const float meanSquare = static_cast<float>(SimdKernels::sumOfSquares(frame, static_cast<size_t>(windowSize)) / windowSize);
+    if (10.0f * std::log10(meanSquare + 1.0e-12f) < silenceThresholdDb)
+    {
+        chroma.fill(1.0f / std::sqrt(12.0f));
+        return;
+    }
+
+    fft->performRealOnlyForwardTransform(frame, true);
+    SimdKernels::complexMagnitude(frame, magnitudes.data(), magnitudes.size());
+
+    chroma.fill(0.0f);
+    for (size_t bin = 0; bin < magnitudes.size(); ++bin)
+        if (binPitchClass[bin] >= 0)
+            chroma[static_cast<size_t>(binPitchClass[bin])] += magnitudes[bin] * magnitudes[bin];
+
+    // Energy rather than magnitude, so window leakage into neighbouring semitones stays small
+    float norm = 0.0f;
+    for (auto value : chroma)
+        norm += value * value;
+    if (norm <= 0.0f)
+    {
+        chroma.fill(1.0f / std::sqrt(12.0f));
+        return;
+    }
+    const float scale = 1.0f / std::sqrt(norm);
+    for (auto& value : chroma)
+        value *= scale;
+}
+
+void ChordRecognizer::advanceViterbi()
+{
+    const int slot = frameCount % smoothingLag;
+    auto& pointers = backPointers[static_cast<size_t>(slot)];
+    frameTimes[static_cast<size_t>(slot)] = (static_cast<double>(totalSamples) - windowSize * 0.5) / sampleRate;
+    scoreHistory[static_cast<size_t>(slot)] = scores;
+
+    // With one price for every change, the best predecessor is either the state itself
+    // or the overall leader, so each frame is one pass over the states
+    const int leader = static_cast<int>(std::max_element(pathScores.begin(), pathScores.end()) - pathScores.begin());
+    const float changeScore = pathScores[static_cast<size_t>(leader)] + logChange;
+
+    float best = -1.0e30f;
+    for (int chord = 0; chord < numChords; ++chord)
+    {
+        const float stayScore = pathScores[static_cast<size_t>(chord)] + logStay;
+        const bool stays = stayScore >= changeScore || frameCount == 0;
+        pointers[static_cast<size_t>(chord)] = static_cast<std::uint8_t>(stays ? chord : leader);
+        const float score = (stays ? stayScore : changeScore) + emissionSharpness * scores[static_cast<size_t>(chord)];
+        pathScores[static_cast<size_t>(chord)] = score;
+        best = std::max(best, score);
+    }
+
+    // Keep the scores near zero so they never lose precision
+    for (auto& score : pathScores)
+        score -= best;
+
+    ++frameCount;
+    if (frameCount < smoothingLag)
+        return;
+
+    // Trace the best path back to the oldest frame in the window; that frame is settled
+    int state = static_cast<int>(std::max_element(pathScores.begin(), pathScores.end()) - pathScores.begin());
+    for (int step = 0; step < smoothingLag - 1; ++step)
+    {
+        const int frame = (frameCount - 1 - step) % smoothingLag;
+        state = backPointers[static_cast<size_t>(frame)][static_cast<size_t>(state)];
+    }
+
+    const size_t oldest = static_cast<size_t>(frameCount % smoothingLag);
+    settle(state, frameTimes[oldest], scoreHistory[oldest][static_cast<size_t>(state)]);
+}
+
+void ChordRecognizer::settle(int chordIndex, double frameTime, float score)
+{
+    if (chordIndex != settledChord)
+    {
+        if (settledChord != noChord && settledFrames > 0)
+        {
+            ChordEvent chord;
+            chord.startTime = settledStart;
+            chord.duration = frameTime - settledStart;
+            chord.root = settledChord / numQualities;
+            chord.quality = static_cast<Quality>(settledChord % numQualities);
+            chord.confidence = juce::jlimit(0.0f, 1.0f, settledScoreSum / static_cast<float>(settledFrames));
+            pushChord(chord);
+        }
+
+        settledChord = chordIndex;
+        settledStart = frameTime;
+        settledScoreSum = 0.0f;
+        settledFrames = 0;
+        currentChord.store(chordIndex);
+    }
+
+    settledScoreSum += score;
+    ++settledFrames;
+}
+
+void ChordRecognizer::pushChord(const ChordEvent& chord)
+{
+    // Dropped if the message thread has stopped draining
+    int start1, size1, start2, size2;
+    chordFifo.prepareToWrite(1, start1, size1, start2, size2);
+    if (size1 > 0)
+        chordQueue[static_cast<size_t>(start1)] = chord;
+    chordFifo.finishedWrite(size1);
+}
+
+int ChordRecognizer::popChords(std::vector<ChordEvent>& destination)
+{
+    const int available = chordFifo.getNumReady();
+    int start1, size1, start2, size2;
+    chordFifo.prepareToRead(available, start1, size1, start2, size2);
+    destination.insert(destination.end(), chordQueue.begin() + start1, chordQueue.begin() + start1 + size1);
+    destination.insert(destination.end(), chordQueue.begin() + start2, chordQueue.begin() + start2 + size2);
+    chordFifo.finishedRead(size1 + size2);
+    return size1 + size2;
+}
+
+std::string ChordRecognizer::getChordSymbol(int root, Quality quality)
+{
+    if (root < 0 || root > 11)
+        return "N.C.";
+    return std::string(pitchClassNames[root]) + qualitySuffixes[static_cast<int>(quality)];
+}
+
+std::string ChordRecognizer::getChordSymbol(int chordIndex)
+{
+    if (chordIndex < 0 || chordIndex >= noChord)
+        return "N.C.";
+    return getChordSymbol(chordIndex / numQualities, static_cast<Quality>(chordIndex % numQualities));
+}
+
+std::vector<int> ChordRecognizer::getChordPitchClasses(int root, Quality quality)
+{
+    std::vector<int> pitchClasses;
+    for (int interval : getQualityIntervals(quality))
+        pitchClasses.push_back((root + interval) % 12);
+    return pitchClasses;
+}
+
+ChordRecognizer::HarmonicRhythm ChordRecognizer::summarise(const std::vector<ChordEvent>& chords, float tempo)
+{
+    HarmonicRhythm rhythm;
+    if (chords.empty())
+        return rhythm;
+
+    double totalDuration = 0.0;
+    for (const auto& chord : chords)
+    {
+        rhythm.symbols.push_back(getChordSymbol(chord.root, chord.quality));
+        totalDuration += chord.duration;
+    }
+
+    const double span = chords.back().startTime + chords.back().duration - chords.front().startTime;
+    rhythm.secondsPerChord = static_cast<float>(totalDuration / static_cast<double>(chords.size()));
+    if (span > 0.0)
+        rhythm.changesPerMinute = static_cast<float>(60.0 * static_cast<double>(chords.size()) / span);
+    if (tempo > 0.0f)
+        rhythm.density = juce::jlimit(0.0f, 1.0f, rhythm.changesPerMinute / tempo);
+    return rhythm;
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "MemoryLedger.h"
+
+/**
+ * Chord Recognizer
+ * Follows the harmony of the input while it plays. Each hop folds a Hann-
+ * windowed spectrum into a 12-bin chroma vector and scores it against a bank
+ * of chord templates with one SIMD matrix-vector product. A fixed-lag Viterbi
+ * filter with a sticky transition model smooths those scores. Each frame costs
+ * one pass over the chord states, and a chord is settled a bounded number of
+ * hops after it is heard. Settled chords go to a lock-free queue, and the
+ * message thread turns them into harmonic rhythm and change density.
+ */
+class ChordRecognizer
+{
+public:
+    enum class Quality : std::uint8_t
+    {
+        Major,
+        Minor,
+        Diminished,
+        Augmented,
+        Suspended4,
+        Dominant7,
+        Major7,
+        Minor7,
+        NumQualities
+    };
+
+    static constexpr int numQualities = static_cast<int>(Quality::NumQualities);
+    static constexpr int numChords = 12 * numQualities + 1; // the last state is "no chord"
+    static constexpr int noChord = numChords - 1;
+    static constexpr int smoothingLag = 6;                 // hops before a chord is settled
+    static constexpr int chordQueueSize = 256;
+
+    struct ChordEvent
+    {
+        double startTime = 0.0;
+        double duration = 0.0;
+        int root = -1;                  // pitch class 0-11, or -1 for no chord
+        Quality quality = Quality::Major;
+        float confidence = 0.0f;        // mean template match over the chord, 0-1
+    };
+
+    // Summary of a stretch of recognised chords
+    struct HarmonicRhythm
+    {
+        std::vector<std::string> symbols; // oldest first, no-chord stretches skipped
+        float secondsPerChord = 0.0f;     // harmonic rhythm
+        float changesPerMinute = 0.0f;
+        float density = 0.0f;             // changes per beat at the given tempo, clamped to 0-1
+    };
+
+    // Analysis buffers are charged to the ledger's audio history account when one is given
+    explicit ChordRecognizer(MemoryLedger* ledger = nullptr);
+    ~ChordRecognizer();
+
+    // Message thread: sizes the window (about 170 ms) and hop for the sample rate
+    void prepare(double sampleRate);
+    void reset();
+
+    // Audio thread: downmixes every channel and analyses each completed hop
+    void process(const juce::AudioBuffer<float>& buffer);
+
+    // Message thread: appends chords settled since the last call; returns how many were added
+    int popChords(std::vector<ChordEvent>& destination);
+
+    // Chord index (root * numQualities + quality, or noChord) most recently settled
+    int getCurrentChord() const { return currentChord.load(); }
+
+    double getLatencySeconds() const { return (windowSize + smoothingLag * hopSize) / sampleRate; }
+
+    static std::string getChordSymbol(int root, Quality quality);
+    static std::string getChordSymbol(int chordIndex);
+
+    // Pitch classes of a chord, root first, e.g. {7, 11, 2, 5} for G7
+    static std::vector<int> getChordPitchClasses(int root, Quality quality);
+
+    static HarmonicRhythm summarise(const std::vector<ChordEvent>& chords, float tempo);
+
+private:
+    void analyseFrame();
+    void computeChroma();
+    void advanceViterbi();
+    void settle(int chordIndex, double frameTime, float score);
+    void pushChord(const ChordEvent& chord);
+    void buildTemplates();
+
+    double sampleRate = 44100.0;
+    int fftOrder = 0;
+    int windowSize = 0;
+    int hopSize = 0;
+
+    std::unique_ptr<juce::dsp::FFT> fft;
+    TrackedVector<float> inputRing;     // windowSize samples, written circularly
+    TrackedVector<float> window;        // Hann
+    TrackedVector<float> fftBuffer;     // 2 * windowSize
+    TrackedVector<float> magnitudes;
+    TrackedVector<std::int8_t> binPitchClass; // -1 outside the chroma range
+    int ringPosition = 0;
+    int samplesUntilHop = 0;
+    int samplesBuffered = 0;
+    std::int64_t totalSamples = 0;
+
+    // Column-major: templates[pitchClass * numChords + chord], each chord unit length
+    std::array<float, 12 * numChords> templates {};
+    std::array<float, 12> chroma {};
+    std::array<float, numChords> scores {};
+
+    // Fixed-lag Viterbi state; backpointers are a ring of the last smoothingLag hops
+    std::array<float, numChords> pathScores {};
+    std::array<std::array<std::uint8_t, numChords>, smoothingLag> backPointers {};
+    std::array<double, smoothingLag> frameTimes {};
+    int frameCount = 0;
+
+    // Chord being settled
+    int settledChord = noChord;
+    double settledStart = 0.0;
+    float settledScoreSum = 0.0f;
+    int settledFrames = 0;
+    std::array<std::array<float, numChords>, smoothingLag> scoreHistory {};
+
+    std::atomic<int> currentChord { noChord };
+
+    // Single producer (audio thread), single consumer (message thread)
+    juce::AbstractFifo chordFifo { chordQueueSize };
+    std::array<ChordEvent, chordQueueSize> chordQueue;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ChordRecognizer)
+};
@@ -0,0 +1,190 @@
+#include "ControllerCurves.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace
+{
+    constexpr int modWheel = 1;
+    constexpr int expression = 11;
+    constexpr int brightness = 74; // filter cutoff on most synths
+
+    float smoothStep(double x)
+    {
+        const float t = static_cast<float>(juce::jlimit(0.0, 1.0, x));
+        return t * t * (3.0f - 2.0f * t);
+    }
+
+    float sine(double seconds, double period)
+    {
+        return static_cast<float>(std::sin(juce::MathConstants<double>::twoPi * seconds / period));
+    }
+}
+
+std::vector<ControllerCurves::Point> ControllerCurves::sample(const Lane& lane, double duration, double resolution)
+{
+    std::vector<Point> points;
+    if (!lane.curve || duration <= 0.0)
+        return points;
+
+    resolution = std::max(0.001, resolution);
+    const auto count = static_cast<size_t>(std::ceil(duration / resolution)) + 1;
+    points.reserve(count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const double time = std::min(duration, static_cast<double>(i) * resolution);
+        points.push_back({ time, juce::jlimit(0.0f, 1.0f, lane.curve(time)) });
+    }
+
+    return points;
+}
+
+std::vector<ControllerCurves::Point> ControllerCurves::thin(const std::vector<Point>& points, float tolerance)
+{
+    if (points.size() <= 2)
+        return points;
+
+    std::vector<bool> keep(points.size(), false);
+    keep.front() = keep.back() = true;
+
+    std::vector<std::pair<size_t, size_t>> spans;
+    spans.emplace_back(0, points.size() - 1);
+
+    while (!spans.empty())
+    {
+        const auto [first, last] = spans.back();
+        spans.pop_back();
+
+        const auto& a = points[first];
+        const auto& b = points[last];
+        const double span = b.time - a.time;
+
+        // Error is measured along the value axis, so the bound holds for every sampled instant
+        float worst = -1.0f;
+        size_t worstIndex = first;
+        for (size_t i = first + 1; i < last; ++i)
+        {
+            const double t = span > 0.0 ? (points[i].time - a.time) / span : 0.0;
+            const float line = a.value + static_cast<float>(t) * (b.value - a.value);
+            const float error = std::abs(points[i].value - line);
+            if (error > worst)
+            {
+                worst = error;
+                worstIndex = i;
+            }
+        }
+
+        if (worst > tolerance)
+        {
+            keep[worstIndex] = true;
+            spans.emplace_back(first, worstIndex);
+            spans.emplace_back(worstIndex, last);
+        }
+    }
+
+    std::vector<Point> thinned;
+    for (size_t i = 0; i < points.size(); ++i)
+        if (keep[i])
+            thinned.push_back(points[i]);
+
+    return thinned;
+}
+
+std::vector<juce::MidiMessage> ControllerCurves::render(const Lane& lane, double duration, float toleranceSteps,
+                                                        double resolution)
+{
+    const int maximum = getMaximumValue(lane.controller);
+    const auto points = thin(sample(lane, duration, resolution), std::max(0.0f, toleranceSteps) / 127.0f);
+
+    std::vector<juce::MidiMessage> messages;
+    messages.reserve(points.size());
+
+    int lastValue = -1;
+    for (const auto& point : points)
+    {
+        const int value = juce::jlimit(0, maximum, juce::roundToInt(point.value * static_cast<float>(maximum)));
+        if (value == lastValue)
+            continue;
+
+        auto message = lane.controller == pitchBend
+            ? juce::MidiMessage::pitchWheel(lane.channel, value)
+            : juce::MidiMessage::controllerEvent(lane.channel, lane.controller, value);
+        message.setTimeStamp(point.time);
+        messages.push_back(message);
+        lastValue = value;
+    }
+
+    return messages;
+}
+
+std::vector<ControllerCurves::Lane> ControllerCurves::getMoodLanes(const std::string& mood, double duration,
+                                                                   int channel, float energy)
+{
+    std::vector<Lane> lanes;
+    const float depth = 0.6f + 0.4f * juce::jlimit(0.0f, 1.0f, energy);
+    duration = std::max(0.001, duration);
+
+    if (mood == "ominous")
+    {
+        // The filter creeps open over the pattern, with a slow uneasy drift on top
+        lanes.push_back({ brightness, channel, [duration, depth](double t)
+        {
+            return 0.15f + 0.6f * depth * smoothStep(t / duration) + 0.06f * sine(t, 3.7);
+        } });
+    }
+    else if (mood == "dreamy")
+    {
+        // Mod wheel swells every six seconds
+        lanes.push_back({ modWheel, channel, [depth](double t)
+        {
+            const float swell = 0.5f - 0.5f * sine(t + 1.5, 6.0);
+            return 0.2f + 0.45f * depth * swell;
+        } });
+    }
+    else if (mood == "suspenseful")
+    {
+        // One long crescendo across the pattern
+        lanes.push_back({ expression, channel, [duration, depth](double t)
+        {
+            const float x = static_cast<float>(juce::jlimit(0.0, 1.0, t / duration));
+            return 0.35f + 0.6f * depth * x * x;
+        } });
+    }
+    else if (mood == "romantic")
+    {
+        // Expression breathes with four-second phrases
+        lanes.push_back({ expression, channel, [depth](double t)
+        {
+            const double phrase = std::fmod(t, 4.0) / 4.0;
+            return 0.55f + 0.3f * depth * static_cast<float>(std::sin(juce::MathConstants<double>::pi * phrase));
+        } });
+    }
+    else if (mood == "gritty")
+    {
+        // Twice-a-second filter wobble
+        lanes.push_back({ brightness, channel, [depth](double t)
+        {
+            return 0.5f + 0.35f * depth * sine(t, 0.5);
+        } });
+    }
+    else if (mood == "energetic" || mood == "uplifting")
+    {
+        // The filter opens into every fourth second, like a riser into each phrase
+        lanes.push_back({ brightness, channel, [depth](double t)
+        {
+            const float phrase = static_cast<float>(std::fmod(t, 4.0) / 4.0);
+            return 0.55f + 0.4f * depth * phrase * phrase * phrase;
+        } });
+    }
+    else if (mood == "frantic")
+    {
+        // Nervous vibrato, a tenth of a semitone either side at the default two-semitone bend range
+        lanes.push_back({ pitchBend, channel, [depth](double t)
+        {
+            return 0.5f + 0.025f * depth * sine(t, 0.18);
+        } });
+    }
+
+    return lanes;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * Controller Curves
+ * Expression lanes for generated patterns: a controller (CC) or pitch-bend
+ * curve on one channel. Each lane is a continuous function of time. It is
+ * sampled finely, then thinned with Ramer-Douglas-Peucker until no sample is
+ * further than a tolerance (in controller steps) from the straight lines
+ * between the kept points. A held value or a steady ramp needs two events
+ * however long it lasts. A wobble needs a few per cycle. So the number of
+ * events per lane follows the curve's shape, not its duration, and a lane
+ * never floods the stream with one message per sample.
+ */
+class ControllerCurves
+{
+public:
+    static constexpr int pitchBend = -1; // controller number of a pitch-bend lane
+
+    struct Lane
+    {
+        int controller = 74;                   // CC number, or pitchBend
+        int channel = 0;                       // same numbering as the generator's notes
+        std::function<float(double)> curve;    // seconds -> 0-1; pitch bend centres on 0.5
+    };
+
+    struct Point
+    {
+        double time = 0.0;
+        float value = 0.0f;
+    };
+
+    // Samples every resolution seconds, including both ends
+    static std::vector<Point> sample(const Lane& lane, double duration, double resolution = 0.01);
+
+    // Ramer-Douglas-Peucker on the value axis; keeps the end points. Iterative, so long lanes cannot overflow the stack.
+    static std::vector<Point> thin(const std::vector<Point>& points, float tolerance);
+
+    // Sampled, thinned and scaled to the lane's message type. Tolerance is in 7-bit controller steps
+    // for both kinds of lane (a pitch-bend step is 1/127 of the bend range). Repeated values are skipped.
+    static std::vector<juce::MidiMessage> render(const Lane& lane, double duration, float toleranceSteps = 1.0f,
+                                                 double resolution = 0.01);
+
+    // Lanes that suit a mood: filter sweeps for ominous, mod wheel swells for dreamy, and so on.
+    // Energy (0-1) scales their depth. Moods without expression lanes return none.
+    static std::vector<Lane> getMoodLanes(const std::string& mood, double duration, int channel, float energy);
+
+    static int getMaximumValue(int controller) { return controller == pitchBend ? 16383 : 127; }
+};
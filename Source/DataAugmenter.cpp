@@ -0,0 +1,223 @@
+#include "DataAugmenter.h"
+#include "FeatureModelGraph.h"
+#include "GrooveShaper.h"
+#include "MidiFile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+
+namespace
+{
+    constexpr int drumChannel = 9;
+    constexpr float defaultTempo = 120.0f;
+    constexpr int maxTracks = 32;
+
+    constexpr float softGamma = 0.7f;
+    constexpr float hardGamma = 1.4f;
+    constexpr float compressionRatio = 0.5f;
+    constexpr float velocityCentre = 64.0f;
+
+    // splitmix64, so a variant's seed depends only on where it sits in the run
+    std::uint32_t mixSeed(std::uint64_t value)
+    {
+        value += 0x9e3779b97f4a7c15ull;
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+        return static_cast<std::uint32_t>((value ^ (value >> 31)) & 0xffffffffu);
+    }
+}
+
+//==============================================================================
+DataAugmenter::DataAugmenter()
+    : shaper(std::make_unique<GrooveShaper>()),
+      graph(std::make_unique<FeatureModelGraph>())
+{
+}
+
+DataAugmenter::~DataAugmenter() = default;
+
+int DataAugmenter::loadAuxiliaryModels(const juce::File& directory)
+{
+    return graph->loadAuxiliaryModels(directory);
+}
+
+bool DataAugmenter::loadSource(const std::string& path, Source& source, std::string& error)
+{
+    smf::MidiFile midi;
+    if (!midi.read(path))
+    {
+        error = "could not read MIDI file";
+        return false;
+    }
+
+    midi.doTimeAnalysis();
+    midi.linkNotePairs();
+
+    source.name = std::filesystem::path(path).filename().string();
+    source.tempo = 0.0f;
+    source.notes.clear();
+    source.noteTracks.clear();
+    source.trackMask = 0;
+
+    for (int track = 0; track < midi.getTrackCount(); ++track)
+    {
+        for (int e = 0; e < midi[track].size(); ++e)
+        {
+            auto& event = midi[track][e];
+            if (source.tempo <= 0.0f && event.isTempo())
+                source.tempo = static_cast<float>(event.getTempoBPM());
+            if (!event.isNoteOn())
+                continue;
+
+            NoteEvent note;
+            note.startTime = event.seconds;
+            note.duration = event.isLinked() ? event.getDurationInSeconds() : 0.0;
+            note.noteNumber = event.getKeyNumber();
+            note.velocity = static_cast<float>(event.getVelocity());
+            note.channel = event.getChannel();
+            source.notes.push_back(note);
+
+            // Tracks past the mask's width share its last bit
+            const int maskTrack = std::min(track, maxTracks - 1);
+            source.noteTracks.push_back(maskTrack);
+            source.trackMask |= 1u << maskTrack;
+        }
+    }
+
+    if (source.tempo <= 0.0f)
+        source.tempo = defaultTempo;
+
+    if (source.notes.size() < 2)
+    {
+        error = "fewer than two notes";
+        return false;
+    }
+    return true;
+}
+
+std::vector<DataAugmenter::Variant> DataAugmenter::enumerateVariants(const Source& source, const Settings& settings,
+                                                                     std::uint32_t sourceIndex)
+{
+    std::vector<int> leftOutTracks { -1 };
+    if (settings.trackSubsets)
+    {
+        for (int track = 0; track < maxTracks; ++track)
+        {
+            const auto bit = 1u << track;
+            if ((source.trackMask & bit) != 0 && source.trackMask != bit)
+                leftOutTracks.push_back(track);
+        }
+    }
+
+    std::vector<Variant> variants;
+    variants.reserve(leftOutTracks.size() * settings.transpositions.size() * settings.tempoScales.size()
+                     * settings.humanizeIntensities.size() * settings.velocityCurves.size());
+
+    const auto runSeed = (static_cast<std::uint64_t>(settings.seed) << 32) | sourceIndex;
+    for (const auto leftOut : leftOutTracks)
+        for (const auto transpose : settings.transpositions)
+            for (const auto tempoScale : settings.tempoScales)
+                for (const auto humanize : settings.humanizeIntensities)
+                    for (const auto curve : settings.velocityCurves)
+                    {
+                        Variant variant;
+                        variant.transpose = transpose;
+                        variant.tempoScale = tempoScale;
+                        variant.humanize = humanize;
+                        variant.velocityCurve = curve;
+                        variant.trackMask = leftOut < 0 ? source.trackMask : source.trackMask & ~(1u << leftOut);
+                        variant.leftOutTrack = leftOut;
+                        variant.seed = mixSeed(runSeed + variants.size() * 0x100000001ull);
+                        variants.push_back(variant);
+                    }
+
+    return variants;
+}
+
+float DataAugmenter::renderVariant(const Source& source, const Variant& variant, std::vector<NoteEvent>& notes)
+{
+    notes.clear();
+    notes.reserve(source.notes.size());
+
+    // Scaling every tempo in the map by one factor keeps ticks where they are and
+    // divides each time in seconds by that factor
+    const double timeScale = variant.tempoScale > 0.0f ? 1.0 / variant.tempoScale : 1.0;
+    const float tempo = source.tempo * (variant.tempoScale > 0.0f ? variant.tempoScale : 1.0f);
+
+    for (size_t i = 0; i < source.notes.size(); ++i)
+    {
+        if ((variant.trackMask & (1u << source.noteTracks[i])) == 0)
+            continue;
+
+        auto note = source.notes[i];
+        if (note.channel != drumChannel)
+        {
+            const int pitch = note.noteNumber + variant.transpose;
+            if (pitch >= 0 && pitch <= 127)
+                note.noteNumber = pitch;
+        }
+        note.startTime *= timeScale;
+        note.duration *= timeScale;
+        note.velocity = applyVelocityCurve(note.velocity, variant.velocityCurve);
+        notes.push_back(note);
+    }
+
+    if (variant.humanize > 0.0f && !notes.empty())
+    {
+        shaper->setRandomSeed(static_cast<juce::int64>(variant.seed));
+        shaper->setGrooveProfile(source.mood, variant.humanize);
+        auto messages = NoteEvents::toMidiMessages(notes);
+        shaper->processGroove(messages, tempo);
+        notes = NoteEvents::fromMidiMessages(messages);
+    }
+
+    return tempo;
+}
+
+std::optional<GrooveFeatures> DataAugmenter::extractVariantFeatures(const Source& source, const Variant& variant)
+{
+    const auto tempo = renderVariant(source, variant, scratch);
+    auto features = FeatureExtractor::extractFeaturesFromNotes(scratch, tempo);
+    if (!features)
+        return features;
+
+    // A missing forest passes the estimate through
+    graph->setInputs(*features);
+    graph->evaluate();
+    features->energy = graph->getEnergy();
+    features->swing = graph->getSwing();
+    return features;
+}
+
+float DataAugmenter::applyVelocityCurve(float velocity, VelocityCurve curve)
+{
+    float shaped = velocity;
+    switch (curve)
+    {
+        case VelocityCurve::Linear:
+            return velocity;
+        case VelocityCurve::Soft:
+            shaped = 127.0f * std::pow(juce::jlimit(0.0f, 1.0f, velocity / 127.0f), softGamma);
+            break;
+        case VelocityCurve::Hard:
+            shaped = 127.0f * std::pow(juce::jlimit(0.0f, 1.0f, velocity / 127.0f), hardGamma);
+            break;
+        case VelocityCurve::Compressed:
+            shaped = velocityCentre + (velocity - velocityCentre) * compressionRatio;
+            break;
+    }
+    return juce::jlimit(1.0f, 127.0f, std::round(shaped));
+}
+
+const char* DataAugmenter::getVelocityCurveName(VelocityCurve curve)
+{
+    switch (curve)
+    {
+        case VelocityCurve::Linear:     return "linear";
+        case VelocityCurve::Soft:       return "soft";
+        case VelocityCurve::Hard:       return "hard";
+        case VelocityCurve::Compressed: return "compressed";
+    }
+    return "linear";
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "NoteEvents.h"
+#include "FeatureExtractor.h"
+
+class FeatureModelGraph;
+class GrooveShaper;
+
+/**
+ * Data Augmenter
+ * Expands a labeled MIDI file into many variants for training the mood model:
+ * transposition, tempo scaling, GrooveShaper humanization at several
+ * intensities, velocity curve remaps and track subsets. Variants only ever
+ * exist in memory. Each one is rendered to notes and its features extracted
+ * straight away, and no MIDI is written. When the energy and swing forests
+ * are loaded, those two features are their predictions, as in the training
+ * CSVs. Sources are read once and shared between threads. Each instance owns
+ * its groove engine and forests, so one instance serves one thread. Variants
+ * are seeded, so a run can be repeated exactly.
+ */
+class DataAugmenter
+{
+public:
+    struct Source
+    {
+        std::string name;
+        std::string mood;
+        float tempo = 120.0f;
+        std::vector<NoteEvent> notes;
+        std::vector<int> noteTracks; // track of each note
+        std::uint32_t trackMask = 0; // tracks that hold notes, up to 32
+    };
+
+    enum class VelocityCurve
+    {
+        Linear,
+        Soft,       // lifts quiet notes
+        Hard,       // pushes quiet notes down
+        Compressed  // halves the distance from the middle
+    };
+
+    struct Variant
+    {
+        int transpose = 0;            // semitones; drums are left alone
+        float tempoScale = 1.0f;
+        float humanize = 0.0f;        // GrooveShaper intensity with the source's mood profile
+        VelocityCurve velocityCurve = VelocityCurve::Linear;
+        std::uint32_t trackMask = ~0u;
+        int leftOutTrack = -1;        // the track missing from trackMask; -1 when every track plays
+        std::uint32_t seed = 0;
+    };
+
+    struct Settings
+    {
+        std::vector<int> transpositions { -3, -2, -1, 0, 1, 2, 3 };
+        std::vector<float> tempoScales { 0.85f, 0.92f, 1.0f, 1.08f, 1.16f };
+        std::vector<float> humanizeIntensities { 0.0f, 0.35f, 0.7f, 1.0f };
+        std::vector<VelocityCurve> velocityCurves { VelocityCurve::Linear, VelocityCurve::Soft,
+                                                    VelocityCurve::Hard, VelocityCurve::Compressed };
+        bool trackSubsets = true; // every track, then each with one track left out
+        std::uint32_t seed = 1;
+    };
+
+    DataAugmenter();
+    ~DataAugmenter();
+
+    // Loads energy_random_forest.onnx and swing_random_forest.onnx from the directory; returns how many loaded
+    int loadAuxiliaryModels(const juce::File& directory);
+
+    // Reads a MIDI file's notes, their tracks and its first tempo
+    static bool loadSource(const std::string& path, Source& source, std::string& error);
+
+    // Every combination of the settings for this source, in a fixed order
+    static std::vector<Variant> enumerateVariants(const Source& source, const Settings& settings, std::uint32_t sourceIndex);
+
+    // Renders a variant into notes, replacing their contents, and returns its tempo
+    float renderVariant(const Source& source, const Variant& variant, std::vector<NoteEvent>& notes);
+
+    // Renders a variant and extracts its features; empty if it has fewer than two notes
+    std::optional<GrooveFeatures> extractVariantFeatures(const Source& source, const Variant& variant);
+
+    static float applyVelocityCurve(float velocity, VelocityCurve curve);
+    static const char* getVelocityCurveName(VelocityCurve curve);
+
+private:
+    std::unique_ptr<GrooveShaper> shaper;
+    std::unique_ptr<FeatureModelGraph> graph;
+    std::vector<NoteEvent> scratch;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DataAugmenter)
+};
@@ -0,0 +1,234 @@
+#include "DrumTranscriber.h"
+#include "FastMath.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Band edges: kick fundamentals, snare body and rattle, hi-hat sizzle
+    constexpr float lowBandHz[] = { 30.0f, 150.0f };
+    constexpr float midBandHz[] = { 250.0f, 5000.0f };
+    constexpr float highBandHz[] = { 7000.0f, 16000.0f };
+    constexpr float noiseBandHz[] = { 1000.0f, 8000.0f };
+
+    // Log compression applied to sine amplitudes before the flux is taken
+    constexpr float compression = 100.0f;
+
+    // Adaptive threshold: running mean and mean absolute deviation of each band's flux
+    constexpr double thresholdSeconds = 0.5;
+    constexpr float minimumFlux = 0.05f;
+    constexpr int warmUpFrames = 8;
+
+    // Hits closer together than this in one band are the same hit
+    constexpr double refractorySeconds[] = { 0.06, 0.06, 0.04 };
+
+    // Spectral shape gates
+    constexpr float kickLowShare = 0.5f;       // low band's share of low + mid energy
+    constexpr float snareFlatness = 0.2f;      // spectral flatness of the noise band
+    constexpr float snareLowShare = 0.6f;      // above this, the mid onset is the kick's leakage
+    constexpr float hatFluxRatio = 1.5f;       // high band flux over mid band flux
+
+    // Velocity follows band energy across this range
+    constexpr float quietestDb = -50.0f;
+    constexpr float loudestDb = 0.0f;
+}
+
+DrumTranscriber::DrumTranscriber(MemoryLedger* ledger)
+    : previousLog(TrackedAllocator<float>(ledger, MemoryLedger::Subsystem::AudioHistory))
+{
+}
+
+DrumTranscriber::~DrumTranscriber() = default;
+
+int DrumTranscriber::getNoteNumber(Piece piece)
+{
+    // General MIDI percussion: bass drum 1, acoustic snare, closed hi-hat
+    switch (piece)
+    {
+        case Piece::Kick:  return 36;
+        case Piece::Snare: return 38;
+        case Piece::HiHat: return 42;
+        default:           return 36;
+    }
+}
+
+void DrumTranscriber::prepare(const Stft& stft)
+{
+    const auto makeRange = [&stft](const float (&edges)[2])
+    {
+        BandRange range;
+        range.firstBin = std::max(1, stft.getBinForFrequency(edges[0]));
+        range.endBin = std::max(range.firstBin + 1, stft.getBinForFrequency(edges[1]));
+        return range;
+    };
+
+    bands[Low] = makeRange(lowBandHz);
+    bands[Mid] = makeRange(midBandHz);
+    bands[High] = makeRange(highBandHz);
+    noiseRange = makeRange(noiseBandHz);
+
+    // A Hann window sums to half its length; a full-scale sine peaks at a quarter of it
+    magnitudeScale = stft.getWindowSize() > 0 ? 4.0f / static_cast<float>(stft.getWindowSize()) : 1.0f;
+
+    previousLog.assign(static_cast<size_t>(stft.getNumBins()), 0.0f);
+    reset();
+}
+
+void DrumTranscriber::reset()
+{
+    std::fill(previousLog.begin(), previousLog.end(), 0.0f);
+    flux.fill(0.0f);
+    energy.fill(0.0f);
+    fluxMean.fill(0.0f);
+    fluxDeviation.fill(0.0f);
+    aboveThreshold.fill(false);
+    lastOnsetTime.fill(-1.0);
+    noiseFlatness = 0.0f;
+    framesSeen = 0;
+
+    recentWrite = 0;
+    recentCount = 0;
+    latestFrameTime = 0.0;
+    for (auto& count : hitCounts)
+        count.store(0);
+}
+
+void DrumTranscriber::addListener(Listener* listener)
+{
+    if (listener != nullptr && std::find(listeners.begin(), listeners.end(), listener) == listeners.end())
+        listeners.push_back(listener);
+}
+
+void DrumTranscriber::removeListener(Listener* listener)
+{
+    listeners.erase(std::remove(listeners.begin(), listeners.end(), listener), listeners.end());
+}
+
+void DrumTranscriber::stftFrameReady(const Stft& stft, const float* magnitudes, double frameTime)
+{
+    if (previousLog.size() != static_cast<size_t>(stft.getNumBins()))
+        return;
+
+    // Flux and energy per band; the bands don't overlap, so each bin is visited once
+    for (int band = 0; band < NumBands; ++band)
+    {
+        const auto range = bands[static_cast<size_t>(band)];
+        float positiveChange = 0.0f;
+        float bandEnergy = 0.0f;
+        for (int bin = range.firstBin; bin < range.endBin; ++bin)
+        {
+            const float amplitude = magnitudes[bin] * magnitudeScale;
+            const float compressed = FastMath::log(1.0f + compression * amplitude);
+            positiveChange += std::max(0.0f, compressed - previousLog[static_cast<size_t>(bin)]);
+            previousLog[static_cast<size_t>(bin)] = compressed;
+            bandEnergy += amplitude * amplitude;
+        }
+        flux[static_cast<size_t>(band)] = positiveChange / static_cast<float>(range.endBin - range.firstBin);
+        energy[static_cast<size_t>(band)] = bandEnergy;
+    }
+
+    // Flatness (geometric over arithmetic mean of power) separates snare noise from tonal attacks
+    float logSum = 0.0f;
+    float powerSum = 0.0f;
+    for (int bin = noiseRange.firstBin; bin < noiseRange.endBin; ++bin)
+    {
+        const float amplitude = magnitudes[bin] * magnitudeScale;
+        const float power = amplitude * amplitude + 1.0e-12f;
+        logSum += FastMath::log(power);
+        powerSum += power;
+    }
+    const float numNoiseBins = static_cast<float>(noiseRange.endBin - noiseRange.firstBin);
+    noiseFlatness = FastMath::exp(logSum / numNoiseBins) / (powerSum / numNoiseBins);
+
+    latestFrameTime = frameTime;
+    if (++framesSeen > warmUpFrames)
+        detectOnsets(frameTime - 0.5 * stft.getWindowSize() / stft.getSampleRate(), stft.getHopSeconds());
+    else
+        for (int band = 0; band < NumBands; ++band)
+            fluxMean[static_cast<size_t>(band)] = flux[static_cast<size_t>(band)];
+
+    for (auto* listener : listeners)
+        listener->drumFrameAnalysed(frameTime);
+}
+
+void DrumTranscriber::detectOnsets(double hitTime, double hopSeconds)
+{
+    const float smoothing = static_cast<float>(std::min(1.0, hopSeconds / thresholdSeconds));
+
+    std::array<bool, NumBands> onset {};
+    std::array<float, NumBands> threshold {};
+    for (size_t band = 0; band < NumBands; ++band)
+    {
+        threshold[band] = fluxMean[band] + thresholdDeviations * fluxDeviation[band] + minimumFlux;
+        const bool above = flux[band] > threshold[band];
+
+        // Rising edge only, and not inside the band's refractory time
+        onset[band] = above && !aboveThreshold[band]
+                   && (lastOnsetTime[band] < 0.0 || hitTime - lastOnsetTime[band] >= refractorySeconds[band]);
+        aboveThreshold[band] = above;
+        if (onset[band])
+            lastOnsetTime[band] = hitTime;
+
+        // Update after testing so an onset doesn't raise its own threshold
+        const float difference = flux[band] - fluxMean[band];
+        fluxMean[band] += smoothing * difference;
+        fluxDeviation[band] += smoothing * (std::abs(difference) - fluxDeviation[band]);
+    }
+
+    const float lowShare = energy[Low] / (energy[Low] + energy[Mid] + 1.0e-12f);
+
+    if (onset[Low] && lowShare >= kickLowShare)
+        addHit(Piece::Kick, hitTime, energy[Low], flux[Low], threshold[Low]);
+
+    if (onset[Mid] && noiseFlatness >= snareFlatness && lowShare < snareLowShare)
+        addHit(Piece::Snare, hitTime, energy[Mid], flux[Mid], threshold[Mid]);
+
+    // Broadband noise (a snare, a crash) lifts the mid band as much as the top one
+    if (onset[High] && flux[High] >= hatFluxRatio * flux[Mid])
+        addHit(Piece::HiHat, hitTime, energy[High], flux[High], threshold[High]);
+}
+
+void DrumTranscriber::addHit(Piece piece, double time, float bandEnergy, float bandFlux, float threshold)
+{
+    NoteEvent hit;
+    hit.startTime = std::max(0.0, time);
+    hit.duration = hitDuration;
+    hit.noteNumber = getNoteNumber(piece);
+    hit.velocity = energyToVelocity(bandEnergy);
+    hit.channel = drumChannel;
+    hit.confidence = juce::jlimit(0.0f, 1.0f, 1.0f - threshold / std::max(bandFlux, 1.0e-6f));
+
+    recentHits[static_cast<size_t>(recentWrite)] = hit;
+    recentWrite = (recentWrite + 1) % recentHitCapacity;
+    recentCount = std::min(recentHitCapacity, recentCount + 1);
+
+    hitCounts[static_cast<size_t>(piece)].fetch_add(1);
+
+    for (auto* listener : listeners)
+        listener->drumHitDetected(hit);
+}
+
+int DrumTranscriber::getRecentHits(std::vector<NoteEvent>& destination, double windowSeconds) const
+{
+    const double since = latestFrameTime - windowSeconds;
+    int added = 0;
+    for (int i = 0; i < recentCount; ++i)
+    {
+        const auto& hit = recentHits[static_cast<size_t>((recentWrite - recentCount + i + recentHitCapacity) % recentHitCapacity)];
+        if (hit.startTime < since)
+            continue;
+        if (destination.size() == destination.capacity())
+            break;
+        destination.push_back(hit);
+        ++added;
+    }
+    return added;
+}
+
+float DrumTranscriber::energyToVelocity(float bandEnergy)
+{
+    const float decibels = 10.0f * std::log10(bandEnergy + 1.0e-12f);
+    const float normalised = (juce::jlimit(quietestDb, loudestDb, decibels) - quietestDb) / (loudestDb - quietestDb);
+    return 1.0f + normalised * 126.0f;
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "MemoryLedger.h"
+#include "NoteEvents.h"
+#include "Stft.h"
+
+/**
+ * Drum Transcriber
+ * Turns a live drum mix into kick, snare and hi-hat hits. It listens to a
+ * short-window STFT and splits each frame into low, mid and high bands. Each
+ * band has a log-compressed spectral flux onset detector with its own adaptive
+ * threshold and refractory time. An onset only counts as a drum when the
+ * frame's spectral shape agrees: bass-heavy for the kick, noisy for the snare,
+ * and little below the top band for the hat. Hits come out as General MIDI
+ * drum notes on channel 10, the same events the MIDI feature path reads. The
+ * work per frame is one pass over the bins.
+ */
+class DrumTranscriber : public Stft::Listener
+{
+public:
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+
+        // Audio thread: each classified hit, in time order
+        virtual void drumHitDetected(const NoteEvent& hit) = 0;
+
+        // Audio thread: called once per analysed frame after its hits, so listeners can keep time
+        virtual void drumFrameAnalysed(double frameTime) { juce::ignoreUnused(frameTime); }
+    };
+
+    enum class Piece : std::uint8_t
+    {
+        Kick,
+        Snare,
+        HiHat,
+        NumPieces
+    };
+
+    static constexpr int numPieces = static_cast<int>(Piece::NumPieces);
+    static constexpr int drumChannel = 9;          // zero-based, so MIDI channel 10
+    static constexpr int recentHitCapacity = 512;
+    static constexpr double hitDuration = 0.05;    // drum notes are triggers; give them a nominal length
+
+    // Analysis buffers are charged to the ledger's audio history account when one is given
+    explicit DrumTranscriber(MemoryLedger* ledger = nullptr);
+    ~DrumTranscriber() override;
+
+    // Message thread: maps the bands onto the transform's bins; call after the STFT is prepared
+    void prepare(const Stft& stft);
+    void reset();
+
+    // Message thread, before processing starts; listeners must outlive the transcriber
+    void addListener(Listener* listener);
+    void removeListener(Listener* listener);
+
+    // Audio thread
+    void stftFrameReady(const Stft& stft, const float* magnitudes, double frameTime) override;
+
+    // Audio thread: appends hits from the last windowSeconds, oldest first, without growing past
+    // the destination's capacity; returns how many were added
+    int getRecentHits(std::vector<NoteEvent>& destination, double windowSeconds) const;
+
+    // Hits detected since the last reset, per piece
+    int getHitCount(Piece piece) const { return hitCounts[static_cast<size_t>(piece)].load(); }
+
+    // Multiples of each band's flux deviation an onset must clear
+    void setSensitivity(float deviations) { thresholdDeviations = deviations; }
+
+    static int getNoteNumber(Piece piece);
+
+private:
+    enum Band
+    {
+        Low,
+        Mid,
+        High,
+        NumBands
+    };
+
+    struct BandRange
+    {
+        int firstBin = 0;
+        int endBin = 0;
+    };
+
+    void detectOnsets(double frameTime, double hopSeconds);
+    void addHit(Piece piece, double time, float energy, float flux, float threshold);
+
+    static float energyToVelocity(float energy);
+
+    std::array<BandRange, NumBands> bands {};
+    BandRange noiseRange;                 // where the snare's flatness is measured
+
+    TrackedVector<float> previousLog;     // log-compressed magnitudes of the last frame
+    float magnitudeScale = 1.0f;          // bin magnitude to sine amplitude
+
+    // Per-band frame measurements and adaptive thresholds
+    std::array<float, NumBands> flux {};
+    std::array<float, NumBands> energy {};
+    std::array<float, NumBands> fluxMean {};
+    std::array<float, NumBands> fluxDeviation {};
+    std::array<bool, NumBands> aboveThreshold {};
+    std::array<double, NumBands> lastOnsetTime {};
+    float noiseFlatness = 0.0f;
+    int framesSeen = 0;
+
+    float thresholdDeviations = 2.5f;
+
+    // Audio thread only: ring of the newest hits for the feature extractor
+    std::array<NoteEvent, recentHitCapacity> recentHits;
+    int recentWrite = 0;
+    int recentCount = 0;
+    double latestFrameTime = 0.0;
+
+    std::array<std::atomic<int>, numPieces> hitCounts {};
+
+    std::vector<Listener*> listeners;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DrumTranscriber)
+};
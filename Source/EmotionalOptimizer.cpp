@@ -1,6 +1,8 @@
 #include "EmotionalOptimizer.h"
+#include "FastMath.h"
+#include "SimdKernels.h"
 
-EmotionalOptimizer::EmotionalOptimizer()
+EmotionalOptimizer::EmotionalOptimizer() : random(juce::Time::currentTimeMillis())
 {
     initializeMoodProfiles();
 }
@@ -74,8 +76,8 @@ void EmotionalOptimizer::applyDynamicShaping(std::vector<MIDINote>& notes, const
         float position = static_cast<float>(i) / notes.size();
         
         // Create dynamic curve using multiple sine waves
-        float energyVariation = std::sin(position * juce::MathConstants<float>::pi * 2.0f) * energyCurve;
-        float tensionVariation = std::sin(position * juce::MathConstants<float>::pi * 4.0f) * tensionCurve;
+        float energyVariation = FastMath::sin2Pi(position) * energyCurve;
+        float tensionVariation = FastMath::sin2Pi(position * 2.0f) * tensionCurve;
         
         // Apply dynamic shaping
         float dynamicMultiplier = 1.0f + (energyVariation + tensionVariation) * 0.3f;
@@ -104,7 +106,7 @@ void EmotionalOptimizer::applyArticulationVariation(std::vector<MIDINote>& notes
         }
         
         // Add subtle timing variations for humanization
-        float timingVariation = (juce::Random::getSystemRandom().nextFloat() - 0.5f) * 0.02f;
+        float timingVariation = (random.nextFloat() - 0.5f) * 0.02f;
         note.startTime += timingVariation;
     }
 }
@@ -166,7 +168,7 @@ void EmotionalOptimizer::applyPhraseTiming(std::vector<MIDINote>& notes, size_t
         float phrasePosition = static_cast<float>(i - start) / (end - start);
         
         // Create rubato curve
-        float rubatoVariation = std::sin(phrasePosition * juce::MathConstants<float>::pi) * rubatoAmount;
+        float rubatoVariation = FastMath::sin2Pi(phrasePosition * 0.5f) * rubatoAmount;
         
         // Apply timing variation
         notes[i].startTime += rubatoVariation;
@@ -175,13 +177,13 @@ void EmotionalOptimizer::applyPhraseTiming(std::vector<MIDINote>& notes, size_t
 
 void EmotionalOptimizer::applyEmotionalOptimization(std::vector<MIDINote>& notes, const EmotionalProfile& profile)
 {
+    // Energy affects velocity
+    float velocityMultiplier = calculateVelocityMultiplier(profile.energy, profile.tension, 0.0f);
+    applyVelocityTransform(notes, velocityMultiplier, 0.0f);
+    
     // Apply overall emotional characteristics
     for (auto& note : notes)
     {
-        // Energy affects velocity
-        float velocityMultiplier = calculateVelocityMultiplier(profile.energy, profile.tension, note.velocity);
-        note.velocity = juce::jlimit(1.0f, 127.0f, note.velocity * velocityMultiplier);
-        
         // Warmth affects note selection (simplified)
         if (profile.warmth < 0.3f)
         {
@@ -198,20 +200,32 @@ void EmotionalOptimizer::applyEmotionalOptimization(std::vector<MIDINote>& notes
 
 void EmotionalOptimizer::adjustVelocityForEmotion(std::vector<MIDINote>& notes, float energy, float tension)
 {
-    for (auto& note : notes)
-    {
-        float baseVelocity = note.velocity;
-        
-        // Energy affects overall velocity
-        float energyMultiplier = 0.5f + (energy * 1.0f);
-        
-        // Tension affects velocity variation
-        float tensionVariation = (tension - 0.5f) * 0.3f;
-        
-        // Apply adjustments
-        float newVelocity = baseVelocity * energyMultiplier + (tensionVariation * 64.0f);
-        note.velocity = juce::jlimit(1.0f, 127.0f, newVelocity);
-    }
+    // Energy affects overall velocity
+    float energyMultiplier = 0.5f + (energy * 1.0f);
+    
+    // Tension affects velocity variation
+    float tensionVariation = (tension - 0.5f) * 0.3f;
+    
+    // Apply adjustments
+    applyVelocityTransform(notes, energyMultiplier, tensionVariation * 64.0f);
+}
+
+void EmotionalOptimizer::setMemoryLedger(MemoryLedger* ledger)
+{
+    velocityScratch = TrackedVector<float>(TrackedAllocator<float>(ledger, MemoryLedger::Subsystem::Caches));
+}
+
+void EmotionalOptimizer::applyVelocityTransform(std::vector<MIDINote>& notes, float gain, float offset)
+{
+    // Gather velocities into a contiguous lane so the clamp runs through the SIMD kernels
+    velocityScratch.resize(notes.size());
+    for (size_t i = 0; i < notes.size(); ++i)
+        velocityScratch[i] = notes[i].velocity;
+    
+    SimdKernels::scaleClamp(velocityScratch.data(), velocityScratch.size(), gain, offset, 1.0f, 127.0f);
+    
+    for (size_t i = 0; i < notes.size(); ++i)
+        notes[i].velocity = velocityScratch[i];
 }
 
 void EmotionalOptimizer::adjustDensityForEmotion(std::vector<MIDINote>& notes, float complexity, float energy)
@@ -274,7 +288,7 @@ void EmotionalOptimizer::adjustHarmonicTension(std::vector<MIDINote>& notes, flo
                 if (targetTension > currentTension)
                 {
                     // Increase tension - add dissonance
-                    if (juce::Random::getSystemRandom().nextFloat() < 0.3f)
+                    if (random.nextFloat() < 0.3f)
                     {
                         note->noteNumber = juce::jlimit(0, 127, note->noteNumber + 1);
                     }
@@ -282,7 +296,7 @@ void EmotionalOptimizer::adjustHarmonicTension(std::vector<MIDINote>& notes, flo
                 else
                 {
                     // Decrease tension - make more consonant
-                    if (juce::Random::getSystemRandom().nextFloat() < 0.3f)
+                    if (random.nextFloat() < 0.3f)
                     {
                         note->noteNumber = juce::jlimit(0, 127, note->noteNumber - 1);
                     }
@@ -303,7 +317,7 @@ void EmotionalOptimizer::adjustGrooveForEmotion(std::vector<MIDINote>& notes, fl
         for (auto& note : notes)
         {
             // Simple swing implementation - offset off-beat notes
-            float beatPosition = std::fmod(note.startTime * tempo / 60.0f, 1.0f);
+            float beatPosition = FastMath::wrapUnit(note.startTime * tempo / 60.0f);
             if (beatPosition > 0.5f) // Off-beat
             {
                 float swingOffset = (targetSwing - swingAmount) * 0.1f;
@@ -399,8 +413,8 @@ float EmotionalOptimizer::calculateSwingAmount(const std::vector<MIDINote>& note
     
     for (size_t i = 0; i < notes.size() - 1; ++i)
     {
-        float beatPosition1 = std::fmod(notes[i].startTime * tempo / 60.0f, 1.0f);
-        float beatPosition2 = std::fmod(notes[i + 1].startTime * tempo / 60.0f, 1.0f);
+        float beatPosition1 = FastMath::wrapUnit(notes[i].startTime * tempo / 60.0f);
+        float beatPosition2 = FastMath::wrapUnit(notes[i + 1].startTime * tempo / 60.0f);
         
         if (beatPosition1 < 0.5f && beatPosition2 > 0.5f) // On-beat to off-beat
         {
@@ -422,7 +436,7 @@ float EmotionalOptimizer::calculateSyncopation(const std::vector<MIDINote>& note
     
     for (const auto& note : notes)
     {
-        float beatPosition = std::fmod(note.startTime * tempo / 60.0f, 1.0f);
+        float beatPosition = FastMath::wrapUnit(note.startTime * tempo / 60.0f);
         if (beatPosition > 0.5f && beatPosition < 0.75f) // Off-beat
         {
             syncopatedNotes++;
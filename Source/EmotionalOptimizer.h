@@ -4,6 +4,7 @@
 #include <vector>
 #include <map>
 #include <string>
+#include "MemoryLedger.h"
 
 /**
  * Emotional Optimization System
@@ -49,10 +50,16 @@ public:
     void loadEmotionalPreset(const std::string& presetName);
     void saveEmotionalPreset(const std::string& presetName, const EmotionalProfile& profile);
     
+    // Scratch buffers are charged to the ledger's cache account
+    void setMemoryLedger(MemoryLedger* ledger);
+    
     // Real-time parameters
     void setEmotionalSensitivity(float sensitivity) { emotionalSensitivity = juce::jlimit(0.0f, 1.0f, sensitivity); }
     void setPresetBlend(float blend) { presetBlend = juce::jlimit(0.0f, 1.0f, blend); }
     
+    // Humanization and tension tweaks are seeded from the clock; a fixed seed makes them repeatable
+    void setRandomSeed(juce::int64 seed) { random.setSeed(seed); }
+    
 private:
     // Mood profiles
     std::map<std::string, EmotionalProfile> moodProfiles;
@@ -63,6 +70,12 @@ private:
     float emotionalSensitivity = 0.5f;
     float presetBlend = 0.0f;
     
+    // Scratch lane for vectorized velocity transforms
+    TrackedVector<float> velocityScratch;
+    
+    // Each instance draws from its own generator, so instances on different threads never share one
+    juce::Random random;
+    
     // Internal processing
     void initializeMoodProfiles();
     EmotionalProfile blendProfiles(const EmotionalProfile& primary, const EmotionalProfile& secondary, float blend);
@@ -70,6 +83,7 @@ private:
     float calculateDensityMultiplier(float complexity, float energy);
     float calculateHarmonicTension(float tension, float brightness);
     float calculateGrooveOffset(float danceability, float tempo);
+    void applyVelocityTransform(std::vector<MIDINote>& notes, float gain, float offset);
     
     // Harmonic analysis
     bool isMinorChord(int rootNote, const std::vector<int>& chordNotes);
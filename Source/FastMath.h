@@ -0,0 +1,241 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Fast Math Approximations
+ * Branch-free polynomial replacements for the libm calls in per-note and
+ * per-sample loops. Everything is inline, works on plain floats and avoids
+ * table lookups so compilers can vectorize the surrounding loop.
+ *
+ * Maximum errors against libm, measured by Tools/FastMathBenchmark:
+ *   sin2Pi / cos2Pi   absolute 2e-7   |turns| <= 4096
+ *   sin / cos         absolute 2e-7   |x| <= 1000
+ *   exp2 / exp        relative 3e-7   inputs clamped to the normal float range
+ *   log2 / log        3e-7            x > 0 normal; absolute below 1, relative above
+ *   tanh              absolute 3e-7   all finite x
+ *   wrap / wrapUnit   absolute 1e-7   |x / period| < 2^31
+ */
+class FastMath
+{
+public:
+    static constexpr float twoPi = 6.283185307179586f;
+    static constexpr float inverseTwoPi = 0.15915494309189535f;
+
+    //==============================================================================
+    // Floor through integer truncation (valid while |x| < 2^31). Written with an
+    // integer correction rather than a float select so loops stay vectorizable.
+    static inline std::int32_t floorToInt(float x)
+    {
+        std::int32_t truncated = static_cast<std::int32_t>(x);
+        return truncated - static_cast<std::int32_t>(static_cast<float>(truncated) > x);
+    }
+
+    static inline float floor(float x)
+    {
+        return static_cast<float>(floorToInt(x));
+    }
+
+    static inline double floor(double x)
+    {
+        std::int64_t truncated = static_cast<std::int64_t>(x);
+        return static_cast<double>(truncated - static_cast<std::int64_t>(static_cast<double>(truncated) > x));
+    }
+
+    // x wrapped into [0, period); unlike fmod, negative inputs wrap forward
+    static inline float wrap(float x, float period)
+    {
+        return x - period * floor(x / period);
+    }
+
+    static inline double wrap(double x, double period)
+    {
+        return x - period * floor(x / period);
+    }
+
+    // Fractional part in [0, 1)
+    static inline float wrapUnit(float x)
+    {
+        return x - floor(x);
+    }
+
+    // Phase in radians wrapped into [-pi, pi)
+    static inline float wrapPhase(float radians)
+    {
+        float turns = radians * inverseTwoPi;
+        return (turns - floor(turns + 0.5f)) * twoPi;
+    }
+
+    //==============================================================================
+    // sin(2 * pi * turns): the natural form for curves driven by a 0..1 position
+    static inline float sin2Pi(float turns)
+    {
+        // Quarter-turn reduction is exact in float, leaving |r| <= pi/4
+        std::int32_t quadrant = floorToInt(turns * 4.0f + 0.5f);
+        float r = (turns - static_cast<float>(quadrant) * 0.25f) * twoPi;
+        return evaluateQuadrant(r, quadrant);
+    }
+
+    static inline float cos2Pi(float turns)
+    {
+        std::int32_t quadrant = floorToInt(turns * 4.0f + 0.5f);
+        float r = (turns - static_cast<float>(quadrant) * 0.25f) * twoPi;
+        return evaluateQuadrant(r, quadrant + 1);
+    }
+
+    static inline float sin(float radians)
+    {
+        std::int32_t quadrant = floorToInt(radians * 0.6366197723675814f + 0.5f);
+        return evaluateQuadrant(reduceHalfPi(radians, quadrant), quadrant);
+    }
+
+    static inline float cos(float radians)
+    {
+        std::int32_t quadrant = floorToInt(radians * 0.6366197723675814f + 0.5f);
+        return evaluateQuadrant(reduceHalfPi(radians, quadrant), quadrant + 1);
+    }
+
+    //==============================================================================
+    static inline float exp2(float x)
+    {
+        x = clamp(x, -126.0f, 127.0f);
+
+        // 2^x = 2^n * e^(f ln2), with f in [-0.5, 0.5]; x - n is exact
+        std::int32_t n = floorToInt(x + 0.5f);
+        return expPolynomial((x - static_cast<float>(n)) * 0.6931471805599453f) * powerOfTwo(n);
+    }
+
+    static inline float exp(float x)
+    {
+        x = clamp(x, -87.0f, 88.0f);
+
+        // Two-part ln2 keeps the reduction exact for large |x|
+        std::int32_t n = floorToInt(x * 1.4426950408889634f + 0.5f);
+        float fn = static_cast<float>(n);
+        float f = (x - fn * 0.693359375f) + fn * 2.12194440e-4f;
+        return expPolynomial(f) * powerOfTwo(n);
+    }
+
+    static inline float log2(float x)
+    {
+        std::int32_t bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+
+        // Split into 2^e * m with m in [sqrt(0.5), sqrt(2)) so the series stays short
+        std::int32_t exponent = (bits - 0x3f3504f3) >> 23;
+        std::int32_t mantissaBits = bits - (exponent << 23);
+        float m;
+        std::memcpy(&m, &mantissaBits, sizeof(m));
+
+        // log2(m) = 2/ln2 * atanh(t), t = (m - 1) / (m + 1), |t| <= 0.172
+        float t = (m - 1.0f) / (m + 1.0f);
+        float t2 = t * t;
+        float p = 1.0f / 9.0f;
+        p = p * t2 + 1.0f / 7.0f;
+        p = p * t2 + 1.0f / 5.0f;
+        p = p * t2 + 1.0f / 3.0f;
+        p = p * t2 + 1.0f;
+        return static_cast<float>(exponent) + 2.8853900817779268f * t * p;
+    }
+
+    static inline float log(float x)
+    {
+        return log2(x) * 0.6931471805599453f;
+    }
+
+    //==============================================================================
+    // Saturating curve for waveshapers; exact limits of +/-1 beyond |x| = 9
+    static inline float tanh(float x)
+    {
+        float clamped = clamp(x, -9.0f, 9.0f);
+        float e = exp2(clamped * 2.8853900817779268f);
+        float viaExp = (e - 1.0f) / (e + 1.0f);
+
+        // Near zero the exp form cancels, so blend in the odd series there
+        float x2 = clamped * clamped;
+        float series = clamped * (1.0f + x2 * (-1.0f / 3.0f + x2 * (2.0f / 15.0f + x2 * (-17.0f / 315.0f))));
+        float useSeries = static_cast<float>(std::abs(clamped) < 0.125f);
+        return viaExp + useSeries * (series - viaExp);
+    }
+
+private:
+    // Clamp as a bitwise select. With std::min/max GCC threads the constant
+    // bounds through the code that follows, and the branches stop the loop vectorizing.
+    static inline float clamp(float x, float lowest, float highest)
+    {
+        std::int32_t bits, lowBits, highBits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        std::memcpy(&lowBits, &lowest, sizeof(lowBits));
+        std::memcpy(&highBits, &highest, sizeof(highBits));
+
+        std::int32_t belowMask = -static_cast<std::int32_t>(x < lowest);
+        std::int32_t aboveMask = -static_cast<std::int32_t>(x > highest);
+        bits = (bits & ~belowMask) | (lowBits & belowMask);
+        bits = (bits & ~aboveMask) | (highBits & aboveMask);
+
+        float result;
+        std::memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+
+    // r in [-pi/4, pi/4] radians; quadrant selects sin/cos and sign
+    static inline float evaluateQuadrant(float r, std::int32_t quadrant)
+    {
+        float r2 = r * r;
+
+        // Taylor series; truncation error < 3e-9 (sin) and < 3e-8 (cos) at pi/4
+        float s = -2.5052108385e-8f;
+        s = s * r2 + 2.7557319224e-6f;
+        s = s * r2 - 1.9841269841e-4f;
+        s = s * r2 + 8.3333333333e-3f;
+        s = s * r2 - 1.6666666667e-1f;
+        s = r + r * r2 * s;
+
+        float c = 2.4801587302e-5f;
+        c = c * r2 - 1.3888888889e-3f;
+        c = c * r2 + 4.1666666667e-2f;
+        c = c * r2 - 0.5f;
+        c = c * r2 + 1.0f;
+
+        float useCos = static_cast<float>(quadrant & 1);
+        float value = s + useCos * (c - s);
+
+        // Quadrants 2 and 3 negate: flip the sign bit directly
+        std::uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        bits ^= static_cast<std::uint32_t>(quadrant & 2) << 30;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    // Cody-Waite reduction by quadrant * pi/2 with a three-part constant
+    static inline float reduceHalfPi(float x, std::int32_t quadrant)
+    {
+        float q = static_cast<float>(quadrant);
+        x = x - q * 1.5703125f;
+        x = x - q * 4.8351287841796875e-4f;
+        return x - q * 3.13916473e-7f;
+    }
+
+    // e^f for |f| <= 0.347; degree-6 Taylor, relative truncation error < 1.3e-7
+    static inline float expPolynomial(float f)
+    {
+        float p = 1.3888888889e-3f;
+        p = p * f + 8.3333333333e-3f;
+        p = p * f + 4.1666666667e-2f;
+        p = p * f + 1.6666666667e-1f;
+        p = p * f + 0.5f;
+        p = p * f + 1.0f;
+        return p * f + 1.0f;
+    }
+
+    static inline float powerOfTwo(std::int32_t n)
+    {
+        std::int32_t bits = (n + 127) << 23;
+        float scale;
+        std::memcpy(&scale, &bits, sizeof(scale));
+        return scale;
+    }
+};
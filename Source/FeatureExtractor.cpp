@@ -1,6 +1,10 @@
 #include "FeatureExtractor.h"
+#include "DrumTranscriber.h"
+#include "FastMath.h"
+#include "SimdKernels.h"
 #include "MidiFile.h"
 #include "Options.h"
+#include <array>
 #include <cmath>
 #include <vector>
 #include <numeric>
@@ -10,12 +14,19 @@
 using namespace std;
 using namespace smf;
 
-FeatureExtractor::FeatureExtractor() 
-    : lastAnalysisTime(0.0)
+FeatureExtractor::FeatureExtractor(MemoryLedger* ledger) 
+    : audioHistory(TrackedAllocator<float>(ledger, MemoryLedger::Subsystem::AudioHistory)),
+      velocityHistory(TrackedAllocator<float>(ledger, MemoryLedger::Subsystem::AudioHistory)),
+      pitchHistory(TrackedAllocator<float>(ledger, MemoryLedger::Subsystem::AudioHistory)),
+      lastAnalysisTime(0.0)
 {
-    audioHistory.reserve(MAX_HISTORY_SIZE);
-    velocityHistory.reserve(MAX_HISTORY_SIZE);
-    pitchHistory.reserve(MAX_HISTORY_SIZE);
+    audioHistory.reserve(historyCapacity);
+    velocityHistory.reserve(historyCapacity);
+    pitchHistory.reserve(historyCapacity);
+    
+    drumHits.reserve(DrumTranscriber::recentHitCapacity);
+    eventTimes.reserve(DrumTranscriber::recentHitCapacity);
+    eventVelocities.reserve(DrumTranscriber::recentHitCapacity);
 }
 
 FeatureExtractor::~FeatureExtractor() {}
@@ -28,31 +39,52 @@ void FeatureExtractor::reset()
     lastAnalysisTime = 0.0;
 }
 
+void FeatureExtractor::setHistoryCapacity(size_t numSamples)
+{
+    historyCapacity = std::max<size_t>(1, numSamples);
+    
+    // Keep the newest samples, then let the buffers give back what they no longer need
+    for (auto* history : { &audioHistory, &velocityHistory, &pitchHistory })
+    {
+        if (history->size() > historyCapacity)
+            history->erase(history->begin(), history->begin() + (history->size() - historyCapacity));
+        
+        // Already the right size: skip the reallocation, which is most of a repeated prepareToPlay
+        if (history->capacity() == historyCapacity)
+            continue;
+        
+        History resized(history->get_allocator());
+        resized.reserve(historyCapacity);
+        resized.assign(history->begin(), history->end());
+        history->swap(resized);
+    }
+}
+
 std::optional<GrooveFeatures> FeatureExtractor::extractFeaturesFromAudio(const juce::AudioBuffer<float>& buffer, double sampleRate)
 {
     // Add current buffer to history
+    const size_t numSamples = static_cast<size_t>(buffer.getNumSamples());
     for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
     {
-        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-        {
-            float sampleValue = buffer.getSample(channel, sample);
-            audioHistory.push_back(sampleValue);
-            
-            // Calculate velocity (amplitude) for this sample
-            float velocity = std::abs(sampleValue);
-            velocityHistory.push_back(velocity);
-            
-            // For pitch, we'll use a simple approximation based on sample value
-            // In a real implementation, you'd use pitch detection algorithms
-            float pitch = (sampleValue + 1.0f) * 64.0f; // Map to 0-128 range
-            pitchHistory.push_back(pitch);
-        }
+        const float* channelData = buffer.getReadPointer(channel);
+        const size_t offset = audioHistory.size();
+        
+        audioHistory.insert(audioHistory.end(), channelData, channelData + numSamples);
+        
+        // Calculate velocity (amplitude) for each sample
+        velocityHistory.resize(offset + numSamples);
+        SimdKernels::absolute(channelData, velocityHistory.data() + offset, numSamples);
+        
+        // For pitch, we'll use a simple approximation based on sample value
+        // In a real implementation, you'd use pitch detection algorithms
+        pitchHistory.resize(offset + numSamples);
+        SimdKernels::affine(channelData, pitchHistory.data() + offset, numSamples, 64.0f, 64.0f); // Map to 0-128 range
     }
     
     // Keep history size manageable
-    if (audioHistory.size() > MAX_HISTORY_SIZE)
+    if (audioHistory.size() > historyCapacity)
     {
-        size_t excess = audioHistory.size() - MAX_HISTORY_SIZE;
+        size_t excess = audioHistory.size() - historyCapacity;
         audioHistory.erase(audioHistory.begin(), audioHistory.begin() + excess);
         velocityHistory.erase(velocityHistory.begin(), velocityHistory.begin() + excess);
         pitchHistory.erase(pitchHistory.begin(), pitchHistory.begin() + excess);
@@ -79,9 +111,62 @@ std::optional<GrooveFeatures> FeatureExtractor::extractFeaturesFromAudio(const j
     features.syncopation = calculateSyncopation(audioHistory, sampleRate);
     features.onsetEntropy = calculateOnsetEntropy(audioHistory, sampleRate);
     
+    if (drumTranscriber != nullptr && buffer.getNumChannels() > 0)
+        applyDrumHitFeatures(features, audioHistory.size() / (sampleRate * buffer.getNumChannels()));
+    
     return features;
 }
 
+void FeatureExtractor::applyDrumHitFeatures(GrooveFeatures& features, double windowSeconds)
+{
+    drumHits.clear();
+    drumTranscriber->getRecentHits(drumHits, windowSeconds);
+    if (drumHits.size() < 2)
+        return;
+    
+    // Measure from the first hit, as a MIDI file is measured from its downbeat
+    eventTimes.clear();
+    eventVelocities.clear();
+    const double origin = drumHits.front().startTime;
+    for (const auto& hit : drumHits)
+    {
+        eventTimes.push_back(static_cast<float>(hit.startTime - origin));
+        eventVelocities.push_back(std::round(hit.velocity));
+    }
+    
+    const float endTime = eventTimes.back();
+    if (endTime <= 0.0f)
+        return;
+    
+    calculateEventFeatures(eventTimes, eventVelocities, endTime, features);
+}
+
+void FeatureExtractor::calculateEventFeatures(const vector<float>& noteTimes, const vector<float>& velocities,
+                                              float endTime, GrooveFeatures& features)
+{
+    float density = noteTimes.size() / endTime;
+
+    // Swing: Deviation from strict 8th note grid (assume 120 BPM 8th notes = 0.25s apart)
+    float swingSum = 0.0f;
+    for (auto& time : noteTimes) {
+        float quant = round(time * 4.0f) / 4.0f; // nearest 0.25
+        swingSum += fabs(time - quant);
+    }
+    float swing = swingSum / noteTimes.size();
+
+    float maxVel = *max_element(velocities.begin(), velocities.end());
+    float minVel = *min_element(velocities.begin(), velocities.end());
+    float dynamicRange = maxVel - minVel;
+    float meanVel = accumulate(velocities.begin(), velocities.end(), 0.0f) / velocities.size();
+
+    float energy = (density * 0.5f) + (meanVel / 127.0f * 0.5f);
+
+    features.swing = swing;
+    features.density = density;
+    features.dynamicRange = dynamicRange;
+    features.energy = energy;
+}
+
 GrooveFeatures FeatureExtractor::extractFeaturesFromMidi(const string& midiPath) {
     MidiFile midi;
     if (!midi.read(midiPath)) return {120.0f, 0.0f, 0.0f, 0.0f, 0.0f}; // fallback
@@ -90,7 +175,7 @@ GrooveFeatures FeatureExtractor::extractFeaturesFromMidi(const string& midiPath)
     midi.linkNotePairs();
 
     vector<float> noteTimes;
-    vector<int> velocities;
+    vector<float> velocities;
     float endTime = 0.0f;
 
     for (int t = 0; t < midi.getTrackCount(); ++t) {
@@ -110,33 +195,201 @@ GrooveFeatures FeatureExtractor::extractFeaturesFromMidi(const string& midiPath)
     if (noteTimes.size() < 2 || endTime <= 0.0f)
         return {120.0f, 0.0f, 0.0f, 0.0f, 0.0f};
 
-    float density = noteTimes.size() / endTime;
+    GrooveFeatures features {};
+    calculateEventFeatures(noteTimes, velocities, endTime, features);
 
-    // Swing: Deviation from strict 8th note grid (assume 120 BPM 8th notes = 0.25s apart)
-    float swingSum = 0.0f;
-    for (auto& time : noteTimes) {
-        float quant = round(time * 4.0f) / 4.0f; // nearest 0.25
-        swingSum += fabs(time - quant);
+    float tempo = 120.0f;
+    if (midi.getTicksPerQuarterNote() > 0) {
+        tempo = 60.0f / midi.getTimeInSeconds(midi.getTicksPerQuarterNote());
     }
-    float swing = swingSum / noteTimes.size();
 
-    int maxVel = *max_element(velocities.begin(), velocities.end());
-    int minVel = *min_element(velocities.begin(), velocities.end());
-    float dynamicRange = static_cast<float>(maxVel - minVel);
-    float meanVel = accumulate(velocities.begin(), velocities.end(), 0.0f) / velocities.size();
+    features.tempo = tempo;
+    return features;
+}
 
-    float energy = (density * 0.5f) + (meanVel / 127.0f * 0.5f);
+std::optional<GrooveFeatures> FeatureExtractor::extractFeaturesFromNotes(const std::vector<NoteEvent>& notes, double tempo)
+{
+    if (notes.size() < 2)
+        return std::nullopt;
 
-    float tempo = 120.0f;
-    if (midi.getTicksPerQuarterNote() > 0) {
-        tempo = 60.0f / midi.getTimeInSeconds(midi.getTicksPerQuarterNote());
+    const double count = static_cast<double>(notes.size());
+    std::vector<double> starts;
+    std::vector<std::pair<double, int>> timeline; // note-offs sort before note-ons at the same time
+    starts.reserve(notes.size());
+    timeline.reserve(notes.size() * 2);
+
+    double endTime = 0.0, velocitySum = 0.0, pitchSum = 0.0;
+    float minVelocity = 127.0f, maxVelocity = 0.0f;
+    int minPitch = 127, maxPitch = 0;
+    for (const auto& note : notes)
+    {
+        starts.push_back(note.startTime);
+        timeline.emplace_back(note.startTime, 1);
+        timeline.emplace_back(note.startTime + note.duration, -1);
+        endTime = std::max(endTime, note.startTime + note.duration);
+        velocitySum += note.velocity;
+        pitchSum += note.noteNumber;
+        minVelocity = std::min(minVelocity, note.velocity);
+        maxVelocity = std::max(maxVelocity, note.velocity);
+        minPitch = std::min(minPitch, note.noteNumber);
+        maxPitch = std::max(maxPitch, note.noteNumber);
     }
+    std::sort(starts.begin(), starts.end());
+    std::sort(timeline.begin(), timeline.end());
+
+    GrooveFeatures features {};
+    features.tempo = tempo;
+    features.density = endTime > 0.0 ? count / endTime : 0.0;
+    features.velocityMean = velocitySum / count;
+    features.pitchMean = pitchSum / count;
+    features.pitchRange = maxPitch - minPitch;
+
+    double velocityVariance = 0.0;
+    for (const auto& note : notes)
+        velocityVariance += (note.velocity - features.velocityMean) * (note.velocity - features.velocityMean);
+    features.velocityStd = std::sqrt(velocityVariance / count);
+
+    // A flat velocity profile falls back to the spread, as the script does
+    features.dynamicRange = maxVelocity - minVelocity;
+    if (features.dynamicRange < 1e-3)
+        features.dynamicRange = features.velocityStd;
+
+    // Mean number of sounding notes, sampled at every note boundary
+    double active = 0.0, polyphonySum = 0.0;
+    for (const auto& boundary : timeline)
+    {
+        active += boundary.second;
+        polyphonySum += active;
+    }
+    features.avgPolyphony = polyphonySum / static_cast<double>(timeline.size());
+
+    // Inter-onset intervals: their variance is the syncopation, the entropy of their 10-bin histogram the onset entropy
+    std::vector<double> iois(starts.size() - 1);
+    for (size_t i = 1; i < starts.size(); ++i)
+        iois[i - 1] = starts[i] - starts[i - 1];
+
+    if (iois.size() > 1)
+    {
+        const double mean = std::accumulate(iois.begin(), iois.end(), 0.0) / static_cast<double>(iois.size());
+        double variance = 0.0;
+        for (const double ioi : iois)
+            variance += (ioi - mean) * (ioi - mean);
+        features.syncopation = variance / static_cast<double>(iois.size());
+
+        const auto range = std::minmax_element(iois.begin(), iois.end());
+        double low = *range.first, high = *range.second;
+        if (high <= low)
+        {
+            low -= 0.5;
+            high += 0.5;
+        }
+
+        // One added to every bin, as in scipy.stats.entropy(histogram + 1)
+        std::array<double, 10> bins;
+        bins.fill(1.0);
+        for (const double ioi : iois)
+            bins[static_cast<size_t>(std::min(9.0, std::floor((ioi - low) / (high - low) * 10.0)))] += 1.0;
+
+        const double total = static_cast<double>(iois.size()) + 10.0;
+        for (const double bin : bins)
+            features.onsetEntropy -= bin / total * std::log(bin / total);
+    }
+
+    features.swing = estimateSwing(starts);
+    features.energy = estimateEnergy(features.tempo, features.density, features.velocityMean, features.dynamicRange);
+    return features;
+}
+
+std::vector<std::string> FeatureExtractor::getFeatureNames()
+{
+    return { "tempo", "swing", "density", "dynamic_range", "energy", "velocity_mean", "velocity_std",
+             "pitch_mean", "pitch_range", "avg_polyphony", "syncopation", "onset_entropy" };
+}
+
+void FeatureExtractor::appendFeatureRow(const GrooveFeatures& features, std::vector<float>& row)
+{
+    const double values[] = { features.tempo, features.swing, features.density, features.dynamicRange,
+                              features.energy, features.velocityMean, features.velocityStd, features.pitchMean,
+                              features.pitchRange, features.avgPolyphony, features.syncopation,
+                              features.onsetEntropy };
+    for (const double value : values)
+        row.push_back(static_cast<float>(value));
+}
 
-    return {tempo, swing, density, dynamicRange, energy};
+double FeatureExtractor::estimateEnergy(double tempo, double density, double velocityMean, double dynamicRange)
+{
+    constexpr double maxEnergy = 17.0;
+    const double blend = tempo / 200.0 * 0.3 + density / 50.0 * 0.4 + velocityMean / 127.0 * 0.2 + dynamicRange / 127.0 * 0.1;
+    return std::clamp(blend * maxEnergy, 0.0, maxEnergy);
+}
+
+double FeatureExtractor::estimateSwing(const std::vector<double>& sortedStarts)
+{
+    constexpr size_t minIntervals = 12;
+    constexpr double uniformTolerance = 0.003;
+
+    if (sortedStarts.size() < minIntervals + 1)
+        return 0.0;
+
+    std::vector<double> iois(sortedStarts.size() - 1);
+    for (size_t i = 1; i < sortedStarts.size(); ++i)
+        iois[i - 1] = sortedStarts[i] - sortedStarts[i - 1];
+
+    const auto meanAndStd = [](const std::vector<double>& values)
+    {
+        const double mean = std::accumulate(values.begin(), values.end(), 0.0) / static_cast<double>(values.size());
+        double variance = 0.0;
+        for (const double value : values)
+            variance += (value - mean) * (value - mean);
+        return std::make_pair(mean, std::sqrt(variance / static_cast<double>(values.size())));
+    };
+
+    // Clip outliers to the median +/- 3 standard deviations
+    auto sorted = iois;
+    std::sort(sorted.begin(), sorted.end());
+    const size_t middle = sorted.size() / 2;
+    const double median = sorted.size() % 2 == 1 ? sorted[middle] : 0.5 * (sorted[middle - 1] + sorted[middle]);
+    const double deviation = meanAndStd(iois).second;
+    for (auto& ioi : iois)
+        ioi = std::clamp(ioi, median - 3.0 * deviation, median + 3.0 * deviation);
+
+    // Three-point median filter, zero-padded at the ends like scipy.signal.medfilt
+    std::vector<double> smoothed(iois.size());
+    for (size_t i = 0; i < iois.size(); ++i)
+    {
+        double window[3] = { i > 0 ? iois[i - 1] : 0.0, iois[i], i + 1 < iois.size() ? iois[i + 1] : 0.0 };
+        std::sort(window, window + 3);
+        smoothed[i] = window[1];
+    }
+
+    if (meanAndStd(smoothed).second < uniformTolerance)
+        return 0.0;
+
+    double oddSum = 0.0, evenSum = 0.0;
+    size_t oddCount = 0, evenCount = 0;
+    for (size_t i = 0; i < smoothed.size(); ++i)
+    {
+        if (i % 2 == 0)
+        {
+            oddSum += smoothed[i];
+            ++oddCount;
+        }
+        else
+        {
+            evenSum += smoothed[i];
+            ++evenCount;
+        }
+    }
+
+    if (oddCount < 3 || evenCount < 3 || evenSum == 0.0)
+        return 0.0;
+
+    const double ratio = (oddSum / static_cast<double>(oddCount)) / (evenSum / static_cast<double>(evenCount));
+    return std::round(std::min(std::abs(ratio - 1.0), 1.0) * 10000.0) / 10000.0;
 }
 
 // Enhanced audio analysis implementations
-double FeatureExtractor::calculateTempo(const std::vector<float>& audioData, double sampleRate)
+double FeatureExtractor::calculateTempo(const History& audioData, double sampleRate)
 {
     if (audioData.size() < static_cast<size_t>(sampleRate)) return 120.0;
     
@@ -166,25 +419,18 @@ double FeatureExtractor::calculateTempo(const std::vector<float>& audioData, dou
     return tempos[tempos.size() / 2];
 }
 
-std::vector<float> FeatureExtractor::calculateAutocorrelation(const std::vector<float>& audioData)
+std::vector<float> FeatureExtractor::calculateAutocorrelation(const History& audioData)
 {
     size_t maxLag = std::min(audioData.size() / 2, static_cast<size_t>(44100)); // Max 1 second
     std::vector<float> autocorrelation(maxLag, 0.0f);
     
     for (size_t lag = 0; lag < maxLag; ++lag)
     {
-        float sum = 0.0f;
-        size_t count = 0;
-        
-        for (size_t i = 0; i < audioData.size() - lag; ++i)
-        {
-            sum += audioData[i] * audioData[i + lag];
-            count++;
-        }
+        size_t count = audioData.size() - lag;
         
         if (count > 0)
         {
-            autocorrelation[lag] = sum / count;
+            autocorrelation[lag] = SimdKernels::dotProduct(audioData.data(), audioData.data() + lag, count) / count;
         }
     }
     
@@ -207,7 +453,7 @@ std::vector<int> FeatureExtractor::findPeaks(const std::vector<float>& data)
     return peaks;
 }
 
-double FeatureExtractor::calculateSwing(const std::vector<float>& audioData, double sampleRate)
+double FeatureExtractor::calculateSwing(const History& audioData, double sampleRate)
 {
     if (audioData.size() < static_cast<size_t>(sampleRate)) return 0.0;
     
@@ -238,7 +484,7 @@ double FeatureExtractor::calculateSwing(const std::vector<float>& audioData, dou
     return swingCount > 0 ? swingAmount / swingCount : 0.0;
 }
 
-std::vector<float> FeatureExtractor::detectOnsets(const std::vector<float>& audioData, double sampleRate)
+std::vector<float> FeatureExtractor::detectOnsets(const History& audioData, double sampleRate)
 {
     std::vector<float> onsets;
     
@@ -262,59 +508,44 @@ std::vector<float> FeatureExtractor::detectOnsets(const std::vector<float>& audi
     return onsets;
 }
 
-double FeatureExtractor::calculateDensity(const std::vector<float>& audioData, double sampleRate)
+double FeatureExtractor::calculateDensity(const History& audioData, double sampleRate)
 {
     // Calculate density as number of significant events per second
-    int significantEvents = 0;
     float threshold = 0.1f;
-    
-    for (float sample : audioData)
-    {
-        if (std::abs(sample) > threshold)
-        {
-            significantEvents++;
-        }
-    }
+    size_t significantEvents = SimdKernels::countAboveAbs(audioData.data(), audioData.size(), threshold);
     
     double duration = audioData.size() / sampleRate;
     return duration > 0 ? significantEvents / duration : 0.0;
 }
 
-double FeatureExtractor::calculateDynamicRange(const std::vector<float>& audioData)
+double FeatureExtractor::calculateDynamicRange(const History& audioData)
 {
     if (audioData.empty()) return 0.0;
     
-    auto minmax = std::minmax_element(audioData.begin(), audioData.end());
-    return *minmax.second - *minmax.first;
+    float minValue = 0.0f, maxValue = 0.0f;
+    SimdKernels::minMax(audioData.data(), audioData.size(), minValue, maxValue);
+    return maxValue - minValue;
 }
 
-double FeatureExtractor::calculateEnergy(const std::vector<float>& audioData)
+double FeatureExtractor::calculateEnergy(const History& audioData)
 {
     if (audioData.empty()) return 0.0;
     
-    double sum = 0.0;
-    for (float sample : audioData)
-    {
-        sum += sample * sample;
-    }
+    double sum = SimdKernels::sumOfSquares(audioData.data(), audioData.size());
     
     return std::sqrt(sum / audioData.size());
 }
 
-double FeatureExtractor::calculateVelocityMean(const std::vector<float>& velocityData)
+double FeatureExtractor::calculateVelocityMean(const History& velocityData)
 {
     if (velocityData.empty()) return 0.0;
     
-    double sum = 0.0;
-    for (float velocity : velocityData)
-    {
-        sum += velocity;
-    }
+    double sum = SimdKernels::sum(velocityData.data(), velocityData.size());
     
     return sum / velocityData.size();
 }
 
-double FeatureExtractor::calculateVelocityStd(const std::vector<float>& velocityData)
+double FeatureExtractor::calculateVelocityStd(const History& velocityData)
 {
     if (velocityData.size() < 2) return 0.0;
     
@@ -330,46 +561,35 @@ double FeatureExtractor::calculateVelocityStd(const std::vector<float>& velocity
     return std::sqrt(sumSquaredDiffs / (velocityData.size() - 1));
 }
 
-double FeatureExtractor::calculatePitchMean(const std::vector<float>& pitchData)
+double FeatureExtractor::calculatePitchMean(const History& pitchData)
 {
     if (pitchData.empty()) return 0.0;
     
-    double sum = 0.0;
-    for (float pitch : pitchData)
-    {
-        sum += pitch;
-    }
+    double sum = SimdKernels::sum(pitchData.data(), pitchData.size());
     
     return sum / pitchData.size();
 }
 
-double FeatureExtractor::calculatePitchRange(const std::vector<float>& pitchData)
+double FeatureExtractor::calculatePitchRange(const History& pitchData)
 {
     if (pitchData.empty()) return 0.0;
     
-    auto minmax = std::minmax_element(pitchData.begin(), pitchData.end());
-    return *minmax.second - *minmax.first;
+    float minValue = 0.0f, maxValue = 0.0f;
+    SimdKernels::minMax(pitchData.data(), pitchData.size(), minValue, maxValue);
+    return maxValue - minValue;
 }
 
-double FeatureExtractor::calculateAvgPolyphony(const std::vector<float>& audioData, double sampleRate)
+double FeatureExtractor::calculateAvgPolyphony(const History& audioData, double sampleRate)
 {
     // Simplified polyphony calculation
     // In practice, this would involve more sophisticated analysis
-    int activeVoices = 0;
     float threshold = 0.1f;
-    
-    for (float sample : audioData)
-    {
-        if (std::abs(sample) > threshold)
-        {
-            activeVoices++;
-        }
-    }
+    size_t activeVoices = SimdKernels::countAboveAbs(audioData.data(), audioData.size(), threshold);
     
     return static_cast<double>(activeVoices) / audioData.size();
 }
 
-double FeatureExtractor::calculateSyncopation(const std::vector<float>& audioData, double sampleRate)
+double FeatureExtractor::calculateSyncopation(const History& audioData, double sampleRate)
 {
     // Simplified syncopation calculation
     // This is a placeholder - real implementation would be much more complex
@@ -382,7 +602,7 @@ double FeatureExtractor::calculateSyncopation(const std::vector<float>& audioDat
         {
             // Check for off-beat emphasis
             double time = i / sampleRate;
-            double beatPosition = std::fmod(time * 2.0, 1.0); // Assuming 120 BPM
+            double beatPosition = FastMath::wrap(time * 2.0, 1.0); // Assuming 120 BPM
             if (beatPosition > 0.25 && beatPosition < 0.75) // Off-beat
             {
                 syncopation += std::abs(audioData[i]);
@@ -394,7 +614,7 @@ double FeatureExtractor::calculateSyncopation(const std::vector<float>& audioDat
     return count > 0 ? syncopation / count : 0.0;
 }
 
-double FeatureExtractor::calculateOnsetEntropy(const std::vector<float>& audioData, double sampleRate)
+double FeatureExtractor::calculateOnsetEntropy(const History& audioData, double sampleRate)
 {
     // Simplified onset entropy calculation
     // This is a placeholder - real implementation would use proper onset detection
@@ -428,7 +648,7 @@ double FeatureExtractor::calculateOnsetEntropy(const std::vector<float>& audioDa
             double probability = interval / (onsets.back() - onsets.front());
             if (probability > 0.0)
             {
-                entropy -= probability * std::log2(probability);
+                entropy -= probability * FastMath::log2(static_cast<float>(probability));
             }
         }
     }
@@ -1,7 +1,12 @@
 #pragma once
+#include <string>
 #include <vector>
 #include <optional>
 #include <JuceHeader.h>
+#include "MemoryLedger.h"
+#include "NoteEvents.h"
+
+class DrumTranscriber;
 
 struct GrooveFeatures {
     double tempo;
@@ -20,7 +25,8 @@ struct GrooveFeatures {
 
 class FeatureExtractor {
 public:
-    FeatureExtractor();
+    // History buffers are charged to the ledger's audio history account when one is given
+    explicit FeatureExtractor(MemoryLedger* ledger = nullptr);
     ~FeatureExtractor();
     
     // Real-time audio feature extraction
@@ -29,28 +35,71 @@ public:
     // MIDI file feature extraction (for training)
     GrooveFeatures extractFeaturesFromMidi(const std::string& midiFilePath);
     
+    // Every feature of a run of notes in memory, defined as extract_groove_features.py defines
+    // them. Energy and swing are the script's estimates for when its forests aren't loaded;
+    // FeatureModelGraph replaces them with the forests' predictions. Empty for fewer than two
+    // notes. Safe to call from any thread.
+    static std::optional<GrooveFeatures> extractFeaturesFromNotes(const std::vector<NoteEvent>& notes, double tempo);
+    
+    // Feature store column names, snake_case as in the training CSVs, in the order appendFeatureRow writes them
+    static std::vector<std::string> getFeatureNames();
+    static void appendFeatureRow(const GrooveFeatures& features, std::vector<float>& row);
+    
+    // Live drum hits replace the amplitude-based rhythm features, so audio and MIDI
+    // features come from the same kind of events; pass nullptr to go back
+    void setDrumTranscriber(const DrumTranscriber* transcriber) { drumTranscriber = transcriber; }
+    
     // Reset internal state for new analysis
     void reset();
+    
+    // Analysis window in samples, counting every channel's block; shrinking releases memory
+    void setHistoryCapacity(size_t numSamples);
+    size_t getHistoryCapacity() const { return historyCapacity; }
+    
+    static constexpr size_t MAX_HISTORY_SIZE = 44100 * 10; // 10 seconds at 44.1kHz
 
 private:
+    using History = TrackedVector<float>;
+    
     // Internal state for real-time analysis
-    std::vector<float> audioHistory;
-    std::vector<float> velocityHistory;
-    std::vector<float> pitchHistory;
+    History audioHistory;
+    History velocityHistory;
+    History pitchHistory;
     double lastAnalysisTime;
-    static constexpr size_t MAX_HISTORY_SIZE = 44100 * 10; // 10 seconds at 44.1kHz
+    size_t historyCapacity = MAX_HISTORY_SIZE;
+    
+    // Drum hit path; scratch is reserved up front so the audio thread doesn't allocate
+    const DrumTranscriber* drumTranscriber = nullptr;
+    std::vector<NoteEvent> drumHits;
+    std::vector<float> eventTimes;
+    std::vector<float> eventVelocities;
+    
+    void applyDrumHitFeatures(GrooveFeatures& features, double windowSeconds);
+    
+    // Swing, density, dynamic range and energy of a run of note-ons, as the training data defines them
+    static void calculateEventFeatures(const std::vector<float>& noteTimes, const std::vector<float>& velocities,
+                                       float endTime, GrooveFeatures& features);
+    
+    // estimate_swing() from extract_groove_features.py, on sorted note starts
+    static double estimateSwing(const std::vector<double>& sortedStarts);
+    
+    // The energy src/core/extract_groove_features.py falls back on without its forest, 0 to 17
+    static double estimateEnergy(double tempo, double density, double velocityMean, double dynamicRange);
     
     // Helper methods
-    double calculateTempo(const std::vector<float>& audioData, double sampleRate);
-    double calculateSwing(const std::vector<float>& audioData, double sampleRate);
-    double calculateDensity(const std::vector<float>& audioData, double sampleRate);
-    double calculateDynamicRange(const std::vector<float>& audioData);
-    double calculateEnergy(const std::vector<float>& audioData);
-    double calculateVelocityMean(const std::vector<float>& audioData);
-    double calculateVelocityStd(const std::vector<float>& audioData);
-    double calculatePitchMean(const std::vector<float>& audioData);
-    double calculatePitchRange(const std::vector<float>& audioData);
-    double calculateAvgPolyphony(const std::vector<float>& audioData, double sampleRate);
-    double calculateSyncopation(const std::vector<float>& audioData, double sampleRate);
-    double calculateOnsetEntropy(const std::vector<float>& audioData, double sampleRate);
+    double calculateTempo(const History& audioData, double sampleRate);
+    double calculateSwing(const History& audioData, double sampleRate);
+    double calculateDensity(const History& audioData, double sampleRate);
+    double calculateDynamicRange(const History& audioData);
+    double calculateEnergy(const History& audioData);
+    double calculateVelocityMean(const History& audioData);
+    double calculateVelocityStd(const History& audioData);
+    double calculatePitchMean(const History& audioData);
+    double calculatePitchRange(const History& audioData);
+    double calculateAvgPolyphony(const History& audioData, double sampleRate);
+    double calculateSyncopation(const History& audioData, double sampleRate);
+    double calculateOnsetEntropy(const History& audioData, double sampleRate);
+    std::vector<float> calculateAutocorrelation(const History& audioData);
+    std::vector<int> findPeaks(const std::vector<float>& data);
+    std::vector<float> detectOnsets(const History& audioData, double sampleRate);
 };
\ No newline at end of file
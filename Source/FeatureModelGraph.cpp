@@ -0,0 +1,320 @@
+#include "FeatureModelGraph.h"
+#include "FeatureExtractor.h"
+#include <onnxruntime_cxx_api.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+
+namespace
+{
+    // Exported next to groove_mood_model.onnx by the training scripts in MLPython/ModelClassificationScripts
+    const char* const energyModelFile = "energy_random_forest.onnx";
+    const char* const swingModelFile = "swing_random_forest.onnx";
+
+    // One runtime environment for every auxiliary session in the process
+    Ort::Env& auxiliaryEnvironment()
+    {
+        static Ort::Env environment(ORT_LOGGING_LEVEL_WARNING, "AamatiFeatureGraph");
+        return environment;
+    }
+}
+
+// A single-output regressor exported from scikit-learn: [batch, numInputs] in, [batch, 1] out
+struct FeatureModelGraph::Model
+{
+    explicit Model(MemoryLedger* ledger) : charge(ledger, MemoryLedger::Subsystem::Inference) {}
+
+    bool load(const std::string& path, size_t expectedInputs)
+    {
+        try
+        {
+            Ort::SessionOptions sessionOptions;
+            sessionOptions.SetIntraOpNumThreads(1);
+            sessionOptions.SetGraphOptimizationLevel(ORT_ENABLE_BASIC);
+            session = Ort::Session(auxiliaryEnvironment(), path.c_str(), sessionOptions);
+
+            if (session.GetInputCount() != 1 || session.GetOutputCount() != 1)
+            {
+                std::cerr << "Auxiliary model needs one input and one output: " << path << std::endl;
+                return false;
+            }
+
+            const auto inputShape = session.GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+            if (inputShape.size() != 2 || inputShape[1] != static_cast<int64_t>(expectedInputs))
+            {
+                std::cerr << "Auxiliary model expects " << expectedInputs << " features per row: " << path << std::endl;
+                return false;
+            }
+
+            Ort::AllocatorWithDefaultOptions allocator;
+            char* inputNamePtr = session.GetInputName(0, allocator);
+            inputName = inputNamePtr;
+            allocator.Free(inputNamePtr);
+            char* outputNamePtr = session.GetOutputName(0, allocator);
+            outputName = outputNamePtr;
+            allocator.Free(outputNamePtr);
+
+            numInputs = expectedInputs;
+            charge.setBytes(static_cast<size_t>(juce::File(path).getSize()));
+            return true;
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Error loading auxiliary model " << path << ": " << e.what() << std::endl;
+            return false;
+        }
+    }
+
+    bool run(const float* inputs, float& output)
+    {
+        try
+        {
+            auto memoryInfo = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
+            const std::array<int64_t, 2> dims = {1, static_cast<int64_t>(numInputs)};
+            Ort::Value inputTensor = Ort::Value::CreateTensor<float>(memoryInfo, const_cast<float*>(inputs), numInputs,
+                                                                     dims.data(), dims.size());
+
+            const char* inputNames[] = {inputName.c_str()};
+            const char* outputNames[] = {outputName.c_str()};
+            auto outputTensors = session.Run(Ort::RunOptions{nullptr}, inputNames, &inputTensor, 1, outputNames, 1);
+            if (outputTensors.empty() || outputTensors.front().GetTensorTypeAndShapeInfo().GetElementCount() != 1)
+                return false;
+
+            output = outputTensors.front().GetTensorMutableData<float>()[0];
+            return std::isfinite(output);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Error during auxiliary prediction: " << e.what() << std::endl;
+            return false;
+        }
+    }
+
+    Ort::Session session { nullptr };
+    std::string inputName;
+    std::string outputName;
+    size_t numInputs = 0;
+    MemoryLedger::Charge charge;
+};
+
+FeatureModelGraph::FeatureModelGraph(MemoryLedger* ledgerToUse)
+    : ledger(ledgerToUse),
+      values(numInputs, 0.0f),
+      versions(numInputs, 0)
+{
+    // The whole cascade, as extract_groove_features.py computes it. Each node only reads values declared before it.
+    const int energy = declare(EnergyModel, {Density, VelocityMean, DynamicRange, AvgPolyphony}, MeasuredEnergy, 1);
+    const int swing = declare(SwingModel, {Density, VelocityMean, DynamicRange, AvgPolyphony, Syncopation, OnsetEntropy,
+                                           RhythmicDensity}, MeasuredSwing, 1);
+    declare(MoodModel, {Tempo, swing, Density, DynamicRange, energy}, -1, numMoods);
+
+    size_t widestInput = 0, widestOutput = 0;
+    for (const auto& state : nodes)
+    {
+        widestInput = std::max(widestInput, state.inputs.size());
+        widestOutput = std::max(widestOutput, static_cast<size_t>(state.numOutputs));
+    }
+    scratchInputs.resize(widestInput);
+    scratchOutputs.resize(widestOutput);
+}
+
+FeatureModelGraph::~FeatureModelGraph() = default;
+
+int FeatureModelGraph::declare(Node node, std::vector<int> inputs, int fallback, int numOutputs)
+{
+    auto& state = nodes[node];
+    jassert(std::all_of(inputs.begin(), inputs.end(),
+                        [this](int input) { return input >= 0 && input < static_cast<int>(values.size()); }));
+
+    state.inputs = std::move(inputs);
+    state.fallback = fallback;
+    state.firstOutput = static_cast<int>(values.size());
+    state.numOutputs = numOutputs;
+    state.seenVersions.assign(std::max<size_t>(1, state.inputs.size()), 0);
+
+    values.resize(values.size() + static_cast<size_t>(numOutputs), 0.0f);
+    versions.resize(values.size(), 0);
+    return state.firstOutput;
+}
+
+int FeatureModelGraph::loadAuxiliaryModels(const juce::File& directory)
+{
+    int loaded = 0;
+    loaded += loadModel(EnergyModel, directory.getChildFile(energyModelFile)) ? 1 : 0;
+    loaded += loadModel(SwingModel, directory.getChildFile(swingModelFile)) ? 1 : 0;
+    return loaded;
+}
+
+bool FeatureModelGraph::loadModel(Node node, const juce::File& file)
+{
+    auto& state = nodes[node];
+    if (state.model != nullptr && loadedPaths[node] == file.getFullPathName())
+        return true;
+
+    std::unique_ptr<Model> model;
+    if (file.existsAsFile())
+    {
+        model = std::make_unique<Model>(ledger);
+        if (!model->load(file.getFullPathName().toStdString(), state.inputs.size()))
+            model.reset();
+    }
+    else
+    {
+        DBG("Auxiliary model not found, using the measured value: " << file.getFullPathName());
+    }
+
+    const bool loaded = model != nullptr;
+    state.model = std::move(model);
+    loadedPaths[node] = loaded ? file.getFullPathName() : juce::String();
+    invalidate(node);
+    return loaded;
+}
+
+bool FeatureModelGraph::hasAuxiliaryModel(Node node) const
+{
+    return nodes[node].model != nullptr;
+}
+
+void FeatureModelGraph::setMoodFunction(MoodFunction function)
+{
+    moodFunction = std::move(function);
+    invalidate(MoodModel);
+}
+
+void FeatureModelGraph::setInputs(const GrooveFeatures& features)
+{
+    const auto set = [this](Input input, double value)
+    {
+        const auto narrowed = static_cast<float>(value);
+        if (values[input] != narrowed)
+        {
+            values[input] = narrowed;
+            ++versions[input];
+        }
+    };
+
+    set(Tempo, features.tempo);
+    set(Density, features.density);
+    set(VelocityMean, features.velocityMean);
+    set(DynamicRange, features.dynamicRange);
+    set(AvgPolyphony, features.avgPolyphony);
+    set(Syncopation, features.syncopation);
+    set(OnsetEntropy, features.onsetEntropy);
+    set(RhythmicDensity, features.density * features.tempo / 1000.0);
+    set(MeasuredEnergy, features.energy);
+    set(MeasuredSwing, features.swing);
+}
+
+bool FeatureModelGraph::dependenciesChanged(const NodeState& state) const
+{
+    if (!state.current)
+        return true;
+
+    // Without its model an auxiliary node depends on the measured value alone
+    if (state.fallback >= 0 && state.model == nullptr)
+        return versions[static_cast<size_t>(state.fallback)] != state.seenVersions[0];
+
+    for (size_t i = 0; i < state.inputs.size(); ++i)
+        if (versions[static_cast<size_t>(state.inputs[i])] != state.seenVersions[i])
+            return true;
+    return false;
+}
+
+void FeatureModelGraph::recordDependencies(NodeState& state)
+{
+    if (state.fallback >= 0 && state.model == nullptr)
+    {
+        state.seenVersions[0] = versions[static_cast<size_t>(state.fallback)];
+        return;
+    }
+
+    for (size_t i = 0; i < state.inputs.size(); ++i)
+        state.seenVersions[i] = versions[static_cast<size_t>(state.inputs[i])];
+}
+
+void FeatureModelGraph::store(const NodeState& state, const float* outputs)
+{
+    // Only a value that moved bumps its version, so an unchanged prediction stops the cascade here
+    for (int i = 0; i < state.numOutputs; ++i)
+    {
+        const auto index = static_cast<size_t>(state.firstOutput + i);
+        if (values[index] != outputs[i])
+        {
+            values[index] = outputs[i];
+            ++versions[index];
+        }
+    }
+}
+
+bool FeatureModelGraph::evaluate()
+{
+    for (auto& state : nodes)
+    {
+        if (!dependenciesChanged(state))
+            continue;
+
+        for (size_t i = 0; i < state.inputs.size(); ++i)
+            scratchInputs[i] = values[static_cast<size_t>(state.inputs[i])];
+
+        bool evaluated = false;
+        if (state.fallback >= 0)
+        {
+            // A missing model passes the measured value through; one that fails does too, but runs again next hop
+            if (state.model != nullptr)
+                evaluated = state.model->run(scratchInputs.data(), scratchOutputs[0]);
+            if (!evaluated)
+                scratchOutputs[0] = values[static_cast<size_t>(state.fallback)];
+            store(state, scratchOutputs.data());
+            evaluated = evaluated || state.model == nullptr;
+        }
+        else if (moodFunction && moodFunction(scratchInputs.data(), scratchOutputs.data()))
+        {
+            store(state, scratchOutputs.data());
+            evaluated = true;
+        }
+
+        state.current = evaluated;
+        if (evaluated)
+        {
+            recordDependencies(state);
+            ++state.evaluations;
+        }
+    }
+
+    return nodes[MoodModel].current;
+}
+
+void FeatureModelGraph::invalidate(Node node)
+{
+    nodes[node].current = false;
+}
+
+float FeatureModelGraph::getEnergy() const
+{
+    return values[static_cast<size_t>(nodes[EnergyModel].firstOutput)];
+}
+
+float FeatureModelGraph::getSwing() const
+{
+    return values[static_cast<size_t>(nodes[SwingModel].firstOutput)];
+}
+
+std::array<float, FeatureModelGraph::numMoodFeatures> FeatureModelGraph::getMoodFeatures() const
+{
+    std::array<float, numMoodFeatures> features {};
+    const auto& inputs = nodes[MoodModel].inputs;
+    for (size_t i = 0; i < features.size() && i < inputs.size(); ++i)
+        features[i] = values[static_cast<size_t>(inputs[i])];
+    return features;
+}
+
+const float* FeatureModelGraph::getMoodProbabilities() const
+{
+    return values.data() + nodes[MoodModel].firstOutput;
+}
+
+std::uint64_t FeatureModelGraph::getEvaluationCount(Node node) const
+{
+    return nodes[node].evaluations;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "MemoryLedger.h"
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+struct GrooveFeatures;
+
+/**
+ * Feature Model Graph
+ * The cascade of models between the extracted features and the mood, declared
+ * once as a DAG in the same shape as extract_groove_features.py: the base
+ * features feed the energy and swing regressors, and their predictions feed
+ * the mood classifier alongside tempo, density and dynamic range. Every value
+ * carries a version that only moves when the value does, and each node
+ * remembers the versions it last read, so a hop re-evaluates only the nodes
+ * whose inputs actually changed. Audio thread only, apart from loading.
+ */
+class FeatureModelGraph
+{
+public:
+    // Base values, set from each hop's features
+    enum Input
+    {
+        Tempo,
+        Density,
+        VelocityMean,
+        DynamicRange,
+        AvgPolyphony,
+        Syncopation,
+        OnsetEntropy,
+        RhythmicDensity, // density * tempo / 1000, as src/core/extract_groove_features.py feeds the swing model
+        MeasuredEnergy,  // stands in for the energy model while it isn't loaded
+        MeasuredSwing,   // likewise for the swing model
+        numInputs
+    };
+
+    // In dependency order
+    enum Node
+    {
+        EnergyModel,
+        SwingModel,
+        MoodModel,
+        numNodes
+    };
+
+    static constexpr int numMoodFeatures = 5;
+    static constexpr int numMoods = 10;
+
+    // Runs the mood model on one row: tempo, swing, density, dynamic range, energy in, numMoods
+    // probabilities out. False leaves the mood dirty, so the next hop asks again.
+    using MoodFunction = std::function<bool(const float* features, float* probabilities)>;
+
+    // Auxiliary sessions are charged to the ledger's inference account when one is given
+    explicit FeatureModelGraph(MemoryLedger* ledger = nullptr);
+    ~FeatureModelGraph();
+
+    // Loads energy_random_forest.onnx and swing_random_forest.onnx from the directory.
+    // Models already loaded from it are kept. Returns how many are loaded.
+    int loadAuxiliaryModels(const juce::File& directory);
+    bool hasAuxiliaryModel(Node node) const;
+
+    void setMoodFunction(MoodFunction function);
+
+    void setInputs(const GrooveFeatures& features);
+
+    // Re-evaluates the nodes whose inputs changed since they last ran.
+    // True when the mood probabilities are current for the inputs.
+    bool evaluate();
+
+    // Forces a node to run on the next evaluate(), e.g. after the model behind it changes
+    void invalidate(Node node);
+
+    float getEnergy() const;
+    float getSwing() const;
+    std::array<float, numMoodFeatures> getMoodFeatures() const;
+    const float* getMoodProbabilities() const;
+
+    // How often each node has run, for diagnostics
+    std::uint64_t getEvaluationCount(Node node) const;
+
+private:
+    struct Model;
+
+    struct NodeState
+    {
+        std::vector<int> inputs;   // value indices, in the order the model reads them
+        int fallback = -1;         // value passed through while an auxiliary model is missing
+        int firstOutput = 0;
+        int numOutputs = 0;
+        std::unique_ptr<Model> model;
+        std::vector<std::uint32_t> seenVersions; // of inputs, or of the fallback alone
+        bool current = false;
+        std::uint64_t evaluations = 0;
+    };
+
+    int declare(Node node, std::vector<int> inputs, int fallback, int numOutputs);
+    bool dependenciesChanged(const NodeState& state) const;
+    void recordDependencies(NodeState& state);
+    void store(const NodeState& state, const float* outputs);
+    bool loadModel(Node node, const juce::File& file);
+
+    MemoryLedger* ledger;
+    std::vector<float> values;
+    std::vector<std::uint32_t> versions;
+    std::array<NodeState, numNodes> nodes;
+    std::vector<float> scratchInputs, scratchOutputs;
+    std::array<juce::String, numNodes> loadedPaths;
+    MoodFunction moodFunction;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FeatureModelGraph)
+};
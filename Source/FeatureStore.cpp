@@ -0,0 +1,288 @@
+#include "FeatureStore.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    const char fileMagic[4] = {'A', 'A', 'F', 'S'};
+    const char blockMagic[4] = {'R', 'O', 'W', 'S'};
+
+    // Explicit byte order, so a store moves between machines unchanged
+    void putUint32(std::vector<char>& out, std::uint32_t value)
+    {
+        for (int shift = 0; shift < 32; shift += 8)
+            out.push_back(static_cast<char>((value >> shift) & 0xffu));
+    }
+
+    void putString(std::vector<char>& out, const std::string& text)
+    {
+        const auto length = static_cast<std::uint32_t>(std::min<size_t>(text.size(), 0xffff));
+        out.push_back(static_cast<char>(length & 0xffu));
+        out.push_back(static_cast<char>(length >> 8));
+        out.insert(out.end(), text.begin(), text.begin() + length);
+    }
+
+    std::uint32_t toUint32(const unsigned char* bytes)
+    {
+        return static_cast<std::uint32_t>(bytes[0]) | (static_cast<std::uint32_t>(bytes[1]) << 8)
+             | (static_cast<std::uint32_t>(bytes[2]) << 16) | (static_cast<std::uint32_t>(bytes[3]) << 24);
+    }
+
+    bool getUint32(std::istream& in, std::uint32_t& value)
+    {
+        unsigned char bytes[4];
+        if (!in.read(reinterpret_cast<char*>(bytes), 4))
+            return false;
+        value = toUint32(bytes);
+        return true;
+    }
+
+    bool getString(std::istream& in, std::string& text)
+    {
+        unsigned char length[2];
+        if (!in.read(reinterpret_cast<char*>(length), 2))
+            return false;
+        text.resize(static_cast<size_t>(length[0] | (length[1] << 8)));
+        return text.empty() || static_cast<bool>(in.read(&text[0], static_cast<std::streamsize>(text.size())));
+    }
+}
+
+int FeatureStore::Column::indexOf(const std::string& category) const
+{
+    const auto it = std::find(categories.begin(), categories.end(), category);
+    return it == categories.end() ? -1 : static_cast<int>(it - categories.begin());
+}
+
+std::vector<std::string> FeatureStore::splitCsvLine(const std::string& line)
+{
+    std::vector<std::string> fields(1);
+    bool quoted = false;
+    for (size_t i = 0; i < line.size(); ++i)
+    {
+        const char c = line[i];
+        if (quoted && c == '"' && i + 1 < line.size() && line[i + 1] == '"')
+            fields.back() += line[++i];
+        else if (c == '"')
+            quoted = !quoted;
+        else if (c == ',' && !quoted)
+            fields.emplace_back();
+        else if (c != '\r')
+            fields.back() += c;
+    }
+    return fields;
+}
+
+//==============================================================================
+FeatureStore::Writer::Writer(int blockRows)
+    : rowsPerBlock(static_cast<size_t>(std::max(1, blockRows)))
+{
+}
+
+FeatureStore::Writer::~Writer()
+{
+    close();
+}
+
+bool FeatureStore::Writer::open(const std::string& path, std::vector<Column> schema)
+{
+    const std::lock_guard<std::mutex> guard(lock);
+    columns = std::move(schema);
+    file.open(path, std::ios::binary | std::ios::trunc);
+    failed = !file.is_open() || columns.empty();
+    rowsWritten = 0;
+    pending.clear();
+    pending.reserve(rowsPerBlock * columns.size());
+    if (failed)
+        return false;
+
+    std::vector<char> header(fileMagic, fileMagic + 4);
+    putUint32(header, version);
+    putUint32(header, static_cast<std::uint32_t>(columns.size()));
+    for (const auto& column : columns)
+    {
+        putString(header, column.name);
+        putUint32(header, static_cast<std::uint32_t>(column.categories.size()));
+        for (const auto& category : column.categories)
+            putString(header, category);
+    }
+
+    failed = !file.write(header.data(), static_cast<std::streamsize>(header.size()));
+    return !failed;
+}
+
+bool FeatureStore::Writer::appendRows(const float* rows, size_t numRows)
+{
+    const std::lock_guard<std::mutex> guard(lock);
+    if (!file.is_open() || failed)
+        return false;
+
+    const size_t width = columns.size();
+    while (numRows > 0)
+    {
+        const size_t room = rowsPerBlock - pending.size() / width;
+        const size_t taken = std::min(room, numRows);
+        pending.insert(pending.end(), rows, rows + taken * width);
+        rows += taken * width;
+        numRows -= taken;
+
+        if (pending.size() / width == rowsPerBlock && !writeBlock())
+            return false;
+    }
+    return true;
+}
+
+bool FeatureStore::Writer::writeBlock()
+{
+    const size_t width = columns.size();
+    const size_t numRows = pending.size() / width;
+    if (numRows == 0)
+        return true;
+
+    // Row-major in, column after column out
+    std::vector<char> block(blockMagic, blockMagic + 4);
+    putUint32(block, static_cast<std::uint32_t>(numRows));
+    block.reserve(block.size() + numRows * width * 4);
+    for (size_t column = 0; column < width; ++column)
+    {
+        for (size_t row = 0; row < numRows; ++row)
+        {
+            std::uint32_t bits;
+            std::memcpy(&bits, &pending[row * width + column], sizeof(bits));
+            putUint32(block, bits);
+        }
+    }
+
+    pending.clear();
+    if (!file.write(block.data(), static_cast<std::streamsize>(block.size())))
+    {
+        failed = true;
+        return false;
+    }
+    rowsWritten += numRows;
+    return true;
+}
+
+bool FeatureStore::Writer::close()
+{
+    const std::lock_guard<std::mutex> guard(lock);
+    if (!file.is_open())
+        return !failed;
+
+    if (!failed)
+        writeBlock();
+    file.close();
+    failed = failed || file.fail();
+    return !failed;
+}
+
+std::uint64_t FeatureStore::Writer::getRowsWritten() const
+{
+    const std::lock_guard<std::mutex> guard(lock);
+    return rowsWritten;
+}
+
+//==============================================================================
+bool FeatureStore::Reader::open(const std::string& path)
+{
+    file.close();
+    file.clear();
+    columns.clear();
+    blocks.clear();
+    numRows = 0;
+
+    file.open(path, std::ios::binary);
+    char magic[4];
+    std::uint32_t fileVersion = 0, numColumns = 0;
+    if (!file.read(magic, 4) || std::memcmp(magic, fileMagic, 4) != 0 || !getUint32(file, fileVersion)
+        || !getUint32(file, numColumns))
+    {
+        error = "not a feature store: " + path;
+        return false;
+    }
+    if (fileVersion != version)
+    {
+        error = "unsupported feature store version " + std::to_string(fileVersion);
+        return false;
+    }
+
+    columns.resize(numColumns);
+    for (auto& column : columns)
+    {
+        std::uint32_t numCategories = 0;
+        if (!getString(file, column.name) || !getUint32(file, numCategories))
+        {
+            error = "truncated header";
+            return false;
+        }
+        column.categories.resize(numCategories);
+        for (auto& category : column.categories)
+            if (!getString(file, category))
+            {
+                error = "truncated header";
+                return false;
+            }
+    }
+
+    // Block index; a block cut short by an interrupted write is left out
+    auto offset = static_cast<std::streamoff>(file.tellg());
+    file.seekg(0, std::ios::end);
+    const auto fileSize = static_cast<std::streamoff>(file.tellg());
+
+    while (offset + 8 <= fileSize)
+    {
+        std::uint32_t rows = 0;
+        file.seekg(offset);
+        if (!file.read(magic, 4) || std::memcmp(magic, blockMagic, 4) != 0 || !getUint32(file, rows))
+            break;
+
+        const auto valuesOffset = offset + 8;
+        const auto blockBytes = static_cast<std::streamoff>(rows) * static_cast<std::streamoff>(columns.size()) * 4;
+        if (valuesOffset + blockBytes > fileSize)
+            break;
+
+        blocks.push_back({ valuesOffset, rows });
+        numRows += rows;
+        offset = valuesOffset + blockBytes;
+    }
+
+    file.clear();
+    return true;
+}
+
+int FeatureStore::Reader::findColumn(const std::string& name) const
+{
+    for (size_t i = 0; i < columns.size(); ++i)
+        if (columns[i].name == name)
+            return static_cast<int>(i);
+    return -1;
+}
+
+bool FeatureStore::Reader::readColumn(int column, std::vector<float>& values)
+{
+    if (column < 0 || column >= static_cast<int>(columns.size()))
+        return false;
+
+    values.clear();
+    values.reserve(numRows);
+    std::vector<unsigned char> bytes;
+    for (const auto& block : blocks)
+    {
+        bytes.resize(static_cast<size_t>(block.rows) * 4);
+        file.seekg(block.offset + static_cast<std::streamoff>(column) * block.rows * 4);
+        if (!file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size())))
+        {
+            error = "could not read column " + columns[static_cast<size_t>(column)].name;
+            file.clear();
+            return false;
+        }
+
+        for (size_t row = 0; row < block.rows; ++row)
+        {
+            const auto bits = toUint32(&bytes[row * 4]);
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            values.push_back(value);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Feature Store
+ * Columnar file of training rows, written by the dataset tools and read by the
+ * evaluation tool and MLPython/feature_store.py. Every value is a 32-bit float.
+ * A categorical column, such as a mood label, stores an index into the category
+ * names kept in the file header. Rows are written in blocks. Each block holds
+ * every column's values for its rows back to back, so a reader can pull one
+ * column without decoding the others.
+ *
+ * Layout, little-endian:
+ *   "AAFS", version, column count, then per column: name and category names
+ *   "ROWS", row count, then each column's values for those rows, repeated per block
+ */
+class FeatureStore
+{
+public:
+    struct Column
+    {
+        std::string name;
+        std::vector<std::string> categories; // empty for a plain numeric column
+
+        // Index of a category name, or -1
+        int indexOf(const std::string& category) const;
+    };
+
+    /**
+     * Feature Store Writer
+     * appendRows() may be called from any number of threads. Rows are buffered
+     * and written a block at a time. The order of rows from different threads
+     * follows the order of their calls.
+     */
+    class Writer
+    {
+    public:
+        explicit Writer(int rowsPerBlock = 65536);
+        ~Writer();
+
+        bool open(const std::string& path, std::vector<Column> columns);
+        const std::vector<Column>& getColumns() const { return columns; }
+
+        // numRows rows of getColumns().size() values each, row after row
+        bool appendRows(const float* rows, size_t numRows);
+
+        // Writes the last partial block; false if any write failed
+        bool close();
+
+        std::uint64_t getRowsWritten() const;
+
+    private:
+        bool writeBlock();
+
+        std::vector<Column> columns;
+        const size_t rowsPerBlock;
+        std::ofstream file;
+        mutable std::mutex lock;
+        std::vector<float> pending;  // row-major, up to rowsPerBlock rows
+        std::uint64_t rowsWritten = 0;
+        bool failed = false;
+
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+    };
+
+    /**
+     * Feature Store Reader
+     * Reads the header and block index on open; columns are read on demand.
+     */
+    class Reader
+    {
+    public:
+        bool open(const std::string& path);
+        const std::vector<Column>& getColumns() const { return columns; }
+        size_t getNumRows() const { return numRows; }
+        const std::string& getError() const { return error; }
+
+        // -1 if there is no column with that name
+        int findColumn(const std::string& name) const;
+
+        bool readColumn(int column, std::vector<float>& values);
+
+    private:
+        struct Block
+        {
+            std::streamoff offset; // of the first value
+            std::uint32_t rows;
+        };
+
+        std::ifstream file;
+        std::vector<Column> columns;
+        std::vector<Block> blocks;
+        size_t numRows = 0;
+        std::string error;
+    };
+
+    // One record of the CSV tables the tools read next to stores, such as labels and the training CSVs.
+    // Quoted fields may hold commas and doubled quotes.
+    static std::vector<std::string> splitCsvLine(const std::string& line);
+
+    static constexpr std::uint32_t version = 1;
+};
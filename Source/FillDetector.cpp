@@ -0,0 +1,185 @@
+#include "FillDetector.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Beats open this fraction of a beat before the grid line
+    constexpr double earlyFraction = 0.125;
+
+    // Hits are stamped a little before the frame that reports them, so beats close late by this much
+    constexpr double settleSeconds = 0.05;
+
+    // Bars of baseline needed before anything counts as a fill, and the baseline's memory in bars
+    constexpr int warmUpBars = 2;
+    constexpr float baselineBars = 8.0f;
+
+    // A fill beat needs at least this many extra onsets, whatever the deviation says
+    constexpr float minimumExcess = 2.0f;
+
+    // Below this many onsets per bar there is no groove to fill against
+    constexpr float minimumBarOnsets = 2.0f;
+}
+
+FillDetector::FillDetector() = default;
+
+FillDetector::~FillDetector() = default;
+
+void FillDetector::setTempo(double beatsPerMinute, int newBeatsPerBar)
+{
+    tempo.store(juce::jlimit(30.0, 300.0, beatsPerMinute));
+    beatsPerBar.store(juce::jlimit(1, maxBeatsPerBar, newBeatsPerBar));
+}
+
+void FillDetector::reset()
+{
+    started = false;
+    beatStart = 0.0;
+    beatIndex = 0;
+    barCount = 0;
+    currentCount = 0;
+
+    baselineMean.fill(0.0f);
+    baselineDeviation.fill(0.0f);
+    barsSeen = 0;
+
+    inFill = false;
+    activeFillBeats = 0;
+    activeFillExcess = 0.0f;
+
+    barHadFill = false;
+    recentBars.fill(false);
+    recentBarPosition = 0;
+    fillActivity.store(0.0f);
+    fillInProgress.store(false);
+}
+
+void FillDetector::drumHitDetected(const NoteEvent& hit)
+{
+    if (!started)
+    {
+        started = true;
+        beatSeconds = 60.0 / tempo.load();
+        beatsInBar = beatsPerBar.load();
+        beatStart = hit.startTime - earlyFraction * beatSeconds;
+    }
+
+    advanceTo(hit.startTime);
+
+    // A hit reported after its beat closed still belongs to the groove; count it in the current beat
+    ++currentCount;
+}
+
+void FillDetector::drumFrameAnalysed(double frameTime)
+{
+    if (started)
+        advanceTo(frameTime - settleSeconds);
+}
+
+void FillDetector::advanceTo(double time)
+{
+    while (time >= beatStart + beatSeconds)
+        closeBeat();
+}
+
+void FillDetector::closeBeat()
+{
+    const auto position = static_cast<size_t>(beatIndex);
+    const float count = static_cast<float>(currentCount);
+    const float excess = count - baselineMean[position];
+
+    float barBaseline = 0.0f;
+    for (int beat = 0; beat < beatsInBar; ++beat)
+        barBaseline += baselineMean[static_cast<size_t>(beat)];
+
+    const bool isFill = barsSeen >= warmUpBars
+                     && barBaseline >= minimumBarOnsets
+                     && excess >= std::max(minimumExcess, thresholdDeviations * baselineDeviation[position]);
+
+    if (isFill)
+    {
+        if (!inFill)
+        {
+            inFill = true;
+            activeFill.startTime = beatStart + earlyFraction * beatSeconds;
+            activeFill.bar = barCount;
+            activeFill.firstBeat = beatIndex;
+            activeFillBeats = 0;
+            activeFillExcess = 0.0f;
+            fillInProgress.store(true);
+        }
+        ++activeFillBeats;
+        activeFillExcess += excess;
+        barHadFill = true;
+    }
+    else
+    {
+        if (inFill)
+            finishFill();
+
+        // Plain averaging while the baseline warms up, then a fixed memory
+        const float smoothing = 1.0f / std::min(baselineBars, static_cast<float>(barsSeen + 1));
+        baselineMean[position] += smoothing * excess;
+        baselineDeviation[position] += smoothing * (std::abs(excess) - baselineDeviation[position]);
+    }
+
+    currentCount = 0;
+    beatStart += beatSeconds;
+
+    if (++beatIndex >= beatsInBar)
+    {
+        beatIndex = 0;
+        ++barCount;
+        ++barsSeen;
+
+        recentBars[static_cast<size_t>(recentBarPosition)] = barHadFill;
+        recentBarPosition = (recentBarPosition + 1) % activityBars;
+        barHadFill = false;
+
+        const auto barsWithFills = std::count(recentBars.begin(), recentBars.end(), true);
+        fillActivity.store(static_cast<float>(barsWithFills) / static_cast<float>(std::min(barsSeen, activityBars)));
+
+        // Tempo changes take effect on bar lines so the beat positions keep their meaning
+        beatSeconds = 60.0 / tempo.load();
+        const int newBeatsPerBar = beatsPerBar.load();
+        if (newBeatsPerBar != beatsInBar)
+        {
+            beatsInBar = newBeatsPerBar;
+            baselineMean.fill(0.0f);
+            baselineDeviation.fill(0.0f);
+            barsSeen = 0;
+        }
+    }
+}
+
+void FillDetector::finishFill()
+{
+    activeFill.duration = activeFillBeats * beatSeconds;
+    activeFill.intensity = activeFillExcess / static_cast<float>(std::max(1, activeFillBeats));
+    pushFill(activeFill);
+
+    inFill = false;
+    fillInProgress.store(false);
+}
+
+void FillDetector::pushFill(const FillEvent& fill)
+{
+    // Dropped if the message thread has stopped draining
+    int start1, size1, start2, size2;
+    fillFifo.prepareToWrite(1, start1, size1, start2, size2);
+    if (size1 > 0)
+        fillQueue[static_cast<size_t>(start1)] = fill;
+    fillFifo.finishedWrite(size1);
+}
+
+int FillDetector::popFills(std::vector<FillEvent>& destination)
+{
+    const int available = fillFifo.getNumReady();
+    int start1, size1, start2, size2;
+    fillFifo.prepareToRead(available, start1, size1, start2, size2);
+    destination.insert(destination.end(), fillQueue.begin() + start1, fillQueue.begin() + start1 + size1);
+    destination.insert(destination.end(), fillQueue.begin() + start2, fillQueue.begin() + start2 + size2);
+    fillFifo.finishedRead(size1 + size2);
+    return size1 + size2;
+}
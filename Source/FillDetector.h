@@ -0,0 +1,102 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <vector>
+#include "DrumTranscriber.h"
+
+/**
+ * Fill Detector
+ * Spots drum fills in the live input while it plays. Drum hits are counted
+ * per beat on a bar grid that starts at the first hit. Each beat position in
+ * the bar keeps its own running baseline, the mean and mean absolute
+ * deviation of its onset count over recent bars, so a busy groove is not
+ * mistaken for a fill. A beat that clearly exceeds its baseline joins a fill.
+ * Fill beats are left out of the baseline. Finished fills go to a lock-free
+ * queue, and the share of recent bars that held one is published as the
+ * fill activity.
+ */
+class FillDetector : public DrumTranscriber::Listener
+{
+public:
+    static constexpr int maxBeatsPerBar = 16;
+    static constexpr int activityBars = 8;   // bars the fill activity is measured over
+    static constexpr int fillQueueSize = 64;
+
+    struct FillEvent
+    {
+        double startTime = 0.0;   // seconds, on the drum transcriber's clock
+        double duration = 0.0;
+        int bar = 0;              // bars since the grid started
+        int firstBeat = 0;        // beat within that bar, from 0
+        float intensity = 0.0f;   // mean onsets per beat above the baseline
+    };
+
+    FillDetector();
+    ~FillDetector() override;
+
+    // Any thread: the grid follows the new tempo from the next beat
+    void setTempo(double beatsPerMinute, int beatsPerBar);
+
+    // Audio thread, or before processing starts
+    void reset();
+
+    // Audio thread
+    void drumHitDetected(const NoteEvent& hit) override;
+    void drumFrameAnalysed(double frameTime) override;
+
+    // Message thread: appends fills finished since the last call; returns how many were added
+    int popFills(std::vector<FillEvent>& destination);
+
+    // Share of the last activityBars bars that held a fill, 0-1
+    float getFillActivity() const { return fillActivity.load(); }
+    bool isFillInProgress() const { return fillInProgress.load(); }
+
+    // Deviations above the baseline a beat must reach to count as a fill
+    void setSensitivity(float deviations) { thresholdDeviations = deviations; }
+
+private:
+    void advanceTo(double time);
+    void closeBeat();
+    void finishFill();
+    void pushFill(const FillEvent& fill);
+
+    std::atomic<double> tempo { 120.0 };
+    std::atomic<int> beatsPerBar { 4 };
+
+    // Grid; beat windows open an eighth of a beat early so hits pushed ahead of the beat count with it
+    bool started = false;
+    double beatStart = 0.0;
+    double beatSeconds = 0.5;
+    int beatsInBar = 4;
+    int beatIndex = 0;
+    int barCount = 0;
+    int currentCount = 0;
+
+    // Running baseline per beat position
+    std::array<float, maxBeatsPerBar> baselineMean {};
+    std::array<float, maxBeatsPerBar> baselineDeviation {};
+    int barsSeen = 0;
+    float thresholdDeviations = 2.0f;
+
+    // Fill being measured
+    bool inFill = false;
+    FillEvent activeFill;
+    int activeFillBeats = 0;
+    float activeFillExcess = 0.0f;
+
+    // Which of the last bars held a fill
+    bool barHadFill = false;
+    std::array<bool, activityBars> recentBars {};
+    int recentBarPosition = 0;
+
+    std::atomic<float> fillActivity { 0.0f };
+    std::atomic<bool> fillInProgress { false };
+
+    // Single producer (audio thread), single consumer (message thread)
+    juce::AbstractFifo fillFifo { fillQueueSize };
+    std::array<FillEvent, fillQueueSize> fillQueue;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FillDetector)
+};
@@ -0,0 +1,299 @@
+#include "FillScheduler.h"
+#include "AuditionSynth.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // How long the generator thread sleeps when the cache is full and nothing wakes it
+    constexpr int idleWaitMs = 250;
+    constexpr int stopTimeoutMs = 2000;
+}
+
+FillScheduler::FillScheduler()
+    : juce::Thread("Fill scheduler")
+{
+}
+
+FillScheduler::~FillScheduler()
+{
+    stop();
+}
+
+void FillScheduler::start(double originSeconds)
+{
+    {
+        const juce::ScopedLock sl(lock);
+        origin = originSeconds;
+        relabel(1);
+    }
+
+    running.store(true);
+    if (!isThreadRunning())
+        startThread();
+    wakeUp.signal();
+}
+
+void FillScheduler::stop()
+{
+    running.store(false);
+    signalThreadShouldExit();
+    wakeUp.signal();
+    stopThread(stopTimeoutMs);
+}
+
+void FillScheduler::setPhraseGrid(const PhraseGrid& grid)
+{
+    const juce::ScopedLock sl(lock);
+
+    PhraseGrid newGrid;
+    newGrid.tempo = juce::jlimit(30.0, 300.0, grid.tempo);
+    newGrid.beatsPerBar = juce::jlimit(1, 16, grid.beatsPerBar);
+    newGrid.barsPerPhrase = juce::jlimit(1, 64, grid.barsPerPhrase);
+    if (newGrid.tempo == phraseGrid.tempo && newGrid.beatsPerBar == phraseGrid.beatsPerBar
+        && newGrid.barsPerPhrase == phraseGrid.barsPerPhrase)
+        return;
+
+    // Keep the boundary just passed where it was, and lay the new grid from there
+    origin += static_cast<double>(nextBoundary - 1) * getPhraseSeconds();
+
+    // A fill is a whole number of beats, so it survives any change but the metre; a new tempo just rescales it
+    if (newGrid.beatsPerBar != phraseGrid.beatsPerBar)
+    {
+        nextBoundary = 1;
+        invalidate();
+    }
+    else
+    {
+        relabel(1);
+        for (auto& slot : slots)
+            if (slot.ready)
+                AIMidiGenerator::rescalePattern(slot.fill, phraseGrid.tempo / newGrid.tempo);
+    }
+
+    phraseGrid = newGrid;
+    wakeUp.signal();
+}
+
+void FillScheduler::setGenerationContext(const AIMidiGenerator::GenerationContext& context)
+{
+    const juce::ScopedLock sl(lock);
+    const int change = AIMidiGenerator::diffContexts(generationContext, context);
+    generationContext = context;
+
+    if ((change & AIMidiGenerator::StructuralChange) != 0)
+    {
+        invalidate();
+        wakeUp.signal();
+        return;
+    }
+
+    if ((change & (AIMidiGenerator::VelocityChange | AIMidiGenerator::PitchSpaceChange)) == 0)
+        return;
+
+    // Fills follow the phrase grid's tempo, not the context's, so only energy and key are carried over
+    for (auto& slot : slots)
+    {
+        if (!slot.ready)
+            continue;
+
+        auto target = context;
+        target.tempo = slot.context.tempo;
+        target.energy = std::max(context.energy, fillActivity.load());
+        if (!AIMidiGenerator::adaptPattern(slot.fill, slot.context, target))
+        {
+            // Not a fill the energy only recolours; it is made again for the new context
+            slot.boundary = -1;
+            slot.fill = {};
+            slot.ready = false;
+            continue;
+        }
+        slot.context = target;
+    }
+
+    // A fill still being generated was made for the old context; it is discarded and made again
+    ++cacheGeneration;
+    wakeUp.signal();
+}
+
+void FillScheduler::setFillAmount(float amount)
+{
+    const juce::ScopedLock sl(lock);
+    amount = juce::jlimit(0.0f, 1.0f, amount);
+    if (amount == fillAmount)
+        return;
+
+    fillAmount = amount;
+    invalidate();
+    wakeUp.signal();
+}
+
+void FillScheduler::invalidate()
+{
+    ++cacheGeneration;
+    for (auto& slot : slots)
+    {
+        slot.boundary = -1;
+        slot.fill = {};
+        slot.ready = false;
+    }
+}
+
+void FillScheduler::relabel(std::int64_t firstBoundary)
+{
+    // A cached fill does not depend on which boundary it leads into, so ready fills move to the new numbering in order
+    std::array<Slot, cacheDepth> kept;
+    size_t numKept = 0;
+    for (auto boundary = nextBoundary; boundary < nextBoundary + cacheDepth; ++boundary)
+    {
+        auto& slot = slots[static_cast<size_t>(boundary % cacheDepth)];
+        if (slot.boundary == boundary && slot.ready)
+            kept[numKept++] = std::move(slot);
+    }
+
+    invalidate();
+    nextBoundary = firstBoundary;
+
+    for (size_t i = 0; i < numKept; ++i)
+    {
+        const auto boundary = firstBoundary + static_cast<std::int64_t>(i);
+        kept[i].boundary = boundary;
+        slots[static_cast<size_t>(boundary % cacheDepth)] = std::move(kept[i]);
+    }
+}
+
+double FillScheduler::getPhraseSeconds() const
+{
+    return phraseGrid.barsPerPhrase * phraseGrid.beatsPerBar * 60.0 / phraseGrid.tempo;
+}
+
+double FillScheduler::getFillSeconds() const
+{
+    if (fillAmount <= 0.0f)
+        return 0.0;
+
+    // Whole beats, at least one, up to the full bar before the boundary
+    const int beats = std::max(1, static_cast<int>(std::lround(fillAmount * phraseGrid.beatsPerBar)));
+    return beats * 60.0 / phraseGrid.tempo;
+}
+
+void FillScheduler::run()
+{
+    while (!threadShouldExit())
+    {
+        std::int64_t wanted = -1;
+        std::uint32_t generation = 0;
+        double fillSeconds = 0.0;
+        AIMidiGenerator::GenerationContext context;
+
+        {
+            const juce::ScopedLock sl(lock);
+            fillSeconds = getFillSeconds();
+            if (running.load() && fillSeconds > 0.0)
+            {
+                for (auto boundary = nextBoundary; boundary < nextBoundary + cacheDepth; ++boundary)
+                {
+                    const auto& slot = slots[static_cast<size_t>(boundary % cacheDepth)];
+                    if (slot.boundary != boundary || !slot.ready)
+                    {
+                        wanted = boundary;
+                        break;
+                    }
+                }
+            }
+            generation = cacheGeneration;
+            context = generationContext;
+        }
+
+        if (wanted < 0)
+        {
+            wakeUp.wait(idleWaitMs);
+            continue;
+        }
+
+        // Generate outside the lock; the message thread never waits on a fill
+        context.energy = std::max(context.energy, fillActivity.load());
+        generator.setGenerationContext(context);
+        auto fill = generator.generateFill(fillSeconds);
+        trimToLength(fill, fillSeconds);
+
+        const juce::ScopedLock sl(lock);
+        if (generation == cacheGeneration && wanted >= nextBoundary)
+        {
+            auto& slot = slots[static_cast<size_t>(wanted % cacheDepth)];
+            slot.boundary = wanted;
+            slot.fill = std::move(fill);
+            slot.context = context;
+            slot.ready = true;
+        }
+    }
+}
+
+int FillScheduler::dispatchDue(AuditionSynth& synth, double nowSeconds, double lookAheadSeconds)
+{
+    const juce::ScopedLock sl(lock);
+
+    const double fillSeconds = getFillSeconds();
+    if (!running.load() || fillSeconds <= 0.0)
+        return 0;
+
+    const double phraseSeconds = getPhraseSeconds();
+    int dispatched = 0;
+
+    for (;;)
+    {
+        const double fillStart = origin + static_cast<double>(nextBoundary) * phraseSeconds - fillSeconds;
+        if (fillStart > nowSeconds + lookAheadSeconds)
+            break;
+
+        auto& slot = slots[static_cast<size_t>(nextBoundary % cacheDepth)];
+        if (fillStart >= nowSeconds && slot.boundary == nextBoundary && slot.ready)
+        {
+            if (!synth.queuePattern(slot.fill, fillStart - nowSeconds))
+                DBG("Audition queue full; fill truncated");
+            ++dispatched;
+        }
+        else
+        {
+            cacheMisses.fetch_add(1);
+        }
+
+        slot.boundary = -1;
+        slot.ready = false;
+        ++nextBoundary;
+    }
+
+    // Sent fills free their slots for the boundaries after them
+    if (dispatched > 0)
+        wakeUp.signal();
+
+    return dispatched;
+}
+
+double FillScheduler::getSecondsToNextFill(double nowSeconds) const
+{
+    const juce::ScopedLock sl(lock);
+    return origin + static_cast<double>(nextBoundary) * getPhraseSeconds() - getFillSeconds() - nowSeconds;
+}
+
+bool FillScheduler::isNextFillReady() const
+{
+    const juce::ScopedLock sl(lock);
+    const auto& slot = slots[static_cast<size_t>(nextBoundary % cacheDepth)];
+    return slot.boundary == nextBoundary && slot.ready;
+}
+
+void FillScheduler::trimToLength(AIMidiGenerator::GeneratedPattern& pattern, double seconds)
+{
+    // The generator's fills run a little long; drop notes that would start on the boundary or after it.
+    // Their note-offs stay behind and release nothing.
+    pattern.messages.erase(std::remove_if(pattern.messages.begin(), pattern.messages.end(),
+                                          [seconds](const juce::MidiMessage& message)
+                                          {
+                                              return message.isNoteOn() && message.getTimeStamp() >= seconds;
+                                          }),
+                           pattern.messages.end());
+
+    pattern.duration = seconds;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include "AIMidiGenerator.h"
+
+class AuditionSynth;
+
+/**
+ * Fill Scheduler
+ * Keeps drum fills ready for the next phrase boundaries so that playing one
+ * costs nothing at the moment it is due. A background thread with its own
+ * generator fills a small cache, one slot per upcoming boundary, and refills a
+ * slot as soon as its fill has been sent. The message thread only hands fills
+ * that are already cached to the audition synth's lock-free event queue, a
+ * little ahead of time, and the audio thread just plays the queued events.
+ * Cached fills outlive most changes. Restarting or re-spacing the phrases
+ * only relabels them, a new tempo rescales them, and a context that only
+ * moved its energy or key remaps or transposes them. Only a new metre, fill
+ * amount or structural context change throws the cache away.
+ */
+class FillScheduler : private juce::Thread
+{
+public:
+    static constexpr int cacheDepth = 2;   // boundaries generated ahead
+
+    struct PhraseGrid
+    {
+        double tempo = 120.0;
+        int beatsPerBar = 4;
+        int barsPerPhrase = 4;
+    };
+
+    FillScheduler();
+    ~FillScheduler() override;
+
+    // Message thread: boundaries fall every phrase after originSeconds on the synth's clock
+    void start(double originSeconds);
+    void stop();
+    bool isRunning() const { return running.load(); }
+
+    // Message thread: cached fills are adapted where they can be and discarded otherwise
+    void setPhraseGrid(const PhraseGrid& grid);
+    void setGenerationContext(const AIMidiGenerator::GenerationContext& context);
+
+    // Message thread: 0 turns fills off, 1 fills the whole bar before a boundary
+    void setFillAmount(float amount);
+
+    // Message thread: how busy the input's own fills are, 0-1; raises the energy of fills not yet generated
+    void setFillActivity(float activity) { fillActivity.store(juce::jlimit(0.0f, 1.0f, activity)); }
+
+    // Message thread: queues every cached fill that starts within lookAheadSeconds of nowSeconds.
+    // Never generates; a fill that isn't ready in time is skipped and counted as a miss.
+    int dispatchDue(AuditionSynth& synth, double nowSeconds, double lookAheadSeconds);
+
+    // Seconds from nowSeconds until the next fill starts, and whether it is already cached
+    double getSecondsToNextFill(double nowSeconds) const;
+    bool isNextFillReady() const;
+
+    int getCacheMisses() const { return cacheMisses.load(); }
+
+private:
+    struct Slot
+    {
+        std::int64_t boundary = -1;   // phrase boundary index the fill leads into
+        AIMidiGenerator::GeneratedPattern fill;
+        AIMidiGenerator::GenerationContext context; // as the fill was generated, fill activity included
+        bool ready = false;
+    };
+
+    void run() override;
+    void invalidate();
+    void relabel(std::int64_t firstBoundary);
+    double getPhraseSeconds() const;
+    double getFillSeconds() const;
+    static void trimToLength(AIMidiGenerator::GeneratedPattern& pattern, double seconds);
+
+    // Shared between the message thread and the generator thread
+    juce::CriticalSection lock;
+    PhraseGrid phraseGrid;
+    AIMidiGenerator::GenerationContext generationContext;
+    float fillAmount = 0.5f;
+    double origin = 0.0;
+    std::int64_t nextBoundary = 1;      // first boundary not yet dispatched
+    std::uint32_t cacheGeneration = 0;  // bumped whenever the cache is thrown away
+    std::array<Slot, cacheDepth> slots;
+
+    std::atomic<bool> running { false };
+    std::atomic<float> fillActivity { 0.0f };
+    std::atomic<int> cacheMisses { 0 };
+    juce::WaitableEvent wakeUp;
+
+    // Generator thread only
+    AIMidiGenerator generator;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FillScheduler)
+};
@@ -1,4 +1,5 @@
 #include "GrooveShaper.h"
+#include "FastMath.h"
 
 GrooveShaper::GrooveShaper() : random(juce::Time::currentTimeMillis())
 {
@@ -221,7 +222,7 @@ float GrooveShaper::getBeatPosition(double timeInSeconds, float tempo, float tim
 {
     double beatsPerSecond = tempo / 60.0;
     double totalBeats = timeInSeconds * beatsPerSecond;
-    return static_cast<float>(std::fmod(totalBeats, timeSignature));
+    return static_cast<float>(FastMath::wrap(totalBeats, static_cast<double>(timeSignature)));
 }
 
 bool GrooveShaper::isOnBeat(float beatPosition, float tolerance)
@@ -236,7 +237,7 @@ bool GrooveShaper::isOffBeat(float beatPosition, float tolerance)
 
 bool GrooveShaper::isStrongBeat(float beatPosition, float timeSignature)
 {
-    float beatInMeasure = std::fmod(beatPosition, timeSignature);
+    float beatInMeasure = FastMath::wrap(beatPosition, timeSignature);
     return beatInMeasure < 0.1f || std::abs(beatInMeasure - 2.0f) < 0.1f; // Beat 1 and 3
 }
 
@@ -244,7 +245,7 @@ float GrooveShaper::generateHumanTimingOffset(float baseOffset, float humanizati
 {
     // Use a more sophisticated humanization algorithm
     float randomVariation = (random.nextFloat() - 0.5f) * 2.0f;
-    float humanFactor = std::sin(baseOffset * juce::MathConstants<float>::pi) * 0.1f;
+    float humanFactor = FastMath::sin2Pi(baseOffset * 0.5f) * 0.1f;
     return (randomVariation + humanFactor) * humanization * 0.05f;
 }
 
@@ -252,7 +253,7 @@ float GrooveShaper::generateVelocityVariation(float baseVelocity, float variatio
 {
     // More musical velocity variation
     float randomVariation = (random.nextFloat() - 0.5f) * 2.0f;
-    float musicalFactor = std::sin(baseVelocity / 127.0f * juce::MathConstants<float>::pi) * 0.2f;
+    float musicalFactor = FastMath::sin2Pi(baseVelocity / 254.0f) * 0.2f;
     return baseVelocity * (1.0f + (randomVariation + musicalFactor) * variation * 0.2f);
 }
 
@@ -49,6 +49,9 @@ public:
     void setHumanizationAmount(float amount) { humanizationAmount = juce::jlimit(0.0f, 1.0f, amount); }
     void setSwingAmount(float amount) { swingAmount = juce::jlimit(0.0f, 1.0f, amount); }
     
+    // Humanization is seeded from the clock; a fixed seed makes it repeatable for datasets
+    void setRandomSeed(juce::int64 seed) { random.setSeed(seed); }
+    
     // Preset management
     void loadGroovePreset(const std::string& presetName);
     void saveGroovePreset(const std::string& presetName, const GrooveProfile& profile);
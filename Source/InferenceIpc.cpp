@@ -0,0 +1,527 @@
+#include "InferenceIpc.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#if JUCE_LINUX
+ #include <fcntl.h>
+ #include <linux/futex.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <sys/syscall.h>
+ #include <unistd.h>
+ #include <ctime>
+#endif
+
+namespace InferenceIpc
+{
+    constexpr std::uint32_t layoutVersion = 1;
+    constexpr std::uint32_t ringSize = 256; // a power of two, larger than maxClients so a push never finds it full
+    constexpr std::uint32_t ringMask = ringSize - 1;
+
+    using Word = std::atomic<std::uint32_t>;
+
+    enum SlotState : std::uint32_t
+    {
+        Idle = 0,
+        Submitted = 1,  // features written and the slot queued on the ring
+        Done = 2        // status and probabilities written
+    };
+
+    struct alignas(64) Header
+    {
+        Word layoutVersion;
+        Word serverEpoch;       // bumped by every server that starts, so two can't take over at once
+        Word serverRunning;
+        Word heartbeatMs;       // juce::Time::getMillisecondCounter() of the server's last pass
+        Word requestCount;      // futex word the server sleeps on; bumped by every submit
+        Word serverSleeping;    // set while the server may be asleep, so busy clients skip the wake call
+        Word ringHead;          // next position a client claims
+    };
+
+    struct Cell
+    {
+        Word sequence;          // equals the position when free to write, position + 1 once it holds a request
+        Word slot;
+    };
+
+    struct alignas(64) Slot
+    {
+        Word owner;             // client token, 0 when free
+        Word leaseMs;           // refreshed by the owner on every request
+        Word state;             // futex word the client sleeps on
+        Word clientWaiting;
+        Word succeeded;
+        std::array<Word, numFeatures> features;
+        std::array<Word, numMoods> probabilities;
+    };
+
+    struct Region
+    {
+        Header header;
+        std::array<Cell, ringSize> ring;
+        std::array<Slot, maxClients> slots;
+    };
+
+    static_assert(ringSize > static_cast<std::uint32_t>(maxClients), "each client has at most one request queued");
+    static_assert(Word::is_always_lock_free && sizeof(Word) == sizeof(std::uint32_t),
+                  "the region is shared between processes, so its atomics must be plain lock-free words");
+}
+
+namespace
+{
+    using namespace InferenceIpc;
+
+    const char* const regionName = "/aamati-inference-v1";
+
+    constexpr std::uint32_t serverTimeoutMs = 1000;  // heartbeats older than this mean the daemon is gone
+    constexpr std::uint32_t leaseTimeoutMs = 10000;  // idle slots are handed back after this
+    constexpr std::uint32_t leaseCheckMs = 1000;
+    constexpr int spinsBeforeSleeping = 200;         // most answers come back within these
+
+    std::uint32_t nowMs()
+    {
+        return juce::Time::getMillisecondCounter();
+    }
+
+    std::uint32_t toBits(float value)
+    {
+        std::uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    float fromBits(std::uint32_t bits)
+    {
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+#if JUCE_LINUX
+    Region* mapRegion(bool create)
+    {
+        // Owner-only permissions: only processes of the same user can submit requests
+        const int fd = shm_open(regionName, O_RDWR | (create ? O_CREAT : 0), 0600);
+        if (fd < 0)
+            return nullptr;
+
+        struct stat info {};
+        bool sized = fstat(fd, &info) == 0 && info.st_size >= static_cast<off_t>(sizeof(Region));
+        if (!sized && create)
+            sized = ftruncate(fd, static_cast<off_t>(sizeof(Region))) == 0; // new pages read as zero
+
+        void* memory = sized ? mmap(nullptr, sizeof(Region), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+        close(fd);
+        return memory != MAP_FAILED ? static_cast<Region*>(memory) : nullptr;
+    }
+
+    void unmapRegion(Region* region)
+    {
+        munmap(region, sizeof(Region));
+    }
+
+    // Shared (not process-private) futexes, since waiter and waker live in different processes
+    void futexWait(Word& word, std::uint32_t expected, std::int64_t timeoutUs)
+    {
+        timespec timeout {};
+        timeout.tv_sec = static_cast<time_t>(timeoutUs / 1000000);
+        timeout.tv_nsec = static_cast<long>((timeoutUs % 1000000) * 1000);
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+    }
+
+    void futexWake(Word& word)
+    {
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+    }
+#else
+    Region* mapRegion(bool) { return nullptr; }
+    void unmapRegion(Region*) {}
+    void futexWait(Word&, std::uint32_t, std::int64_t) { std::this_thread::yield(); }
+    void futexWake(Word&) {}
+#endif
+
+    bool isServerAlive(const Region& region)
+    {
+        return region.header.layoutVersion.load(std::memory_order_acquire) == layoutVersion
+            && region.header.serverRunning.load(std::memory_order_acquire) != 0
+            && nowMs() - region.header.heartbeatMs.load(std::memory_order_relaxed) < serverTimeoutMs;
+    }
+
+    template <typename Clock>
+    bool waitForAnswer(Slot& request, typename Clock::time_point deadline)
+    {
+        for (int spin = 0; spin < spinsBeforeSleeping; ++spin)
+            if (request.state.load(std::memory_order_acquire) != Submitted)
+                return true;
+
+        for (;;)
+        {
+            if (request.state.load(std::memory_order_acquire) != Submitted)
+                return true;
+
+            const auto remainingUs = std::chrono::duration_cast<std::chrono::microseconds>(deadline - Clock::now()).count();
+            if (remainingUs <= 0)
+                return false;
+
+            // The server reads clientWaiting after publishing the answer, so one of the two always sees the other
+            request.clientWaiting.store(1);
+            if (request.state.load() == Submitted)
+                futexWait(request.state, Submitted, remainingUs);
+            request.clientWaiting.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+//==============================================================================
+InferenceClient::InferenceClient()
+{
+    while (token == 0)
+        token = static_cast<std::uint32_t>(juce::Random::getSystemRandom().nextInt());
+}
+
+InferenceClient::~InferenceClient()
+{
+    disconnect();
+    if (region != nullptr)
+        unmapRegion(region);
+}
+
+bool InferenceClient::connect()
+{
+    if (isConnected())
+        return true;
+
+    if (region == nullptr)
+        region = mapRegion(false);
+
+    return region != nullptr && ::isServerAlive(*region) && claimSlot();
+}
+
+void InferenceClient::disconnect()
+{
+    // The mapping stays until destruction, so this is safe from the audio thread
+    if (region != nullptr && slot >= 0)
+    {
+        auto owner = token;
+        region->slots[static_cast<size_t>(slot)].owner.compare_exchange_strong(owner, 0);
+    }
+    slot = -1;
+}
+
+bool InferenceClient::isServerAlive() const
+{
+    return region != nullptr && ::isServerAlive(*region);
+}
+
+bool InferenceClient::claimSlot()
+{
+    for (int i = 0; i < InferenceIpc::maxClients; ++i)
+    {
+        auto& candidate = region->slots[static_cast<size_t>(i)];
+        if (candidate.owner.load(std::memory_order_relaxed) != 0)
+            continue;
+
+        // Leased before it is claimed, so the server can't mistake the fresh claim for an expired one
+        std::uint32_t free = 0;
+        candidate.leaseMs.store(nowMs(), std::memory_order_relaxed);
+        if (candidate.owner.compare_exchange_strong(free, token))
+        {
+            candidate.state.store(InferenceIpc::Idle);
+            slot = i;
+            return true;
+        }
+    }
+
+    slot = -1;
+    return false;
+}
+
+bool InferenceClient::renewSlot()
+{
+    // A slot left idle past its lease goes back to the pool; take another
+    auto& request = region->slots[static_cast<size_t>(slot)];
+    request.leaseMs.store(nowMs(), std::memory_order_relaxed);
+    if (request.owner.load() == token)
+        return true;
+
+    awaitingAnswer = false;
+    return claimSlot();
+}
+
+bool InferenceClient::push(const InferenceIpc::Features& features)
+{
+    using namespace InferenceIpc;
+
+    auto& request = region->slots[static_cast<size_t>(slot)];
+    for (int i = 0; i < numFeatures; ++i)
+        request.features[static_cast<size_t>(i)].store(toBits(features[static_cast<size_t>(i)]), std::memory_order_relaxed);
+    request.state.store(Submitted);
+
+    // Claim a ring position, then fill it; the server reads a cell only once its sequence says it is full
+    auto& header = region->header;
+    auto position = header.ringHead.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        auto& cell = region->ring[position & ringMask];
+        const auto sequence = cell.sequence.load(std::memory_order_acquire);
+        const auto difference = static_cast<std::int32_t>(sequence - position);
+        if (difference == 0)
+        {
+            if (header.ringHead.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                cell.slot.store(static_cast<std::uint32_t>(slot), std::memory_order_relaxed);
+                cell.sequence.store(position + 1, std::memory_order_release);
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            request.state.store(Idle);
+            return false;
+        }
+        else
+        {
+            position = header.ringHead.load(std::memory_order_relaxed);
+        }
+    }
+
+    // The server reads requestCount before it sleeps, so either it sees this bump or we see it sleeping
+    header.requestCount.fetch_add(1);
+    if (header.serverSleeping.load() != 0)
+        futexWake(header.requestCount);
+    return true;
+}
+
+bool InferenceClient::readAnswer(InferenceIpc::Probabilities& probabilities)
+{
+    using namespace InferenceIpc;
+
+    auto& request = region->slots[static_cast<size_t>(slot)];
+    for (int i = 0; i < numMoods; ++i)
+        probabilities[static_cast<size_t>(i)] = fromBits(request.probabilities[static_cast<size_t>(i)].load(std::memory_order_relaxed));
+    return request.succeeded.load(std::memory_order_relaxed) != 0;
+}
+
+bool InferenceClient::submit(const InferenceIpc::Features& features)
+{
+    if (!isConnected() || !isServerAlive() || !renewSlot())
+        return false;
+
+    // The previous row, collected or not, holds the slot until the daemon has answered it
+    if (region->slots[static_cast<size_t>(slot)].state.load(std::memory_order_acquire) == InferenceIpc::Submitted)
+        return false;
+
+    awaitingAnswer = push(features);
+    return awaitingAnswer;
+}
+
+InferenceClient::Answer InferenceClient::collect(InferenceIpc::Probabilities& probabilities)
+{
+    if (!awaitingAnswer || !isConnected())
+        return Answer::None;
+
+    const auto state = region->slots[static_cast<size_t>(slot)].state.load(std::memory_order_acquire);
+    if (state == InferenceIpc::Submitted)
+        return Answer::Waiting;
+
+    // Anything but Done means the slot was handed back and claimed afresh
+    awaitingAnswer = false;
+    return state == InferenceIpc::Done && readAnswer(probabilities) ? Answer::Ready : Answer::Failed;
+}
+
+bool InferenceClient::predict(const InferenceIpc::Features& features, InferenceIpc::Probabilities& probabilities,
+                              int timeoutMs)
+{
+    using Clock = std::chrono::steady_clock;
+
+    if (!isConnected() || !isServerAlive() || !renewSlot())
+        return false;
+
+    // Whatever was submitted without waiting is abandoned
+    awaitingAnswer = false;
+    auto& request = region->slots[static_cast<size_t>(slot)];
+    const auto deadline = Clock::now() + std::chrono::milliseconds(juce::jmax(0, timeoutMs));
+
+    // An abandoned request may still be in flight; its answer is of no use now, but the slot is busy until it comes
+    if (request.state.load(std::memory_order_acquire) == InferenceIpc::Submitted && !waitForAnswer<Clock>(request, deadline))
+        return false;
+
+    if (!push(features) || !waitForAnswer<Clock>(request, deadline))
+        return false;
+
+    return readAnswer(probabilities);
+}
+
+//==============================================================================
+InferenceServer::InferenceServer() = default;
+
+InferenceServer::~InferenceServer()
+{
+    stop();
+}
+
+bool InferenceServer::start()
+{
+    using namespace InferenceIpc;
+
+    if (region != nullptr)
+        return true;
+
+    region = mapRegion(true);
+    if (region == nullptr)
+        return false;
+
+    auto& header = region->header;
+    auto epoch = header.serverEpoch.load();
+    if (::isServerAlive(*region) || !header.serverEpoch.compare_exchange_strong(epoch, epoch + 1))
+    {
+        unmapRegion(region);
+        region = nullptr;
+        return false;
+    }
+
+    // Take over from whatever was here before: an empty ring, and requests still in flight answered as failed
+    header.serverRunning.store(0);
+    header.ringHead.store(0);
+    for (std::uint32_t i = 0; i < ringSize; ++i)
+        region->ring[i].sequence.store(i, std::memory_order_relaxed);
+    tail = 0;
+
+    for (auto& request : region->slots)
+    {
+        if (request.state.load() == Submitted)
+        {
+            request.succeeded.store(0, std::memory_order_relaxed);
+            request.state.store(Done);
+            futexWake(request.state);
+        }
+    }
+
+    stats = {};
+    lastLeaseCheckMs = nowMs();
+    header.heartbeatMs.store(nowMs());
+    header.layoutVersion.store(layoutVersion);
+    header.serverRunning.store(1);
+    return true;
+}
+
+void InferenceServer::stop()
+{
+    if (region == nullptr)
+        return;
+
+    region->header.serverRunning.store(0);
+    unmapRegion(region);
+    region = nullptr;
+}
+
+bool InferenceServer::hasRequest() const
+{
+    const auto& cell = region->ring[tail & InferenceIpc::ringMask];
+    return cell.sequence.load(std::memory_order_acquire) == tail + 1;
+}
+
+bool InferenceServer::popRequest(int& slotIndex)
+{
+    if (!hasRequest())
+        return false;
+
+    auto& cell = region->ring[tail & InferenceIpc::ringMask];
+    slotIndex = static_cast<int>(cell.slot.load(std::memory_order_relaxed));
+    cell.sequence.store(tail + InferenceIpc::ringSize, std::memory_order_release);
+    ++tail;
+    return slotIndex >= 0 && slotIndex < InferenceIpc::maxClients;
+}
+
+void InferenceServer::releaseExpiredSlots()
+{
+    const auto now = nowMs();
+    if (now - lastLeaseCheckMs < leaseCheckMs)
+        return;
+    lastLeaseCheckMs = now;
+
+    // Tokens, not process ids, mark ownership: sandboxed hosts may each see their own pid namespace
+    int connected = 0;
+    for (auto& request : region->slots)
+    {
+        auto owner = request.owner.load();
+        if (owner == 0)
+            continue;
+
+        if (request.state.load() != InferenceIpc::Submitted
+            && now - request.leaseMs.load(std::memory_order_relaxed) > leaseTimeoutMs)
+            request.owner.compare_exchange_strong(owner, 0);
+        else
+            ++connected;
+    }
+    stats.connectedClients = connected;
+}
+
+void InferenceServer::waitForRequests(int timeoutMs)
+{
+    auto& header = region->header;
+    const auto count = header.requestCount.load();
+    header.serverSleeping.store(1);
+    if (!hasRequest())
+        futexWait(header.requestCount, count, static_cast<std::int64_t>(timeoutMs) * 1000);
+    header.serverSleeping.store(0, std::memory_order_relaxed);
+}
+
+void InferenceServer::serve(const BatchFunction& infer, const std::function<bool()>& shouldStop, int pollMs)
+{
+    using namespace InferenceIpc;
+
+    std::array<float, maxBatch * numFeatures> batchFeatures {};
+    std::array<float, maxBatch * numMoods> batchProbabilities {};
+    std::array<int, maxBatch> batchSlots {};
+
+    while (region != nullptr && !shouldStop())
+    {
+        region->header.heartbeatMs.store(nowMs(), std::memory_order_relaxed);
+        releaseExpiredSlots();
+
+        // Whatever queued up while the last batch ran goes into the next one
+        int numRows = 0;
+        int index = 0;
+        while (numRows < maxBatch && popRequest(index))
+        {
+            auto& request = region->slots[static_cast<size_t>(index)];
+            if (request.state.load(std::memory_order_acquire) != Submitted)
+                continue;
+
+            for (int i = 0; i < numFeatures; ++i)
+                batchFeatures[static_cast<size_t>(numRows * numFeatures + i)] =
+                    fromBits(request.features[static_cast<size_t>(i)].load(std::memory_order_relaxed));
+            batchSlots[static_cast<size_t>(numRows++)] = index;
+        }
+
+        if (numRows == 0)
+        {
+            waitForRequests(pollMs);
+            continue;
+        }
+
+        const bool succeeded = infer(batchFeatures.data(), numRows, batchProbabilities.data());
+        ++stats.batches;
+        stats.requests += static_cast<std::uint64_t>(numRows);
+        stats.largestBatch = juce::jmax(stats.largestBatch, numRows);
+        if (!succeeded)
+            ++stats.failedBatches;
+
+        for (int row = 0; row < numRows; ++row)
+        {
+            auto& request = region->slots[static_cast<size_t>(batchSlots[static_cast<size_t>(row)])];
+            for (int i = 0; i < numMoods; ++i)
+                request.probabilities[static_cast<size_t>(i)].store(
+                    toBits(succeeded ? batchProbabilities[static_cast<size_t>(row * numMoods + i)] : 0.0f),
+                    std::memory_order_relaxed);
+            request.succeeded.store(succeeded ? 1 : 0, std::memory_order_relaxed);
+
+            request.state.store(Done);
+            if (request.clientWaiting.load() != 0)
+                futexWake(request.state);
+        }
+    }
+}
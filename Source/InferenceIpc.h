@@ -0,0 +1,131 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <cstdint>
+#include <functional>
+
+/**
+ * Inference IPC
+ * Lets plugin instances in any number of processes share one model session,
+ * hosted by the inference daemon (Tools/InferenceDaemon.cpp), so that each
+ * sandboxed process doesn't load ONNX Runtime itself. Everything lives in one
+ * POSIX shared-memory region. Each client owns a request slot. Submitting
+ * writes the features into the slot and pushes its index onto a bounded
+ * multi-producer ring. The server drains the ring in batches, runs one
+ * inference per batch, writes the probabilities back and wakes the waiting
+ * clients. Wakeups are futexes on words in the region, so neither side makes
+ * a system call while the other is busy. The daemon path is Linux only.
+ * Elsewhere connect() always fails and callers predict in process.
+ */
+namespace InferenceIpc
+{
+    constexpr int numFeatures = 5;
+    constexpr int numMoods = 10;
+    constexpr int maxClients = 128;
+    constexpr int maxBatch = 64;
+
+    using Features = std::array<float, numFeatures>;
+    using Probabilities = std::array<float, numMoods>;
+
+    struct Region;
+}
+
+/**
+ * Inference Client
+ * One plugin instance's connection to the daemon. submit() and collect() are
+ * meant for the audio thread: neither allocates nor waits, and a row's answer
+ * is picked up on a later call once the daemon has written it. predict() is
+ * the blocking form for tools. It waits at most its timeout, and a request
+ * that times out is abandoned, its late answer discarded.
+ */
+class InferenceClient
+{
+public:
+    InferenceClient();
+    ~InferenceClient();
+
+    // Maps the region and claims a slot; false if no daemon is running or every slot is taken
+    bool connect();
+    void disconnect();
+    bool isConnected() const { return region != nullptr && slot >= 0; }
+
+    // False once the daemon has missed its heartbeat for a second
+    bool isServerAlive() const;
+
+    enum class Answer
+    {
+        None,    // nothing submitted since the last answer
+        Waiting, // the daemon hasn't answered yet
+        Ready,
+        Failed   // the daemon's batch failed, or the slot was lost
+    };
+
+    // Queues one row without waiting. False while the previous row is unanswered, or on a full ring or a lost daemon.
+    bool submit(const InferenceIpc::Features& features);
+
+    // The state of the row last submitted, without waiting; Ready fills the probabilities and clears it
+    Answer collect(InferenceIpc::Probabilities& probabilities);
+
+    // Submits one row and waits for its probabilities. False on timeout, a full ring or a lost daemon.
+    bool predict(const InferenceIpc::Features& features, InferenceIpc::Probabilities& probabilities, int timeoutMs);
+
+private:
+    bool claimSlot();
+    bool renewSlot();
+    bool push(const InferenceIpc::Features& features);
+    bool readAnswer(InferenceIpc::Probabilities& probabilities);
+
+    InferenceIpc::Region* region = nullptr;
+    int slot = -1;
+    std::uint32_t token = 0; // marks our slot as ours; never 0
+    bool awaitingAnswer = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(InferenceClient)
+};
+
+/**
+ * Inference Server
+ * The daemon's side: serves batches to a caller-supplied inference function.
+ * Only one server can run on a machine at a time.
+ */
+class InferenceServer
+{
+public:
+    // Reads numRows * numFeatures floats and writes numRows * numMoods; false fails the whole batch
+    using BatchFunction = std::function<bool(const float* features, int numRows, float* probabilities)>;
+
+    struct Stats
+    {
+        std::uint64_t requests = 0;
+        std::uint64_t batches = 0;
+        std::uint64_t failedBatches = 0;
+        int largestBatch = 0;
+        int connectedClients = 0;
+    };
+
+    InferenceServer();
+    ~InferenceServer();
+
+    // Creates or takes over the region; false if another server is alive or shared memory is unavailable
+    bool start();
+    void stop();
+
+    // Serves until shouldStop() returns true. It is asked at least every pollMs while idle.
+    void serve(const BatchFunction& infer, const std::function<bool()>& shouldStop, int pollMs = 100);
+
+    Stats getStats() const { return stats; }
+
+private:
+    bool popRequest(int& slotIndex);
+    bool hasRequest() const;
+    void releaseExpiredSlots();
+    void waitForRequests(int timeoutMs);
+
+    InferenceIpc::Region* region = nullptr;
+    std::uint32_t tail = 0;
+    std::uint32_t lastLeaseCheckMs = 0;
+    Stats stats;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(InferenceServer)
+};
@@ -0,0 +1,161 @@
+#include "MemoryLedger.h"
+
+#include <cstdio>
+
+MemoryLedger::MemoryLedger()
+    : MemoryLedger(&getProcessLedger())
+{
+}
+
+MemoryLedger::MemoryLedger(MemoryLedger* parentLedger)
+    : parent(parentLedger)
+{
+}
+
+MemoryLedger::~MemoryLedger()
+{
+    // Hand back anything still charged so the process totals stay correct
+    if (parent != nullptr)
+    {
+        for (size_t i = 0; i < numSubsystems; ++i)
+        {
+            size_t live = counters[i].live.load();
+            if (live > 0)
+                parent->released(static_cast<Subsystem>(i), live);
+        }
+    }
+}
+
+MemoryLedger& MemoryLedger::getProcessLedger()
+{
+    static MemoryLedger processLedger(nullptr);
+    return processLedger;
+}
+
+void MemoryLedger::allocated(Subsystem subsystem, size_t bytes)
+{
+    auto& counter = counters[static_cast<size_t>(subsystem)];
+    size_t live = counter.live.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+
+    size_t peak = counter.peak.load(std::memory_order_relaxed);
+    while (live > peak && !counter.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+    {
+    }
+
+    if (parent != nullptr)
+        parent->allocated(subsystem, bytes);
+}
+
+void MemoryLedger::released(Subsystem subsystem, size_t bytes)
+{
+    auto& counter = counters[static_cast<size_t>(subsystem)];
+
+    // Clamp at zero rather than wrapping if a charge is released twice
+    size_t live = counter.live.load(std::memory_order_relaxed);
+    size_t updated;
+    do
+    {
+        updated = live > bytes ? live - bytes : 0;
+    } while (!counter.live.compare_exchange_weak(live, updated, std::memory_order_relaxed));
+
+    if (parent != nullptr)
+        parent->released(subsystem, bytes);
+}
+
+MemoryLedger::Usage MemoryLedger::getUsage(Subsystem subsystem) const
+{
+    const auto& counter = counters[static_cast<size_t>(subsystem)];
+    return { counter.live.load(std::memory_order_relaxed), counter.peak.load(std::memory_order_relaxed) };
+}
+
+size_t MemoryLedger::getTotalLiveBytes() const
+{
+    size_t total = 0;
+    for (const auto& counter : counters)
+        total += counter.live.load(std::memory_order_relaxed);
+    return total;
+}
+
+size_t MemoryLedger::getTotalPeakBytes() const
+{
+    // Sum of per-subsystem peaks: an upper bound, since peaks needn't coincide
+    size_t total = 0;
+    for (const auto& counter : counters)
+        total += counter.peak.load(std::memory_order_relaxed);
+    return total;
+}
+
+void MemoryLedger::resetPeaks()
+{
+    for (auto& counter : counters)
+        counter.peak.store(counter.live.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+bool MemoryLedger::isOverBudget() const
+{
+    size_t budget = getBudget();
+    return budget > 0 && getTotalLiveBytes() > budget;
+}
+
+std::string MemoryLedger::describe() const
+{
+    std::string text;
+    for (size_t i = 0; i < numSubsystems; ++i)
+    {
+        auto usage = getUsage(static_cast<Subsystem>(i));
+        text += getSubsystemName(static_cast<Subsystem>(i));
+        text += ": " + formatBytes(usage.liveBytes) + " (peak " + formatBytes(usage.peakBytes) + ")\n";
+    }
+
+    text += "total: " + formatBytes(getTotalLiveBytes());
+    if (getBudget() > 0)
+        text += " of " + formatBytes(getBudget()) + " budget";
+    return text;
+}
+
+const char* MemoryLedger::getSubsystemName(Subsystem subsystem)
+{
+    switch (subsystem)
+    {
+        case Subsystem::AudioHistory:   return "audio history";
+        case Subsystem::Inference:      return "inference";
+        case Subsystem::PatternLibrary: return "pattern library";
+        case Subsystem::Caches:         return "caches";
+        case Subsystem::UserInterface:  return "user interface";
+        default:                        return "unknown";
+    }
+}
+
+std::string MemoryLedger::formatBytes(size_t bytes)
+{
+    char buffer[32];
+    if (bytes >= 1024 * 1024)
+        std::snprintf(buffer, sizeof(buffer), "%.1f MB", static_cast<double>(bytes) / (1024.0 * 1024.0));
+    else if (bytes >= 1024)
+        std::snprintf(buffer, sizeof(buffer), "%.1f KB", static_cast<double>(bytes) / 1024.0);
+    else
+        std::snprintf(buffer, sizeof(buffer), "%zu B", bytes);
+    return buffer;
+}
+
+//==============================================================================
+void MemoryLedger::Charge::attach(MemoryLedger* newLedger, Subsystem newSubsystem)
+{
+    size_t current = bytes;
+    setBytes(0);
+    ledger = newLedger;
+    subsystem = newSubsystem;
+    setBytes(current);
+}
+
+void MemoryLedger::Charge::setBytes(size_t newBytes)
+{
+    if (ledger != nullptr)
+    {
+        if (newBytes > bytes)
+            ledger->allocated(subsystem, newBytes - bytes);
+        else if (newBytes < bytes)
+            ledger->released(subsystem, bytes - newBytes);
+    }
+    bytes = newBytes;
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Memory Ledger
+ * Per-instance accounting of live and peak bytes, tagged by subsystem.
+ * Containers that own bulk memory use TrackedAllocator so every allocation is
+ * counted; memory owned by third-party code (ONNX sessions, JUCE components)
+ * is charged explicitly through MemoryLedger::Charge. Every instance ledger
+ * also feeds a process-wide ledger so many instances can be summed.
+ */
+class MemoryLedger
+{
+public:
+    enum class Subsystem
+    {
+        AudioHistory,
+        Inference,
+        PatternLibrary,
+        Caches,
+        UserInterface,
+        NumSubsystems
+    };
+
+    static constexpr size_t numSubsystems = static_cast<size_t>(Subsystem::NumSubsystems);
+
+    struct Usage
+    {
+        size_t liveBytes = 0;
+        size_t peakBytes = 0;
+    };
+
+    /**
+     * Explicit charge for memory the ledger can't see being allocated.
+     * Re-setting the size adjusts the ledger by the difference and the charge
+     * is released when this object is destroyed.
+     */
+    class Charge
+    {
+    public:
+        Charge() = default;
+        Charge(MemoryLedger* ledger, Subsystem subsystem) : ledger(ledger), subsystem(subsystem) {}
+        ~Charge() { setBytes(0); }
+
+        void attach(MemoryLedger* newLedger, Subsystem newSubsystem);
+        void setBytes(size_t newBytes);
+        size_t getBytes() const { return bytes; }
+
+    private:
+        MemoryLedger* ledger = nullptr;
+        Subsystem subsystem = Subsystem::Caches;
+        size_t bytes = 0;
+
+        Charge(const Charge&) = delete;
+        Charge& operator=(const Charge&) = delete;
+    };
+
+    MemoryLedger();
+    ~MemoryLedger();
+
+    void allocated(Subsystem subsystem, size_t bytes);
+    void released(Subsystem subsystem, size_t bytes);
+
+    Usage getUsage(Subsystem subsystem) const;
+    size_t getTotalLiveBytes() const;
+    size_t getTotalPeakBytes() const;
+    void resetPeaks();
+
+    // Per-instance budget for the low-memory profile
+    void setBudget(size_t bytes) { budgetBytes.store(bytes); }
+    size_t getBudget() const { return budgetBytes.load(); }
+    bool isOverBudget() const;
+
+    // One line per subsystem, e.g. "audio history: 3.4 MB (peak 3.4 MB)"
+    std::string describe() const;
+
+    static const char* getSubsystemName(Subsystem subsystem);
+    static std::string formatBytes(size_t bytes);
+
+    // Totals across every instance in this process
+    static MemoryLedger& getProcessLedger();
+
+private:
+    struct Counter
+    {
+        std::atomic<size_t> live { 0 };
+        std::atomic<size_t> peak { 0 };
+    };
+
+    explicit MemoryLedger(MemoryLedger* parent);
+
+    std::array<Counter, numSubsystems> counters;
+    std::atomic<size_t> budgetBytes { 0 };
+    MemoryLedger* parent = nullptr;
+
+    MemoryLedger(const MemoryLedger&) = delete;
+    MemoryLedger& operator=(const MemoryLedger&) = delete;
+};
+
+/**
+ * Standard allocator that reports to a MemoryLedger under one subsystem tag.
+ * A default-constructed allocator (no ledger) behaves like std::allocator.
+ */
+template <typename T>
+class TrackedAllocator
+{
+public:
+    using value_type = T;
+
+    TrackedAllocator() noexcept = default;
+    TrackedAllocator(MemoryLedger* ledger, MemoryLedger::Subsystem subsystem) noexcept
+        : ledger(ledger), subsystem(subsystem) {}
+
+    template <typename U>
+    TrackedAllocator(const TrackedAllocator<U>& other) noexcept
+        : ledger(other.getLedger()), subsystem(other.getSubsystem()) {}
+
+    T* allocate(size_t count)
+    {
+        T* pointer = std::allocator<T>().allocate(count);
+        if (ledger != nullptr)
+            ledger->allocated(subsystem, count * sizeof(T));
+        return pointer;
+    }
+
+    void deallocate(T* pointer, size_t count) noexcept
+    {
+        if (ledger != nullptr)
+            ledger->released(subsystem, count * sizeof(T));
+        std::allocator<T>().deallocate(pointer, count);
+    }
+
+    MemoryLedger* getLedger() const noexcept { return ledger; }
+    MemoryLedger::Subsystem getSubsystem() const noexcept { return subsystem; }
+
+    // Assignment adopts the source allocator, so bytes are always released to the ledger that counted them
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+private:
+    MemoryLedger* ledger = nullptr;
+    MemoryLedger::Subsystem subsystem = MemoryLedger::Subsystem::Caches;
+};
+
+template <typename T, typename U>
+bool operator==(const TrackedAllocator<T>& a, const TrackedAllocator<U>& b) noexcept
+{
+    return a.getLedger() == b.getLedger() && a.getSubsystem() == b.getSubsystem();
+}
+
+template <typename T, typename U>
+bool operator!=(const TrackedAllocator<T>& a, const TrackedAllocator<U>& b) noexcept
+{
+    return !(a == b);
+}
+
+template <typename T>
+using TrackedVector = std::vector<T, TrackedAllocator<T>>;
@@ -0,0 +1,454 @@
+#include "MidiCompliance.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+#include <vector>
+
+namespace
+{
+    constexpr std::uint8_t metaStatus = 0xff;
+    constexpr std::uint8_t endOfTrackType = 0x2f;
+    constexpr std::uint8_t endOfTrackEvent[] = {0xff, 0x2f, 0x00};
+
+    // The meta events mido calls set_tempo, time_signature and key_signature
+    bool belongsInTrackZero(std::uint8_t metaType)
+    {
+        return metaType == 0x51 || metaType == 0x58 || metaType == 0x59;
+    }
+
+    std::uint32_t readBigEndian32(const std::uint8_t* bytes)
+    {
+        return (static_cast<std::uint32_t>(bytes[0]) << 24) | (static_cast<std::uint32_t>(bytes[1]) << 16)
+             | (static_cast<std::uint32_t>(bytes[2]) << 8) | static_cast<std::uint32_t>(bytes[3]);
+    }
+
+    // SMF variable-length quantities are at most four bytes
+    bool readVariableLength(const std::uint8_t*& p, const std::uint8_t* end, std::uint32_t& value)
+    {
+        value = 0;
+        for (int i = 0; i < 4 && p < end; ++i)
+        {
+            const auto byte = *p++;
+            value = (value << 7) | (byte & 0x7fu);
+            if ((byte & 0x80u) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    void writeVariableLength(std::vector<std::uint8_t>& out, std::uint32_t value)
+    {
+        std::uint8_t bytes[5];
+        int count = 0;
+        do
+        {
+            bytes[count++] = static_cast<std::uint8_t>(value & 0x7fu);
+            value >>= 7;
+        } while (value != 0 && count < 5);
+
+        while (count-- > 0)
+            out.push_back(static_cast<std::uint8_t>(bytes[count] | (count > 0 ? 0x80u : 0u)));
+    }
+
+    struct Chunk
+    {
+        const std::uint8_t* header; // the 8-byte id and length
+        const std::uint8_t* body;
+        std::uint32_t length;
+        bool isTrack;
+    };
+
+    struct Event
+    {
+        std::uint64_t tick;        // absolute
+        const std::uint8_t* bytes; // after the delta time; starts at the status byte unless runningStatus
+        std::size_t size;
+        std::uint8_t status;       // with running status resolved
+        bool runningStatus;
+
+        bool isMeta() const { return status == metaStatus; }
+        std::uint8_t metaType() const { return bytes[1]; }
+
+        bool isMovable() const { return isMeta() && belongsInTrackZero(metaType()); }
+
+        bool sameAs(const Event& other) const
+        {
+            return tick == other.tick && size == other.size && std::memcmp(bytes, other.bytes, size) == 0;
+        }
+    };
+
+    // Calls visit(event) for every event in a track chunk. Running status is allowed to carry
+    // across meta and sysex events, as many writers do. Returns false with a reason on bad data.
+    template <typename Visitor>
+    bool walkTrack(const Chunk& chunk, Visitor&& visit, std::string& error)
+    {
+        const auto* p = chunk.body;
+        const auto* const end = chunk.body + chunk.length;
+        std::uint64_t tick = 0;
+        std::uint8_t runningStatus = 0;
+
+        while (p < end)
+        {
+            std::uint32_t delta = 0;
+            if (!readVariableLength(p, end, delta) || p >= end)
+            {
+                error = "bad delta time";
+                return false;
+            }
+            tick += delta;
+
+            Event event { tick, p, 0, *p, false };
+            if (event.status < 0x80)
+            {
+                if (runningStatus == 0)
+                {
+                    error = "data byte without a status";
+                    return false;
+                }
+                event.status = runningStatus;
+                event.runningStatus = true;
+            }
+            else
+            {
+                ++p;
+            }
+
+            std::uint32_t length = 0;
+            if (event.status == metaStatus)
+            {
+                if (p >= end)
+                {
+                    error = "meta event without a type";
+                    return false;
+                }
+                ++p;
+                if (!readVariableLength(p, end, length))
+                {
+                    error = "bad meta event length";
+                    return false;
+                }
+            }
+            else if (event.status == 0xf0 || event.status == 0xf7)
+            {
+                if (!readVariableLength(p, end, length))
+                {
+                    error = "bad sysex length";
+                    return false;
+                }
+            }
+            else if (event.status > 0xf0)
+            {
+                error = "system message in a track";
+                return false;
+            }
+            else
+            {
+                const auto type = event.status & 0xf0u;
+                length = (type == 0xc0 || type == 0xd0) ? 1 : 2;
+                runningStatus = event.status;
+            }
+
+            if (length > static_cast<std::size_t>(end - p))
+            {
+                error = "event runs past the end of its track";
+                return false;
+            }
+            p += length;
+            event.size = static_cast<std::size_t>(p - event.bytes);
+            visit(event);
+        }
+        return true;
+    }
+
+    // Re-encodes events at their absolute ticks. Running status is only kept where the
+    // previous written event had the same status, so dropped or inserted metas never break it.
+    class TrackWriter
+    {
+    public:
+        explicit TrackWriter(std::vector<std::uint8_t>& destination) : out(destination)
+        {
+            out.clear();
+            out.insert(out.end(), {'M', 'T', 'r', 'k', 0, 0, 0, 0});
+        }
+
+        void write(const Event& event)
+        {
+            const auto tick = std::max(event.tick, lastTick);
+            writeVariableLength(out, static_cast<std::uint32_t>(tick - lastTick));
+            lastTick = tick;
+
+            if (event.runningStatus && event.status != lastStatus)
+                out.push_back(event.status);
+            out.insert(out.end(), event.bytes, event.bytes + event.size);
+            lastStatus = event.status < 0xf0 ? event.status : 0;
+        }
+
+        void finish()
+        {
+            const auto length = static_cast<std::uint32_t>(out.size() - 8);
+            for (int i = 0; i < 4; ++i)
+                out[static_cast<size_t>(4 + i)] = static_cast<std::uint8_t>(length >> (24 - 8 * i));
+        }
+
+        std::uint64_t getLastTick() const { return lastTick; }
+
+    private:
+        std::vector<std::uint8_t>& out;
+        std::uint64_t lastTick = 0;
+        std::uint8_t lastStatus = 0;
+    };
+
+    // A buffered file that is only created on the first write, so clean files never touch the disk
+    class LazyFileBuffer : public std::streambuf
+    {
+    public:
+        explicit LazyFileBuffer(std::filesystem::path pathToUse) : path(std::move(pathToUse)) {}
+
+        bool close()
+        {
+            if (!file.is_open())
+                return true;
+            file.close();
+            return !file.fail();
+        }
+
+    protected:
+        std::streamsize xsputn(const char* bytes, std::streamsize count) override
+        {
+            if (!file.is_open())
+                file.open(path, std::ios::binary | std::ios::trunc);
+            return file.write(bytes, count) ? count : 0;
+        }
+
+        int_type overflow(int_type c) override
+        {
+            if (traits_type::eq_int_type(c, traits_type::eof()))
+                return traits_type::not_eof(c);
+            const char byte = traits_type::to_char_type(c);
+            return xsputn(&byte, 1) == 1 ? c : traits_type::eof();
+        }
+
+    private:
+        std::filesystem::path path;
+        std::ofstream file;
+    };
+}
+
+MidiCompliance::Report MidiCompliance::normalize(const std::uint8_t* data, std::size_t size, std::ostream& output)
+{
+    Report report;
+    if (data == nullptr || size < 14 || std::memcmp(data, "MThd", 4) != 0)
+    {
+        report.error = "not a standard MIDI file";
+        return report;
+    }
+
+    const auto headerLength = readBigEndian32(data + 4);
+    if (headerLength < 6 || headerLength > size - 8)
+    {
+        report.error = "bad header chunk";
+        return report;
+    }
+
+    const int format = (data[8] << 8) | data[9];
+    if (format == 2)
+    {
+        report.result = Result::Skipped;
+        return report;
+    }
+
+    // Chunk boundaries only; no event is decoded yet
+    std::vector<Chunk> chunks;
+    for (std::size_t offset = 8 + headerLength; size - offset >= 8;)
+    {
+        const auto* header = data + offset;
+        const auto length = readBigEndian32(header + 4);
+        if (length > size - offset - 8)
+        {
+            report.error = "truncated chunk";
+            return report;
+        }
+        chunks.push_back({ header, header + 8, length, std::memcmp(header, "MTrk", 4) == 0 });
+        offset += 8 + static_cast<std::size_t>(length);
+    }
+
+    const auto firstTrack = std::find_if(chunks.begin(), chunks.end(), [](const Chunk& chunk) { return chunk.isTrack; });
+    if (firstTrack == chunks.end())
+    {
+        report.error = "no track chunks";
+        return report;
+    }
+
+    // The single scan: every later track, looking for events that belong in track 0
+    std::vector<Event> moved;
+    std::vector<bool> affected(chunks.size(), false);
+    for (auto it = firstTrack + 1; it != chunks.end(); ++it)
+    {
+        if (!it->isTrack)
+            continue;
+
+        const auto index = static_cast<size_t>(it - chunks.begin());
+        const bool parsed = walkTrack(*it, [&](const Event& event)
+        {
+            if (event.isMovable())
+            {
+                moved.push_back(event);
+                affected[index] = true;
+            }
+        }, report.error);
+
+        if (!parsed)
+            return report;
+    }
+
+    if (moved.empty())
+    {
+        report.result = Result::Clean;
+        return report;
+    }
+
+    std::vector<Event> trackZero;
+    if (!walkTrack(*firstTrack, [&trackZero](const Event& event) { trackZero.push_back(event); }, report.error))
+        return report;
+
+    // Same tick, same bytes: already there, or moved from two tracks that both carried it
+    std::vector<Event> merged;
+    merged.reserve(moved.size());
+    for (const auto& event : moved)
+    {
+        const auto matches = [&event](const Event& other) { return other.isMovable() && other.sameAs(event); };
+        if (std::any_of(trackZero.begin(), trackZero.end(), matches) || std::any_of(merged.begin(), merged.end(), matches))
+            ++report.duplicatesDropped;
+        else
+            merged.push_back(event);
+    }
+    std::stable_sort(merged.begin(), merged.end(), [](const Event& a, const Event& b) { return a.tick < b.tick; });
+    report.movedEvents = static_cast<int>(merged.size());
+
+    // Moved events go ahead of track 0's own events at the same tick. End of track stays last,
+    // pushed out if a moved event comes after it; anything written after it is dropped.
+    std::vector<std::uint8_t> rewrittenTrackZero;
+    {
+        TrackWriter writer(rewrittenTrackZero);
+        auto next = merged.begin();
+        bool ended = false;
+        for (const auto& event : trackZero)
+        {
+            const bool isEnd = event.isMeta() && event.metaType() == endOfTrackType;
+            for (; next != merged.end() && (isEnd || next->tick <= event.tick); ++next)
+                writer.write(*next);
+            writer.write(event);
+            if (isEnd)
+            {
+                ended = true;
+                break;
+            }
+        }
+
+        for (; next != merged.end(); ++next)
+            writer.write(*next);
+        if (!ended)
+            writer.write({ writer.getLastTick(), endOfTrackEvent, sizeof(endOfTrackEvent), metaStatus, false });
+        writer.finish();
+    }
+
+    // The other tracks the scan marked, minus what moved; removed delta times carry into the next event
+    std::vector<std::vector<std::uint8_t>> rewritten(chunks.size());
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        if (!affected[i])
+            continue;
+
+        TrackWriter writer(rewritten[i]);
+        walkTrack(chunks[i], [&writer](const Event& event)
+        {
+            if (!event.isMovable())
+                writer.write(event);
+        }, report.error);
+        writer.finish();
+    }
+    report.rewrittenTracks = 1 + static_cast<int>(std::count(affected.begin(), affected.end(), true));
+
+    // Header and untouched chunks straight from the input
+    output.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(8 + headerLength));
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        const auto& chunk = chunks[i];
+        const std::vector<std::uint8_t>* replacement = nullptr;
+        if (&chunk == &*firstTrack)
+            replacement = &rewrittenTrackZero;
+        else if (affected[i])
+            replacement = &rewritten[i];
+
+        if (replacement != nullptr)
+            output.write(reinterpret_cast<const char*>(replacement->data()), static_cast<std::streamsize>(replacement->size()));
+        else
+            output.write(reinterpret_cast<const char*>(chunk.header), static_cast<std::streamsize>(8 + chunk.length));
+    }
+
+    if (!output)
+    {
+        report.error = "write failed";
+        return report;
+    }
+
+    report.result = Result::Fixed;
+    return report;
+}
+
+MidiCompliance::Report MidiCompliance::normalizeFile(const std::string& inputPath, const std::string& outputPath)
+{
+    Report report;
+
+    std::vector<std::uint8_t> data;
+    {
+        std::ifstream input(inputPath, std::ios::binary | std::ios::ate);
+        const auto size = input ? static_cast<std::streamoff>(input.tellg()) : -1;
+        if (size < 0)
+        {
+            report.error = "could not read file";
+            return report;
+        }
+        data.resize(static_cast<size_t>(size));
+        input.seekg(0);
+        if (!input.read(reinterpret_cast<char*>(data.data()), size))
+        {
+            report.error = "could not read file";
+            return report;
+        }
+    }
+
+    // Written beside the destination and renamed over it, so a failed write never leaves half a file
+    std::error_code error;
+    const std::filesystem::path destination(outputPath);
+    if (destination.has_parent_path())
+        std::filesystem::create_directories(destination.parent_path(), error);
+    auto temporary = destination;
+    temporary += ".tmp";
+
+    LazyFileBuffer buffer(temporary);
+    std::ostream output(&buffer);
+    report = normalize(data.data(), data.size(), output);
+    if (!buffer.close() && report.result == Result::Fixed)
+    {
+        report.result = Result::Failed;
+        report.error = "write failed";
+    }
+
+    if (report.result != Result::Fixed)
+    {
+        std::filesystem::remove(temporary, error);
+        return report;
+    }
+
+    std::filesystem::rename(temporary, destination, error);
+    if (error)
+    {
+        std::filesystem::remove(temporary, error);
+        report.result = Result::Failed;
+        report.error = "could not replace " + outputPath;
+    }
+    return report;
+}
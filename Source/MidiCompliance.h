@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/**
+ * MIDI Compliance
+ * Moves tempo, time signature and key signature meta events out of later
+ * tracks and into track 0, where the feature extractors and most DAWs expect
+ * them. It replaces fixed_midi_compliance.py. The file is read once and checked
+ * in a single pass over its chunks. Only track 0 and the tracks that held
+ * misplaced events are re-encoded. Every other chunk is written straight from
+ * the input bytes. Moved events keep their absolute time. An event that
+ * duplicates one already in track 0 at the same tick is dropped.
+ */
+class MidiCompliance
+{
+public:
+    enum class Result
+    {
+        Clean,   // nothing to move; no output is written
+        Fixed,
+        Skipped, // format 2: each track is its own sequence, so nothing is shared through track 0
+        Failed
+    };
+
+    struct Report
+    {
+        Result result = Result::Failed;
+        int movedEvents = 0;
+        int duplicatesDropped = 0;
+        int rewrittenTracks = 0; // including track 0
+        std::string error;
+    };
+
+    // Normalizes a whole SMF held in memory. The fixed file is written to output only when
+    // the result is Fixed.
+    static Report normalize(const std::uint8_t* data, std::size_t size, std::ostream& output);
+
+    // Reads inputPath and writes the fixed file to outputPath through a temporary file. The
+    // paths may be the same. Clean, skipped and unreadable files are not written.
+    static Report normalizeFile(const std::string& inputPath, const std::string& outputPath);
+};
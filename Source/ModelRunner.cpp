@@ -1,10 +1,13 @@
 #include "ModelRunner.h"
 #include <vector>
 #include <iostream>
+#include <fstream>
+#include <algorithm>
 
-ModelRunner::ModelRunner(const std::string& modelPath)
+ModelRunner::ModelRunner(const std::string& modelPath, MemoryLedger* ledger)
     : env(ORT_LOGGING_LEVEL_WARNING, "Aamati"),
-      modelLoaded(false)
+      modelLoaded(false),
+      sessionCharge(ledger, MemoryLedger::Subsystem::Inference)
 {
     loadModel(modelPath);
 }
@@ -42,6 +45,11 @@ bool ModelRunner::loadModel(const std::string& modelPath)
         initializeModel();
         modelLoaded = true;
         
+        // ONNX Runtime allocates outside our allocators; the session keeps roughly
+        // one copy of the weights resident, so charge the model size as the estimate
+        std::ifstream modelStream(modelPath, std::ios::binary | std::ios::ate);
+        sessionCharge.setBytes(modelStream.good() ? static_cast<size_t>(modelStream.tellg()) : 0);
+        
         std::cout << "Model loaded successfully: " << modelPath << std::endl;
         return true;
     }
@@ -146,6 +154,7 @@ void ModelRunner::unloadModel()
     {
         // Session will be automatically destroyed
         modelLoaded = false;
+        sessionCharge.setBytes(0);
     }
 }
 
@@ -162,6 +171,9 @@ void ModelRunner::initializeModel()
     char* output_name_ptr = session.GetOutputName(0, allocator);
     outputName = std::string(output_name_ptr);
     allocator.Free(output_name_ptr);
+
+    const auto inputShape = session.GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+    fixedBatchSize = inputShape.empty() ? 0 : std::max<int64_t>(0, inputShape[0]);
 }
 
 std::string ModelRunner::predict(const std::array<float, 5>& features)
@@ -216,38 +228,92 @@ std::string ModelRunner::predict(const std::array<float, 5>& features)
             return "output_size_mismatch";
         }
         
-        // Find the index with highest probability
-        int bestIdx = 0;
-        float bestScore = outData[0];
-        
-        for (size_t i = 1; i < moodLabels.size(); ++i)
-        {
-            if (outData[i] > bestScore)
-            {
-                bestScore = outData[i];
-                bestIdx = static_cast<int>(i);
-            }
-        }
+        return chooseMood(outData, moodLabels.size());
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error during prediction: " << e.what() << std::endl;
+        return "prediction_error";
+    }
+}
 
-        // Validate confidence threshold
-        if (bestScore < 0.1f) // Very low confidence
+std::string ModelRunner::chooseMood(const float* probabilities, size_t count)
+{
+    const auto moodLabels = getMoodLabels();
+    if (probabilities == nullptr || count != moodLabels.size())
+        return "output_size_mismatch";
+
+    // Find the index with highest probability
+    int bestIdx = 0;
+    float bestScore = probabilities[0];
+    
+    for (size_t i = 1; i < moodLabels.size(); ++i)
+    {
+        if (probabilities[i] > bestScore)
         {
-            std::cerr << "Low confidence prediction: " << bestScore << std::endl;
-            return "low_confidence";
+            bestScore = probabilities[i];
+            bestIdx = static_cast<int>(i);
         }
+    }
+
+    // Validate confidence threshold
+    if (bestScore < 0.1f) // Very low confidence
+    {
+        std::cerr << "Low confidence prediction: " << bestScore << std::endl;
+        return "low_confidence";
+    }
 
-        if (bestIdx >= 0 && bestIdx < static_cast<int>(moodLabels.size()))
+    if (bestIdx >= 0 && bestIdx < static_cast<int>(moodLabels.size()))
+    {
+        std::cout << "Predicted mood: " << moodLabels[bestIdx] << " (confidence: " << bestScore << ")" << std::endl;
+        return moodLabels[bestIdx];
+    }
+    
+    return "unknown";
+}
+
+bool ModelRunner::predictBatch(const float* features, size_t numRows, float* probabilities)
+{
+    if (!modelLoaded || features == nullptr || probabilities == nullptr)
+        return false;
+
+    try
+    {
+        auto memory_info = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
+
+        // One run for the whole batch, or one per row if the model was exported for a fixed batch of one
+        const size_t rowsPerRun = fixedBatchSize == 1 ? 1 : numRows;
+        for (size_t first = 0; first < numRows; first += rowsPerRun)
         {
-            std::cout << "Predicted mood: " << moodLabels[bestIdx] << " (confidence: " << bestScore << ")" << std::endl;
-            return moodLabels[bestIdx];
+            std::vector<int64_t> dims = {static_cast<int64_t>(rowsPerRun), 5};
+            Ort::Value inputTensor = Ort::Value::CreateTensor<float>(
+                memory_info,
+                const_cast<float*>(features + first * 5),
+                rowsPerRun * 5,
+                dims.data(),
+                dims.size()
+            );
+
+            auto outputTensors = session.Run(Ort::RunOptions{nullptr},
+                                             &inputName, &inputTensor, 1,
+                                             &outputName, 1);
+
+            if (outputTensors.empty()
+                || outputTensors.front().GetTensorTypeAndShapeInfo().GetElementCount() != rowsPerRun * numMoods)
+            {
+                std::cerr << "Unexpected output from batched prediction" << std::endl;
+                return false;
+            }
+
+            const float* outData = outputTensors.front().GetTensorMutableData<float>();
+            std::copy(outData, outData + rowsPerRun * numMoods, probabilities + first * numMoods);
         }
-        
-        return "unknown";
+        return true;
     }
     catch (const std::exception& e)
     {
-        std::cerr << "Error during prediction: " << e.what() << std::endl;
-        return "prediction_error";
+        std::cerr << "Error during batched prediction: " << e.what() << std::endl;
+        return false;
     }
 }
 
@@ -1,13 +1,15 @@
 #pragma once
 
 #include <onnxruntime_cxx_api.h>
+#include "MemoryLedger.h"
 #include <string>
 #include <array>
 #include <vector>
 
 class ModelRunner {
 public:
-    explicit ModelRunner(const std::string& modelPath);
+    // The loaded session is charged to the ledger's inference account when one is given
+    explicit ModelRunner(const std::string& modelPath, MemoryLedger* ledger = nullptr);
     ~ModelRunner();
     
     // Main prediction method
@@ -17,6 +19,18 @@ public:
     std::vector<float> predictProbabilities(const std::array<float, 5>& features);
     bool isModelLoaded() const { return modelLoaded; }
     
+    // Many rows at once, as the inference daemon batches requests: numRows * 5 features in,
+    // numRows * numMoods probabilities out. Models exported with a fixed batch size run row by row.
+    bool predictBatch(const float* features, size_t numRows, float* probabilities);
+    
+    // The mood predict() would name for one row of probabilities, or the same error labels
+    static std::string chooseMood(const float* probabilities, size_t count);
+    static bool validateInputFeatures(const std::array<float, 5>& features);
+    static constexpr size_t numMoods = 10;
+    
+    // The moods in the order of the model's outputs
+    static std::vector<std::string> getMoodLabels();
+    
     // Model management
     bool loadModel(const std::string& modelPath);
     void unloadModel();
@@ -27,8 +41,9 @@ private:
     std::string inputName;
     std::string outputName;
     bool modelLoaded;
+    int64_t fixedBatchSize = 0; // 0 when the model takes any batch size
+    MemoryLedger::Charge sessionCharge;
     
     // Helper methods
     void initializeModel();
-    std::vector<std::string> getMoodLabels();
 };
\ No newline at end of file
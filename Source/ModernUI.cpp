@@ -1,5 +1,132 @@
 #include "ModernUI.h"
 
+#include <deque>
+
+/**
+ * Scrolling piano-roll of the live transcription: the frame-by-frame pitch
+ * track as a line, finished notes as bars shaded by velocity.
+ */
+class ModernUI::MelodicContourView : public juce::Component
+{
+public:
+    explicit MelodicContourView(const UIStyle& style) : style(style) {}
+
+    void append(const std::vector<PitchPoint>& newPoints, const std::vector<NoteEvent>& newNotes)
+    {
+        for (const auto& point : newPoints)
+        {
+            points.push_back(point);
+            latestTime = std::max(latestTime, point.time);
+        }
+        for (const auto& note : newNotes)
+        {
+            notes.push_back(note);
+            latestTime = std::max(latestTime, note.startTime + note.duration);
+        }
+
+        // Drop what has scrolled out of view
+        const double horizon = latestTime - visibleSeconds;
+        while (!points.empty() && points.front().time < horizon)
+            points.pop_front();
+        while (!notes.empty() && notes.front().startTime + notes.front().duration < horizon)
+            notes.pop_front();
+
+        repaint();
+    }
+
+    void paint(juce::Graphics& g) override
+    {
+        auto bounds = getLocalBounds().toFloat();
+        g.setColour(style.background);
+        g.fillRoundedRectangle(bounds, style.cornerRadius);
+
+        // Fit the visible pitches, at least an octave tall
+        float lowest = 127.0f, highest = 0.0f;
+        for (const auto& point : points)
+        {
+            if (point.midiPitch <= 0.0f)
+                continue;
+            lowest = std::min(lowest, point.midiPitch);
+            highest = std::max(highest, point.midiPitch);
+        }
+        for (const auto& note : notes)
+        {
+            lowest = std::min(lowest, static_cast<float>(note.noteNumber));
+            highest = std::max(highest, static_cast<float>(note.noteNumber));
+        }
+        if (lowest > highest)
+        {
+            lowest = 48.0f;
+            highest = 72.0f;
+        }
+        const float centre = 0.5f * (lowest + highest);
+        const float span = std::max(12.0f, highest - lowest + 4.0f);
+        lowest = centre - 0.5f * span;
+        highest = centre + 0.5f * span;
+
+        auto timeToX = [&](double time)
+        {
+            return bounds.getRight() - static_cast<float>((latestTime - time) / visibleSeconds) * bounds.getWidth();
+        };
+        auto pitchToY = [&](float pitch)
+        {
+            return bounds.getBottom() - (pitch - lowest) / (highest - lowest) * bounds.getHeight();
+        };
+
+        // Octave lines on every C
+        g.setFont(style.smallFont);
+        for (int note = static_cast<int>(std::ceil(lowest / 12.0f)) * 12; note <= highest; note += 12)
+        {
+            const float y = pitchToY(static_cast<float>(note));
+            g.setColour(style.surface);
+            g.drawHorizontalLine(juce::roundToInt(y), bounds.getX(), bounds.getRight());
+            g.setColour(style.secondary.withAlpha(0.6f));
+            g.drawText(juce::MidiMessage::getMidiNoteName(note, true, true, 4),
+                       juce::Rectangle<float>(bounds.getX() + 4.0f, y - 14.0f, 40.0f, 14.0f),
+                       juce::Justification::bottomLeft);
+        }
+
+        const float rowHeight = std::max(2.0f, bounds.getHeight() / (highest - lowest));
+        for (const auto& note : notes)
+        {
+            const float x = timeToX(note.startTime);
+            const float width = std::max(2.0f, timeToX(note.startTime + note.duration) - x);
+            g.setColour(style.accent.withAlpha(0.25f + 0.75f * note.velocity / 127.0f));
+            g.fillRoundedRectangle(x, pitchToY(static_cast<float>(note.noteNumber)) - 0.5f * rowHeight,
+                                   width, rowHeight, 2.0f);
+        }
+
+        // Pitch track, broken wherever the input is unvoiced
+        juce::Path contour;
+        bool drawing = false;
+        for (const auto& point : points)
+        {
+            if (point.midiPitch <= 0.0f)
+            {
+                drawing = false;
+                continue;
+            }
+
+            const juce::Point<float> position(timeToX(point.time), pitchToY(point.midiPitch));
+            if (drawing)
+                contour.lineTo(position);
+            else
+                contour.startNewSubPath(position);
+            drawing = true;
+        }
+        g.setColour(style.primary);
+        g.strokePath(contour, juce::PathStrokeType(1.5f));
+    }
+
+private:
+    static constexpr double visibleSeconds = 8.0;
+
+    const UIStyle& style;
+    std::deque<PitchPoint> points;
+    std::deque<NoteEvent> notes;
+    double latestTime = 0.0;
+};
+
 ModernUI::ModernUI()
 {
     setupUI();
@@ -101,6 +228,13 @@ void ModernUI::setupUI()
     moodProgressBar.setPercentage(0.0);
     moodPanel.addAndMakeVisible(moodProgressBar);
     
+    // Setup status components
+    statusLabel.setText("Status: Starting...", juce::dontSendNotification);
+    statusLabel.setFont(style.smallFont);
+    statusLabel.setJustificationType(juce::Justification::centredLeft);
+    statusLabel.setColour(juce::Label::textColourId, style.secondary);
+    statusPanel.addAndMakeVisible(statusLabel);
+    
     // Create feature buttons and panels
     createFeatureButtons();
     createFeaturePanels();
@@ -375,6 +509,10 @@ void ModernUI::createMelodicContourPanel()
     contourLabel->attachToComponent(contourSlider, false);
     panel->addAndMakeVisible(contourLabel);
     
+    // Live transcription display, laid out in resized()
+    melodicContourView = new MelodicContourView(style);
+    panel->addAndMakeVisible(melodicContourView);
+    
     featurePanels["Melodic Contour"] = panel;
     featurePanel.addChildComponent(panel);
 }
@@ -384,8 +522,8 @@ void ModernUI::createHarmonicDensityPanel()
     auto* panel = new juce::Component();
     panel->setName("Harmonic Density");
     
-    // Add harmonic density controls
-    auto* densitySlider = new juce::Slider();
+    // Add harmonic density controls; the slider follows the measured change density
+    densitySlider = new juce::Slider();
     densitySlider->setSliderStyle(juce::Slider::RotaryHorizontalVerticalDrag);
     densitySlider->setTextBoxStyle(juce::Slider::TextBoxBelow, false, 80, 20);
     densitySlider->setRange(0.0, 1.0, 0.01);
@@ -397,6 +535,19 @@ void ModernUI::createHarmonicDensityPanel()
     densityLabel->attachToComponent(densitySlider, false);
     panel->addAndMakeVisible(densityLabel);
     
+    // Recognised harmony, laid out in resized()
+    chordLabel = new juce::Label();
+    chordLabel->setText("Chord: --", juce::dontSendNotification);
+    chordLabel->setFont(style.titleFont);
+    chordLabel->setColour(juce::Label::textColourId, style.primary);
+    panel->addAndMakeVisible(chordLabel);
+    
+    progressionLabel = new juce::Label();
+    progressionLabel->setText("Listening for chords...", juce::dontSendNotification);
+    progressionLabel->setFont(style.bodyFont);
+    progressionLabel->setColour(juce::Label::textColourId, style.secondary);
+    panel->addAndMakeVisible(progressionLabel);
+    
     featurePanels["Harmonic Density"] = panel;
     featurePanel.addChildComponent(panel);
 }
@@ -406,19 +557,31 @@ void ModernUI::createFillOrnamentPanel()
     auto* panel = new juce::Component();
     panel->setName("Fill & Ornament");
     
-    // Add fill and ornament controls
-    auto* fillSlider = new juce::Slider();
-    fillSlider->setSliderStyle(juce::Slider::RotaryHorizontalVerticalDrag);
-    fillSlider->setTextBoxStyle(juce::Slider::TextBoxBelow, false, 80, 20);
-    fillSlider->setRange(0.0, 1.0, 0.01);
-    fillSlider->setValue(0.5);
-    panel->addAndMakeVisible(fillSlider);
+    // Add fill and ornament controls; the amount sets how much of the bar before each phrase boundary is filled
+    fillAmountSlider = new juce::Slider();
+    fillAmountSlider->setSliderStyle(juce::Slider::RotaryHorizontalVerticalDrag);
+    fillAmountSlider->setTextBoxStyle(juce::Slider::TextBoxBelow, false, 80, 20);
+    fillAmountSlider->setRange(0.0, 1.0, 0.01);
+    fillAmountSlider->setValue(0.5);
+    fillAmountSlider->onValueChange = [this]()
+    {
+        if (onFillAmountChanged)
+            onFillAmountChanged(static_cast<float>(fillAmountSlider->getValue()));
+    };
+    panel->addAndMakeVisible(fillAmountSlider);
     
     auto* fillLabel = new juce::Label();
     fillLabel->setText("Fill Amount", juce::dontSendNotification);
-    fillLabel->attachToComponent(fillSlider, false);
+    fillLabel->attachToComponent(fillAmountSlider, false);
     panel->addAndMakeVisible(fillLabel);
     
+    // Detected and scheduled fills, laid out in resized()
+    fillStatusLabel = new juce::Label();
+    fillStatusLabel->setText("Listening for fills...", juce::dontSendNotification);
+    fillStatusLabel->setFont(style.bodyFont);
+    fillStatusLabel->setColour(juce::Label::textColourId, style.secondary);
+    panel->addAndMakeVisible(fillStatusLabel);
+    
     featurePanels["Fill & Ornament"] = panel;
     featurePanel.addChildComponent(panel);
 }
@@ -447,6 +610,54 @@ void ModernUI::createAIMidiGenerationPanel()
     lengthLabel->attachToComponent(lengthSlider, false);
     panel->addAndMakeVisible(lengthLabel);
     
+    // Whole songs in the current mood: intro, verses, choruses, bridge and outro
+    songButton = new juce::TextButton();
+    songButton->setButtonText("Generate Song");
+    songButton->setColour(juce::TextButton::buttonColourId, style.accent);
+    songButton->setColour(juce::TextButton::textColourOnId, juce::Colours::white);
+    songButton->onClick = [this]()
+    {
+        if (onSongGeneration)
+            onSongGeneration();
+    };
+    panel->addAndMakeVisible(songButton);
+    
+    songStatusLabel = new juce::Label();
+    songStatusLabel->setFont(style.bodyFont);
+    songStatusLabel->setColour(juce::Label::textColourId, style.secondary);
+    panel->addAndMakeVisible(songStatusLabel);
+    
+    // Live arpeggio over the chords heard in the input
+    arpeggiatorToggle = new juce::ToggleButton("Arpeggiate heard chords");
+    arpeggiatorToggle->setColour(juce::ToggleButton::textColourId, style.secondary);
+    arpeggiatorToggle->onClick = [this]()
+    {
+        if (onArpeggiatorToggled)
+            onArpeggiatorToggled(arpeggiatorToggle->getToggleState());
+    };
+    panel->addAndMakeVisible(arpeggiatorToggle);
+    
+    // Regenerate one bar of the last pattern, or step back through earlier versions
+    variationButton = new juce::TextButton();
+    variationButton->setButtonText("Vary a Bar");
+    variationButton->setEnabled(false);
+    variationButton->onClick = [this]()
+    {
+        if (onPatternVariation)
+            onPatternVariation();
+    };
+    panel->addAndMakeVisible(variationButton);
+    
+    undoButton = new juce::TextButton();
+    undoButton->setButtonText("Undo");
+    undoButton->setEnabled(false);
+    undoButton->onClick = [this]()
+    {
+        if (onPatternUndo)
+            onPatternUndo();
+    };
+    panel->addAndMakeVisible(undoButton);
+    
     featurePanels["AI MIDI Generation"] = panel;
     featurePanel.addChildComponent(panel);
 }
@@ -496,13 +707,26 @@ void ModernUI::createMoodRemixingPanel()
     auto* panel = new juce::Component();
     panel->setName("Mood Remixer");
     
-    // Add mood remixing controls
-    auto* remixButton = new juce::TextButton();
+    // Add mood remixing controls; the button remixes every MIDI file in a folder to the current mood
+    remixButton = new juce::TextButton();
     remixButton->setButtonText("Remix to New Mood");
     remixButton->setColour(juce::TextButton::buttonColourId, style.success);
     remixButton->setColour(juce::TextButton::textColourOnId, juce::Colours::white);
+    remixButton->onClick = [this]()
+    {
+        juce::FileChooser chooser("Select a folder of MIDI files to remix", juce::File());
+        if (chooser.browseForDirectory() && onRemixFolderChosen)
+            onRemixFolderChosen(chooser.getResult());
+    };
     panel->addAndMakeVisible(remixButton);
     
+    // Target mood and job progress, laid out in resized()
+    remixStatusLabel = new juce::Label();
+    remixStatusLabel->setText("Choose a folder to remix", juce::dontSendNotification);
+    remixStatusLabel->setFont(style.bodyFont);
+    remixStatusLabel->setColour(juce::Label::textColourId, style.secondary);
+    panel->addAndMakeVisible(remixStatusLabel);
+    
     featurePanels["Mood Remixer"] = panel;
     featurePanel.addChildComponent(panel);
 }
@@ -535,6 +759,32 @@ void ModernUI::createGrooveHumanizationPanel()
     humanizeButton->setColour(juce::TextButton::textColourOnId, juce::Colours::white);
     panel->addAndMakeVisible(humanizeButton);
     
+    // Tighten incoming MIDI onto a sixteenth grid, laid out in resized()
+    quantizeToggle = new juce::ToggleButton("Quantize input");
+    quantizeToggle->setColour(juce::ToggleButton::textColourId, style.secondary);
+    panel->addAndMakeVisible(quantizeToggle);
+    
+    quantizeStrengthSlider = new juce::Slider();
+    quantizeStrengthSlider->setSliderStyle(juce::Slider::RotaryHorizontalVerticalDrag);
+    quantizeStrengthSlider->setTextBoxStyle(juce::Slider::TextBoxBelow, false, 80, 20);
+    quantizeStrengthSlider->setRange(0.0, 1.0, 0.01);
+    quantizeStrengthSlider->setValue(0.75);
+    panel->addAndMakeVisible(quantizeStrengthSlider);
+    
+    auto* strengthLabel = new juce::Label();
+    strengthLabel->setText("Strength", juce::dontSendNotification);
+    strengthLabel->attachToComponent(quantizeStrengthSlider, false);
+    panel->addAndMakeVisible(strengthLabel);
+    
+    auto notifyQuantize = [this]()
+    {
+        if (onQuantizeChanged)
+            onQuantizeChanged(quantizeToggle->getToggleState(),
+                              static_cast<float>(quantizeStrengthSlider->getValue()));
+    };
+    quantizeToggle->onClick = notifyQuantize;
+    quantizeStrengthSlider->onValueChange = notifyQuantize;
+    
     featurePanels["Groove Humanizer"] = panel;
     featurePanel.addChildComponent(panel);
 }
@@ -601,6 +851,9 @@ void ModernUI::resized()
     analysisLabel.setBounds(240, 50, 300, 20);
     moodProgressBar.setBounds(240, 70, 300, 15);
     
+    // Layout status components
+    statusLabel.setBounds(20, 10, statusPanel.getWidth() - 40, 20);
+    
     // Layout feature buttons in a grid
     int buttonWidth = 150;
     int buttonHeight = 40;
@@ -622,6 +875,62 @@ void ModernUI::resized()
     {
         activeFeaturePanel->setBounds(10, 200, featurePanel.getWidth() - 20, 180);
     }
+    
+    if (chordLabel && progressionLabel)
+    {
+        auto harmonyBounds = chordLabel->getParentComponent()->getLocalBounds().reduced(10);
+        harmonyBounds.removeFromLeft(140);
+        chordLabel->setBounds(harmonyBounds.removeFromTop(40));
+        progressionLabel->setBounds(harmonyBounds.removeFromTop(60));
+    }
+    
+    if (fillStatusLabel)
+    {
+        auto fillBounds = fillStatusLabel->getParentComponent()->getLocalBounds().reduced(10);
+        fillBounds.removeFromLeft(140);
+        fillStatusLabel->setBounds(fillBounds.removeFromTop(80));
+    }
+    
+    if (songButton && songStatusLabel)
+    {
+        auto songBounds = songButton->getParentComponent()->getLocalBounds().reduced(10);
+        songBounds.removeFromLeft(140);
+        songButton->setBounds(songBounds.removeFromTop(30).removeFromLeft(160));
+        songStatusLabel->setBounds(songBounds.removeFromTop(60));
+        if (arpeggiatorToggle)
+            arpeggiatorToggle->setBounds(songBounds.removeFromTop(30).removeFromLeft(220));
+        if (variationButton && undoButton)
+        {
+            auto historyBounds = songBounds.removeFromTop(30);
+            variationButton->setBounds(historyBounds.removeFromLeft(110));
+            historyBounds.removeFromLeft(10);
+            undoButton->setBounds(historyBounds.removeFromLeft(70));
+        }
+    }
+    
+    if (remixButton && remixStatusLabel)
+    {
+        auto remixBounds = remixButton->getParentComponent()->getLocalBounds().reduced(10);
+        remixButton->setBounds(remixBounds.removeFromLeft(160).removeFromTop(30));
+        remixBounds.removeFromLeft(10);
+        remixStatusLabel->setBounds(remixBounds.removeFromTop(80));
+    }
+    
+    if (quantizeToggle && quantizeStrengthSlider)
+    {
+        auto quantizeBounds = quantizeToggle->getParentComponent()->getLocalBounds().reduced(10);
+        quantizeBounds.removeFromLeft(180);
+        quantizeToggle->setBounds(quantizeBounds.removeFromTop(30).removeFromLeft(160));
+        quantizeBounds.removeFromTop(25);
+        quantizeStrengthSlider->setBounds(quantizeBounds.removeFromLeft(100).removeFromTop(100));
+    }
+    
+    if (melodicContourView)
+    {
+        auto contourBounds = melodicContourView->getParentComponent()->getLocalBounds().reduced(10);
+        contourBounds.removeFromLeft(140);
+        melodicContourView->setBounds(contourBounds);
+    }
 }
 
 void ModernUI::updateMoodDisplay(const MoodDisplay& mood)
@@ -653,6 +962,108 @@ void ModernUI::setMoodAnalysis(const std::string& analysis)
     repaint();
 }
 
+void ModernUI::updateMelodicContour(const std::vector<PitchPoint>& points, const std::vector<NoteEvent>& notes)
+{
+    if (melodicContourView && (!points.empty() || !notes.empty()))
+        melodicContourView->append(points, notes);
+}
+
+void ModernUI::updateHarmonicAnalysis(const std::string& currentChord, const ChordRecognizer::HarmonicRhythm& rhythm)
+{
+    if (!chordLabel || !progressionLabel)
+        return;
+    
+    chordLabel->setText("Chord: " + currentChord, juce::dontSendNotification);
+    
+    std::string progression;
+    for (const auto& symbol : rhythm.symbols)
+        progression += (progression.empty() ? "" : " - ") + symbol;
+    if (!progression.empty())
+        progressionLabel->setText(progression + "\n" + juce::String(rhythm.secondsPerChord, 1).toStdString() + " s per chord, "
+                                  + juce::String(rhythm.changesPerMinute, 0).toStdString() + " changes/min",
+                                  juce::dontSendNotification);
+    
+    if (densitySlider)
+        densitySlider->setValue(rhythm.density, juce::dontSendNotification);
+}
+
+void ModernUI::updateFillStatus(float inputFillActivity, int fillsDetected, double secondsToNextFill, bool nextFillReady)
+{
+    if (!fillStatusLabel)
+        return;
+    
+    std::string status = "Input fills: " + std::to_string(fillsDetected) + ", in "
+                       + juce::String(inputFillActivity * 100.0f, 0).toStdString() + "% of recent bars";
+    if (secondsToNextFill >= 0.0)
+        status += "\nNext fill in " + juce::String(secondsToNextFill, 1).toStdString() + " s"
+                + (nextFillReady ? " (ready)" : " (generating)");
+    
+    fillStatusLabel->setText(status, juce::dontSendNotification);
+}
+
+float ModernUI::getFillAmount() const
+{
+    return fillAmountSlider ? static_cast<float>(fillAmountSlider->getValue()) : 0.5f;
+}
+
+void ModernUI::updateSongStatus(const std::string& section, double positionSeconds, double lengthSeconds,
+                                size_t uniqueSections, size_t totalSections)
+{
+    if (!songStatusLabel)
+        return;
+    
+    if (section.empty())
+    {
+        songStatusLabel->setText({}, juce::dontSendNotification);
+        return;
+    }
+    
+    const auto formatTime = [](double seconds)
+    {
+        const int whole = juce::jmax(0, static_cast<int>(seconds));
+        return juce::String(whole / 60) + ":" + juce::String(whole % 60).paddedLeft('0', 2);
+    };
+    
+    songStatusLabel->setText("Song: " + section + "  " + formatTime(positionSeconds).toStdString() + " / "
+                             + formatTime(lengthSeconds).toStdString() + "\n" + std::to_string(uniqueSections)
+                             + " sections generated for " + std::to_string(totalSections),
+                             juce::dontSendNotification);
+}
+
+void ModernUI::setPatternHistoryState(bool hasPattern, bool canUndo)
+{
+    if (variationButton)
+        variationButton->setEnabled(hasPattern);
+    if (undoButton)
+        undoButton->setEnabled(canUndo);
+}
+
+void ModernUI::updateRemixProgress(size_t completed, size_t total, size_t failed, bool finished)
+{
+    if (!remixStatusLabel)
+        return;
+    
+    std::string status = (finished ? "Remixed " : "Remixing ") + std::to_string(completed) + " of " + std::to_string(total) + " files";
+    if (failed > 0)
+        status += "\n" + std::to_string(failed) + " could not be remixed";
+    
+    remixStatusLabel->setText(status, juce::dontSendNotification);
+    if (remixButton)
+        remixButton->setEnabled(finished);
+}
+
+void ModernUI::setRemixTargetMood(const std::string& mood)
+{
+    if (remixStatusLabel)
+        remixStatusLabel->setText("Target mood: " + mood + "\nChoose a folder to remix", juce::dontSendNotification);
+}
+
+void ModernUI::setStatusText(const std::string& summary, const std::string& details)
+{
+    statusLabel.setText(summary, juce::dontSendNotification);
+    statusLabel.setTooltip(details);
+}
+
 void ModernUI::showFeaturePanel(const std::string& featureName)
 {
     // Hide current panel
@@ -671,6 +1082,11 @@ void ModernUI::showFeaturePanel(const std::string& featureName)
     
     // Update button states
     updateFeatureButtonStates();
+    resized();
+    
+    // Let the owner start the engine behind the feature
+    if (auto* callback = findFeatureCallback(featureName); callback && *callback)
+        (*callback)();
     
     repaint();
 }
@@ -711,6 +1127,30 @@ void ModernUI::onDownloadReport()
     setMoodAnalysis("Generating report...");
 }
 
+std::function<void()>* ModernUI::findFeatureCallback(const std::string& featureName)
+{
+    static const std::pair<const char*, std::function<void()> ModernUI::*> callbacks[] = {
+        {"Emotional Optimization", &ModernUI::onEmotionalOptimization},
+        {"Groove Shaping", &ModernUI::onGrooveShaping},
+        {"Instrumentation", &ModernUI::onInstrumentation},
+        {"Melodic Contour", &ModernUI::onMelodicContour},
+        {"Harmonic Density", &ModernUI::onHarmonicDensity},
+        {"Fill & Ornament", &ModernUI::onFillOrnament},
+        {"AI MIDI Generation", &ModernUI::onAIMidiGeneration},
+        {"Key/Tempo Detection", &ModernUI::onKeyTempoDetection},
+        {"Visual Analyzer", &ModernUI::onVisualAnalysis},
+        {"Mood Remixer", &ModernUI::onMoodRemixing},
+        {"Mastering Tools", &ModernUI::onMasteringTools},
+        {"Groove Humanizer", &ModernUI::onGrooveHumanization},
+        {"Dynamic Balancer", &ModernUI::onDynamicBalancing}
+    };
+    
+    for (const auto& [name, member] : callbacks)
+        if (featureName == name)
+            return &(this->*member);
+    return nullptr;
+}
+
 void ModernUI::updateFeatureButtonStates()
 {
     for (auto& button : featureButtons)
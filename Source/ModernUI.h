@@ -4,6 +4,8 @@
 #include <vector>
 #include <map>
 #include <string>
+#include "NoteEvents.h"
+#include "ChordRecognizer.h"
 
 /**
  * Modern UI System for Aamati
@@ -51,7 +53,32 @@ public:
     void updateMoodDisplay(const MoodDisplay& mood);
     void setMoodAnalysis(const std::string& analysis);
     
-    // Feature panels
+    // Status panel: one-line telemetry summary, with details shown as a tooltip
+    void setStatusText(const std::string& summary, const std::string& details = {});
+    
+    // Melodic contour panel: appends the live pitch track and transcribed notes
+    void updateMelodicContour(const std::vector<PitchPoint>& points, const std::vector<NoteEvent>& notes);
+    
+    // Harmonic density panel: current chord, recent progression and harmonic rhythm
+    void updateHarmonicAnalysis(const std::string& currentChord, const ChordRecognizer::HarmonicRhythm& rhythm);
+    
+    // Fill and ornament panel: the input's fill activity and when the next generated fill plays;
+    // a negative secondsToNextFill means no fills are scheduled
+    void updateFillStatus(float inputFillActivity, int fillsDetected, double secondsToNextFill, bool nextFillReady);
+    float getFillAmount() const;
+    
+    // AI MIDI generation panel: the section of the song now playing; an empty section means no song
+    void updateSongStatus(const std::string& section, double positionSeconds, double lengthSeconds,
+                          size_t uniqueSections, size_t totalSections);
+    
+    // AI MIDI generation panel: enables the bar variation and undo buttons
+    void setPatternHistoryState(bool hasPattern, bool canUndo);
+    
+    // Mood remixer panel: progress of the folder remix job
+    void updateRemixProgress(size_t completed, size_t total, size_t failed, bool finished);
+    void setRemixTargetMood(const std::string& mood);
+    
+    // Feature panels; showing a panel also fires its feature callback
     void showFeaturePanel(const std::string& featureName);
     void hideFeaturePanel();
     void toggleAdvancedFeatures();
@@ -67,12 +94,19 @@ public:
     std::function<void()> onMelodicContour;
     std::function<void()> onHarmonicDensity;
     std::function<void()> onFillOrnament;
+    std::function<void(float)> onFillAmountChanged;
     std::function<void()> onAIMidiGeneration;
+    std::function<void()> onSongGeneration;
+    std::function<void(bool)> onArpeggiatorToggled;
+    std::function<void()> onPatternVariation;
+    std::function<void()> onPatternUndo;
     std::function<void()> onKeyTempoDetection;
     std::function<void()> onVisualAnalysis;
     std::function<void()> onMoodRemixing;
+    std::function<void(const juce::File&)> onRemixFolderChosen;
     std::function<void()> onMasteringTools;
     std::function<void()> onGrooveHumanization;
+    std::function<void(bool, float)> onQuantizeChanged;
     std::function<void()> onDynamicBalancing;
     
 private:
@@ -101,6 +135,9 @@ private:
     juce::Label analysisLabel;
     juce::ProgressBar moodProgressBar;
     
+    // Status components
+    juce::Label statusLabel;
+    
     // Feature buttons
     struct FeatureButton
     {
@@ -117,6 +154,34 @@ private:
     std::map<std::string, juce::Component*> featurePanels;
     juce::Component* activeFeaturePanel = nullptr;
     
+    // Scrolling pitch track inside the melodic contour panel
+    class MelodicContourView;
+    MelodicContourView* melodicContourView = nullptr;
+    
+    // Harmonic density panel readouts
+    juce::Label* chordLabel = nullptr;
+    juce::Label* progressionLabel = nullptr;
+    juce::Slider* densitySlider = nullptr;
+    
+    // Fill and ornament panel controls and readout
+    juce::Slider* fillAmountSlider = nullptr;
+    juce::Label* fillStatusLabel = nullptr;
+    
+    // AI MIDI generation panel song controls and readout
+    juce::TextButton* songButton = nullptr;
+    juce::Label* songStatusLabel = nullptr;
+    juce::ToggleButton* arpeggiatorToggle = nullptr;
+    juce::TextButton* variationButton = nullptr;
+    juce::TextButton* undoButton = nullptr;
+    
+    // Groove humanizer panel live quantize controls
+    juce::ToggleButton* quantizeToggle = nullptr;
+    juce::Slider* quantizeStrengthSlider = nullptr;
+    
+    // Mood remixer panel controls and readout
+    juce::TextButton* remixButton = nullptr;
+    juce::Label* remixStatusLabel = nullptr;
+    
     // UI State
     bool showAdvancedFeatures = false;
     MoodDisplay currentMood;
@@ -126,6 +191,7 @@ private:
     void createFeatureButtons();
     void createFeaturePanels();
     void updateFeatureButtonStates();
+    std::function<void()>* findFeatureCallback(const std::string& featureName);
     void drawModernButton(juce::Graphics& g, const juce::Rectangle<int>& bounds, 
                          const std::string& text, bool isActive, juce::Colour color);
     void drawMoodDisplay(juce::Graphics& g, const juce::Rectangle<int>& bounds);
@@ -0,0 +1,396 @@
+#include "MonophonicTranscriber.h"
+#include "SimdKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    // A key maximum counts as the period once it reaches this share of the highest one
+    constexpr float peakThreshold = 0.9f;
+
+    int nextPowerOfTwoOrder(int value)
+    {
+        int order = 0;
+        while ((1 << order) < value)
+            ++order;
+        return order;
+    }
+}
+
+MonophonicTranscriber::MonophonicTranscriber(MemoryLedger* ledger)
+    : inputRing(TrackedAllocator<float>(ledger, MemoryLedger::Subsystem::AudioHistory)),
+      frameBuffer(TrackedAllocator<float>(ledger, MemoryLedger::Subsystem::AudioHistory)),
+      fftBuffer(TrackedAllocator<float>(ledger, MemoryLedger::Subsystem::AudioHistory)),
+      nsdf(TrackedAllocator<float>(ledger, MemoryLedger::Subsystem::AudioHistory))
+{
+}
+
+MonophonicTranscriber::~MonophonicTranscriber() = default;
+
+void MonophonicTranscriber::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate > 0.0 ? newSampleRate : 44100.0;
+
+    // 40 ms holds two periods of the lowest pitch; the FFT is twice the window so the
+    // autocorrelation doesn't wrap around
+    const int windowOrder = nextPowerOfTwoOrder(static_cast<int>(sampleRate * 0.04));
+    windowSize = 1 << windowOrder;
+    hopSize = windowSize / 4;
+    fftOrder = windowOrder + 1;
+
+    minLag = std::max(2, static_cast<int>(sampleRate / maxFrequencyHz));
+    maxLag = std::min(windowSize - 2, static_cast<int>(std::ceil(sampleRate / minFrequencyHz)));
+
+    if (fft == nullptr || fft->getSize() != (1 << fftOrder))
+        fft = std::make_unique<juce::dsp::FFT>(fftOrder);
+
+    inputRing.assign(static_cast<size_t>(windowSize), 0.0f);
+    frameBuffer.assign(static_cast<size_t>(windowSize), 0.0f);
+    fftBuffer.assign(static_cast<size_t>(4 << windowOrder), 0.0f);
+    nsdf.assign(static_cast<size_t>(maxLag + 2), 0.0f);
+
+    reset();
+}
+
+void MonophonicTranscriber::reset()
+{
+    std::fill(inputRing.begin(), inputRing.end(), 0.0f);
+    ringPosition = 0;
+    samplesUntilHop = hopSize;
+    samplesBuffered = 0;
+    totalSamples = 0;
+
+    state = State::Silence;
+    candidateFrames = 0;
+    unvoicedFrames = 0;
+    changeFrames = 0;
+    previousLevelDb = -100.0f;
+    activeFrames = 0;
+    currentNote.store(-1);
+}
+
+void MonophonicTranscriber::process(const juce::AudioBuffer<float>& buffer)
+{
+    if (windowSize == 0)
+        return;
+
+    const int numChannels = buffer.getNumChannels();
+    const int numSamples = buffer.getNumSamples();
+    if (numChannels == 0)
+        return;
+
+    const float channelGain = 1.0f / static_cast<float>(numChannels);
+    int position = 0;
+
+    // Copy in runs that end at a hop or at the end of the ring, so each run is contiguous
+    while (position < numSamples)
+    {
+        const int run = std::min({ numSamples - position, samplesUntilHop, windowSize - ringPosition });
+        float* destination = inputRing.data() + ringPosition;
+
+        const float* first = buffer.getReadPointer(0, position);
+        for (int i = 0; i < run; ++i)
+            destination[i] = first[i] * channelGain;
+        for (int channel = 1; channel < numChannels; ++channel)
+        {
+            const float* source = buffer.getReadPointer(channel, position);
+            for (int i = 0; i < run; ++i)
+                destination[i] += source[i] * channelGain;
+        }
+
+        position += run;
+        totalSamples += run;
+        ringPosition = (ringPosition + run) % windowSize;
+        samplesBuffered = std::min(windowSize, samplesBuffered + run);
+        samplesUntilHop -= run;
+
+        if (samplesUntilHop == 0)
+        {
+            samplesUntilHop = hopSize;
+            if (samplesBuffered == windowSize)
+                analyseFrame();
+        }
+    }
+}
+
+void MonophonicTranscriber::analyseFrame()
+{
+    // Oldest sample first
+    const size_t tail = static_cast<size_t>(windowSize - ringPosition);
+    std::memcpy(frameBuffer.data(), inputRing.data() + ringPosition, tail * sizeof(float));
+    std::memcpy(frameBuffer.data() + tail, inputRing.data(), static_cast<size_t>(ringPosition) * sizeof(float));
+
+    Frame frame;
+    frame.time = (static_cast<double>(totalSamples) - windowSize * 0.5) / sampleRate;
+
+    const float meanSquare = static_cast<float>(SimdKernels::sumOfSquares(frameBuffer.data(), frameBuffer.size()) / windowSize);
+    frame.levelDb = 10.0f * std::log10(meanSquare + 1.0e-12f);
+
+    // Quiet frames can't start or hold a note, so they skip the FFT
+    float period = 0.0f;
+    if (frame.levelDb >= silenceThresholdDb && estimatePitch(period, frame.clarity))
+    {
+        frame.midiPitch = NoteEvents::frequencyToMidi(static_cast<float>(sampleRate) / period);
+        frame.voiced = frame.clarity >= clarityThreshold;
+    }
+
+    pushPitchPoint({ frame.time, frame.voiced ? frame.midiPitch : 0.0f, frame.clarity });
+    advanceStateMachine(frame);
+    previousLevelDb = frame.levelDb;
+}
+
+bool MonophonicTranscriber::estimatePitch(float& periodSamples, float& clarity)
+{
+    const float* x = frameBuffer.data();
+    float* spectrum = fftBuffer.data();
+    const int fftSize = 1 << fftOrder;
+
+    // Autocorrelation as the inverse transform of the power spectrum
+    std::fill(fftBuffer.begin(), fftBuffer.end(), 0.0f);
+    std::memcpy(spectrum, x, static_cast<size_t>(windowSize) * sizeof(float));
+    fft->performRealOnlyForwardTransform(spectrum);
+    for (int bin = 0; bin < fftSize; ++bin)
+    {
+        const float re = spectrum[2 * bin];
+        const float im = spectrum[2 * bin + 1];
+        spectrum[2 * bin] = re * re + im * im;
+        spectrum[2 * bin + 1] = 0.0f;
+    }
+    fft->performRealOnlyInverseTransform(spectrum);
+
+    // Lag 0 is the frame energy, which fixes the scale whatever the FFT's normalisation
+    const float energy = static_cast<float>(SimdKernels::sumOfSquares(x, static_cast<size_t>(windowSize)));
+    if (spectrum[0] <= 0.0f || energy <= 0.0f)
+        return false;
+    const float scale = energy / spectrum[0];
+
+    // n(tau) = 2 r(tau) / m(tau), with m the running sum of squares of both overlapping parts
+    float m = 2.0f * energy;
+    nsdf[0] = 1.0f;
+    for (int tau = 1; tau <= maxLag + 1; ++tau)
+    {
+        const float leaving = x[tau - 1];
+        const float leavingEnd = x[windowSize - tau];
+        m -= leaving * leaving + leavingEnd * leavingEnd;
+        nsdf[static_cast<size_t>(tau)] = m > 1.0e-9f ? 2.0f * spectrum[tau] * scale / m : 0.0f;
+    }
+
+    // Key maxima: the highest point of each positive lobe after the zero-lag lobe
+    auto forEachKeyMaximum = [this](auto&& visit)
+    {
+        int tau = 1;
+        while (tau <= maxLag && nsdf[static_cast<size_t>(tau)] > 0.0f)
+            ++tau;
+
+        while (tau <= maxLag)
+        {
+            while (tau <= maxLag && nsdf[static_cast<size_t>(tau)] <= 0.0f)
+                ++tau;
+
+            int best = -1;
+            while (tau <= maxLag && nsdf[static_cast<size_t>(tau)] > 0.0f)
+            {
+                if (tau >= minLag && (best < 0 || nsdf[static_cast<size_t>(tau)] > nsdf[static_cast<size_t>(best)]))
+                    best = tau;
+                ++tau;
+            }
+
+            if (best > 0 && visit(best))
+                return;
+        }
+    };
+
+    float highest = 0.0f;
+    forEachKeyMaximum([this, &highest](int tau)
+    {
+        highest = std::max(highest, nsdf[static_cast<size_t>(tau)]);
+        return false;
+    });
+    if (highest <= 0.0f)
+        return false;
+
+    int chosen = -1;
+    forEachKeyMaximum([this, &chosen, highest](int tau)
+    {
+        if (nsdf[static_cast<size_t>(tau)] < peakThreshold * highest)
+            return false;
+        chosen = tau;
+        return true;
+    });
+    if (chosen < 0)
+        return false;
+
+    // Parabolic interpolation between neighbouring lags
+    const float a = nsdf[static_cast<size_t>(chosen - 1)];
+    const float b = nsdf[static_cast<size_t>(chosen)];
+    const float c = nsdf[static_cast<size_t>(chosen + 1)];
+    const float denominator = a - 2.0f * b + c;
+    const float delta = std::abs(denominator) > 1.0e-9f ? juce::jlimit(-0.5f, 0.5f, 0.5f * (a - c) / denominator) : 0.0f;
+
+    periodSamples = static_cast<float>(chosen) + delta;
+    clarity = juce::jlimit(0.0f, 1.0f, b - 0.25f * (a - c) * delta);
+    return periodSamples > 0.0f;
+}
+
+void MonophonicTranscriber::advanceStateMachine(const Frame& frame)
+{
+    if (state == State::Silence)
+    {
+        if (!frame.voiced)
+        {
+            candidateFrames = 0;
+            return;
+        }
+
+        // A candidate restarts if its pitch wanders before it is confirmed
+        if (candidateFrames > 0
+            && std::abs(frame.midiPitch - candidatePitchSum / static_cast<float>(candidateFrames)) > pitchChangeSemitones)
+            candidateFrames = 0;
+
+        if (candidateFrames == 0)
+        {
+            candidateTime = frame.time;
+            candidatePitchSum = 0.0f;
+            candidatePeakDb = frame.levelDb;
+        }
+
+        ++candidateFrames;
+        candidatePitchSum += frame.midiPitch;
+        candidatePeakDb = std::max(candidatePeakDb, frame.levelDb);
+
+        if (candidateFrames >= onsetFrames)
+        {
+            startNote(candidateTime, candidatePitchSum / static_cast<float>(candidateFrames), candidatePeakDb, frame.clarity);
+            activeFrames = candidateFrames;
+            candidateFrames = 0;
+        }
+        return;
+    }
+
+    if (!frame.voiced)
+    {
+        changeFrames = 0;
+        if (unvoicedFrames++ == 0)
+            unvoicedSince = frame.time;
+
+        if (unvoicedFrames >= offsetFrames)
+        {
+            finishNote(unvoicedSince);
+            state = State::Silence;
+        }
+        return;
+    }
+
+    unvoicedFrames = 0;
+
+    // A different pitch held for a few frames ends the note and starts the next one
+    if (std::abs(frame.midiPitch - activeCentre) > pitchChangeSemitones)
+    {
+        if (changeFrames++ == 0)
+        {
+            changeSince = frame.time;
+            changePitchSum = 0.0f;
+        }
+        changePitchSum += frame.midiPitch;
+
+        if (changeFrames >= pitchChangeFrames)
+        {
+            finishNote(changeSince);
+            startNote(changeSince, changePitchSum / static_cast<float>(changeFrames), frame.levelDb, frame.clarity);
+            activeFrames = changeFrames;
+            changeFrames = 0;
+        }
+        return;
+    }
+
+    changeFrames = 0;
+
+    // A sharp rise in level on the same pitch is a new attack
+    if (frame.levelDb - previousLevelDb > reattackDb)
+    {
+        finishNote(frame.time);
+        startNote(frame.time, frame.midiPitch, frame.levelDb, frame.clarity);
+        return;
+    }
+
+    ++activeFrames;
+    activeCentre += (frame.midiPitch - activeCentre) / static_cast<float>(activeFrames);
+    activeClaritySum += frame.clarity;
+    ++activeClarityFrames;
+    if (activeFrames <= velocityFrames)
+        activePeakDb = std::max(activePeakDb, frame.levelDb);
+}
+
+void MonophonicTranscriber::startNote(double time, float midiPitch, float levelDb, float clarity)
+{
+    state = State::Note;
+    activeNote = NoteEvent();
+    activeNote.startTime = time;
+    activeCentre = midiPitch;
+    activeFrames = 1;
+    activePeakDb = levelDb;
+    activeClaritySum = clarity;
+    activeClarityFrames = 1;
+    unvoicedFrames = 0;
+    changeFrames = 0;
+    currentNote.store(juce::jlimit(0, 127, juce::roundToInt(midiPitch)));
+}
+
+void MonophonicTranscriber::finishNote(double endTime)
+{
+    activeNote.noteNumber = juce::jlimit(0, 127, juce::roundToInt(activeCentre));
+    activeNote.velocity = levelToVelocity(activePeakDb);
+    activeNote.duration = std::max(endTime - activeNote.startTime, getHopSeconds());
+    activeNote.confidence = juce::jlimit(0.0f, 1.0f, activeClaritySum / static_cast<float>(activeClarityFrames));
+    pushNote(activeNote);
+    currentNote.store(-1);
+}
+
+void MonophonicTranscriber::pushNote(const NoteEvent& note)
+{
+    // Dropped if the message thread has stopped draining
+    int start1, size1, start2, size2;
+    noteFifo.prepareToWrite(1, start1, size1, start2, size2);
+    if (size1 > 0)
+        noteQueue[static_cast<size_t>(start1)] = note;
+    noteFifo.finishedWrite(size1);
+}
+
+void MonophonicTranscriber::pushPitchPoint(const PitchPoint& point)
+{
+    int start1, size1, start2, size2;
+    contourFifo.prepareToWrite(1, start1, size1, start2, size2);
+    if (size1 > 0)
+        contourQueue[static_cast<size_t>(start1)] = point;
+    contourFifo.finishedWrite(size1);
+}
+
+int MonophonicTranscriber::popNotes(std::vector<NoteEvent>& destination)
+{
+    const int available = noteFifo.getNumReady();
+    int start1, size1, start2, size2;
+    noteFifo.prepareToRead(available, start1, size1, start2, size2);
+    destination.insert(destination.end(), noteQueue.begin() + start1, noteQueue.begin() + start1 + size1);
+    destination.insert(destination.end(), noteQueue.begin() + start2, noteQueue.begin() + start2 + size2);
+    noteFifo.finishedRead(size1 + size2);
+    return size1 + size2;
+}
+
+int MonophonicTranscriber::popContour(std::vector<PitchPoint>& destination)
+{
+    const int available = contourFifo.getNumReady();
+    int start1, size1, start2, size2;
+    contourFifo.prepareToRead(available, start1, size1, start2, size2);
+    destination.insert(destination.end(), contourQueue.begin() + start1, contourQueue.begin() + start1 + size1);
+    destination.insert(destination.end(), contourQueue.begin() + start2, contourQueue.begin() + start2 + size2);
+    contourFifo.finishedRead(size1 + size2);
+    return size1 + size2;
+}
+
+float MonophonicTranscriber::levelToVelocity(float levelDb)
+{
+    // -60 dBFS RMS plays pianissimo, -6 dBFS fortissimo
+    return juce::jlimit(1.0f, 127.0f, juce::jmap(levelDb, -60.0f, -6.0f, 1.0f, 127.0f));
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "MemoryLedger.h"
+#include "NoteEvents.h"
+
+/**
+ * Monophonic Transcriber
+ * Turns a live monophonic input (voice, bass, lead) into notes as it plays.
+ * Each hop analyses the latest window with the McLeod pitch method: an
+ * FFT-based normalised square difference function gives the period and a
+ * clarity score. A small state machine with onset and offset hysteresis then
+ * segments the frames into notes. It does constant work per frame and never
+ * looks back at earlier frames. Finished notes and every frame's pitch go into
+ * lock-free queues, and the message thread drains them in the shared NoteEvent
+ * format. All memory is allocated in prepare(), so process() is realtime safe.
+ */
+class MonophonicTranscriber
+{
+public:
+    static constexpr float minFrequencyHz = 50.0f;
+    static constexpr float maxFrequencyHz = 1500.0f;
+    static constexpr int noteQueueSize = 256;
+    static constexpr int contourQueueSize = 2048;
+
+    // Analysis buffers are charged to the ledger's audio history account when one is given
+    explicit MonophonicTranscriber(MemoryLedger* ledger = nullptr);
+    ~MonophonicTranscriber();
+
+    // Message thread: sizes the window (about 40 ms) and hop for the sample rate
+    void prepare(double sampleRate);
+    void reset();
+
+    // Audio thread: downmixes every channel and analyses each completed hop
+    void process(const juce::AudioBuffer<float>& buffer);
+
+    // Message thread: appends what was detected since the last call; returns how many were added
+    int popNotes(std::vector<NoteEvent>& destination);
+    int popContour(std::vector<PitchPoint>& destination);
+
+    // MIDI note currently sounding, or -1
+    int getCurrentNote() const { return currentNote.load(); }
+
+    double getHopSeconds() const { return hopSize / sampleRate; }
+    double getLatencySeconds() const { return windowSize / sampleRate; }
+
+    // Segmentation tuning
+    void setClarityThreshold(float threshold) { clarityThreshold = threshold; }
+    void setSilenceThresholdDb(float decibels) { silenceThresholdDb = decibels; }
+
+private:
+    enum class State
+    {
+        Silence,
+        Note
+    };
+
+    struct Frame
+    {
+        double time = 0.0;
+        float midiPitch = 0.0f;
+        float clarity = 0.0f;
+        float levelDb = -100.0f;
+        bool voiced = false;
+    };
+
+    void analyseFrame();
+    bool estimatePitch(float& periodSamples, float& clarity);
+    void advanceStateMachine(const Frame& frame);
+    void startNote(double time, float midiPitch, float levelDb, float clarity);
+    void finishNote(double endTime);
+    void pushNote(const NoteEvent& note);
+    void pushPitchPoint(const PitchPoint& point);
+
+    static float levelToVelocity(float levelDb);
+
+    double sampleRate = 44100.0;
+    int fftOrder = 0;
+    int windowSize = 0;
+    int hopSize = 0;
+    int minLag = 0;
+    int maxLag = 0;
+
+    std::unique_ptr<juce::dsp::FFT> fft;
+    TrackedVector<float> inputRing;   // windowSize samples, written circularly
+    TrackedVector<float> frameBuffer; // unrolled window
+    TrackedVector<float> fftBuffer;   // 2 * FFT size, as juce::dsp::FFT wants for real transforms
+    TrackedVector<float> nsdf;        // normalised square difference per lag
+    int ringPosition = 0;
+    int samplesUntilHop = 0;
+    int samplesBuffered = 0;
+    std::int64_t totalSamples = 0;
+
+    // Segmentation
+    float clarityThreshold = 0.8f;
+    float silenceThresholdDb = -50.0f;
+    static constexpr int onsetFrames = 2;     // voiced frames before a note starts
+    static constexpr int offsetFrames = 3;    // unvoiced frames before it ends
+    static constexpr int pitchChangeFrames = 3;
+    static constexpr float pitchChangeSemitones = 0.7f;
+    static constexpr float reattackDb = 9.0f; // level jump that restarts a held pitch
+    static constexpr int velocityFrames = 4;  // frames after the onset that set the velocity
+
+    State state = State::Silence;
+    int candidateFrames = 0;
+    double candidateTime = 0.0;
+    float candidatePitchSum = 0.0f;
+    float candidatePeakDb = -100.0f;
+    int unvoicedFrames = 0;
+    double unvoicedSince = 0.0;
+    int changeFrames = 0;
+    double changeSince = 0.0;
+    float changePitchSum = 0.0f;
+    float previousLevelDb = -100.0f;
+
+    NoteEvent activeNote;
+    float activeCentre = 0.0f;     // running mean of the note's pitch
+    int activeFrames = 0;
+    float activePeakDb = -100.0f;
+    float activeClaritySum = 0.0f;
+    int activeClarityFrames = 1;
+
+    std::atomic<int> currentNote { -1 };
+
+    // Single producer (audio thread), single consumer (message thread)
+    juce::AbstractFifo noteFifo { noteQueueSize };
+    std::array<NoteEvent, noteQueueSize> noteQueue;
+    juce::AbstractFifo contourFifo { contourQueueSize };
+    std::array<PitchPoint, contourQueueSize> contourQueue;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MonophonicTranscriber)
+};
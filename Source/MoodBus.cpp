@@ -0,0 +1,166 @@
+#include "MoodBus.h"
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+struct alignas(64) MoodBus::Slot
+{
+    static constexpr int moodWords = (maxMoodLength + 1) / 4;
+
+    // Odd while a publisher is writing; everything below is only valid when it reads the same before and after
+    std::atomic<std::uint32_t> sequence;
+    std::atomic<std::uint32_t> publishedAtMs;
+    std::atomic<std::uint32_t> tempoBits;
+    std::atomic<std::uint32_t> energyBits;
+    std::array<std::atomic<std::uint32_t>, moodWords> mood;
+};
+
+namespace
+{
+    // Versioned, so a build with another slot layout never maps this one
+    const char* const busFileName = "Aamati-MoodBus-v1.bin";
+    const char* const busLockName = "AamatiMoodBus";
+
+    // A write takes nanoseconds, so a few tries nearly always get a clean copy
+    constexpr int maxReadAttempts = 4;
+
+    // A publisher that died mid-write would leave its slot busy for good. After this many
+    // busy publishes in a row, roughly a few seconds of blocks, a live publisher closes the write.
+    constexpr int busyPublishLimit = 1000;
+
+    static_assert(std::atomic<std::uint32_t>::is_always_lock_free,
+                  "slots shared between processes need lock-free atomics");
+    static_assert(std::is_standard_layout<std::atomic<std::uint32_t>>::value
+                  && sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t),
+                  "slots are laid out in a file, so atomics must be plain words");
+
+    std::uint32_t toBits(float value)
+    {
+        std::uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    float fromBits(std::uint32_t bits)
+    {
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+}
+
+MoodBus::MoodBus()
+{
+    const auto file = juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile(busFileName);
+    const auto size = static_cast<juce::int64>(sizeof(Slot) * numChannels);
+
+    {
+        // The first instance on the machine creates the file zeroed, which is an empty bus; later ones map what is there
+        juce::InterProcessLock lock(busLockName);
+        const juce::InterProcessLock::ScopedLockType sl(lock);
+        if (file.getSize() < size)
+        {
+            juce::MemoryBlock zeros(static_cast<size_t>(size), true);
+            if (!file.replaceWithData(zeros.getData(), zeros.getSize()))
+                DBG("Could not create mood bus file: " << file.getFullPathName());
+        }
+    }
+
+    auto mapped = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readWrite);
+    if (mapped->getData() != nullptr && static_cast<juce::int64>(mapped->getSize()) >= size)
+    {
+        slots = static_cast<Slot*>(mapped->getData());
+        mappedFile = std::move(mapped);
+    }
+    else
+    {
+        DBG("Mood bus is local to this process; could not map " << file.getFullPathName());
+        static Slot localSlots[numChannels];
+        slots = localSlots;
+    }
+}
+
+MoodBus::~MoodBus() = default;
+
+bool MoodBus::publish(int channel, const char* mood, float tempo, float energy)
+{
+    if (channel < 0 || channel >= numChannels || mood == nullptr)
+        return false;
+
+    auto& slot = slots[channel];
+    auto sequence = slot.sequence.load(std::memory_order_relaxed);
+    if ((sequence & 1u) != 0)
+    {
+        if (++busyPublishes >= busyPublishLimit)
+        {
+            slot.sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_relaxed);
+            busyPublishes = 0;
+        }
+        return false;
+    }
+
+    if (!slot.sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_acquire, std::memory_order_relaxed))
+        return false;
+    busyPublishes = 0;
+
+    // Readers that see the odd sequence, or a changed one afterwards, throw away what they copied
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.publishedAtMs.store(juce::jmax<std::uint32_t>(1, juce::Time::getMillisecondCounter()), std::memory_order_relaxed);
+    slot.tempoBits.store(toBits(tempo), std::memory_order_relaxed);
+    slot.energyBits.store(toBits(energy), std::memory_order_relaxed);
+
+    // Four characters per word, zero-padded; the last byte is always a terminator
+    bool ended = false;
+    for (int word = 0; word < Slot::moodWords; ++word)
+    {
+        std::uint32_t packed = 0;
+        for (int byte = 0; byte < 4; ++byte)
+        {
+            const int index = word * 4 + byte;
+            ended = ended || index >= maxMoodLength || mood[index] == '\0';
+            if (!ended)
+                packed |= static_cast<std::uint32_t>(static_cast<unsigned char>(mood[index])) << (8 * byte);
+        }
+        slot.mood[static_cast<size_t>(word)].store(packed, std::memory_order_relaxed);
+    }
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    return true;
+}
+
+bool MoodBus::read(int channel, Reading& reading, std::uint32_t maxAgeMs) const
+{
+    if (channel < 0 || channel >= numChannels)
+        return false;
+
+    const auto& slot = slots[channel];
+    for (int attempt = 0; attempt < maxReadAttempts; ++attempt)
+    {
+        const auto before = slot.sequence.load(std::memory_order_acquire);
+        if ((before & 1u) != 0)
+            continue;
+
+        Reading copy;
+        copy.publishedAtMs = slot.publishedAtMs.load(std::memory_order_relaxed);
+        copy.tempo = fromBits(slot.tempoBits.load(std::memory_order_relaxed));
+        copy.energy = fromBits(slot.energyBits.load(std::memory_order_relaxed));
+        for (int word = 0; word < Slot::moodWords; ++word)
+        {
+            const auto packed = slot.mood[static_cast<size_t>(word)].load(std::memory_order_relaxed);
+            for (int byte = 0; byte < 4; ++byte)
+                copy.mood[word * 4 + byte] = static_cast<char>((packed >> (8 * byte)) & 0xffu);
+        }
+        copy.mood[maxMoodLength] = '\0';
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == before)
+        {
+            reading = copy;
+            break;
+        }
+    }
+
+    return reading.publishedAtMs != 0 && juce::Time::getMillisecondCounter() - reading.publishedAtMs <= maxAgeMs;
+}
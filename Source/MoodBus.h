@@ -0,0 +1,63 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <cstdint>
+#include <memory>
+
+/**
+ * Mood Bus
+ * Lets one Aamati instance, say the one on the drum bus, broadcast its mood
+ * and tempo so that the other instances don't each run analysis and
+ * inference. Each channel of the bus is a seqlock slot in a small
+ * memory-mapped file in the temp folder. Instances in separate plugin
+ * processes on the same machine therefore share it too. Publishing and
+ * reading never block or allocate, so both run on the audio thread. A
+ * publisher that finds the slot mid-write skips that update. A reader that
+ * keeps catching writes keeps the last value it read. If the file cannot be
+ * mapped, the bus falls back to slots shared within this process only.
+ */
+class MoodBus
+{
+public:
+    static constexpr int numChannels = 16;
+    static constexpr int maxMoodLength = 31;
+    static constexpr std::uint32_t defaultMaxAgeMs = 2000; // a publisher silent this long counts as gone
+
+    enum class Mode
+    {
+        Off,
+        Publish,
+        Subscribe
+    };
+
+    struct Reading
+    {
+        char mood[maxMoodLength + 1] = {};
+        float tempo = 0.0f;
+        float energy = 0.0f;
+        std::uint32_t publishedAtMs = 0;   // juce::Time::getMillisecondCounter(), the same in every process; 0 if never read
+    };
+
+    MoodBus();
+    ~MoodBus();
+
+    // Whether other processes see the same slots, or only instances in this one
+    bool isShared() const { return mappedFile != nullptr; }
+
+    // Audio thread: false if the update was skipped because another publisher was writing the channel.
+    // Moods longer than maxMoodLength are cut short.
+    bool publish(int channel, const char* mood, float tempo, float energy);
+
+    // Audio thread: refreshes reading from the channel, keeping its previous contents if writes kept getting in the way.
+    // True if reading then holds a value published within maxAgeMs.
+    bool read(int channel, Reading& reading, std::uint32_t maxAgeMs = defaultMaxAgeMs) const;
+
+private:
+    struct Slot;
+
+    Slot* slots = nullptr;
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    int busyPublishes = 0; // audio thread only
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MoodBus)
+};
@@ -0,0 +1,350 @@
+#include "MoodRemixer.h"
+#include "AIMidiGenerator.h"
+#include "EmotionalOptimizer.h"
+#include "GrooveShaper.h"
+#include "MidiFile.h"
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <map>
+
+namespace
+{
+    constexpr int drumChannel = 9;
+    constexpr float defaultTempo = 120.0f;
+
+    bool isMidiFile(const std::filesystem::path& path)
+    {
+        auto extension = path.extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return extension == ".mid" || extension == ".midi";
+    }
+
+    // FNV-1a of the input path: a file remixes the same way whichever worker picks it up
+    juce::int64 getFileSeed(const std::string& path)
+    {
+        std::uint64_t hash = 0xcbf29ce484222325ull;
+        for (const unsigned char c : path)
+            hash = (hash ^ c) * 0x100000001b3ull;
+        return static_cast<juce::int64>(hash);
+    }
+}
+
+//==============================================================================
+MoodRemixer::MoodRemixer(const Options& remixOptions)
+    : options(remixOptions)
+{
+    const auto secondary = options.secondaryMood.empty() ? options.mood : options.secondaryMood;
+
+    optimizer = std::make_unique<EmotionalOptimizer>();
+    optimizer->setMoodProfile(options.mood, secondary);
+
+    shaper = std::make_unique<GrooveShaper>();
+    shaper->setGrooveProfile(options.mood, options.grooveIntensity);
+
+    if (options.addRhythmLayer || options.addHarmonyLayer)
+        generator = std::make_unique<AIMidiGenerator>();
+}
+
+MoodRemixer::~MoodRemixer() = default;
+
+void MoodRemixer::applyMoodPipeline(std::vector<NoteEvent>& notes, EmotionalOptimizer* optimizer,
+                                    GrooveShaper* shaper, float tempo)
+{
+    if (optimizer)
+    {
+        auto midiNotes = NoteEvents::toMIDINotes(notes);
+        optimizer->processMIDINotes(midiNotes, tempo);
+        notes = NoteEvents::fromMIDINotes(midiNotes);
+    }
+    if (shaper)
+    {
+        auto messages = NoteEvents::toMidiMessages(notes);
+        shaper->processGroove(messages, tempo);
+        notes = NoteEvents::fromMidiMessages(messages);
+    }
+}
+
+MoodRemixer::Result MoodRemixer::remixFile(const std::string& inputPath, const std::string& outputPath)
+{
+    Result result;
+    result.inputPath = inputPath;
+    result.outputPath = outputPath;
+
+    smf::MidiFile midi;
+    if (!midi.read(inputPath))
+    {
+        result.error = "could not read MIDI file";
+        return result;
+    }
+
+    midi.doTimeAnalysis();
+    midi.linkNotePairs();
+
+    const auto seed = getFileSeed(inputPath);
+    optimizer->setRandomSeed(seed);
+    shaper->setRandomSeed(seed);
+    if (generator)
+        generator->setRandomSeed(seed);
+
+    // The pipeline works in seconds; notes keep the track their channel first appeared on
+    float tempo = 0.0f;
+    std::vector<NoteEvent> notes;
+    std::array<int, 16> channelTrack;
+    channelTrack.fill(-1);
+
+    for (int track = 0; track < midi.getTrackCount(); ++track)
+    {
+        for (int e = 0; e < midi[track].size(); ++e)
+        {
+            auto& event = midi[track][e];
+            if (tempo <= 0.0f && event.isTempo())
+                tempo = static_cast<float>(event.getTempoBPM());
+            if (!event.isNoteOn())
+                continue;
+
+            NoteEvent note;
+            note.startTime = event.seconds;
+            note.duration = event.isLinked() ? event.getDurationInSeconds() : 0.0;
+            note.noteNumber = event.getKeyNumber();
+            note.velocity = static_cast<float>(event.getVelocity());
+            note.channel = event.getChannel();
+            notes.push_back(note);
+
+            if (channelTrack[static_cast<size_t>(note.channel)] < 0)
+                channelTrack[static_cast<size_t>(note.channel)] = track;
+        }
+    }
+
+    if (tempo <= 0.0f)
+        tempo = defaultTempo;
+
+    result.notesIn = notes.size();
+    if (notes.empty())
+    {
+        result.error = "no notes to remix";
+        return result;
+    }
+
+    double length = 0.0;
+    for (const auto& note : notes)
+        length = std::max(length, note.startTime + note.duration);
+
+    if (options.quantizeStrength > 0.0f)
+    {
+        Quantizer::Settings settings;
+        settings.gridTicks = options.quantizeGridTicks;
+        settings.strength = options.quantizeStrength;
+        settings.tempo = tempo;
+        Quantizer(settings).quantize(notes);
+    }
+
+    applyMoodPipeline(notes, optimizer.get(), shaper.get(), tempo);
+    if (generator)
+        addGeneratedLayers(notes, tempo, length);
+
+    // Ticks come from the file's own tempo map, so tempo changes survive the round trip
+    struct PlacedNote
+    {
+        int onTick;
+        int offTick;
+        const NoteEvent* note;
+    };
+    std::vector<PlacedNote> placed;
+    placed.reserve(notes.size());
+    for (const auto& note : notes)
+    {
+        const int onTick = midi.getAbsoluteTickTime(std::max(0.0, note.startTime));
+        const int offTick = std::max(onTick + 1, midi.getAbsoluteTickTime(note.startTime + note.duration));
+        placed.push_back({ onTick, offTick, &note });
+    }
+
+    // Replace the notes; tempo, meter, program and controller events stay where they were
+    for (int track = 0; track < midi.getTrackCount(); ++track)
+        for (int e = 0; e < midi[track].size(); ++e)
+            if (midi[track][e].isNoteOn() || midi[track][e].isNoteOff())
+                midi[track][e].clear();
+    midi.removeEmpties();
+
+    for (const auto& p : placed)
+    {
+        const int channel = juce::jlimit(0, 15, p.note->channel);
+        int& track = channelTrack[static_cast<size_t>(channel)];
+        if (track < 0)
+            track = midi.addTrack();
+
+        const int key = juce::jlimit(0, 127, p.note->noteNumber);
+        midi.addNoteOn(track, p.onTick, channel, key, juce::jlimit(1, 127, juce::roundToInt(p.note->velocity)));
+        midi.addNoteOff(track, p.offTick, channel, key);
+    }
+    midi.sortTracks();
+    result.notesOut = placed.size();
+
+    std::error_code error;
+    const auto folder = std::filesystem::path(outputPath).parent_path();
+    if (!folder.empty())
+        std::filesystem::create_directories(folder, error);
+
+    if (!midi.write(outputPath))
+    {
+        result.error = "could not write " + outputPath;
+        return result;
+    }
+
+    result.succeeded = true;
+    return result;
+}
+
+void MoodRemixer::addGeneratedLayers(std::vector<NoteEvent>& notes, float tempo, double length)
+{
+    std::array<bool, 16> usedChannels {};
+    for (const auto& note : notes)
+        usedChannels[static_cast<size_t>(juce::jlimit(0, 15, note.channel))] = true;
+
+    AIMidiGenerator::GenerationContext context;
+    context.primaryMood = options.mood;
+    context.secondaryMood = options.secondaryMood.empty() ? options.mood : options.secondaryMood;
+    context.tempo = tempo;
+    generator->setGenerationContext(context);
+
+    auto addLayer = [&notes](const AIMidiGenerator::GeneratedPattern& pattern, int channel)
+    {
+        for (auto note : NoteEvents::fromMidiMessages(pattern.messages))
+        {
+            note.channel = channel;
+            notes.push_back(note);
+        }
+    };
+
+    // Layers are generated in the target mood; existing parts are never doubled
+    if (options.addRhythmLayer && !usedChannels[drumChannel])
+        addLayer(generator->generateRhythm(length, drumChannel + 1), drumChannel);
+
+    if (options.addHarmonyLayer)
+    {
+        for (int channel = 0; channel < 16; ++channel)
+        {
+            if (channel == drumChannel || usedChannels[static_cast<size_t>(channel)])
+                continue;
+            addLayer(generator->generateHarmony(length, channel + 1), channel);
+            break;
+        }
+    }
+}
+
+std::vector<std::string> MoodRemixer::findMidiFiles(const std::string& folder, bool recursive)
+{
+    std::vector<std::string> files;
+    std::error_code error;
+    const std::filesystem::path root(folder);
+
+    if (std::filesystem::is_regular_file(root, error))
+    {
+        if (isMidiFile(root))
+            files.push_back(root.string());
+        return files;
+    }
+
+    const auto addEntry = [&files](const std::filesystem::directory_entry& entry)
+    {
+        std::error_code entryError;
+        if (entry.is_regular_file(entryError) && isMidiFile(entry.path()))
+            files.push_back(entry.path().string());
+    };
+
+    const auto directoryOptions = std::filesystem::directory_options::skip_permission_denied;
+    if (recursive)
+    {
+        for (std::filesystem::recursive_directory_iterator it(root, directoryOptions, error), end; !error && it != end; it.increment(error))
+            addEntry(*it);
+    }
+    else
+    {
+        for (std::filesystem::directory_iterator it(root, directoryOptions, error), end; !error && it != end; it.increment(error))
+            addEntry(*it);
+    }
+
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+std::string MoodRemixer::getOutputPath(const std::string& inputPath, const std::string& inputRoot,
+                                       const std::string& outputRoot)
+{
+    const std::filesystem::path input(inputPath);
+    std::error_code error;
+    auto relative = std::filesystem::is_regular_file(inputRoot, error)
+                        ? input.filename()
+                        : input.lexically_relative(inputRoot);
+    if (relative.empty() || relative.begin()->string() == "..")
+        relative = input.filename();
+
+    return (std::filesystem::path(outputRoot) / relative).string();
+}
+
+//==============================================================================
+MoodRemixBatch::MoodRemixBatch(const MoodRemixer::Options& remixOptions, std::vector<Job> remixJobs, int threads)
+    : options(remixOptions),
+      jobs(std::move(remixJobs))
+{
+    if (threads <= 0)
+        threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    numThreads = static_cast<int>(std::min<size_t>(static_cast<size_t>(threads), std::max<size_t>(1, jobs.size())));
+}
+
+MoodRemixBatch::~MoodRemixBatch()
+{
+    cancel();
+    waitUntilFinished();
+}
+
+void MoodRemixBatch::start()
+{
+    if (started)
+        return;
+    started = true;
+
+    activeWorkers.store(numThreads);
+    workers.reserve(static_cast<size_t>(numThreads));
+    for (int i = 0; i < numThreads; ++i)
+        workers.emplace_back([this] { runWorker(); });
+}
+
+void MoodRemixBatch::waitUntilFinished()
+{
+    for (auto& worker : workers)
+        if (worker.joinable())
+            worker.join();
+}
+
+std::vector<MoodRemixer::Result> MoodRemixBatch::getFailures() const
+{
+    std::lock_guard<std::mutex> lock(failureLock);
+    return failures;
+}
+
+void MoodRemixBatch::runWorker()
+{
+    // Engines are built once per worker and reused for every file it claims
+    MoodRemixer remixer(options);
+
+    while (!cancelled.load())
+    {
+        const auto index = nextJob.fetch_add(1);
+        if (index >= jobs.size())
+            break;
+
+        auto result = remixer.remixFile(jobs[index].inputPath, jobs[index].outputPath);
+        if (!result.succeeded)
+        {
+            failed.fetch_add(1);
+            std::lock_guard<std::mutex> lock(failureLock);
+            failures.push_back(std::move(result));
+        }
+        completed.fetch_add(1);
+    }
+
+    activeWorkers.fetch_sub(1);
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "NoteEvents.h"
+#include "Quantizer.h"
+
+class EmotionalOptimizer;
+class GrooveShaper;
+class AIMidiGenerator;
+
+/**
+ * Mood Remixer
+ * Offline MIDI-to-MIDI remixing. A file's notes go through the same pipeline as
+ * live transcription: the EmotionalOptimizer for the target mood, then the
+ * GrooveShaper with that mood's groove profile. Generated rhythm and harmony
+ * layers can be added on top. Tempo, time signature, program and controller
+ * events are kept as they were; only the notes are replaced. Each instance
+ * owns its engines, so one instance serves one thread.
+ */
+class MoodRemixer
+{
+public:
+    struct Options
+    {
+        std::string mood = "chill";
+        std::string secondaryMood;      // empty means the same as mood
+        float grooveIntensity = 0.8f;
+        bool addRhythmLayer = false;    // only when the file has no drums of its own
+        bool addHarmonyLayer = false;   // on the first channel the file doesn't use
+        float quantizeStrength = 0.0f;  // tightens the input before the mood pipeline; 0 leaves it alone
+        int quantizeGridTicks = Quantizer::ticksPerQuarter / 4;
+    };
+
+    struct Result
+    {
+        std::string inputPath;
+        std::string outputPath;
+        bool succeeded = false;
+        std::string error;
+        size_t notesIn = 0;
+        size_t notesOut = 0;
+    };
+
+    explicit MoodRemixer(const Options& options);
+    ~MoodRemixer();
+
+    // Reads inputPath, remixes it and writes outputPath, creating its folder if needed
+    Result remixFile(const std::string& inputPath, const std::string& outputPath);
+
+    // The note pipeline shared with live transcription; either engine may be null
+    static void applyMoodPipeline(std::vector<NoteEvent>& notes, EmotionalOptimizer* optimizer,
+                                  GrooveShaper* shaper, float tempo);
+
+    // .mid and .midi files under folder, sorted so batches run in a repeatable order
+    static std::vector<std::string> findMidiFiles(const std::string& folder, bool recursive = true);
+
+    // Where a file under inputRoot goes under outputRoot, keeping its relative path
+    static std::string getOutputPath(const std::string& inputPath, const std::string& inputRoot,
+                                     const std::string& outputRoot);
+
+private:
+    void addGeneratedLayers(std::vector<NoteEvent>& notes, float tempo, double length);
+
+    Options options;
+    std::unique_ptr<EmotionalOptimizer> optimizer;
+    std::unique_ptr<GrooveShaper> shaper;
+    std::unique_ptr<AIMidiGenerator> generator;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MoodRemixer)
+};
+
+/**
+ * Mood Remix Batch
+ * Runs a MoodRemixer job over many files on worker threads. Each worker builds
+ * its own remixer once and then claims files one at a time from a shared
+ * counter. Only the file being remixed is in memory, however large the library,
+ * and a slow file never holds the others back. Progress can be read from any
+ * thread while the job runs.
+ */
+class MoodRemixBatch
+{
+public:
+    struct Job
+    {
+        std::string inputPath;
+        std::string outputPath;
+    };
+
+    // numThreads 0 uses every hardware thread
+    MoodRemixBatch(const MoodRemixer::Options& options, std::vector<Job> jobs, int numThreads = 0);
+    ~MoodRemixBatch();
+
+    void start();
+    void cancel() { cancelled.store(true); }
+    void waitUntilFinished();
+
+    size_t getTotal() const { return jobs.size(); }
+    size_t getCompleted() const { return completed.load(); }
+    size_t getFailed() const { return failed.load(); }
+    bool isFinished() const { return activeWorkers.load() == 0 && started; }
+    int getNumThreads() const { return numThreads; }
+
+    // Results of the files that failed so far
+    std::vector<MoodRemixer::Result> getFailures() const;
+
+private:
+    void runWorker();
+
+    const MoodRemixer::Options options;
+    const std::vector<Job> jobs;
+    int numThreads = 1;
+    bool started = false;
+
+    std::vector<std::thread> workers;
+    std::atomic<size_t> nextJob { 0 };
+    std::atomic<size_t> completed { 0 };
+    std::atomic<size_t> failed { 0 };
+    std::atomic<int> activeWorkers { 0 };
+    std::atomic<bool> cancelled { false };
+
+    mutable std::mutex failureLock;
+    std::vector<MoodRemixer::Result> failures;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MoodRemixBatch)
+};
@@ -0,0 +1,221 @@
+#include "MotifEngine.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr int minMotifLength = 3;
+    constexpr int maxDuration = 32; // two bars of sixteenths
+
+    int floorDivide(int value, int divisor)
+    {
+        return value >= 0 ? value / divisor : -((divisor - 1 - value) / divisor);
+    }
+}
+
+MotifEngine::MotifEngine(const Parameters& engineParameters)
+    : parameters(engineParameters)
+{
+    for (int pitchClass = 0; pitchClass < 12; ++pitchClass)
+        if ((parameters.scaleMask >> pitchClass) & 1u)
+            scale[static_cast<size_t>(scaleSize++)] = pitchClass;
+
+    // An empty mask would leave nothing to step through
+    if (scaleSize == 0)
+        scale[static_cast<size_t>(scaleSize++)] = 0;
+}
+
+MotifEngine::Motif MotifEngine::createMotif(juce::Random& random) const
+{
+    Motif motif;
+    motif.length = juce::jlimit(minMotifLength, maxMotifLength,
+                                minMotifLength + juce::roundToInt(parameters.complexity * 3.0f));
+
+    // Energetic motifs move in shorter notes and leap more often
+    const int baseDuration = parameters.energy > 0.66f ? 1 : (parameters.energy > 0.33f ? 2 : 4);
+    const float leapChance = 0.15f + 0.35f * parameters.energy;
+
+    for (int i = 0; i < motif.length; ++i)
+    {
+        int interval = 0;
+        if (i > 0)
+        {
+            const int size = random.nextFloat() < leapChance ? 2 + random.nextInt(3) : 1;
+            interval = random.nextFloat() < 0.5f ? size : -size;
+        }
+        motif.intervals[static_cast<size_t>(i)] = static_cast<std::int8_t>(interval);
+
+        int duration = baseDuration * (random.nextFloat() < 0.3f ? 2 : 1);
+        if (i == motif.length - 1)
+            duration *= 2; // land on the last note
+        motif.durations[static_cast<size_t>(i)] = static_cast<std::uint8_t>(std::min(duration, maxDuration));
+    }
+    return motif;
+}
+
+int MotifEngine::buildPhrase(const Motif& motif, double durationSeconds, juce::Random& random, std::vector<Note>& destination) const
+{
+    if (motif.length == 0 || durationSeconds <= 0.0)
+        return 0;
+
+    const double sixteenth = 60.0 / std::max(1.0f, parameters.tempo) / 4.0;
+    const auto firstNew = destination.size();
+    destination.reserve(firstNew + static_cast<size_t>(durationSeconds / sixteenth) + 1);
+
+    const int baseVelocity = static_cast<int>(40 + parameters.energy * 60); // as for generated melodies
+    int anchor = 0;
+    double time = 0.0;
+
+    for (int instance = 0; time < durationSeconds; ++instance)
+    {
+        Motif development = motif;
+        const double remaining = durationSeconds - time;
+
+        if (remaining < getSixteenths(motif) * sixteenth * 1.5)
+        {
+            // Cadence: the head of the motif, broadened, landing on a tonic
+            fragment(development, 0, std::min(2, development.length));
+            augment(development);
+            const int landing = anchor + getSpan(development);
+            anchor += floorDivide(landing + scaleSize / 2, scaleSize) * scaleSize - landing;
+        }
+        else if (instance == 1)
+        {
+            // Sequence: the answer restates the motif a step or two away
+            anchor += (random.nextFloat() < 0.5f ? 1 : -1) * (1 + random.nextInt(2));
+        }
+        else if (instance > 1)
+        {
+            if (random.nextFloat() < parameters.complexity)
+            {
+                switch (random.nextInt(5))
+                {
+                    case 0: invert(development); break;
+                    case 1: retrograde(development); break;
+                    case 2: diminish(development); break;
+                    case 3: augment(development); break;
+                    default:
+                        fragment(development, random.nextInt(std::max(1, development.length - 1)), 2);
+                        break;
+                }
+            }
+            anchor += random.nextInt(5) - 2;
+        }
+
+        // Drift back towards the tonic octave so long phrases stay in register
+        if (std::abs(anchor) > scaleSize)
+            anchor -= (anchor > 0 ? 1 : -1) * scaleSize;
+
+        int degree = anchor;
+        for (int i = 0; i < development.length && time < durationSeconds; ++i)
+        {
+            degree += development.intervals[static_cast<size_t>(i)];
+            const double slot = development.durations[static_cast<size_t>(i)] * sixteenth;
+
+            // Motif heads are accented and the phrase swells towards its middle
+            const double arch = std::sin(juce::MathConstants<double>::pi * time / durationSeconds);
+            const int velocity = baseVelocity + (i == 0 ? 8 : 0) + static_cast<int>(arch * 10.0);
+
+            Note note;
+            note.startTime = time;
+            note.duration = std::min(slot, durationSeconds - time) * parameters.gate;
+            note.noteNumber = degreeToNote(degree);
+            note.velocity = juce::jlimit(1, 127, velocity);
+            destination.push_back(note);
+
+            time += slot;
+        }
+    }
+
+    return static_cast<int>(destination.size() - firstNew);
+}
+
+void MotifEngine::invert(Motif& motif)
+{
+    for (int i = 0; i < motif.length; ++i)
+        motif.intervals[static_cast<size_t>(i)] = static_cast<std::int8_t>(-motif.intervals[static_cast<size_t>(i)]);
+}
+
+void MotifEngine::retrograde(Motif& motif)
+{
+    if (motif.length == 0)
+        return;
+
+    // The last note becomes the first, and every step is taken backwards
+    const int span = getSpan(motif);
+    std::reverse(motif.intervals.begin() + 1, motif.intervals.begin() + motif.length);
+    for (int i = 1; i < motif.length; ++i)
+        motif.intervals[static_cast<size_t>(i)] = static_cast<std::int8_t>(-motif.intervals[static_cast<size_t>(i)]);
+    motif.intervals[0] = static_cast<std::int8_t>(span);
+    std::reverse(motif.durations.begin(), motif.durations.begin() + motif.length);
+}
+
+void MotifEngine::augment(Motif& motif)
+{
+    for (int i = 0; i < motif.length; ++i)
+    {
+        auto& duration = motif.durations[static_cast<size_t>(i)];
+        duration = static_cast<std::uint8_t>(std::min(duration * 2, maxDuration));
+    }
+}
+
+void MotifEngine::diminish(Motif& motif)
+{
+    for (int i = 0; i < motif.length; ++i)
+    {
+        auto& duration = motif.durations[static_cast<size_t>(i)];
+        duration = static_cast<std::uint8_t>(std::max(1, duration / 2));
+    }
+}
+
+void MotifEngine::fragment(Motif& motif, int first, int count)
+{
+    first = juce::jlimit(0, std::max(0, motif.length - 1), first);
+    count = juce::jlimit(0, motif.length - first, count);
+
+    // The fragment's first note keeps the pitch it had in the whole motif
+    int offset = 0;
+    for (int i = 0; i <= first; ++i)
+        offset += motif.intervals[static_cast<size_t>(i)];
+
+    for (int i = 0; i < count; ++i)
+    {
+        motif.intervals[static_cast<size_t>(i)] = motif.intervals[static_cast<size_t>(first + i)];
+        motif.durations[static_cast<size_t>(i)] = motif.durations[static_cast<size_t>(first + i)];
+    }
+    if (count > 0)
+        motif.intervals[0] = static_cast<std::int8_t>(offset);
+    motif.length = count;
+}
+
+int MotifEngine::getSpan(const Motif& motif)
+{
+    int span = 0;
+    for (int i = 0; i < motif.length; ++i)
+        span += motif.intervals[static_cast<size_t>(i)];
+    return span;
+}
+
+int MotifEngine::getSixteenths(const Motif& motif)
+{
+    int sixteenths = 0;
+    for (int i = 0; i < motif.length; ++i)
+        sixteenths += motif.durations[static_cast<size_t>(i)];
+    return sixteenths;
+}
+
+std::uint16_t MotifEngine::getScaleMask(const std::vector<int>& pitchClasses)
+{
+    std::uint16_t mask = 0;
+    for (int pitchClass : pitchClasses)
+        mask = static_cast<std::uint16_t>(mask | (1u << (((pitchClass % 12) + 12) % 12)));
+    return mask;
+}
+
+int MotifEngine::degreeToNote(int degree) const
+{
+    const int octave = floorDivide(degree, scaleSize);
+    const int step = degree - octave * scaleSize;
+    return juce::jlimit(0, 127, parameters.tonic + 12 * octave + scale[static_cast<size_t>(step)]);
+}
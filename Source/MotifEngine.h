@@ -0,0 +1,80 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Motif Engine
+ * Builds melodies by developing a short motif instead of drawing every note
+ * independently. A motif is a few scale-step intervals and durations in
+ * fixed-size arrays. Phrases are made of restatements of it, each with a
+ * cheap transform: sequence (transposition within the scale), inversion,
+ * retrograde, augmentation, diminution or fragmentation. The last one becomes
+ * a cadence onto the tonic. Every transform is a single pass over the motif;
+ * building a phrase only allocates the notes it appends.
+ */
+class MotifEngine
+{
+public:
+    static constexpr int maxMotifLength = 8;
+
+    // intervals[0] is the first note's offset from the phrase's current degree, the rest are
+    // steps from the previous note; durations are in sixteenths
+    struct Motif
+    {
+        std::array<std::int8_t, maxMotifLength> intervals {};
+        std::array<std::uint8_t, maxMotifLength> durations {};
+        int length = 0;
+    };
+
+    // Filled from the generator's context; energy and complexity are 0-1
+    struct Parameters
+    {
+        int tonic = 60;                  // MIDI note of scale degree 0
+        std::uint16_t scaleMask = 0x0ab5; // bit n set when the pitch class n semitones above the tonic is in the scale
+        float energy = 0.5f;             // shorter notes, wider leaps, louder
+        float complexity = 0.5f;         // longer motifs, more varied development
+        float tempo = 120.0f;
+        float gate = 0.9f;               // sounding share of each note's slot
+    };
+
+    struct Note
+    {
+        double startTime = 0.0;
+        double duration = 0.0;
+        int noteNumber = 60;
+        int velocity = 64;
+    };
+
+    explicit MotifEngine(const Parameters& parameters);
+
+    // A new motif in the parameters' character
+    Motif createMotif(juce::Random& random) const;
+
+    // Appends a phrase about durationSeconds long developed from motif; returns how many notes were added
+    int buildPhrase(const Motif& motif, double durationSeconds, juce::Random& random, std::vector<Note>& destination) const;
+
+    // Transforms, in place
+    static void invert(Motif& motif);
+    static void retrograde(Motif& motif);
+    static void augment(Motif& motif);
+    static void diminish(Motif& motif);
+    static void fragment(Motif& motif, int first, int count);
+
+    // Scale steps from the motif's anchor to its last note, and its length in sixteenths
+    static int getSpan(const Motif& motif);
+    static int getSixteenths(const Motif& motif);
+
+    static std::uint16_t getScaleMask(const std::vector<int>& pitchClasses);
+
+private:
+    int degreeToNote(int degree) const;
+
+    Parameters parameters;
+    std::array<int, 12> scale {}; // semitones above the tonic of each degree
+    int scaleSize = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MotifEngine)
+};
@@ -0,0 +1,124 @@
+#include "NoteEvents.h"
+#include "FastMath.h"
+
+#include <algorithm>
+#include <array>
+
+std::vector<juce::MidiMessage> NoteEvents::toMidiMessages(const std::vector<NoteEvent>& notes)
+{
+    std::vector<juce::MidiMessage> messages;
+    messages.reserve(notes.size() * 2);
+
+    for (const auto& note : notes)
+    {
+        const int channel = juce::jlimit(0, 15, note.channel) + 1;
+        const int number = juce::jlimit(0, 127, note.noteNumber);
+        const auto velocity = static_cast<juce::uint8>(juce::jlimit(1, 127, juce::roundToInt(note.velocity)));
+
+        auto noteOn = juce::MidiMessage::noteOn(channel, number, velocity);
+        noteOn.setTimeStamp(note.startTime);
+        messages.push_back(noteOn);
+
+        auto noteOff = juce::MidiMessage::noteOff(channel, number);
+        noteOff.setTimeStamp(note.startTime + std::max(0.0, note.duration));
+        messages.push_back(noteOff);
+    }
+
+    // Stable, so a note-off never moves ahead of the note-on it belongs to
+    std::stable_sort(messages.begin(), messages.end(), [](const juce::MidiMessage& a, const juce::MidiMessage& b)
+    {
+        return a.getTimeStamp() < b.getTimeStamp();
+    });
+    return messages;
+}
+
+std::vector<NoteEvent> NoteEvents::fromMidiMessages(const std::vector<juce::MidiMessage>& messages)
+{
+    std::vector<NoteEvent> notes;
+    // Index into notes of the sounding note for each channel and key, or -1
+    std::array<std::array<int, 128>, 16> sounding;
+    for (auto& channel : sounding)
+        channel.fill(-1);
+
+    double lastTime = 0.0;
+    for (const auto& message : messages)
+    {
+        lastTime = std::max(lastTime, message.getTimeStamp());
+        if (!message.isNoteOnOrOff())
+            continue;
+
+        const int channel = message.getChannel() - 1;
+        const int number = message.getNoteNumber();
+        int& open = sounding[static_cast<size_t>(channel)][static_cast<size_t>(number)];
+
+        // A repeated note-on closes the previous one
+        if (open >= 0)
+        {
+            auto& note = notes[static_cast<size_t>(open)];
+            note.duration = message.getTimeStamp() - note.startTime;
+            open = -1;
+        }
+
+        if (message.isNoteOn())
+        {
+            NoteEvent note;
+            note.startTime = message.getTimeStamp();
+            note.noteNumber = number;
+            note.velocity = static_cast<float>(message.getVelocity());
+            note.channel = channel;
+            open = static_cast<int>(notes.size());
+            notes.push_back(note);
+        }
+    }
+
+    for (const auto& channel : sounding)
+        for (int open : channel)
+            if (open >= 0)
+                notes[static_cast<size_t>(open)].duration = lastTime - notes[static_cast<size_t>(open)].startTime;
+
+    return notes;
+}
+
+std::vector<EmotionalOptimizer::MIDINote> NoteEvents::toMIDINotes(const std::vector<NoteEvent>& notes)
+{
+    std::vector<EmotionalOptimizer::MIDINote> result;
+    result.reserve(notes.size());
+    for (const auto& note : notes)
+    {
+        EmotionalOptimizer::MIDINote midiNote;
+        midiNote.noteNumber = note.noteNumber;
+        midiNote.velocity = note.velocity;
+        midiNote.startTime = static_cast<float>(note.startTime);
+        midiNote.duration = static_cast<float>(note.duration);
+        midiNote.channel = note.channel;
+        result.push_back(midiNote);
+    }
+    return result;
+}
+
+std::vector<NoteEvent> NoteEvents::fromMIDINotes(const std::vector<EmotionalOptimizer::MIDINote>& notes)
+{
+    std::vector<NoteEvent> result;
+    result.reserve(notes.size());
+    for (const auto& midiNote : notes)
+    {
+        NoteEvent note;
+        note.noteNumber = midiNote.noteNumber;
+        note.velocity = midiNote.velocity;
+        note.startTime = midiNote.startTime;
+        note.duration = midiNote.duration;
+        note.channel = midiNote.channel;
+        result.push_back(note);
+    }
+    return result;
+}
+
+float NoteEvents::frequencyToMidi(float frequencyHz)
+{
+    return 69.0f + 12.0f * FastMath::log2(frequencyHz / 440.0f);
+}
+
+float NoteEvents::midiToFrequency(float midiPitch)
+{
+    return 440.0f * FastMath::exp2((midiPitch - 69.0f) / 12.0f);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+#include "EmotionalOptimizer.h"
+
+/**
+ * Shared note-event format
+ * One representation for notes that come from analysis (audio transcription,
+ * chord and drum detection) instead of a MIDI file. Times are in seconds, like
+ * the timestamps GrooveShaper works on. Channels are numbered 0-15. The
+ * converters below feed the same notes to GrooveShaper (juce::MidiMessage
+ * pairs) and EmotionalOptimizer (MIDINote).
+ */
+struct NoteEvent
+{
+    double startTime = 0.0;
+    double duration = 0.0;
+    int noteNumber = 60;
+    float velocity = 64.0f;   // 1-127
+    int channel = 0;
+    float confidence = 1.0f;  // detector certainty, 0-1
+};
+
+// One frame of a pitch track, for contour displays
+struct PitchPoint
+{
+    double time = 0.0;
+    float midiPitch = 0.0f;   // fractional MIDI note; 0 when unvoiced
+    float confidence = 0.0f;
+};
+
+class NoteEvents
+{
+public:
+    // Note-on/note-off pairs with timestamps in seconds, sorted by time
+    static std::vector<juce::MidiMessage> toMidiMessages(const std::vector<NoteEvent>& notes);
+
+    // Pairs note-ons with their note-offs; a note still held at the end lasts until the last event
+    static std::vector<NoteEvent> fromMidiMessages(const std::vector<juce::MidiMessage>& messages);
+
+    static std::vector<EmotionalOptimizer::MIDINote> toMIDINotes(const std::vector<NoteEvent>& notes);
+    static std::vector<NoteEvent> fromMIDINotes(const std::vector<EmotionalOptimizer::MIDINote>& notes);
+
+    static float frequencyToMidi(float frequencyHz);
+    static float midiToFrequency(float midiPitch);
+};
@@ -0,0 +1,341 @@
+#include "OutputLimiter.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Priority weights; velocity contributes up to 1
+    constexpr float drumPriority = 0.3f;
+    constexpr float bassPriority = 0.2f;
+    constexpr int bassNoteLimit = 48;
+    constexpr float agePenaltyPerSecond = 0.25f;
+    constexpr float maxAgePenalty = 0.5f;
+}
+
+OutputLimiter::OutputLimiter()
+{
+    applySettings();
+    reset();
+}
+
+void OutputLimiter::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate > 0.0 ? newSampleRate : 44100.0;
+    applySettings();
+    reset();
+    stolenCount.store(0);
+    droppedCount.store(0);
+    coalescedCount.store(0);
+    deferredCount.store(0);
+}
+
+void OutputLimiter::reset()
+{
+    releases.head = releases.tail = 0;
+    others.head = others.tail = 0;
+    queuedSlots.fill(-1);
+    numQueued = 0;
+    numSounding = 0;
+    noteStates.fill(Idle);
+    tokens = burst;
+    lastRefill = 0;
+}
+
+void OutputLimiter::setSettings(const Settings& settings)
+{
+    maxVoices.store(settings.maxVoices);
+    maxEventsPerMs.store(settings.maxEventsPerMs);
+    burstEvents.store(settings.burstEvents);
+    maxDeferralMs.store(settings.maxDeferralMs);
+}
+
+void OutputLimiter::beginBlock()
+{
+    applySettings();
+}
+
+void OutputLimiter::applySettings()
+{
+    voiceLimit = juce::jlimit(1, maxTrackedVoices, maxVoices.load());
+
+    // A rate of zero or less means unlimited
+    const float rate = maxEventsPerMs.load();
+    eventsPerSample = rate > 0.0f ? static_cast<double>(rate) * 1000.0 / sampleRate : 0.0;
+    burst = static_cast<double>(std::max(1, burstEvents.load()));
+    maxDeferral = static_cast<std::int64_t>(std::max(0.0f, maxDeferralMs.load()) * sampleRate / 1000.0);
+}
+
+void OutputLimiter::refill(std::int64_t now)
+{
+    if (eventsPerSample <= 0.0)
+        tokens = burst;
+    else if (now > lastRefill)
+        tokens = std::min(burst, tokens + static_cast<double>(now - lastRefill) * eventsPerSample);
+
+    lastRefill = now;
+}
+
+size_t OutputLimiter::queueKey(std::uint8_t status, std::uint8_t channel, std::uint8_t data1)
+{
+    // Notes, aftertouch and controllers are told apart by their first data byte
+    const int type = juce::jlimit(0, 6, (status >> 4) - 8);
+    return static_cast<size_t>((type * 16 + (channel & 15)) * 128 + (status < 0xc0 ? (data1 & 127) : 0));
+}
+
+int OutputLimiter::findQueued(std::uint8_t status, std::uint8_t channel, std::uint8_t data1) const
+{
+    return queuedSlots[queueKey(status, channel, data1)];
+}
+
+void OutputLimiter::append(const Event& event)
+{
+    auto& ring = ringFor(event.status);
+    if (ring.tail - ring.head == static_cast<std::uint32_t>(ringSize))
+        compact(ring);
+
+    const auto slot = static_cast<int>(ring.tail++ % ringSize);
+    ring.slots[static_cast<size_t>(slot)] = event;
+    queuedSlots[queueKey(event.status, event.channel, event.data1)] = static_cast<std::int16_t>(slot);
+    ++numQueued;
+}
+
+void OutputLimiter::compact(Ring& ring)
+{
+    // At most queueSize events wait, so this frees at least half the ring
+    std::uint32_t write = ring.head;
+    for (std::uint32_t read = ring.head; read != ring.tail; ++read)
+    {
+        const Event event = ring.slots[read % ringSize];
+        if (event.status == 0)
+            continue;
+
+        const auto slot = static_cast<int>(write++ % ringSize);
+        ring.slots[static_cast<size_t>(slot)] = event;
+        queuedSlots[queueKey(event.status, event.channel, event.data1)] = static_cast<std::int16_t>(slot);
+    }
+    ring.tail = write;
+}
+
+void OutputLimiter::removeQueued(Ring& ring, int slot)
+{
+    auto& event = ring.slots[static_cast<size_t>(slot)];
+    queuedSlots[queueKey(event.status, event.channel, event.data1)] = -1;
+    event.status = 0;
+    --numQueued;
+
+    while (!ring.isEmpty() && ring.slots[ring.head % ringSize].status == 0)
+        ++ring.head;
+}
+
+void OutputLimiter::push(const Event& incoming)
+{
+    Event event = incoming;
+    if (isNoteOff(event))
+        event.status = 0x80;
+
+    auto& state = noteStates[key(event.channel, event.data1)];
+
+    if (event.status == 0x80)
+    {
+        if (state == Dropped)
+        {
+            state = Idle;
+            return;
+        }
+
+        // A note that ends before it could be sent never sounds
+        const int waitingOn = findQueued(0x90, event.channel, event.data1);
+        if (waitingOn >= 0)
+        {
+            removeQueued(others, waitingOn);
+            coalescedCount.fetch_add(1);
+            if (state != Sounding)
+                return;
+        }
+
+        if (state != Sounding || findQueued(0x80, event.channel, event.data1) >= 0)
+        {
+            coalescedCount.fetch_add(1);
+            return;
+        }
+    }
+    else
+    {
+        // Repeated note-ons keep the loudest velocity; controllers and the like keep the latest value
+        const int waiting = findQueued(event.status, event.channel, event.data1);
+        if (waiting >= 0)
+        {
+            auto& queued = others.slots[static_cast<size_t>(waiting)];
+            if (event.status == 0x90)
+                queued.data2 = std::max(queued.data2, event.data2);
+            else
+            {
+                queued.data1 = event.data1;
+                queued.data2 = event.data2;
+            }
+            coalescedCount.fetch_add(1);
+            return;
+        }
+    }
+
+    if (numQueued == queueSize)
+    {
+        // Full: a release or controller makes room by dropping the oldest waiting note-on
+        int victim = -1;
+        if (event.status != 0x90)
+            for (auto i = others.head; i != others.tail && victim < 0; ++i)
+                if (others.slots[i % ringSize].status == 0x90)
+                    victim = static_cast<int>(i % ringSize);
+
+        droppedCount.fetch_add(1);
+        if (victim < 0)
+            return;
+        removeQueued(others, victim);
+    }
+
+    append(event);
+}
+
+float OutputLimiter::getPriority(int channel, int note, int velocity, std::int64_t age) const
+{
+    float priority = static_cast<float>(velocity) / 127.0f;
+    if (channel == drumChannel)
+        priority += drumPriority;
+    else if (note < bassNoteLimit)
+        priority += bassPriority;
+
+    const float ageSeconds = static_cast<float>(static_cast<double>(std::max<std::int64_t>(0, age)) / sampleRate);
+    return priority - std::min(maxAgePenalty, ageSeconds * agePenaltyPerSecond);
+}
+
+int OutputLimiter::findVictim(std::int64_t now) const
+{
+    int victim = -1;
+    float lowest = 0.0f;
+    for (int i = 0; i < numSounding; ++i)
+    {
+        const auto& voice = sounding[static_cast<size_t>(i)];
+        const float priority = getPriority(voice.channel, voice.note, voice.velocity, now - voice.startTime);
+        if (victim < 0 || priority < lowest)
+        {
+            victim = i;
+            lowest = priority;
+        }
+    }
+    return victim;
+}
+
+void OutputLimiter::addVoice(const Event& event)
+{
+    auto& state = noteStates[key(event.channel, event.data1)];
+    if (state == Sounding)
+    {
+        // Retrigger: the note keeps its voice
+        for (int i = 0; i < numSounding; ++i)
+        {
+            auto& voice = sounding[static_cast<size_t>(i)];
+            if (voice.channel == event.channel && voice.note == event.data1)
+            {
+                voice.startTime = event.time;
+                voice.velocity = event.data2;
+            }
+        }
+        return;
+    }
+
+    state = Sounding;
+    if (numSounding < maxTrackedVoices)
+        sounding[static_cast<size_t>(numSounding++)] = { event.time, event.channel, event.data1, event.data2 };
+}
+
+void OutputLimiter::removeVoice(int channel, int note)
+{
+    for (int i = 0; i < numSounding; ++i)
+    {
+        const auto& voice = sounding[static_cast<size_t>(i)];
+        if (voice.channel == channel && voice.note == note)
+        {
+            sounding[static_cast<size_t>(i)] = sounding[static_cast<size_t>(--numSounding)];
+            return;
+        }
+    }
+}
+
+bool OutputLimiter::pop(std::int64_t now, Event& event)
+{
+    refill(now);
+
+    while (numQueued > 0 && tokens >= 1.0)
+    {
+        // Releases first, so a flood of note-ons cannot hold notes open
+        auto& ring = releases.isEmpty() ? others : releases;
+        const auto index = static_cast<int>(ring.head % ringSize);
+        const Event next = ring.slots[static_cast<size_t>(index)];
+        auto& state = noteStates[key(next.channel, next.data1)];
+
+        if (next.status == 0x90)
+        {
+            const float priority = getPriority(next.channel, next.data1, next.data2, 0);
+            if (now - next.time > maxDeferral)
+            {
+                removeQueued(ring, index);
+                droppedCount.fetch_add(1);
+                continue;
+            }
+
+            if (state != Sounding && numSounding >= voiceLimit)
+            {
+                const int victim = findVictim(now);
+                const auto& stolen = sounding[static_cast<size_t>(victim)];
+                if (priority <= getPriority(stolen.channel, stolen.note, stolen.velocity, now - stolen.startTime))
+                {
+                    removeQueued(ring, index);
+                    state = Dropped;
+                    droppedCount.fetch_add(1);
+                    continue;
+                }
+
+                // The stolen note's release goes out now; the new note follows on the next call
+                event = { now, 0x80, stolen.channel, stolen.note, 0 };
+                noteStates[key(stolen.channel, stolen.note)] = Dropped;
+                removeVoice(stolen.channel, stolen.note);
+                tokens -= 1.0;
+                stolenCount.fetch_add(1);
+                return true;
+            }
+
+            addVoice(next);
+        }
+        else if (next.status == 0x80)
+        {
+            removeVoice(next.channel, next.data1);
+            state = Idle;
+        }
+
+        removeQueued(ring, index);
+        tokens -= 1.0;
+        if (now > next.time)
+            deferredCount.fetch_add(1);
+
+        event = next;
+        event.time = now;
+        return true;
+    }
+
+    return false;
+}
+
+std::int64_t OutputLimiter::getNextReadyTime(std::int64_t now) const
+{
+    if (numQueued == 0)
+        return -1;
+
+    if (eventsPerSample <= 0.0)
+        return now;
+
+    const double available = std::min(burst, tokens + static_cast<double>(std::max<std::int64_t>(0, now - lastRefill)) * eventsPerSample);
+    if (available >= 1.0)
+        return now;
+
+    return now + static_cast<std::int64_t>(std::ceil((1.0 - available) / eventsPerSample));
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Output Limiter
+ * Last stage before generated MIDI reaches a synth. Dense blends and
+ * intensified patterns can start more notes at one instant than the synth
+ * has voices. They can also send more events per millisecond than a
+ * hardware MIDI link carries. A token bucket limits the event rate. Events
+ * over the budget wait in a fixed-size queue, where note-offs are served
+ * first so releases are never starved. Waiting events are indexed by status,
+ * channel and key, so a push or pop costs the same however long the queue
+ * is. Events that arrive while an equivalent one is still waiting are
+ * coalesced: repeated note-ons, repeated controller values, and a note whose
+ * note-off arrives before its note-on could be sent. A note-on that has
+ * waited longer than the deferral limit is dropped. Past the voice cap, a new
+ * note steals the sounding note with the lowest priority, or is dropped if it
+ * ranks lower than all of them. Priority comes from velocity, drum and bass
+ * register, and age. A dropped note's note-off is swallowed. Everything lives
+ * in fixed arrays, so the audio thread never allocates.
+ */
+class OutputLimiter
+{
+public:
+    static constexpr int queueSize = 1024;
+    static constexpr int maxTrackedVoices = 256;
+    static constexpr int drumChannel = 9;
+
+    struct Event
+    {
+        std::int64_t time = 0;   // samples
+        std::uint8_t status = 0; // high nibble only
+        std::uint8_t channel = 0; // 0-15
+        std::uint8_t data1 = 0;
+        std::uint8_t data2 = 0;
+    };
+
+    struct Settings
+    {
+        int maxVoices = 48;
+        float maxEventsPerMs = 4.0f;   // DIN MIDI carries about one three-byte message per millisecond
+        int burstEvents = 32;          // events that may go out at once after a quiet spell
+        float maxDeferralMs = 20.0f;   // a note-on that would be later than this is dropped
+    };
+
+    OutputLimiter();
+
+    // Message thread: sets the clock; times are samples at this rate
+    void prepare(double sampleRate);
+
+    // Audio thread: forgets waiting events and sounding notes
+    void reset();
+
+    // Safe to call while processing
+    void setSettings(const Settings& settings);
+
+    // Audio thread: picks up settings changes; call once per block before push() and pop()
+    void beginBlock();
+
+    // Audio thread: offers an event that is due now
+    void push(const Event& event);
+
+    // Audio thread: the next event allowed out at time now; false when none is
+    bool pop(std::int64_t now, Event& event);
+
+    // Audio thread: earliest time the rate allows the next waiting event, or -1 when nothing waits
+    std::int64_t getNextReadyTime(std::int64_t now) const;
+
+    int getNumSoundingNotes() const { return numSounding; }
+
+    // Totals since prepare(), for telemetry
+    std::uint64_t getNumStolen() const { return stolenCount.load(); }
+    std::uint64_t getNumDropped() const { return droppedCount.load(); }
+    std::uint64_t getNumCoalesced() const { return coalescedCount.load(); }
+    std::uint64_t getNumDeferred() const { return deferredCount.load(); }
+
+private:
+    enum NoteState : std::uint8_t
+    {
+        Idle,
+        Sounding,
+        Dropped // the next note-off is swallowed
+    };
+
+    struct Voice
+    {
+        std::int64_t startTime = 0;
+        std::uint8_t channel = 0;
+        std::uint8_t note = 0;
+        std::uint8_t velocity = 0;
+    };
+
+    // Waiting events in arrival order. A removed event leaves a hole (status 0)
+    // that is skipped once it reaches the head; a full ring is compacted.
+    static constexpr int ringSize = 2 * queueSize;
+    static constexpr int numQueueKeys = 7 * 16 * 128; // status 0x80-0xe0, channel, first data byte
+
+    struct Ring
+    {
+        std::array<Event, ringSize> slots;
+        std::uint32_t head = 0;
+        std::uint32_t tail = 0;
+
+        bool isEmpty() const { return head == tail; }
+    };
+
+    void applySettings();
+    void refill(std::int64_t now);
+    Ring& ringFor(std::uint8_t status) { return status == 0x80 ? releases : others; }
+    void append(const Event& event);
+    void compact(Ring& ring);
+    void removeQueued(Ring& ring, int slot);
+    int findQueued(std::uint8_t status, std::uint8_t channel, std::uint8_t data1) const;
+    int findVictim(std::int64_t now) const;
+    float getPriority(int channel, int note, int velocity, std::int64_t age) const;
+    void addVoice(const Event& event);
+    void removeVoice(int channel, int note);
+
+    static bool isNoteOn(const Event& event) { return event.status == 0x90 && event.data2 > 0; }
+    static bool isNoteOff(const Event& event) { return event.status == 0x80 || (event.status == 0x90 && event.data2 == 0); }
+    static size_t key(int channel, int note) { return static_cast<size_t>((channel & 15) * 128 + (note & 127)); }
+    static size_t queueKey(std::uint8_t status, std::uint8_t channel, std::uint8_t data1);
+
+    double sampleRate = 44100.0;
+
+    std::atomic<int> maxVoices { 48 };
+    std::atomic<float> maxEventsPerMs { 4.0f };
+    std::atomic<int> burstEvents { 32 };
+    std::atomic<float> maxDeferralMs { 20.0f };
+
+    // Audio thread only
+    int voiceLimit = 48;
+    double eventsPerSample = 0.0;
+    double burst = 32.0;
+    std::int64_t maxDeferral = 0;
+    double tokens = 0.0;
+    std::int64_t lastRefill = 0;
+
+    Ring releases; // note-offs
+    Ring others;
+    std::array<std::int16_t, numQueueKeys> queuedSlots; // slot in its ring, or -1
+    int numQueued = 0;
+
+    std::array<NoteState, 16 * 128> noteStates {};
+    std::array<Voice, maxTrackedVoices> sounding;
+    int numSounding = 0;
+
+    std::atomic<std::uint64_t> stolenCount { 0 };
+    std::atomic<std::uint64_t> droppedCount { 0 };
+    std::atomic<std::uint64_t> coalescedCount { 0 };
+    std::atomic<std::uint64_t> deferredCount { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OutputLimiter)
+};
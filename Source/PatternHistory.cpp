@@ -0,0 +1,282 @@
+#include "PatternHistory.h"
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
+
+namespace
+{
+    int getNoteKey(const juce::MidiMessage& message)
+    {
+        return (message.getChannel() & 15) * 128 + message.getNoteNumber();
+    }
+
+    bool isEarlier(const juce::MidiMessage& a, const juce::MidiMessage& b)
+    {
+        return a.getTimeStamp() < b.getTimeStamp();
+    }
+}
+
+//==============================================================================
+PatternVersion::PatternVersion(const AIMidiGenerator::GeneratedPattern& pattern, double barSeconds)
+    : secondsPerBar(std::max(0.01, barSeconds)),
+      duration(pattern.duration),
+      patternType(pattern.patternType),
+      confidence(pattern.confidence)
+{
+    auto messages = pattern.messages;
+    std::stable_sort(messages.begin(), messages.end(), isEarlier);
+
+    const auto barAt = [this](double time)
+    {
+        return static_cast<size_t>(std::max(0.0, std::floor(time / secondsPerBar)));
+    };
+
+    std::vector<Bar> contents(std::max<size_t>(1, static_cast<size_t>(std::ceil(duration / secondsPerBar - 1.0e-9))));
+
+    // A note-off joins the bar of the note-on it ends, first in first out
+    std::map<int, std::deque<size_t>> openNotes;
+
+    for (auto& message : messages)
+    {
+        size_t bar = barAt(message.getTimeStamp());
+        if (message.isNoteOn())
+        {
+            openNotes[getNoteKey(message)].push_back(bar);
+        }
+        else if (message.isNoteOff())
+        {
+            auto open = openNotes.find(getNoteKey(message));
+            if (open != openNotes.end() && !open->second.empty())
+            {
+                bar = open->second.front();
+                open->second.pop_front();
+            }
+        }
+
+        if (bar >= contents.size())
+            contents.resize(bar + 1);
+
+        message.setTimeStamp(message.getTimeStamp() - static_cast<double>(bar) * secondsPerBar);
+        contents[bar].push_back(message);
+    }
+
+    // Empty bars all point at one shared empty chunk
+    const auto empty = std::make_shared<const Bar>();
+    bars.reserve(contents.size());
+    for (auto& content : contents)
+        bars.push_back(content.empty() ? empty : std::make_shared<const Bar>(std::move(content)));
+}
+
+AIMidiGenerator::GeneratedPattern PatternVersion::toPattern() const
+{
+    AIMidiGenerator::GeneratedPattern pattern;
+    pattern.duration = duration;
+    pattern.patternType = patternType;
+    pattern.confidence = confidence;
+
+    size_t total = 0;
+    for (const auto& bar : bars)
+        total += bar->size();
+    pattern.messages.reserve(total);
+
+    for (size_t i = 0; i < bars.size(); ++i)
+    {
+        const double barStart = static_cast<double>(i) * secondsPerBar;
+        for (const auto& message : *bars[i])
+        {
+            pattern.messages.push_back(message);
+            pattern.messages.back().setTimeStamp(message.getTimeStamp() + barStart);
+        }
+    }
+
+    std::stable_sort(pattern.messages.begin(), pattern.messages.end(), isEarlier);
+    return pattern;
+}
+
+const PatternVersion::Bar& PatternVersion::getBar(int index) const
+{
+    static const Bar emptyBar;
+    if (index < 0 || index >= getNumBars())
+        return emptyBar;
+    return *bars[static_cast<size_t>(index)];
+}
+
+PatternVersion PatternVersion::withBar(int index, Bar messages) const
+{
+    PatternVersion version(*this);
+    if (index >= 0 && index < getNumBars())
+        version.bars[static_cast<size_t>(index)] = std::make_shared<const Bar>(std::move(messages));
+    return version;
+}
+
+PatternVersion::Bar PatternVersion::clipToBar(Bar messages, double barSeconds)
+{
+    std::stable_sort(messages.begin(), messages.end(), isEarlier);
+
+    Bar clipped;
+    clipped.reserve(messages.size());
+    std::map<int, std::deque<juce::MidiMessage>> openNotes;
+
+    for (const auto& message : messages)
+    {
+        if (message.getTimeStamp() >= barSeconds)
+            break;
+
+        if (message.isNoteOn())
+        {
+            openNotes[getNoteKey(message)].push_back(message);
+        }
+        else if (message.isNoteOff())
+        {
+            auto open = openNotes.find(getNoteKey(message));
+            if (open != openNotes.end() && !open->second.empty())
+                open->second.pop_front();
+        }
+        clipped.push_back(message);
+    }
+
+    for (const auto& open : openNotes)
+        for (const auto& noteOn : open.second)
+            clipped.push_back(juce::MidiMessage::noteOff(noteOn.getChannel(), noteOn.getNoteNumber())
+                                  .withTimeStamp(barSeconds));
+    return clipped;
+}
+
+PatternVersion PatternVersion::withEditedBars(int first, int last, const std::function<void(Bar&, int)>& edit) const
+{
+    PatternVersion version(*this);
+    first = std::max(0, first);
+    last = std::min(getNumBars(), last);
+
+    for (int i = first; i < last; ++i)
+    {
+        auto copy = std::make_shared<Bar>(*bars[static_cast<size_t>(i)]);
+        edit(*copy, i);
+        version.bars[static_cast<size_t>(i)] = std::move(copy);
+    }
+
+    return version;
+}
+
+int PatternVersion::countSharedBars(const PatternVersion& other) const
+{
+    int shared = 0;
+    const auto count = std::min(bars.size(), other.bars.size());
+    for (size_t i = 0; i < count; ++i)
+        shared += bars[i] == other.bars[i] ? 1 : 0;
+    return shared;
+}
+
+//==============================================================================
+PatternHistory::PatternHistory(MemoryLedger* ledger, size_t maxUndoSteps)
+    : maxSteps(std::max<size_t>(1, maxUndoSteps)),
+      charge(ledger, MemoryLedger::Subsystem::PatternLibrary)
+{
+}
+
+PatternHistory::~PatternHistory() = default;
+
+void PatternHistory::commit(PatternVersion version)
+{
+    if (!versions.empty())
+        versions.erase(versions.begin() + static_cast<std::ptrdiff_t>(current) + 1, versions.end());
+
+    versions.push_back(std::move(version));
+    while (versions.size() > maxSteps)
+        versions.pop_front();
+
+    current = versions.size() - 1;
+    updateMemoryCharge();
+}
+
+void PatternHistory::clear()
+{
+    versions.clear();
+    variations.clear();
+    current = 0;
+    updateMemoryCharge();
+}
+
+const PatternVersion& PatternHistory::getCurrent() const
+{
+    static const PatternVersion emptyVersion;
+    return versions.empty() ? emptyVersion : versions[current];
+}
+
+bool PatternHistory::undo()
+{
+    if (!canUndo())
+        return false;
+    --current;
+    return true;
+}
+
+bool PatternHistory::redo()
+{
+    if (!canRedo())
+        return false;
+    ++current;
+    return true;
+}
+
+void PatternHistory::storeVariation(const std::string& name, PatternVersion version)
+{
+    variations[name] = std::move(version);
+    updateMemoryCharge();
+}
+
+const PatternVersion* PatternHistory::getVariation(const std::string& name) const
+{
+    const auto found = variations.find(name);
+    return found != variations.end() ? &found->second : nullptr;
+}
+
+void PatternHistory::removeVariation(const std::string& name)
+{
+    variations.erase(name);
+    updateMemoryCharge();
+}
+
+std::vector<std::string> PatternHistory::getVariationNames() const
+{
+    std::vector<std::string> names;
+    names.reserve(variations.size());
+    for (const auto& entry : variations)
+        names.push_back(entry.first);
+    return names;
+}
+
+PatternHistory::Stats PatternHistory::getStats() const
+{
+    Stats stats;
+    std::unordered_set<const PatternVersion::Bar*> seen;
+
+    const auto count = [&stats, &seen](const PatternVersion& version)
+    {
+        ++stats.versions;
+        stats.bytes += sizeof(PatternVersion) + static_cast<size_t>(version.getNumBars()) * sizeof(PatternVersion::BarPointer);
+        for (int i = 0; i < version.getNumBars(); ++i)
+        {
+            const auto* bar = version.getBarPointer(i).get();
+            ++stats.barReferences;
+            if (seen.insert(bar).second)
+                stats.bytes += sizeof(PatternVersion::Bar) + bar->capacity() * sizeof(juce::MidiMessage);
+        }
+    };
+
+    for (const auto& version : versions)
+        count(version);
+    for (const auto& entry : variations)
+    {
+        stats.bytes += entry.first.capacity();
+        count(entry.second);
+    }
+
+    stats.uniqueBars = seen.size();
+    return stats;
+}
+
+void PatternHistory::updateMemoryCharge()
+{
+    charge.setBytes(getStats().bytes);
+}
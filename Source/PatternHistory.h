@@ -0,0 +1,114 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "AIMidiGenerator.h"
+#include "MemoryLedger.h"
+
+/**
+ * Pattern Version
+ * Immutable generated pattern, split into bar-sized chunks held by shared
+ * pointers. A note lives in the bar of its note-on together with its
+ * note-off, so a bar can be replaced without cutting notes in half.
+ * Controller messages go by their own time. Every edit returns a new version
+ * that shares all the bars it did not touch. Copying a version copies one
+ * pointer per bar, and an edit only costs the bars it changed.
+ */
+class PatternVersion
+{
+public:
+    using Bar = std::vector<juce::MidiMessage>; // timestamps relative to the bar start
+    using BarPointer = std::shared_ptr<const Bar>;
+
+    PatternVersion() = default;
+    PatternVersion(const AIMidiGenerator::GeneratedPattern& pattern, double secondsPerBar);
+
+    // Whole pattern, sorted by time
+    AIMidiGenerator::GeneratedPattern toPattern() const;
+
+    int getNumBars() const { return static_cast<int>(bars.size()); }
+    double getSecondsPerBar() const { return secondsPerBar; }
+    double getDuration() const { return duration; }
+    const Bar& getBar(int index) const;
+    const BarPointer& getBarPointer(int index) const { return bars[static_cast<size_t>(index)]; }
+
+    // New version with one bar replaced; the other bars are shared
+    PatternVersion withBar(int index, Bar messages) const;
+
+    // Fresh material cut to one bar: sorted, events at or past the bar line dropped and notes still
+    // held there ended at the line, so nothing spills into the next bar
+    static Bar clipToBar(Bar messages, double secondsPerBar);
+
+    // New version where edit has changed a copy of each bar in [first, last); bars outside are shared
+    PatternVersion withEditedBars(int first, int last, const std::function<void(Bar&, int)>& edit) const;
+
+    // Bars held by both versions without a copy
+    int countSharedBars(const PatternVersion& other) const;
+
+private:
+    std::vector<BarPointer> bars;
+    double secondsPerBar = 2.0;
+    double duration = 0.0;
+    std::string patternType;
+    float confidence = 0.0f;
+};
+
+/**
+ * Pattern History
+ * Undo and redo over pattern versions, plus named variations kept alongside.
+ * Versions share unchanged bars, so hundreds of steps and variations hold
+ * little more than the bars that were actually edited. Each distinct bar is
+ * charged to the ledger's pattern library account once, however many versions
+ * refer to it.
+ */
+class PatternHistory
+{
+public:
+    static constexpr size_t defaultUndoSteps = 256;
+
+    struct Stats
+    {
+        size_t versions = 0;        // undo steps and variations
+        size_t uniqueBars = 0;
+        size_t barReferences = 0;
+        size_t bytes = 0;
+    };
+
+    explicit PatternHistory(MemoryLedger* ledger = nullptr, size_t maxUndoSteps = defaultUndoSteps);
+    ~PatternHistory();
+
+    // Makes version current; anything that could have been redone is dropped
+    void commit(PatternVersion version);
+    void clear();
+
+    bool isEmpty() const { return versions.empty(); }
+    const PatternVersion& getCurrent() const;
+
+    bool canUndo() const { return current > 0; }
+    bool canRedo() const { return current + 1 < versions.size(); }
+    bool undo();
+    bool redo();
+
+    void storeVariation(const std::string& name, PatternVersion version);
+    const PatternVersion* getVariation(const std::string& name) const;
+    void removeVariation(const std::string& name);
+    std::vector<std::string> getVariationNames() const;
+
+    Stats getStats() const;
+
+private:
+    void updateMemoryCharge();
+
+    std::deque<PatternVersion> versions;
+    size_t current = 0;
+    size_t maxSteps = defaultUndoSteps;
+    std::map<std::string, PatternVersion> variations;
+    MemoryLedger::Charge charge;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PatternHistory)
+};
@@ -1,4 +1,8 @@
 #include "PluginEditor.h"
+#include "AuditionSynth.h"
+#include "MonophonicTranscriber.h"
+#include "FillDetector.h"
+#include "Quantizer.h"
 
 AamatiAudioProcessorEditor::CustomLookAndFeel::CustomLookAndFeel()
 {
@@ -90,16 +94,34 @@ AamatiAudioProcessorEditor::AamatiAudioProcessorEditor(AamatiAudioProcessor& p)
       mlEnabledAttachment(std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
           audioProcessor.parameters, "mlEnabled", mlEnabledButton))
 {
+    auto& startupTimeline = audioProcessor.getStartupTimeline();
+    StartupTimeline::ScopedPhase editorPhase(startupTimeline, "editor constructor");
+    
     setLookAndFeel(&customLookAndFeel);
     
     // Initialize advanced processing components
-    emotionalOptimizer = std::make_unique<EmotionalOptimizer>();
-    grooveShaper = std::make_unique<GrooveShaper>();
-    aiMidiGenerator = std::make_unique<AIMidiGenerator>();
+    {
+        StartupTimeline::ScopedPhase phase(startupTimeline, "processing engines");
+        emotionalOptimizer = std::make_unique<EmotionalOptimizer>();
+        grooveShaper = std::make_unique<GrooveShaper>();
+        aiMidiGenerator = std::make_unique<AIMidiGenerator>();
+        fillScheduler = std::make_unique<FillScheduler>();
+        songArranger = std::make_unique<SongArranger>(&audioProcessor.getMemoryLedger());
+        patternHistory = std::make_unique<PatternHistory>(&audioProcessor.getMemoryLedger());
+    }
+    
+    // Charge editor-owned engines and the UI to this instance's ledger
+    auto& memoryLedger = audioProcessor.getMemoryLedger();
+    emotionalOptimizer->setMemoryLedger(&memoryLedger);
+    aiMidiGenerator->setMemoryLedger(&memoryLedger);
+    uiCharge.attach(&memoryLedger, MemoryLedger::Subsystem::UserInterface);
     
     // Initialize modern UI
-    modernUI = std::make_unique<ModernUI>();
-    addAndMakeVisible(modernUI.get());
+    {
+        StartupTimeline::ScopedPhase phase(startupTimeline, "modern UI");
+        modernUI = std::make_unique<ModernUI>();
+        addAndMakeVisible(modernUI.get());
+    }
     
     // Set up modern UI callbacks
     setupModernUICallbacks();
@@ -183,6 +205,13 @@ AamatiAudioProcessorEditor::AamatiAudioProcessorEditor(AamatiAudioProcessor& p)
     featuresLabel.setJustificationType(juce::Justification::centred);
     featuresLabel.setColour(juce::Label::textColourId, juce::Colour(200, 200, 200));
     addAndMakeVisible(featuresLabel);
+    
+    // Memory telemetry
+    memoryLabel.setText("MEMORY: --", juce::dontSendNotification);
+    memoryLabel.setFont(juce::Font(juce::FontOptions().withHeight(12.0f)));
+    memoryLabel.setJustificationType(juce::Justification::centred);
+    memoryLabel.setColour(juce::Label::textColourId, juce::Colour(200, 200, 200));
+    addAndMakeVisible(memoryLabel);
 
     // Start update timer
     updateTimer.startTimer(100); // Update every 100ms
@@ -207,20 +236,186 @@ void AamatiAudioProcessorEditor::setupModernUICallbacks()
     
     modernUI->onAIMidiGeneration = [this]() {
         if (aiMidiGenerator) {
+            // Only the fields the editor owns change, so a click that keeps the mood adapts the last melody
+            auto context = aiMidiGenerator->getGenerationContext();
+            context.primaryMood = currentMood;
+            context.secondaryMood = currentSecondaryMood;
+            context.tempo = getTempo();
+            aiMidiGenerator->updateContext(context);
+            
+            // Standalone: play the result through the built-in audition synth
+            if (auto* synth = audioProcessor.getAuditionSynth())
+            {
+                auto pattern = aiMidiGenerator->getContextPattern(8.0, "melody");
+                auto rhythm = aiMidiGenerator->generateRhythm(8.0);
+                pattern.messages.insert(pattern.messages.end(), rhythm.messages.begin(), rhythm.messages.end());
+                
+                // Later bar variations and undo steps build on this version
+                patternHistory->commit(PatternVersion(pattern, 4 * 60.0 / context.tempo));
+                modernUI->setPatternHistoryState(true, patternHistory->canUndo());
+                
+                for (int channel = 0; channel < AuditionSynth::numChannels; ++channel)
+                    synth->setChannelPreset(channel, aiMidiGenerator->getInstrumentPreset(channel));
+                
+                synth->stopAll();
+                if (!synth->queuePattern(pattern, 0.1))
+                    DBG("Audition queue full; pattern truncated");
+                
+                // Phrases now count from the start of the new pattern
+                if (fillScheduler->isRunning())
+                {
+                    fillScheduler->setGenerationContext(context);
+                    fillScheduler->start(synth->getPlayheadSeconds() + 0.1);
+                }
+            }
+        }
+    };
+    
+    modernUI->onPatternVariation = [this]() {
+        if (!aiMidiGenerator || patternHistory->isEmpty())
+            return;
+        
+        // Only the regenerated bar is new; every other bar is shared with the previous version
+        const auto& current = patternHistory->getCurrent();
+        const int bar = variationRandom.nextInt(current.getNumBars());
+        
+        // A variation is new material, so the last one is never reused; it follows the generator's context
+        aiMidiGenerator->clearPatternCache("variation");
+        auto fresh = aiMidiGenerator->getContextPattern(current.getSecondsPerBar(), "variation");
+        auto rhythm = aiMidiGenerator->generateRhythm(current.getSecondsPerBar());
+        fresh.messages.insert(fresh.messages.end(), rhythm.messages.begin(), rhythm.messages.end());
+        
+        patternHistory->commit(current.withBar(bar, PatternVersion::clipToBar(std::move(fresh.messages),
+                                                                               current.getSecondsPerBar())));
+        auditionCurrentVersion();
+    };
+    
+    modernUI->onPatternUndo = [this]() {
+        if (patternHistory->undo())
+            auditionCurrentVersion();
+    };
+    
+    modernUI->onSongGeneration = [this]() {
+        auto* synth = audioProcessor.getAuditionSynth();
+        if (!aiMidiGenerator || synth == nullptr)
+            return;
+        
+        // Standalone: only the distinct sections are generated now; updateSong() renders the rest as it plays
+        const float tempo = getTempo();
+        songArranger->arrange(SongArranger::createDefaultPlan(currentMood), *aiMidiGenerator, tempo);
+        
+        for (int channel = 0; channel < AuditionSynth::numChannels; ++channel)
+            synth->setChannelPreset(channel, aiMidiGenerator->getInstrumentPreset(channel));
+        
+        synth->stopAll();
+        songOrigin = synth->getPlayheadSeconds() + 0.1;
+        songRenderedUntil = 0.0;
+        updateSong();
+    };
+    
+    modernUI->onArpeggiatorToggled = [this](bool enabled) {
+        auto* synth = audioProcessor.getAuditionSynth();
+        if (synth == nullptr)
+            return;
+        
+        if (enabled && !arpeggiatorRunning)
+        {
+            // Standalone: follow the chords heard in the input with the current mood's figure
+            audioProcessor.setChordRecognitionEnabled(true);
+            liveArpeggiator.setSettings(Arpeggiator::getMoodSettings(currentMood));
+            liveArpeggiator.setChord(nullptr, 0);
+            arpeggioChord = -1;
+            arpeggioOrigin = synth->getPlayheadSeconds();
+            arpeggioTempo = getTempo();
+            arpeggioRenderedTick = 0;
+            arpeggiatorRunning = true;
+        }
+        else if (!enabled && arpeggiatorRunning)
+        {
+            queueArpeggio(arpeggioRenderedTick, true);
+            arpeggiatorRunning = false;
+        }
+    };
+    
+    modernUI->onMelodicContour = [this]() {
+        audioProcessor.setTranscriptionEnabled(true);
+    };
+    
+    modernUI->onHarmonicDensity = [this]() {
+        audioProcessor.setChordRecognitionEnabled(true);
+    };
+    
+    modernUI->onFillOrnament = [this]() {
+        audioProcessor.setFillDetectionEnabled(true);
+        
+        // Standalone: keep fills ready for the phrase boundaries of what the audition synth plays
+        if (auto* synth = audioProcessor.getAuditionSynth())
+        {
             AIMidiGenerator::GenerationContext context;
             context.primaryMood = currentMood;
             context.secondaryMood = currentSecondaryMood;
-            context.tempo = 120.0f; // Get from processor
-            aiMidiGenerator->setGenerationContext(context);
+            context.tempo = getTempo();
+            fillScheduler->setGenerationContext(context);
+            
+            FillScheduler::PhraseGrid grid;
+            grid.tempo = context.tempo;
+            fillScheduler->setPhraseGrid(grid);
+            fillScheduler->setFillAmount(modernUI->getFillAmount());
+            
+            if (!fillScheduler->isRunning())
+                fillScheduler->start(synth->getPlayheadSeconds());
         }
     };
     
+    modernUI->onFillAmountChanged = [this](float amount) {
+        fillScheduler->setFillAmount(amount);
+    };
+    
+    modernUI->onQuantizeChanged = [this](bool enabled, float strength) {
+        audioProcessor.getLiveQuantizer().setSettings(Quantizer::ticksPerQuarter / 4, strength, 1.0f, 0.0f,
+                                                      Quantizer::NoteEnds::KeepLength);
+        audioProcessor.setLiveQuantizeEnabled(enabled);
+    };
+    
+    modernUI->onMoodRemixing = [this]() {
+        if (!remixBatch || remixBatch->isFinished())
+            modernUI->setRemixTargetMood(currentMood);
+    };
+    
+    modernUI->onRemixFolderChosen = [this](const juce::File& folder) {
+        if (remixBatch && !remixBatch->isFinished())
+            return;
+        
+        // Results go next to the originals, one folder per mood, with the library's layout kept
+        const auto inputRoot = folder.getFullPathName().toStdString();
+        const auto outputRoot = folder.getChildFile("Remixed-" + juce::String(currentMood)).getFullPathName().toStdString();
+        
+        std::vector<MoodRemixBatch::Job> jobs;
+        for (const auto& path : MoodRemixer::findMidiFiles(inputRoot))
+            if (path.rfind(outputRoot, 0) != 0)
+                jobs.push_back({ path, MoodRemixer::getOutputPath(path, inputRoot, outputRoot) });
+        
+        MoodRemixer::Options options;
+        options.mood = currentMood;
+        options.secondaryMood = currentSecondaryMood;
+        
+        remixBatch = std::make_unique<MoodRemixBatch>(options, std::move(jobs));
+        remixBatch->start();
+        updateRemix();
+    };
+    
     // Add more callbacks for other features...
 }
 
 AamatiAudioProcessorEditor::~AamatiAudioProcessorEditor()
 {
     updateTimer.stopTimer();
+    audioProcessor.setTranscriptionEnabled(false);
+    audioProcessor.setChordRecognitionEnabled(false);
+    audioProcessor.setFillDetectionEnabled(false);
+    fillScheduler->stop();
+    if (remixBatch)
+        remixBatch->cancel();
     setLookAndFeel(nullptr);
 }
 
@@ -278,6 +473,273 @@ void AamatiAudioProcessorEditor::timerCallback()
     {
         featuresLabel.setText("FEATURES: EXTRACTING...", juce::dontSendNotification);
     }
+    
+    updateMemoryTelemetry();
+    updateTranscription();
+    updateHarmony();
+    updateFills();
+    updateSong();
+    updateArpeggiator();
+    updateRemix();
+    audioProcessor.getStartupTimeline().traceFirstPredictionIfPending();
+}
+
+void AamatiAudioProcessorEditor::updateTranscription()
+{
+    if (!audioProcessor.isTranscriptionEnabled())
+        return;
+    
+    std::vector<PitchPoint> contour;
+    std::vector<NoteEvent> notes;
+    auto& transcriber = audioProcessor.getTranscriber();
+    transcriber.popContour(contour);
+    transcriber.popNotes(notes);
+    
+    if (!notes.empty())
+    {
+        const float tempo = getTempo();
+        
+        // Audio-derived notes go through the same processing as file MIDI
+        MoodRemixer::applyMoodPipeline(notes, emotionalOptimizer.get(), grooveShaper.get(), tempo);
+        
+        // Keep the last few bars for export and the later feature panels
+        transcribedNotes.insert(transcribedNotes.end(), notes.begin(), notes.end());
+        constexpr size_t maxTranscribedNotes = 512;
+        if (transcribedNotes.size() > maxTranscribedNotes)
+            transcribedNotes.erase(transcribedNotes.begin(),
+                                   transcribedNotes.end() - static_cast<std::ptrdiff_t>(maxTranscribedNotes));
+    }
+    
+    if (modernUI)
+        modernUI->updateMelodicContour(contour, notes);
+}
+
+void AamatiAudioProcessorEditor::updateHarmony()
+{
+    if (!audioProcessor.isChordRecognitionEnabled())
+        return;
+    
+    auto& recognizer = audioProcessor.getChordRecognizer();
+    if (recognizer.popChords(recognisedChords) > 0)
+    {
+        // Harmonic rhythm over the last few chords only, so it tracks changes in the song
+        constexpr size_t maxRecentChords = 8;
+        if (recognisedChords.size() > maxRecentChords)
+            recognisedChords.erase(recognisedChords.begin(),
+                                   recognisedChords.end() - static_cast<std::ptrdiff_t>(maxRecentChords));
+        
+        const float tempo = getTempo();
+        auto rhythm = ChordRecognizer::summarise(recognisedChords, tempo);
+        
+        if (aiMidiGenerator)
+        {
+            AIMidiGenerator::HarmonyContext harmony;
+            for (const auto& chord : recognisedChords)
+                harmony.chords.push_back(ChordRecognizer::getChordPitchClasses(chord.root, chord.quality));
+            harmony.secondsPerChord = rhythm.secondsPerChord;
+            harmony.changeDensity = rhythm.density;
+            aiMidiGenerator->setHarmonyContext(harmony);
+        }
+        
+        if (modernUI)
+            modernUI->updateHarmonicAnalysis(ChordRecognizer::getChordSymbol(recognizer.getCurrentChord()), rhythm);
+    }
+}
+
+void AamatiAudioProcessorEditor::updateFills()
+{
+    if (!audioProcessor.isFillDetectionEnabled())
+        return;
+    
+    auto& detector = audioProcessor.getFillDetector();
+    std::vector<FillDetector::FillEvent> fills;
+    detectedFillCount += detector.popFills(fills);
+    const float activity = detector.getFillActivity();
+    
+    double secondsToNextFill = -1.0;
+    bool nextFillReady = false;
+    auto* synth = audioProcessor.getAuditionSynth();
+    if (synth != nullptr && fillScheduler->isRunning())
+    {
+        // Busier fills in the input make the generated ones busier too
+        fillScheduler->setFillActivity(activity);
+        
+        // Hand fills over well ahead of the timer period, so the audio thread only reads queued events
+        constexpr double fillLookAheadSeconds = 0.5;
+        const double now = synth->getPlayheadSeconds();
+        fillScheduler->dispatchDue(*synth, now, fillLookAheadSeconds);
+        
+        secondsToNextFill = std::max(0.0, fillScheduler->getSecondsToNextFill(now));
+        nextFillReady = fillScheduler->isNextFillReady();
+    }
+    
+    if (modernUI)
+        modernUI->updateFillStatus(activity, detectedFillCount, secondsToNextFill, nextFillReady);
+}
+
+void AamatiAudioProcessorEditor::auditionCurrentVersion()
+{
+    modernUI->setPatternHistoryState(!patternHistory->isEmpty(), patternHistory->canUndo());
+    
+    auto* synth = audioProcessor.getAuditionSynth();
+    if (synth == nullptr || patternHistory->isEmpty())
+        return;
+    
+    synth->stopAll();
+    if (!synth->queuePattern(patternHistory->getCurrent().toPattern(), 0.1))
+        DBG("Audition queue full; pattern truncated");
+}
+
+void AamatiAudioProcessorEditor::updateSong()
+{
+    auto* synth = audioProcessor.getAuditionSynth();
+    if (synth == nullptr || songArranger->getNumSections() == 0)
+        return;
+    
+    const double length = songArranger->getLengthSeconds();
+    const double now = synth->getPlayheadSeconds();
+    const double position = now - songOrigin;
+    
+    // A second ahead covers several timer periods; the last slice is closed so the final note-offs go out
+    constexpr double songLookAheadSeconds = 1.0;
+    const double renderTo = std::min(position + songLookAheadSeconds, length);
+    if (renderTo > songRenderedUntil)
+    {
+        const bool lastSlice = renderTo >= length;
+        AIMidiGenerator::GeneratedPattern slice;
+        songArranger->render(songRenderedUntil, lastSlice ? std::nextafter(length, length + 1.0) : renderTo, slice.messages);
+        for (auto& message : slice.messages)
+            message.setTimeStamp(message.getTimeStamp() - songRenderedUntil);
+        
+        if (!synth->queuePattern(slice, songOrigin + songRenderedUntil - now))
+            DBG("Audition queue full; song slice truncated");
+        songRenderedUntil = lastSlice ? std::numeric_limits<double>::max() : renderTo;
+    }
+    
+    const auto stats = songArranger->getStats();
+    if (modernUI)
+        modernUI->updateSongStatus(songArranger->getSectionNameAt(position), position, length,
+                                   stats.uniqueSections, stats.sectionReferences);
+    
+    if (position >= length)
+        songArranger->clear();
+}
+
+void AamatiAudioProcessorEditor::updateArpeggiator()
+{
+    auto* synth = audioProcessor.getAuditionSynth();
+    if (!arpeggiatorRunning || synth == nullptr)
+        return;
+    
+    // Chord changes land at the first tick not yet queued
+    const int chord = audioProcessor.getChordRecognizer().getCurrentChord();
+    if (chord != arpeggioChord)
+    {
+        arpeggioChord = chord;
+        std::vector<int> notes;
+        if (chord != ChordRecognizer::noChord)
+        {
+            const int root = chord / ChordRecognizer::numQualities;
+            const auto quality = static_cast<ChordRecognizer::Quality>(chord % ChordRecognizer::numQualities);
+            for (int pitchClass : ChordRecognizer::getChordPitchClasses(root, quality))
+            {
+                // Stack upwards from the root, starting at C3
+                int note = 48 + pitchClass;
+                while (!notes.empty() && note <= notes.back())
+                    note += 12;
+                notes.push_back(note);
+            }
+        }
+        liveArpeggiator.setChord(notes);
+    }
+    
+    // A little over the timer period ahead, so the audio thread only ever reads queued events
+    constexpr double arpeggioLookAheadSeconds = 0.3;
+    const double songTime = synth->getPlayheadSeconds() - arpeggioOrigin;
+    queueArpeggio(Arpeggiator::secondsToTicks(songTime + arpeggioLookAheadSeconds, arpeggioTempo), false);
+}
+
+void AamatiAudioProcessorEditor::queueArpeggio(std::int64_t toTick, bool release)
+{
+    auto* synth = audioProcessor.getAuditionSynth();
+    if (synth == nullptr || (toTick <= arpeggioRenderedTick && !release))
+        return;
+    
+    constexpr int arpeggioChannel = 1; // the generator's harmony channel
+    const float tempo = arpeggioTempo;
+    const double sliceStart = Arpeggiator::ticksToSeconds(arpeggioRenderedTick, tempo);
+    
+    AIMidiGenerator::GeneratedPattern slice;
+    const auto emit = [&slice, tempo, sliceStart](const Arpeggiator::Event& event)
+    {
+        auto message = event.velocity > 0
+                         ? juce::MidiMessage::noteOn(arpeggioChannel, event.note, static_cast<juce::uint8>(event.velocity))
+                         : juce::MidiMessage::noteOff(arpeggioChannel, event.note);
+        message.setTimeStamp(std::max(0.0, Arpeggiator::ticksToSeconds(event.tick, tempo) - sliceStart));
+        slice.messages.push_back(message);
+    };
+    
+    if (release)
+        liveArpeggiator.flush(arpeggioRenderedTick, emit);
+    else
+        liveArpeggiator.render(arpeggioRenderedTick, toTick, emit);
+    
+    if (!slice.messages.empty() && !synth->queuePattern(slice, arpeggioOrigin + sliceStart - synth->getPlayheadSeconds()))
+        DBG("Audition queue full; arpeggio truncated");
+    arpeggioRenderedTick = std::max(arpeggioRenderedTick, toTick);
+}
+
+void AamatiAudioProcessorEditor::updateRemix()
+{
+    if (!remixBatch || !modernUI)
+        return;
+    
+    const bool finished = remixBatch->isFinished();
+    modernUI->updateRemixProgress(remixBatch->getCompleted(), remixBatch->getTotal(), remixBatch->getFailed(), finished);
+    
+    // Keep the finished job's counts on screen, but stop polling it
+    if (finished)
+    {
+        for (const auto& failure : remixBatch->getFailures())
+            DBG("Mood remix failed for " << failure.inputPath << ": " << failure.error);
+        remixBatch.reset();
+    }
+}
+
+float AamatiAudioProcessorEditor::getTempo() const
+{
+    const float broadcast = audioProcessor.getBroadcastTempo();
+    return broadcast > 0.0f ? broadcast : 120.0f;
+}
+
+void AamatiAudioProcessorEditor::updateMemoryTelemetry()
+{
+    // The processor applies its own profile when the parameter moves; the editor-owned caches follow it here
+    bool lowMemory = audioProcessor.isLowMemoryProfile();
+    if (lowMemory != lowMemoryProfileApplied)
+    {
+        lowMemoryProfileApplied = lowMemory;
+        if (lowMemory && aiMidiGenerator)
+            aiMidiGenerator->trimPatternLibraries(AamatiAudioProcessor::lowMemoryPatternsPerLibrary);
+    }
+    
+    // Components plus one ARGB backing frame for the painted area
+    uiCharge.setBytes(sizeof(*this) + sizeof(ModernUI) + static_cast<size_t>(getWidth() * getHeight()) * 4);
+    
+    const auto& memoryLedger = audioProcessor.getMemoryLedger();
+    std::string summary = "MEMORY: " + MemoryLedger::formatBytes(memoryLedger.getTotalLiveBytes())
+                        + " (PEAK " + MemoryLedger::formatBytes(memoryLedger.getTotalPeakBytes()) + ")";
+    if (memoryLedger.getBudget() > 0)
+        summary += " / BUDGET " + MemoryLedger::formatBytes(memoryLedger.getBudget());
+    
+    std::string details = memoryLedger.describe();
+    memoryLabel.setText(summary, juce::dontSendNotification);
+    memoryLabel.setTooltip(details);
+    memoryLabel.setColour(juce::Label::textColourId, memoryLedger.isOverBudget() ? juce::Colour(255, 100, 100)
+                                                                                 : juce::Colour(200, 200, 200));
+    
+    if (modernUI)
+        modernUI->setStatusText(summary, details);
 }
 
 void AamatiAudioProcessorEditor::paint(juce::Graphics& g)
@@ -343,7 +805,7 @@ void AamatiAudioProcessorEditor::resized()
         titleLabel.setBounds(titleSection);
         
         // Status section
-        auto statusSection = bounds.removeFromTop(80);
+        auto statusSection = bounds.removeFromTop(105);
         auto moodArea = statusSection.removeFromTop(30);
         moodLabel.setBounds(moodArea);
         
@@ -353,6 +815,9 @@ void AamatiAudioProcessorEditor::resized()
         auto featuresArea = statusSection.removeFromTop(25);
         featuresLabel.setBounds(featuresArea);
         
+        auto memoryArea = statusSection.removeFromTop(25);
+        memoryLabel.setBounds(memoryArea);
+        
         // Control section
         auto controlArea = bounds.withSizeKeepingCentre(500, 300);
         
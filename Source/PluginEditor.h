@@ -7,6 +7,13 @@
 #include "EmotionalOptimizer.h"
 #include "GrooveShaper.h"
 #include "AIMidiGenerator.h"
+#include "NoteEvents.h"
+#include "ChordRecognizer.h"
+#include "FillScheduler.h"
+#include "MoodRemixer.h"
+#include "SongArranger.h"
+#include "Arpeggiator.h"
+#include "PatternHistory.h"
 
 class AamatiAudioProcessorEditor : public juce::AudioProcessorEditor
 {
@@ -43,6 +50,7 @@ private:
     juce::Label moodLabel;
     juce::Label modelStatusLabel;
     juce::Label featuresLabel;
+    juce::Label memoryLabel;
 
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> highPassAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> lowPassAttachment;
@@ -104,6 +112,9 @@ private:
     std::string currentSecondaryMood = "unknown";
     float currentConfidence = 0.0f;
     
+    // Tempo for generation: the mood bus broadcast while subscribed, 120 BPM otherwise
+    float getTempo() const;
+    
     // Advanced Processing Components
     std::unique_ptr<ModernUI> modernUI;
     std::unique_ptr<EmotionalOptimizer> emotionalOptimizer;
@@ -113,6 +124,49 @@ private:
     // UI Mode
     bool useModernUI = true;
     
+    // Memory accounting for the editor itself and the low-memory profile last applied
+    MemoryLedger::Charge uiCharge;
+    bool lowMemoryProfileApplied = false;
+    void updateMemoryTelemetry();
+    
+    // Live transcription: notes run through the emotional optimizer and groove shaper
+    std::vector<NoteEvent> transcribedNotes;
+    void updateTranscription();
+    
+    // Live chord recognition: recent chords drive the generator's harmony context
+    std::vector<ChordRecognizer::ChordEvent> recognisedChords;
+    void updateHarmony();
+    
+    // Fill detection on the input, and fills kept ready for the audition synth's phrase boundaries
+    std::unique_ptr<FillScheduler> fillScheduler;
+    int detectedFillCount = 0;
+    void updateFills();
+    
+    // Generated song streamed into the audition synth a little ahead of the playhead
+    std::unique_ptr<SongArranger> songArranger;
+    double songOrigin = 0.0;        // audition synth time the song started at
+    double songRenderedUntil = 0.0; // song time already queued
+    void updateSong();
+    
+    // Live arpeggio over the recognised chords, queued into the audition synth on its own tick grid
+    Arpeggiator liveArpeggiator;
+    bool arpeggiatorRunning = false;
+    double arpeggioOrigin = 0.0;          // audition synth time of tick 0
+    float arpeggioTempo = 120.0f;         // held for the whole run, so the tick grid never jumps
+    std::int64_t arpeggioRenderedTick = 0;
+    int arpeggioChord = -1;
+    void updateArpeggiator();
+    void queueArpeggio(std::int64_t toTick, bool release);
+    
+    // Versions of the generated pattern; bar variations and undo steps share unchanged bars
+    std::unique_ptr<PatternHistory> patternHistory;
+    juce::Random variationRandom;
+    void auditionCurrentVersion();
+    
+    // Folder remix job started from the mood remixer panel
+    std::unique_ptr<MoodRemixBatch> remixBatch;
+    void updateRemix();
+    
     // Custom look and feel
     class AamatiLookAndFeel : public juce::LookAndFeel_V4
     {
@@ -2,11 +2,23 @@
 #include "PluginEditor.h"
 #include "ModelRunner.h"
 #include "FeatureExtractor.h"
+#include "SimdKernels.h"
+#include "AuditionSynth.h"
+#include "MonophonicTranscriber.h"
+#include "ChordRecognizer.h"
+#include "Stft.h"
+#include "DrumTranscriber.h"
+#include "FillDetector.h"
+#include "Quantizer.h"
+#include "InferenceIpc.h"
+#include "FeatureModelGraph.h"
 
 #include <onnxruntime/core/providers/shared_library/provider_api.h>
 #include <vector>
 #include <string>
 #include <iostream>
+#include <limits>
+#include <algorithm>
 
 // Mood enum
 enum class Mood {
@@ -42,19 +54,54 @@ AamatiAudioProcessor::AamatiAudioProcessor()
             "mlEnabled", "ML Processing Enabled", true),
         std::make_unique<juce::AudioParameterFloat>(
             "mlSensitivity", "ML Sensitivity",
-            juce::NormalisableRange<float>(0.1f, 2.0f, 0.1f), 1.0f)
+            juce::NormalisableRange<float>(0.1f, 2.0f, 0.1f), 1.0f),
+        std::make_unique<juce::AudioParameterBool>(
+            "lowMemory", "Low Memory Profile", false),
+        std::make_unique<juce::AudioParameterChoice>(
+            "moodBus", "Mood Bus", juce::StringArray { "Off", "Publish", "Subscribe" }, 0),
+        std::make_unique<juce::AudioParameterInt>(
+            "moodBusChannel", "Mood Bus Channel", 1, MoodBus::numChannels, 1)
     })
 {
+    startupTimeline.setTraceSink([](const std::string& line) { DBG(juce::String(line)); });
+
+    // Plugin hosts have their own instruments; only the Standalone app needs to make sound itself
+    if (wrapperType == wrapperType_Standalone)
+        auditionSynth = std::make_unique<AuditionSynth>(&memoryLedger);
+
+    transcriber = std::make_unique<MonophonicTranscriber>(&memoryLedger);
+    chordRecognizer = std::make_unique<ChordRecognizer>(&memoryLedger);
+    onsetStft = std::make_unique<Stft>(&memoryLedger);
+    drumTranscriber = std::make_unique<DrumTranscriber>(&memoryLedger);
+    onsetStft->addListener(drumTranscriber.get());
+    fillDetector = std::make_unique<FillDetector>();
+    drumTranscriber->addListener(fillDetector.get());
+    liveQuantizer = std::make_unique<LiveQuantizer>();
+    moodBus = std::make_unique<MoodBus>();
+    inferenceClient = std::make_unique<InferenceClient>();
+    modelGraph = std::make_unique<FeatureModelGraph>(&memoryLedger);
+    modelGraph->setMoodFunction([this](const float* features, float* probabilities)
+                                {
+                                    return predictMoodProbabilities(features, probabilities);
+                                });
+
+    parameters.addParameterListener("lowMemory", this);
+
+    startupTimeline.addPhase("processor constructor", 0.0, startupTimeline.getElapsedMs());
 }
 
-AamatiAudioProcessor::~AamatiAudioProcessor() {}
+AamatiAudioProcessor::~AamatiAudioProcessor()
+{
+    parameters.removeParameterListener("lowMemory", this);
+    cancelPendingUpdate();
+}
 
 const juce::String AamatiAudioProcessor::getName() const {
     return JucePlugin_Name;
 }
 
-bool AamatiAudioProcessor::acceptsMidi() const { return false; }
-bool AamatiAudioProcessor::producesMidi() const { return false; }
+bool AamatiAudioProcessor::acceptsMidi() const { return true; }
+bool AamatiAudioProcessor::producesMidi() const { return true; }
 bool AamatiAudioProcessor::isMidiEffect() const { return false; }
 double AamatiAudioProcessor::getTailLengthSeconds() const { return 0.0; }
 
@@ -67,26 +114,61 @@ void AamatiAudioProcessor::changeProgramName(int, const juce::String&) {}
 void AamatiAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
     juce::ignoreUnused(sampleRate, samplesPerBlock);
+    StartupTimeline::ScopedPhase preparePhase(startupTimeline, "prepareToPlay");
 
-    // Find executable directory
-    auto exeDir = juce::File::getSpecialLocation(juce::File::currentExecutableFile).getParentDirectory();
+    juce::File modelFile;
+    {
+        StartupTimeline::ScopedPhase phase(startupTimeline, "model file lookup");
+        modelFile = findModelFile();
+    }
 
-    // Construct full path to your model inside Resources folder
-    auto modelFile = exeDir.getChildFile("Resources/groove_mood_model.onnx");
+    // With the inference daemon running, every instance on the machine shares its session
+    hasDaemonAnswer = false;
+    daemonAnswerIsStale = false;
+    missedDaemonHops = 0;
+    if (inferenceClient->connect())
+        DBG("Using the inference daemon; no model loaded in process");
+    else
+        loadModelInProcess(modelFile);
 
-    // Create ModelRunner instance
-    if (modelFile.exists())
     {
-        modelRunner = std::make_unique<ModelRunner>(modelFile.getFullPathName().toStdString());
-        DBG("ML Model loaded successfully");
+        // The energy and swing models run in process either way; without them the measured values are used
+        StartupTimeline::ScopedPhase phase(startupTimeline, "auxiliary models");
+        modelGraph->loadAuxiliaryModels(modelFile.getParentDirectory());
     }
-    else
+
     {
-        DBG("ML Model file not found: " << modelFile.getFullPathName());
+        StartupTimeline::ScopedPhase phase(startupTimeline, "feature extractor");
+
+        // Reuse the existing history buffers rather than reserving them all over again
+        if (featureExtractor)
+            featureExtractor->reset();
+        else
+            featureExtractor = std::make_unique<FeatureExtractor>(&memoryLedger);
+        featureExtractor->setDrumTranscriber(drumTranscriber.get());
+
+        applyMemoryProfile();
     }
 
-    // Initialize feature extractor
-    featureExtractor = std::make_unique<FeatureExtractor>();
+    if (auditionSynth)
+    {
+        StartupTimeline::ScopedPhase phase(startupTimeline, "audition synth");
+        auditionSynth->prepare(sampleRate, samplesPerBlock);
+    }
+
+    StartupTimeline::ScopedPhase dspPhase(startupTimeline, "DSP prepare");
+
+    transcriber->prepare(sampleRate);
+    transcriberRunning = false;
+    chordRecognizer->prepare(sampleRate);
+    chordRecognizerRunning = false;
+    // About 20 ms with four hops per window: 5 ms onset resolution at 48 kHz
+    onsetStft->prepare(sampleRate, 0.02, 4);
+    drumTranscriber->prepare(*onsetStft);
+    drumTranscriberRunning = false;
+    fillDetector->reset();
+    liveQuantizer->prepare(sampleRate);
+    liveQuantizerRunning = false;
 
     juce::dsp::ProcessSpec spec;
     spec.sampleRate = sampleRate;
@@ -98,6 +180,65 @@ void AamatiAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
     updateFilters();
 }
 
+juce::File AamatiAudioProcessor::findModelFile()
+{
+    // Find executable directory
+    auto exeDir = juce::File::getSpecialLocation(juce::File::currentExecutableFile).getParentDirectory();
+
+    // Construct full path to your model inside Resources folder
+    return exeDir.getChildFile("Resources/groove_mood_model.onnx");
+}
+
+void AamatiAudioProcessor::loadModelInProcess(const juce::File& modelFile)
+{
+    // Hosts call prepareToPlay again on every rate or block size change; the session
+    // doesn't depend on either, so only build it when the model isn't loaded yet
+    const std::string modelPath = modelFile.getFullPathName().toStdString();
+    if (modelRunner && modelRunner->isModelLoaded() && modelPath == loadedModelPath)
+    {
+        DBG("ML Model already loaded");
+    }
+    else if (modelFile.exists())
+    {
+        StartupTimeline::ScopedPhase phase(startupTimeline, "ONNX session creation");
+        auto runner = std::make_unique<ModelRunner>(modelPath, &memoryLedger);
+
+        // After losing the inference daemon this runs while audio plays, so swap under the callback lock
+        const juce::ScopedLock lock(getCallbackLock());
+        modelRunner = std::move(runner);
+        loadedModelPath = modelPath;
+        modelGraph->invalidate(FeatureModelGraph::MoodModel);
+        DBG("ML Model loaded successfully");
+    }
+    else
+    {
+        DBG("ML Model file not found: " << modelFile.getFullPathName());
+    }
+}
+
+void AamatiAudioProcessor::parameterChanged(const juce::String& parameterID, float newValue)
+{
+    // Hosts may automate this from the audio thread, and the profile reallocates, so it is applied later
+    juce::ignoreUnused(parameterID, newValue);
+    memoryProfileChanged.store(true);
+    triggerAsyncUpdate();
+}
+
+void AamatiAudioProcessor::handleAsyncUpdate()
+{
+    if (memoryProfileChanged.exchange(false))
+        applyMemoryProfile();
+
+    // The inference daemon stopped answering mid-session
+    if (inferenceDaemonLost.exchange(false) && !inferenceClient->isConnected())
+        loadModelInProcess(findModelFile());
+}
+
+bool AamatiAudioProcessor::isUsingInferenceDaemon() const
+{
+    return inferenceClient->isConnected();
+}
+
 void AamatiAudioProcessor::updateFilters()
 {
     auto highPassFreq = parameters.getRawParameterValue("highPass")->load();
@@ -114,6 +255,65 @@ void AamatiAudioProcessor::updateFilters()
 
 void AamatiAudioProcessor::releaseResources() {}
 
+bool AamatiAudioProcessor::isLowMemoryProfile() const
+{
+    return parameters.getRawParameterValue("lowMemory")->load() > 0.5f;
+}
+
+void AamatiAudioProcessor::setMemoryBudget(size_t bytes)
+{
+    // Stored in the state tree so each instance keeps its own budget across sessions
+    parameters.state.setProperty("memoryBudget", static_cast<juce::int64>(bytes), nullptr);
+    applyMemoryProfile();
+}
+
+size_t AamatiAudioProcessor::getMemoryBudget() const
+{
+    auto budget = static_cast<juce::int64>(parameters.state.getProperty("memoryBudget", static_cast<juce::int64>(defaultMemoryBudget)));
+    return static_cast<size_t>(juce::jmax<juce::int64>(0, budget));
+}
+
+void AamatiAudioProcessor::applyMemoryProfile()
+{
+    const bool lowMemory = isLowMemoryProfile();
+    const size_t budget = lowMemory ? getMemoryBudget() : 0;
+    memoryLedger.setBudget(budget);
+
+    // Resizing the histories reallocates, so keep the audio thread out while it happens
+    const juce::ScopedLock lock(getCallbackLock());
+
+    if (featureExtractor)
+    {
+        size_t capacity = FeatureExtractor::MAX_HISTORY_SIZE;
+        if (lowMemory)
+        {
+            // Histories get half the budget across their three buffers, but never less
+            // than the one second per channel the analysis needs before it runs
+            size_t affordable = budget / 2 / (3 * sizeof(float));
+            size_t minimum = static_cast<size_t>(getSampleRate()) * static_cast<size_t>(juce::jmax(1, getTotalNumInputChannels()));
+            capacity = std::max(minimum, std::min(FeatureExtractor::MAX_HISTORY_SIZE, affordable));
+        }
+        featureExtractor->setHistoryCapacity(capacity);
+    }
+
+    memoryLedger.resetPeaks();
+
+    if (memoryLedger.isOverBudget())
+        DBG("Memory over budget: " << memoryLedger.describe());
+}
+
+MoodBus::Mode AamatiAudioProcessor::getMoodBusMode() const
+{
+    const int mode = juce::roundToInt(parameters.getRawParameterValue("moodBus")->load());
+    return static_cast<MoodBus::Mode>(juce::jlimit(0, 2, mode));
+}
+
+int AamatiAudioProcessor::getMoodBusChannel() const
+{
+    const int channel = juce::roundToInt(parameters.getRawParameterValue("moodBusChannel")->load());
+    return juce::jlimit(1, MoodBus::numChannels, channel) - 1;
+}
+
 bool AamatiAudioProcessor::isBusesLayoutSupported(const juce::AudioProcessor::BusesLayout& layouts) const {
     return layouts.getMainInputChannelSet() == juce::AudioChannelSet::stereo()
         && layouts.getMainOutputChannelSet() == juce::AudioChannelSet::stereo();
@@ -124,6 +324,41 @@ void AamatiAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::
 {
     juce::ScopedNoDenormals noDenormals;
     
+    // Analyse the raw input, before the effect chain colours it
+    const bool transcribe = transcriptionEnabled.load();
+    if (transcribe && !transcriberRunning)
+        transcriber->reset();
+    transcriberRunning = transcribe;
+    if (transcribe)
+        transcriber->process(buffer);
+    
+    const bool recogniseChords = chordRecognitionEnabled.load();
+    if (recogniseChords && !chordRecognizerRunning)
+        chordRecognizer->reset();
+    chordRecognizerRunning = recogniseChords;
+    if (recogniseChords)
+        chordRecognizer->process(buffer);
+    
+    // A subscriber with a live publisher takes the broadcast mood and skips feature extraction and inference.
+    // Until a publisher is heard, or once it falls silent, it analyses its own input.
+    bool mlEnabled = parameters.getRawParameterValue("mlEnabled")->load() > 0.5f;
+    const bool subscribed = mlEnabled && getMoodBusMode() == MoodBus::Mode::Subscribe
+                         && moodBus->read(getMoodBusChannel(), moodBusReading);
+    const bool analyse = mlEnabled && !subscribed;
+    broadcastTempo.store(subscribed ? moodBusReading.tempo : 0.0f);
+    
+    // Drum hits feed the groove features and the fill detector, so transcribe whenever either listens
+    const bool transcribeDrums = analyse || fillDetectionEnabled.load();
+    if (transcribeDrums && !drumTranscriberRunning)
+    {
+        onsetStft->reset();
+        drumTranscriber->reset();
+        fillDetector->reset();
+    }
+    drumTranscriberRunning = transcribeDrums;
+    if (transcribeDrums)
+        onsetStft->process(buffer);
+    
     // Update filters if necessary
     updateFilters();
     
@@ -135,8 +370,12 @@ void AamatiAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::
     processorChain.process(context);
     
     // ML Processing
-    bool mlEnabled = parameters.getRawParameterValue("mlEnabled")->load() > 0.5f;
-    if (mlEnabled && modelRunner && featureExtractor)
+    if (subscribed)
+    {
+        float sensitivity = parameters.getRawParameterValue("mlSensitivity")->load();
+        applyMoodProcessing(buffer, moodBusReading.mood, sensitivity);
+    }
+    else if (analyse && (modelRunner || inferenceClient->isConnected()) && featureExtractor)
     {
         // Extract features from current audio buffer
         auto features = featureExtractor->extractFeaturesFromAudio(buffer, getSampleRate());
@@ -151,27 +390,34 @@ void AamatiAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::
         }
     }
     
-    // Mid/Side processing
-    for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+    // Mid/Side processing: reduce mid component to alter the stereo image
+    SimdKernels::midSide(buffer.getWritePointer(0), buffer.getWritePointer(1),
+                         static_cast<size_t>(buffer.getNumSamples()), 0.5f, 1.0f);
+
+    // Incoming MIDI is delayed onto the grid; switching off releases whatever is still pending
+    const bool quantize = liveQuantizeEnabled.load();
+    if (quantize && !liveQuantizerRunning)
+        liveQuantizer->reset();
+    else if (!quantize && liveQuantizerRunning)
+        liveQuantizer->flush(midiMessages);
+    liveQuantizerRunning = quantize;
+    if (quantize)
     {
-        // Get left and right channel samples
-        float left = buffer.getSample(0, sample);
-        float right = buffer.getSample(1, sample);
-        
-        // Compute mid and side components
-        float mid = (left + right) * 0.5f;
-        float side = (left - right) * 0.5f;
-        
-        // Reduce mid component to alter the stereo image
-        mid *= 0.5f;
-        
-        // Reassign mid and side back to the left and right channels
-        buffer.setSample(0, sample, mid + side); // Left channel
-        buffer.setSample(1, sample, mid - side); // Right channel
+        // The grid follows the host's tempo and beats rather than the moment quantizing was switched on
+        if (auto* playHead = getPlayHead())
+            if (const auto position = playHead->getPosition())
+                if (const auto bpm = position->getBpm())
+                {
+                    const auto ppq = position->getPpqPosition();
+                    liveQuantizer->syncToHost(*bpm, ppq ? *ppq : 0.0, ppq && position->getIsPlaying());
+                }
+
+        liveQuantizer->process(midiMessages, buffer.getNumSamples());
     }
 
-    // Midi messages are ignored for now
-    (void)midiMessages;
+    // Generated patterns are auditioned after the effect chain so they play back unprocessed
+    if (auditionSynth)
+        auditionSynth->renderNextBlock(buffer, midiMessages);
 }
 
 void AamatiAudioProcessor::processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
@@ -197,6 +443,7 @@ void AamatiAudioProcessor::setStateInformation(const void* data, int sizeInBytes
     if (xmlState.get() != nullptr) {
         parameters.replaceState(juce::ValueTree::fromXml(*xmlState));
         updateFilters(); // Apply the loaded parameters
+        applyMemoryProfile();
     }
 }
 
@@ -207,17 +454,23 @@ juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
 
 void AamatiAudioProcessor::applyMLProcessing(juce::AudioBuffer<float>& buffer, const GrooveFeatures& features, float sensitivity)
 {
-    // Convert features to array format expected by model
-    std::array<float, 5> featureArray = {
-        static_cast<float>(features.tempo),
-        static_cast<float>(features.swing),
-        static_cast<float>(features.density),
-        static_cast<float>(features.dynamicRange),
-        static_cast<float>(features.energy)
-    };
-
-    // Get mood prediction
-    std::string predictedMood = modelRunner->predict(featureArray);
+    // Energy and swing come from their own models, as in training; only the models whose
+    // inputs moved since the last hop run again
+    modelGraph->setInputs(features);
+    if (!modelGraph->evaluate())
+        return; // no mood for these features yet; the next block asks again
+
+    // The daemon's answer to an earlier row stands in until this row's arrives
+    if (daemonAnswerIsStale)
+        modelGraph->invalidate(FeatureModelGraph::MoodModel);
+
+    const std::string predictedMood = ModelRunner::chooseMood(modelGraph->getMoodProbabilities(),
+                                                              FeatureModelGraph::numMoods);
+    startupTimeline.markFirstPrediction();
+    
+    if (getMoodBusMode() == MoodBus::Mode::Publish)
+        moodBus->publish(getMoodBusChannel(), predictedMood.c_str(), static_cast<float>(features.tempo),
+                         modelGraph->getEnergy());
     
     // Apply mood-based processing
     applyMoodProcessing(buffer, predictedMood, sensitivity);
@@ -226,21 +479,77 @@ void AamatiAudioProcessor::applyMLProcessing(juce::AudioBuffer<float>& buffer, c
     DBG("Predicted Mood: " << predictedMood);
 }
 
+bool AamatiAudioProcessor::predictMoodProbabilities(const float* features, float* probabilities)
+{
+    static_assert(FeatureModelGraph::numMoods == static_cast<int>(ModelRunner::numMoods)
+                  && FeatureModelGraph::numMoods == InferenceIpc::numMoods, "one mood layout everywhere");
+
+    std::array<float, 5> featureArray;
+    std::copy(features, features + featureArray.size(), featureArray.begin());
+    if (!ModelRunner::validateInputFeatures(featureArray))
+        return false;
+
+    // From the inference daemon while it is connected, without ever waiting for it
+    if (inferenceClient->isConnected())
+    {
+        const auto answer = inferenceClient->collect(daemonAnswer);
+        if (answer == InferenceClient::Answer::Ready)
+        {
+            hasDaemonAnswer = true;
+            daemonAnsweredRow = daemonRowInFlight;
+            missedDaemonHops = 0;
+        }
+        else if (answer != InferenceClient::Answer::None)
+        {
+            ++missedDaemonHops;
+        }
+
+        // This hop's row goes out once the previous one is answered
+        if (answer != InferenceClient::Answer::Waiting)
+        {
+            if (inferenceClient->submit(featureArray))
+                daemonRowInFlight = featureArray;
+            else
+                ++missedDaemonHops;
+        }
+
+        if (missedDaemonHops >= maxMissedDaemonHops || !inferenceClient->isServerAlive())
+        {
+            // Load a model of our own off the audio thread and predict in process from then on
+            inferenceClient->disconnect();
+            missedDaemonHops = 0;
+            hasDaemonAnswer = false;
+            daemonAnswerIsStale = false;
+            inferenceDaemonLost.store(true);
+            triggerAsyncUpdate();
+            return false;
+        }
+
+        if (!hasDaemonAnswer)
+            return false;
+
+        std::copy(daemonAnswer.begin(), daemonAnswer.end(), probabilities);
+        daemonAnswerIsStale = daemonAnsweredRow != featureArray;
+        return true;
+    }
+
+    return modelRunner != nullptr && modelRunner->predictBatch(featureArray.data(), 1, probabilities);
+}
+
 void AamatiAudioProcessor::applyMoodProcessing(juce::AudioBuffer<float>& buffer, const std::string& mood, float sensitivity)
 {
+    const size_t numSamples = static_cast<size_t>(buffer.getNumSamples());
+    const std::pair<float, float> unbounded = {std::numeric_limits<float>::lowest(), std::numeric_limits<float>::max()};
+    
     // Apply different processing based on predicted mood
     if (mood == "energetic" || mood == "frantic")
     {
         // Add brightness and punch
         for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
         {
-            for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-            {
-                float sampleValue = buffer.getSample(channel, sample);
-                // Apply slight saturation and high-frequency emphasis
-                sampleValue = juce::jlimit(-1.0f, 1.0f, sampleValue * (1.0f + sensitivity * 0.1f));
-                buffer.setSample(channel, sample, sampleValue);
-            }
+            // Apply slight saturation and high-frequency emphasis
+            SimdKernels::scaleClamp(buffer.getWritePointer(channel), numSamples,
+                                    1.0f + sensitivity * 0.1f, 0.0f, -1.0f, 1.0f);
         }
     }
     else if (mood == "chill" || mood == "dreamy")
@@ -248,13 +557,9 @@ void AamatiAudioProcessor::applyMoodProcessing(juce::AudioBuffer<float>& buffer,
         // Apply gentle filtering and reverb-like processing
         for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
         {
-            for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-            {
-                float sampleValue = buffer.getSample(channel, sample);
-                // Apply gentle low-pass filtering effect
-                sampleValue *= (1.0f - sensitivity * 0.05f);
-                buffer.setSample(channel, sample, sampleValue);
-            }
+            // Apply gentle low-pass filtering effect
+            SimdKernels::scaleClamp(buffer.getWritePointer(channel), numSamples,
+                                    1.0f - sensitivity * 0.05f, 0.0f, unbounded.first, unbounded.second);
         }
     }
     else if (mood == "ominous" || mood == "suspenseful")
@@ -262,13 +567,9 @@ void AamatiAudioProcessor::applyMoodProcessing(juce::AudioBuffer<float>& buffer,
         // Add dark character with low-end emphasis
         for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
         {
-            for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-            {
-                float sampleValue = buffer.getSample(channel, sample);
-                // Apply slight low-frequency emphasis
-                sampleValue *= (1.0f + sensitivity * 0.05f);
-                buffer.setSample(channel, sample, sampleValue);
-            }
+            // Apply slight low-frequency emphasis
+            SimdKernels::scaleClamp(buffer.getWritePointer(channel), numSamples,
+                                    1.0f + sensitivity * 0.05f, 0.0f, unbounded.first, unbounded.second);
         }
     }
 }
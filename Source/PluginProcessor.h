@@ -2,8 +2,23 @@
 
 #include <JuceHeader.h>
 #include "ModelRunner.h"
-
-class AamatiAudioProcessor : public juce::AudioProcessor
+#include "MemoryLedger.h"
+#include "StartupTimeline.h"
+#include "MoodBus.h"
+#include "InferenceIpc.h"
+
+class AuditionSynth;
+class MonophonicTranscriber;
+class ChordRecognizer;
+class Stft;
+class DrumTranscriber;
+class FillDetector;
+class LiveQuantizer;
+class FeatureModelGraph;
+
+class AamatiAudioProcessor : public juce::AudioProcessor,
+                             private juce::AsyncUpdater,
+                             private juce::AudioProcessorValueTreeState::Listener
 {
 public:
     AamatiAudioProcessor();
@@ -37,12 +52,81 @@ public:
     void setStateInformation(const void* data, int sizeInBytes) override;
     void updateFilters();
 
+private:
+    // Declared ahead of the parameters so its clock starts before any other member is built
+    StartupTimeline startupTimeline;
+
+public:
     // Parameters
     juce::AudioProcessorValueTreeState parameters;
 
+    // Memory telemetry: live/peak bytes per subsystem for this instance
+    MemoryLedger& getMemoryLedger() { return memoryLedger; }
+    const MemoryLedger& getMemoryLedger() const { return memoryLedger; }
+
+    // Low-memory profile: shrinks history windows and caches towards the per-instance
+    // budget. Re-applied on prepareToPlay, state restore, budget changes and, on the
+    // message thread, whenever the lowMemory parameter moves.
+    bool isLowMemoryProfile() const;
+    void setMemoryBudget(size_t bytes);
+    size_t getMemoryBudget() const;
+    void applyMemoryProfile();
+
+    static constexpr size_t defaultMemoryBudget = 32 * 1024 * 1024;
+    static constexpr size_t lowMemoryPatternsPerLibrary = 4;
+
+    // Inference daemon: when one is running at prepareToPlay, predictions go to its shared session and no
+    // model is loaded here. The audio thread never waits for it: each hop submits its row and collects an
+    // earlier row's answer. After this many hops in a row without an answer, the model is loaded in
+    // process and used from then on.
+    bool isUsingInferenceDaemon() const;
+    static constexpr int maxMissedDaemonHops = 8;
+
+    // Cold-start telemetry: constructor, prepareToPlay, editor and first prediction
+    StartupTimeline& getStartupTimeline() { return startupTimeline; }
+    const StartupTimeline& getStartupTimeline() const { return startupTimeline; }
+
+    // Built-in synth for hearing generated patterns; only exists in the Standalone build
+    AuditionSynth* getAuditionSynth() { return auditionSynth.get(); }
+
+    // Live audio-to-MIDI transcription of the input, drained by the melodic contour panel
+    void setTranscriptionEnabled(bool shouldBeEnabled) { transcriptionEnabled.store(shouldBeEnabled); }
+    bool isTranscriptionEnabled() const { return transcriptionEnabled.load(); }
+    MonophonicTranscriber& getTranscriber() { return *transcriber; }
+
+    // Live chord recognition of the input, drained by the harmonic density panel
+    void setChordRecognitionEnabled(bool shouldBeEnabled) { chordRecognitionEnabled.store(shouldBeEnabled); }
+    bool isChordRecognitionEnabled() const { return chordRecognitionEnabled.load(); }
+    ChordRecognizer& getChordRecognizer() { return *chordRecognizer; }
+
+    // Live fill detection on the transcribed drums, drained by the fill and ornament panel
+    void setFillDetectionEnabled(bool shouldBeEnabled) { fillDetectionEnabled.store(shouldBeEnabled); }
+    bool isFillDetectionEnabled() const { return fillDetectionEnabled.load(); }
+    FillDetector& getFillDetector() { return *fillDetector; }
+
+    // Quantizes incoming MIDI on the host's beat grid before it goes out and the audition synth plays it.
+    // Only the MIDI is delayed, so the delay is not reported as latency: the audio is never late.
+    void setLiveQuantizeEnabled(bool shouldBeEnabled) { liveQuantizeEnabled.store(shouldBeEnabled); }
+    bool isLiveQuantizeEnabled() const { return liveQuantizeEnabled.load(); }
+    LiveQuantizer& getLiveQuantizer() { return *liveQuantizer; }
+
+    // Mood bus: a publisher broadcasts the mood it predicts; a subscriber plays the broadcast mood
+    // and skips its own analysis while a publisher is live on its channel
+    MoodBus::Mode getMoodBusMode() const;
+    int getMoodBusChannel() const; // 0-based
+    MoodBus& getMoodBus() { return *moodBus; }
+
+    // Subscriber: the tempo the publisher broadcasts, in BPM; 0 while no publisher is heard. Any thread.
+    float getBroadcastTempo() const { return broadcastTempo.load(); }
+
 private:
     void applyMLProcessing(juce::AudioBuffer<float>& buffer, const GrooveFeatures& features, float sensitivity);
     void applyMoodProcessing(juce::AudioBuffer<float>& buffer, const std::string& mood, float sensitivity);
+    bool predictMoodProbabilities(const float* features, float* probabilities);
+    static juce::File findModelFile();
+    void loadModelInProcess(const juce::File& modelFile);
+    void handleAsyncUpdate() override;
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
 
     juce::dsp::ProcessorChain<
         juce::dsp::IIR::Filter<float>,  // High-pass
@@ -50,8 +134,40 @@ private:
         juce::dsp::Gain<float>         // Optional gain control
     > processorChain;
 
+    // Declared before everything it accounts for, so it is destroyed last
+    MemoryLedger memoryLedger;
+
     std::unique_ptr<ModelRunner> modelRunner;
     std::unique_ptr<FeatureExtractor> featureExtractor;
+    std::string loadedModelPath;
+    std::unique_ptr<InferenceClient> inferenceClient;
+    std::atomic<bool> inferenceDaemonLost { false };    // handled by handleAsyncUpdate
+    std::atomic<bool> memoryProfileChanged { false };   // handled by handleAsyncUpdate
+    InferenceIpc::Features daemonRowInFlight {};   // audio thread only, like the rest of the daemon state
+    InferenceIpc::Features daemonAnsweredRow {};
+    InferenceIpc::Probabilities daemonAnswer {};
+    bool hasDaemonAnswer = false;
+    bool daemonAnswerIsStale = false;              // answers an earlier row than the one last asked about
+    int missedDaemonHops = 0;
+    std::unique_ptr<FeatureModelGraph> modelGraph; // energy and swing models feeding the mood model
+    std::unique_ptr<AuditionSynth> auditionSynth;
+    std::unique_ptr<MonophonicTranscriber> transcriber;
+    std::atomic<bool> transcriptionEnabled { false };
+    bool transcriberRunning = false; // audio thread only
+    std::unique_ptr<ChordRecognizer> chordRecognizer;
+    std::atomic<bool> chordRecognitionEnabled { false };
+    bool chordRecognizerRunning = false; // audio thread only
+    std::unique_ptr<Stft> onsetStft;     // short-window transform shared by the onset analysers
+    std::unique_ptr<DrumTranscriber> drumTranscriber;
+    bool drumTranscriberRunning = false; // audio thread only
+    std::unique_ptr<FillDetector> fillDetector;
+    std::atomic<bool> fillDetectionEnabled { false };
+    std::unique_ptr<LiveQuantizer> liveQuantizer;
+    std::atomic<bool> liveQuantizeEnabled { false };
+    bool liveQuantizerRunning = false; // audio thread only
+    std::unique_ptr<MoodBus> moodBus;
+    MoodBus::Reading moodBusReading;    // audio thread only
+    std::atomic<float> broadcastTempo { 0.0f };
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AamatiAudioProcessor)
 
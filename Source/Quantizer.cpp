@@ -0,0 +1,387 @@
+#include "Quantizer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Template offsets stay inside half a step, so neighbouring targets never cross
+    constexpr float maxTemplateOffset = 0.45f;
+    constexpr float maxSwing = 0.45f;
+
+    std::int64_t floorDiv(std::int64_t value, std::int64_t divisor)
+    {
+        const auto quotient = value / divisor;
+        return (value % divisor != 0 && (value < 0) != (divisor < 0)) ? quotient - 1 : quotient;
+    }
+}
+
+Quantizer::Quantizer()
+{
+    rebuildTable();
+}
+
+Quantizer::Quantizer(const Settings& initialSettings)
+    : settings(initialSettings)
+{
+    rebuildTable();
+}
+
+void Quantizer::setSettings(const Settings& newSettings)
+{
+    settings = newSettings;
+    rebuildTable();
+}
+
+void Quantizer::setGrooveTemplate(const float* offsets, const float* velocityScales, int numPoints)
+{
+    templatePoints = juce::jlimit(0, maxCyclePoints, numPoints);
+    for (int i = 0; i < templatePoints; ++i)
+    {
+        templateOffsets[static_cast<size_t>(i)] = offsets != nullptr
+            ? juce::jlimit(-maxTemplateOffset, maxTemplateOffset, offsets[i]) : 0.0f;
+        templateVelocities[static_cast<size_t>(i)] = velocityScales != nullptr
+            ? juce::jmax(0.0f, velocityScales[i]) : 1.0f;
+    }
+    rebuildTable();
+}
+
+void Quantizer::clearGrooveTemplate()
+{
+    templatePoints = 0;
+    rebuildTable();
+}
+
+void Quantizer::setGrooveTemplateFromNotes(const std::vector<NoteEvent>& notes, int numPoints)
+{
+    numPoints = juce::jlimit(1, maxCyclePoints, numPoints);
+    const double gridTicks = static_cast<double>(juce::jmax(1, settings.gridTicks));
+
+    std::array<double, maxCyclePoints> offsetSums {};
+    std::array<double, maxCyclePoints> velocitySums {};
+    std::array<int, maxCyclePoints> counts {};
+    double totalVelocity = 0.0;
+
+    // Measured against the straight grid, whatever swing is set
+    for (const auto& note : notes)
+    {
+        const double position = secondsToTicks(note.startTime) / gridTicks;
+        const auto step = static_cast<std::int64_t>(std::floor(position + 0.5));
+        const auto index = static_cast<size_t>(step - floorDiv(step, numPoints) * numPoints);
+        offsetSums[index] += position - static_cast<double>(step);
+        velocitySums[index] += note.velocity;
+        ++counts[index];
+        totalVelocity += note.velocity;
+    }
+
+    const double meanVelocity = notes.empty() ? 0.0 : totalVelocity / static_cast<double>(notes.size());
+
+    std::array<float, maxCyclePoints> offsets {};
+    std::array<float, maxCyclePoints> velocityScales {};
+    for (size_t i = 0; i < static_cast<size_t>(numPoints); ++i)
+    {
+        velocityScales[i] = 1.0f;
+        if (counts[i] == 0)
+            continue;
+
+        offsets[i] = static_cast<float>(offsetSums[i] / counts[i]);
+        if (meanVelocity > 0.0)
+            velocityScales[i] = static_cast<float>(velocitySums[i] / counts[i] / meanVelocity);
+    }
+
+    setGrooveTemplate(offsets.data(), velocityScales.data(), numPoints);
+}
+
+void Quantizer::rebuildTable()
+{
+    settings.gridTicks = juce::jmax(1, settings.gridTicks);
+    settings.strength = juce::jlimit(0.0f, 1.0f, settings.strength);
+    settings.window = juce::jlimit(0.0f, 1.0f, settings.window);
+    settings.swing = juce::jlimit(0.0f, maxSwing, settings.swing);
+    settings.tempo = juce::jmax(1.0f, settings.tempo);
+
+    secondsPerTick = 60.0 / (static_cast<double>(settings.tempo) * ticksPerQuarter);
+    const double gridTicks = static_cast<double>(settings.gridTicks);
+
+    if (templatePoints > 0)
+    {
+        cyclePoints = templatePoints;
+        for (size_t i = 0; i < static_cast<size_t>(cyclePoints); ++i)
+        {
+            targetTicks[i] = (static_cast<double>(i) + templateOffsets[i]) * gridTicks;
+            targetVelocities[i] = templateVelocities[i];
+        }
+    }
+    else if (settings.swing > 0.0f)
+    {
+        cyclePoints = 2;
+        targetTicks[0] = 0.0;
+        targetTicks[1] = (1.0 + settings.swing) * gridTicks;
+        targetVelocities[0] = targetVelocities[1] = 1.0f;
+    }
+    else
+    {
+        cyclePoints = 1;
+        targetTicks[0] = 0.0;
+        targetVelocities[0] = 1.0f;
+    }
+
+    cycleTicks = cyclePoints * gridTicks;
+
+    largestGap = targetTicks[0] + cycleTicks - targetTicks[static_cast<size_t>(cyclePoints - 1)];
+    for (size_t i = 1; i < static_cast<size_t>(cyclePoints); ++i)
+        largestGap = juce::jmax(largestGap, targetTicks[i] - targetTicks[i - 1]);
+}
+
+double Quantizer::getTargetTick(std::int64_t step) const
+{
+    const auto cycle = floorDiv(step, cyclePoints);
+    const auto index = static_cast<size_t>(step - cycle * cyclePoints);
+    return static_cast<double>(cycle) * cycleTicks + targetTicks[index];
+}
+
+double Quantizer::findTarget(double tick, float& velocityScale) const
+{
+    velocityScale = 1.0f;
+
+    // Each target stays within half a step of its straight position, so the
+    // targets either side of tick are among the three steps around it
+    const auto step = static_cast<std::int64_t>(std::floor(tick / settings.gridTicks));
+    std::int64_t lower = step - 1;
+    if (getTargetTick(step + 1) <= tick)
+        lower = step + 1;
+    else if (getTargetTick(step) <= tick)
+        lower = step;
+
+    const double lowerTick = getTargetTick(lower);
+    const double upperTick = getTargetTick(lower + 1);
+    const bool towardsUpper = upperTick - tick < tick - lowerTick;
+    const double target = towardsUpper ? upperTick : lowerTick;
+
+    if (std::abs(target - tick) > settings.window * 0.5 * (upperTick - lowerTick))
+        return tick;
+
+    const auto targetStep = towardsUpper ? lower + 1 : lower;
+    const auto index = static_cast<size_t>(targetStep - floorDiv(targetStep, cyclePoints) * cyclePoints);
+    velocityScale = 1.0f + settings.strength * (targetVelocities[index] - 1.0f);
+    return tick + settings.strength * (target - tick);
+}
+
+double Quantizer::quantizeTime(double seconds) const
+{
+    float velocityScale = 1.0f;
+    return ticksToSeconds(findTarget(secondsToTicks(seconds), velocityScale));
+}
+
+void Quantizer::quantize(NoteEvent& note) const
+{
+    float velocityScale = 1.0f;
+    const double start = ticksToSeconds(findTarget(secondsToTicks(note.startTime), velocityScale));
+    const double end = note.startTime + note.duration;
+
+    switch (settings.noteEnds)
+    {
+        case NoteEnds::KeepLength:
+            break;
+
+        case NoteEnds::Quantize:
+        {
+            const double quantizedEnd = quantizeTime(end);
+            if (quantizedEnd > start)
+                note.duration = quantizedEnd - start;
+            break;
+        }
+
+        case NoteEnds::KeepEnd:
+            if (end > start)
+                note.duration = end - start;
+            break;
+    }
+
+    note.startTime = start;
+    note.velocity = juce::jlimit(1.0f, 127.0f, note.velocity * velocityScale);
+}
+
+void Quantizer::quantize(std::vector<NoteEvent>& notes) const
+{
+    for (auto& note : notes)
+        quantize(note);
+}
+
+double Quantizer::getMaximumDelaySeconds() const
+{
+    return settings.strength * settings.window * 0.5 * largestGap * secondsPerTick;
+}
+
+//==============================================================================
+LiveQuantizer::LiveQuantizer()
+{
+    output.ensureSize(maxPendingEvents * 8);
+}
+
+void LiveQuantizer::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate > 0.0 ? newSampleRate : 44100.0;
+    reset();
+}
+
+void LiveQuantizer::reset()
+{
+    samplesProcessed = 0;
+    originSeconds = 0.0;
+    numPending = 0;
+    for (auto& channel : noteOnTimes)
+        channel.fill(0.0);
+    for (auto& channel : noteOnShifts)
+        channel.fill(0.0);
+    applySettings();
+}
+
+void LiveQuantizer::setSettings(int newGridTicks, float newStrength, float newWindow, float newSwing,
+                                Quantizer::NoteEnds newNoteEnds)
+{
+    gridTicks.store(newGridTicks);
+    strength.store(newStrength);
+    window.store(newWindow);
+    swing.store(newSwing);
+    noteEnds.store(static_cast<int>(newNoteEnds));
+}
+
+void LiveQuantizer::syncToHost(double bpm, double ppqPosition, bool playing)
+{
+    if (bpm <= 0.0)
+        return;
+
+    // The grid is laid out at the float tempo the quantizer keeps, so the origin uses the same value
+    const float hostTempo = static_cast<float>(bpm);
+    tempo.store(hostTempo);
+    if (playing)
+        originSeconds = static_cast<double>(samplesProcessed) / sampleRate - ppqPosition * 60.0 / hostTempo;
+}
+
+void LiveQuantizer::applySettings()
+{
+    Quantizer::Settings wanted;
+    wanted.gridTicks = gridTicks.load();
+    wanted.strength = strength.load();
+    wanted.window = window.load();
+    wanted.swing = swing.load();
+    wanted.noteEnds = static_cast<Quantizer::NoteEnds>(noteEnds.load());
+    wanted.tempo = tempo.load();
+    wanted.originSeconds = originSeconds;
+
+    // Host positions jitter by fractions of a sample; only a real move re-anchors the grid
+    const auto& current = quantizer.getSettings();
+    if (wanted.gridTicks != current.gridTicks || wanted.strength != current.strength
+        || wanted.window != current.window || wanted.swing != current.swing
+        || wanted.noteEnds != current.noteEnds || wanted.tempo != current.tempo
+        || std::abs(wanted.originSeconds - current.originSeconds) * sampleRate > 0.5)
+    {
+        // The table is fixed-size, so rebuilding it here does not allocate
+        quantizer.setSettings(wanted);
+    }
+
+    latency = quantizer.getMaximumDelaySeconds();
+    latencySeconds.store(latency);
+}
+
+void LiveQuantizer::schedule(double time, const std::uint8_t* data, int size)
+{
+    if (numPending >= maxPendingEvents)
+    {
+        // A burst beyond the array's capacity passes through unquantized
+        output.addEvent(data, size, 0);
+        return;
+    }
+
+    // Equal times keep their arrival order
+    int position = numPending;
+    while (position > 0 && pending[static_cast<size_t>(position - 1)].time > time)
+    {
+        pending[static_cast<size_t>(position)] = pending[static_cast<size_t>(position - 1)];
+        --position;
+    }
+
+    auto& event = pending[static_cast<size_t>(position)];
+    event.time = time;
+    event.size = static_cast<std::uint8_t>(size);
+    std::copy(data, data + size, event.data);
+    ++numPending;
+}
+
+void LiveQuantizer::process(juce::MidiBuffer& midi, int numSamples)
+{
+    applySettings();
+    output.clear();
+
+    const auto ends = quantizer.getSettings().noteEnds;
+
+    for (const auto metadata : midi)
+    {
+        const auto message = metadata.getMessage();
+        const auto* data = message.getRawData();
+        const int size = message.getRawDataSize();
+
+        // Only short channel messages are delayed; anything else goes straight through
+        if (size > 3 || message.isSysEx() || message.isMetaEvent())
+        {
+            output.addEvent(data, size, metadata.samplePosition);
+            continue;
+        }
+
+        const double time = static_cast<double>(samplesProcessed + metadata.samplePosition) / sampleRate;
+        double outTime = time + latency;
+
+        if (message.isNoteOnOrOff())
+        {
+            const auto channel = static_cast<size_t>(message.getChannel() - 1) & 15;
+            const auto note = static_cast<size_t>(message.getNoteNumber()) & 127;
+
+            if (message.isNoteOn())
+            {
+                outTime = quantizer.quantizeTime(time) + latency;
+                noteOnTimes[channel][note] = outTime;
+                noteOnShifts[channel][note] = outTime - time;
+            }
+            else
+            {
+                if (ends == Quantizer::NoteEnds::KeepLength)
+                    outTime = time + noteOnShifts[channel][note];
+                else if (ends == Quantizer::NoteEnds::Quantize)
+                    outTime = quantizer.quantizeTime(time) + latency;
+
+                // Never before the note it ends
+                outTime = juce::jmax(outTime, noteOnTimes[channel][note]);
+            }
+        }
+
+        schedule(outTime, data, size);
+    }
+
+    // Everything due in this block, at its sample position
+    const double blockEnd = static_cast<double>(samplesProcessed + numSamples) / sampleRate;
+    int due = 0;
+    while (due < numPending && pending[static_cast<size_t>(due)].time < blockEnd)
+    {
+        const auto& event = pending[static_cast<size_t>(due)];
+        const auto position = static_cast<std::int64_t>(event.time * sampleRate) - samplesProcessed;
+        output.addEvent(event.data, event.size, static_cast<int>(juce::jlimit<std::int64_t>(0, juce::jmax(0, numSamples - 1), position)));
+        ++due;
+    }
+
+    if (due > 0)
+    {
+        std::move(pending.begin() + due, pending.begin() + numPending, pending.begin());
+        numPending -= due;
+    }
+
+    midi.clear();
+    midi.addEvents(output, 0, -1, 0);
+    samplesProcessed += numSamples;
+}
+
+void LiveQuantizer::flush(juce::MidiBuffer& midi)
+{
+    for (int i = 0; i < numPending; ++i)
+        midi.addEvent(pending[static_cast<size_t>(i)].data, pending[static_cast<size_t>(i)].size, 0);
+    numPending = 0;
+}
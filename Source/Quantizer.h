@@ -0,0 +1,171 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "NoteEvents.h"
+
+/**
+ * Quantizer
+ * Pulls notes in the shared NoteEvent format towards a grid on the tick
+ * timeline, at the same 960 PPQ resolution as the arpeggiator. One cycle of
+ * grid targets is precomputed as a table: a straight grid, a swing grid that
+ * delays every second step, or a groove template with per-step offsets and
+ * velocity scales. Each note then only looks at the table entries around its
+ * own tick, so a whole file costs O(n). Strength moves a note part of the way.
+ * The window leaves notes alone when they are too far from the grid, so
+ * deliberate pushes survive. The note ends keep the length, snap to the grid
+ * as well, or stay where they were.
+ */
+class Quantizer
+{
+public:
+    static constexpr int ticksPerQuarter = 960;
+    static constexpr int maxCyclePoints = 64;
+
+    enum class NoteEnds
+    {
+        KeepLength,
+        Quantize,
+        KeepEnd
+    };
+
+    struct Settings
+    {
+        int gridTicks = ticksPerQuarter / 4; // sixteenths
+        float strength = 1.0f;               // 0 leaves notes alone, 1 snaps them
+        float window = 1.0f;                 // share of half the gap between targets that is captured
+        float swing = 0.0f;                  // delay of every second step, as a share of a step (1/3 is triplet feel)
+        NoteEnds noteEnds = NoteEnds::KeepLength;
+        float tempo = 120.0f;
+        double originSeconds = 0.0;          // time of tick 0
+    };
+
+    Quantizer();
+    explicit Quantizer(const Settings& settings);
+
+    void setSettings(const Settings& newSettings);
+    const Settings& getSettings() const { return settings; }
+
+    // Per-step offsets in steps (clamped to +-0.45) and velocity scales over one cycle; replaces swing
+    void setGrooveTemplate(const float* offsets, const float* velocityScales, int numPoints);
+    void clearGrooveTemplate();
+    bool hasGrooveTemplate() const { return templatePoints > 0; }
+
+    // Takes the groove of a played part: averages each cycle step's offset and velocity over the notes
+    void setGrooveTemplateFromNotes(const std::vector<NoteEvent>& notes, int numPoints);
+
+    // Quantized start time, with the strength and window applied
+    double quantizeTime(double seconds) const;
+
+    void quantize(NoteEvent& note) const;
+    void quantize(std::vector<NoteEvent>& notes) const;
+
+    // Furthest a note can move later. A live path that delays everything by this much never has to move a note into the past.
+    double getMaximumDelaySeconds() const;
+
+    double ticksToSeconds(double ticks) const { return settings.originSeconds + ticks * secondsPerTick; }
+    double secondsToTicks(double seconds) const { return (seconds - settings.originSeconds) / secondsPerTick; }
+
+private:
+    void rebuildTable();
+
+    // Where tick is pulled to, and the velocity scale of that target
+    double findTarget(double tick, float& velocityScale) const;
+    double getTargetTick(std::int64_t step) const;
+
+    Settings settings;
+    double secondsPerTick = 0.0;
+
+    // Groove template as given, in steps
+    std::array<float, maxCyclePoints> templateOffsets {};
+    std::array<float, maxCyclePoints> templateVelocities {};
+    int templatePoints = 0;
+
+    // One cycle of targets, in ticks from the start of the cycle
+    std::array<double, maxCyclePoints> targetTicks {};
+    std::array<float, maxCyclePoints> targetVelocities {};
+    int cyclePoints = 1;
+    double cycleTicks = 0.0;
+    double largestGap = 0.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Quantizer)
+};
+
+/**
+ * Live Quantizer
+ * Quantizes the incoming MIDI of the realtime path on the host's beat grid.
+ * A note can only move later, so every event is delayed by the quantizer's
+ * largest forward move. The latency is bounded by half the widest grid gap
+ * times the window and strength. Note-ons go out at their target plus that
+ * delay, and note-offs follow the note-end setting. Pending events sit in a
+ * fixed-size, time-sorted array, and the output is built in a buffer sized up
+ * front. Settings are atomics that the audio thread compares at the start of
+ * each block.
+ */
+class LiveQuantizer
+{
+public:
+    static constexpr int maxPendingEvents = 512;
+
+    LiveQuantizer();
+
+    // Message thread: resets the clock; until a host position arrives, the grid starts at the first sample after this
+    void prepare(double sampleRate);
+    void reset();
+
+    // Safe to call while processing
+    void setSettings(int gridTicks, float strength, float window, float swing, Quantizer::NoteEnds noteEnds);
+    void setTempo(float bpm) { tempo.store(bpm); }
+
+    // Audio thread, before process(): takes the host's tempo and, while it plays, puts tick 0 on its beat 0.
+    // A stopped transport leaves the grid where it was, running on at the tempo.
+    void syncToHost(double bpm, double ppqPosition, bool playing);
+
+    // Audio thread: replaces the buffer's contents with the quantized, delayed events
+    void process(juce::MidiBuffer& midi, int numSamples);
+
+    // Audio thread: adds every pending event at the start of the buffer, so no note is left hanging
+    void flush(juce::MidiBuffer& midi);
+
+    // Current delay of the live path
+    double getLatencySeconds() const { return latencySeconds.load(); }
+
+private:
+    struct PendingEvent
+    {
+        double time = 0.0;
+        std::uint8_t data[3] {};
+        std::uint8_t size = 0;
+    };
+
+    void applySettings();
+    void schedule(double time, const std::uint8_t* data, int size);
+
+    double sampleRate = 44100.0;
+    std::int64_t samplesProcessed = 0;
+    double originSeconds = 0.0; // audio thread only
+
+    std::atomic<int> gridTicks { Quantizer::ticksPerQuarter / 4 };
+    std::atomic<float> strength { 1.0f };
+    std::atomic<float> window { 1.0f };
+    std::atomic<float> swing { 0.0f };
+    std::atomic<int> noteEnds { static_cast<int>(Quantizer::NoteEnds::KeepLength) };
+    std::atomic<float> tempo { 120.0f };
+    std::atomic<double> latencySeconds { 0.0 };
+
+    // Audio thread only
+    Quantizer quantizer;
+    double latency = 0.0;
+    std::array<PendingEvent, maxPendingEvents> pending;
+    int numPending = 0;
+    juce::MidiBuffer output;
+
+    // When each sounding note went out, and how far its note-on moved
+    std::array<std::array<double, 128>, 16> noteOnTimes {};
+    std::array<std::array<double, 128>, 16> noteOnShifts {};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LiveQuantizer)
+};
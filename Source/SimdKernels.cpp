@@ -0,0 +1,288 @@
+#include "SimdKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+ #define AAMATI_SIMD_X86 1
+ #if defined(_MSC_VER)
+  #include <intrin.h>
+ #else
+  #include <cpuid.h>
+ #endif
+#endif
+
+namespace
+{
+    // Portable fallback kernels, also used for the tails of the vector paths
+    float scalarDotProduct(const float* a, const float* b, size_t n)
+    {
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; ++i)
+            sum += a[i] * b[i];
+        return sum;
+    }
+
+    double scalarSumOfSquares(const float* data, size_t n)
+    {
+        double sum = 0.0;
+        for (size_t i = 0; i < n; ++i)
+            sum += static_cast<double>(data[i]) * data[i];
+        return sum;
+    }
+
+    double scalarSum(const float* data, size_t n)
+    {
+        double sum = 0.0;
+        for (size_t i = 0; i < n; ++i)
+            sum += data[i];
+        return sum;
+    }
+
+    void scalarMinMax(const float* data, size_t n, float& minValue, float& maxValue)
+    {
+        if (n == 0)
+        {
+            minValue = maxValue = 0.0f;
+            return;
+        }
+
+        float lo = data[0];
+        float hi = data[0];
+        for (size_t i = 1; i < n; ++i)
+        {
+            lo = std::min(lo, data[i]);
+            hi = std::max(hi, data[i]);
+        }
+        minValue = lo;
+        maxValue = hi;
+    }
+
+    size_t scalarCountAboveAbs(const float* data, size_t n, float threshold)
+    {
+        size_t count = 0;
+        for (size_t i = 0; i < n; ++i)
+            count += std::abs(data[i]) > threshold ? 1 : 0;
+        return count;
+    }
+
+    void scalarScaleClamp(float* data, size_t n, float gain, float offset, float lowest, float highest)
+    {
+        for (size_t i = 0; i < n; ++i)
+            data[i] = std::min(highest, std::max(lowest, data[i] * gain + offset));
+    }
+
+    void scalarAbsolute(const float* src, float* dest, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+            dest[i] = std::abs(src[i]);
+    }
+
+    void scalarAffine(const float* src, float* dest, size_t n, float scale, float offset)
+    {
+        for (size_t i = 0; i < n; ++i)
+            dest[i] = src[i] * scale + offset;
+    }
+
+    void scalarMidSide(float* left, float* right, size_t n, float midGain, float sideGain)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            float mid = (left[i] + right[i]) * 0.5f * midGain;
+            float side = (left[i] - right[i]) * 0.5f * sideGain;
+            left[i] = mid + side;
+            right[i] = mid - side;
+        }
+    }
+
+    void scalarPanMix(const float* src, float* left, float* right, size_t n, float leftGain, float rightGain)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            left[i] += src[i] * leftGain;
+            right[i] += src[i] * rightGain;
+        }
+    }
+
+    void scalarMatrixVector(const float* matrix, const float* vector, float* out, size_t numRows, size_t numColumns)
+    {
+        for (size_t r = 0; r < numRows; ++r)
+            out[r] = 0.0f;
+        for (size_t c = 0; c < numColumns; ++c)
+        {
+            const float* column = matrix + c * numRows;
+            for (size_t r = 0; r < numRows; ++r)
+                out[r] += column[r] * vector[c];
+        }
+    }
+
+    void scalarComplexMagnitude(const float* interleaved, float* magnitudes, size_t numBins)
+    {
+        for (size_t i = 0; i < numBins; ++i)
+        {
+            float re = interleaved[2 * i];
+            float im = interleaved[2 * i + 1];
+            magnitudes[i] = std::sqrt(re * re + im * im);
+        }
+    }
+
+    SimdKernels::Isa parseIsaOverride(const char* text, SimdKernels::Isa fallback)
+    {
+        if (text == nullptr) return fallback;
+        if (std::strcmp(text, "scalar") == 0) return SimdKernels::Isa::Scalar;
+        if (std::strcmp(text, "sse2") == 0) return SimdKernels::Isa::SSE2;
+        if (std::strcmp(text, "avx2") == 0) return SimdKernels::Isa::AVX2;
+        if (std::strcmp(text, "avx512") == 0) return SimdKernels::Isa::AVX512;
+        return fallback;
+    }
+
+#if AAMATI_SIMD_X86
+    void cpuid(int leaf, int subleaf, unsigned int regs[4])
+    {
+       #if defined(_MSC_VER)
+        int info[4];
+        __cpuidex(info, leaf, subleaf);
+        for (int i = 0; i < 4; ++i) regs[i] = static_cast<unsigned int>(info[i]);
+       #else
+        __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+       #endif
+    }
+
+    unsigned long long readXcr0()
+    {
+       #if defined(_MSC_VER)
+        return _xgetbv(0);
+       #else
+        unsigned int eax = 0, edx = 0;
+        __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return (static_cast<unsigned long long>(edx) << 32) | eax;
+       #endif
+    }
+#endif
+}
+
+const SimdKernels::KernelTable* getScalarKernelTable()
+{
+    static const SimdKernels::KernelTable table = []
+    {
+        SimdKernels::KernelTable t;
+        t.isa = SimdKernels::Isa::Scalar;
+        t.dotProduct = scalarDotProduct;
+        t.sumOfSquares = scalarSumOfSquares;
+        t.sum = scalarSum;
+        t.minMax = scalarMinMax;
+        t.countAboveAbs = scalarCountAboveAbs;
+        t.scaleClamp = scalarScaleClamp;
+        t.absolute = scalarAbsolute;
+        t.affine = scalarAffine;
+        t.midSide = scalarMidSide;
+        t.panMix = scalarPanMix;
+        t.complexMagnitude = scalarComplexMagnitude;
+        t.matrixVector = scalarMatrixVector;
+        return t;
+    }();
+    return &table;
+}
+
+SimdKernels::Isa SimdKernels::detectHardwareIsa()
+{
+    Isa best = Isa::Scalar;
+
+   #if AAMATI_SIMD_X86
+    unsigned int regs[4] = {};
+    cpuid(0, 0, regs);
+    const unsigned int maxLeaf = regs[0];
+
+    cpuid(1, 0, regs);
+    const bool hasSSE2 = (regs[3] & (1u << 26)) != 0;
+    const bool hasOsxsave = (regs[2] & (1u << 27)) != 0;
+    const bool hasFma = (regs[2] & (1u << 12)) != 0;
+
+    if (hasSSE2)
+        best = Isa::SSE2;
+
+    if (hasOsxsave && maxLeaf >= 7)
+    {
+        // The OS must save YMM/ZMM state across context switches, not just the CPU support it
+        const unsigned long long xcr0 = readXcr0();
+        const bool osSavesYmm = (xcr0 & 0x6) == 0x6;
+        const bool osSavesZmm = (xcr0 & 0xE6) == 0xE6;
+
+        cpuid(7, 0, regs);
+        const bool hasAVX2 = (regs[1] & (1u << 5)) != 0;
+        const bool hasAVX512F = (regs[1] & (1u << 16)) != 0;
+
+        if (osSavesYmm && hasAVX2 && hasFma)
+            best = Isa::AVX2;
+        if (osSavesZmm && hasAVX512F && best == Isa::AVX2)
+            best = Isa::AVX512;
+    }
+   #endif
+
+    return best;
+}
+
+SimdKernels::Isa SimdKernels::detectIsa()
+{
+    const Isa hardware = detectHardwareIsa();
+
+    // Render hosts can cap the ISA (e.g. to avoid AVX-512 clock throttling)
+    const Isa requested = parseIsaOverride(std::getenv("AAMATI_SIMD_ISA"), hardware);
+    return std::min(requested, hardware);
+}
+
+const SimdKernels::KernelTable& SimdKernels::get()
+{
+    static const KernelTable* table = []
+    {
+        const KernelTable* selected = getTableFor(detectIsa());
+        return selected != nullptr ? selected : getScalarKernelTable();
+    }();
+    return *table;
+}
+
+const SimdKernels::KernelTable* SimdKernels::getTableFor(Isa isa)
+{
+    if (!isSupported(isa))
+        return nullptr;
+
+    switch (isa)
+    {
+        case Isa::AVX512: return getAVX512KernelTable();
+        case Isa::AVX2:   return getAVX2KernelTable();
+        case Isa::SSE2:   return getSSE2KernelTable();
+        case Isa::Scalar: break;
+    }
+    return getScalarKernelTable();
+}
+
+bool SimdKernels::isSupported(Isa isa)
+{
+    // Checked against the hardware rather than the environment cap so benchmarks can compare every ISA
+    static const Isa hardware = detectHardwareIsa();
+
+    if (isa > hardware)
+        return false;
+
+    switch (isa)
+    {
+        case Isa::AVX512: return getAVX512KernelTable() != nullptr;
+        case Isa::AVX2:   return getAVX2KernelTable() != nullptr;
+        case Isa::SSE2:   return getSSE2KernelTable() != nullptr;
+        case Isa::Scalar: break;
+    }
+    return true;
+}
+
+const char* SimdKernels::getIsaName(Isa isa)
+{
+    switch (isa)
+    {
+        case Isa::Scalar: return "scalar";
+        case Isa::SSE2:   return "sse2";
+        case Isa::AVX2:   return "avx2";
+        case Isa::AVX512: return "avx512";
+    }
+    return "unknown";
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * SIMD Kernel Layer
+ * Vectorized inner loops for analysis and DSP. The best instruction set
+ * (AVX-512, AVX2, SSE2 or a portable scalar fallback) is chosen once per
+ * process from CPUID and every caller goes through the same kernel table.
+ */
+class SimdKernels
+{
+public:
+    enum class Isa
+    {
+        Scalar,
+        SSE2,
+        AVX2,
+        AVX512
+    };
+
+    struct KernelTable
+    {
+        Isa isa = Isa::Scalar;
+
+        // Reductions. sum and sumOfSquares accumulate in double, as the long history windows need it
+        float (*dotProduct)(const float* a, const float* b, size_t numSamples) = nullptr;
+        double (*sumOfSquares)(const float* data, size_t numSamples) = nullptr;
+        double (*sum)(const float* data, size_t numSamples) = nullptr;
+        void (*minMax)(const float* data, size_t numSamples, float& minValue, float& maxValue) = nullptr;
+        size_t (*countAboveAbs)(const float* data, size_t numSamples, float threshold) = nullptr;
+
+        // Element-wise transforms (dest may alias src)
+        void (*scaleClamp)(float* data, size_t numSamples, float gain, float offset, float lowest, float highest) = nullptr;
+        void (*absolute)(const float* src, float* dest, size_t numSamples) = nullptr;
+        void (*affine)(const float* src, float* dest, size_t numSamples, float scale, float offset) = nullptr;
+        void (*midSide)(float* left, float* right, size_t numSamples, float midGain, float sideGain) = nullptr;
+
+        // Mixing: left += src * leftGain, right += src * rightGain
+        void (*panMix)(const float* src, float* left, float* right, size_t numSamples, float leftGain, float rightGain) = nullptr;
+
+        // Spectral: interleaved (re, im) pairs -> magnitudes
+        void (*complexMagnitude)(const float* interleaved, float* magnitudes, size_t numBins) = nullptr;
+
+        // Template matching: out[r] = sum over c of matrix[c * numRows + r] * vector[c].
+        // Column-major, so each column is one contiguous run across all the rows.
+        void (*matrixVector)(const float* matrix, const float* vector, float* out, size_t numRows, size_t numColumns) = nullptr;
+    };
+
+    // Kernel table selected at startup for this CPU
+    static const KernelTable& get();
+
+    // Instruction set backing get()
+    static Isa getActiveIsa() { return get().isa; }
+
+    // Table for a specific instruction set, or nullptr if this build/CPU can't run it
+    static const KernelTable* getTableFor(Isa isa);
+
+    static bool isSupported(Isa isa);
+    static const char* getIsaName(Isa isa);
+
+    // Convenience wrappers over get()
+    static float dotProduct(const float* a, const float* b, size_t n) { return get().dotProduct(a, b, n); }
+    static double sumOfSquares(const float* data, size_t n) { return get().sumOfSquares(data, n); }
+    static double sum(const float* data, size_t n) { return get().sum(data, n); }
+    static void minMax(const float* data, size_t n, float& minValue, float& maxValue) { get().minMax(data, n, minValue, maxValue); }
+    static size_t countAboveAbs(const float* data, size_t n, float threshold) { return get().countAboveAbs(data, n, threshold); }
+    static void scaleClamp(float* data, size_t n, float gain, float offset, float lowest, float highest) { get().scaleClamp(data, n, gain, offset, lowest, highest); }
+    static void absolute(const float* src, float* dest, size_t n) { get().absolute(src, dest, n); }
+    static void affine(const float* src, float* dest, size_t n, float scale, float offset) { get().affine(src, dest, n, scale, offset); }
+    static void midSide(float* left, float* right, size_t n, float midGain, float sideGain) { get().midSide(left, right, n, midGain, sideGain); }
+    static void panMix(const float* src, float* left, float* right, size_t n, float leftGain, float rightGain) { get().panMix(src, left, right, n, leftGain, rightGain); }
+    static void complexMagnitude(const float* interleaved, float* magnitudes, size_t numBins) { get().complexMagnitude(interleaved, magnitudes, numBins); }
+    static void matrixVector(const float* matrix, const float* vector, float* out, size_t numRows, size_t numColumns) { get().matrixVector(matrix, vector, out, numRows, numColumns); }
+
+private:
+    static Isa detectHardwareIsa();
+    static Isa detectIsa();
+};
+
+// Per-ISA tables; each returns nullptr when its translation unit was built for a non-x86 target
+const SimdKernels::KernelTable* getScalarKernelTable();
+const SimdKernels::KernelTable* getSSE2KernelTable();
+const SimdKernels::KernelTable* getAVX2KernelTable();
+const SimdKernels::KernelTable* getAVX512KernelTable();
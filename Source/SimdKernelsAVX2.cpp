@@ -0,0 +1,296 @@
+#include "SimdKernels.h"
+
+// Built with AVX2/FMA code generation (see CMakeLists.txt); only reached after CPUID confirms support
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+
+#include <immintrin.h>
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    inline float horizontalSum(__m256 v)
+    {
+        __m128 sums = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+        __m128 shuffled = _mm_movehdup_ps(sums);
+        sums = _mm_add_ps(sums, shuffled);
+        shuffled = _mm_movehl_ps(shuffled, sums);
+        return _mm_cvtss_f32(_mm_add_ss(sums, shuffled));
+    }
+
+    inline double horizontalSum(__m256d v)
+    {
+        const __m128d sums = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(sums, _mm_unpackhi_pd(sums, sums)));
+    }
+
+    inline __m256 absMask()
+    {
+        return _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    }
+
+    float dotProductAVX2(const float* a, const float* b, size_t n)
+    {
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16)
+        {
+            acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+            acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+        }
+        for (; i + 8 <= n; i += 8)
+            acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        float sum = horizontalSum(_mm256_add_ps(acc0, acc1));
+        for (; i < n; ++i)
+            sum += a[i] * b[i];
+        return sum;
+    }
+
+    // Each group of eight floats is widened into two four-lane double vectors before accumulating
+    double sumOfSquaresAVX2(const float* data, size_t n)
+    {
+        __m256d acc0 = _mm256_setzero_pd();
+        __m256d acc1 = _mm256_setzero_pd();
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            const __m256 v = _mm256_loadu_ps(data + i);
+            const __m256d lo = _mm256_cvtps_pd(_mm256_castps256_ps128(v));
+            const __m256d hi = _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1));
+            acc0 = _mm256_fmadd_pd(lo, lo, acc0);
+            acc1 = _mm256_fmadd_pd(hi, hi, acc1);
+        }
+        double sum = horizontalSum(_mm256_add_pd(acc0, acc1));
+        for (; i < n; ++i)
+            sum += static_cast<double>(data[i]) * data[i];
+        return sum;
+    }
+
+    double sumAVX2(const float* data, size_t n)
+    {
+        __m256d acc0 = _mm256_setzero_pd();
+        __m256d acc1 = _mm256_setzero_pd();
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            const __m256 v = _mm256_loadu_ps(data + i);
+            acc0 = _mm256_add_pd(acc0, _mm256_cvtps_pd(_mm256_castps256_ps128(v)));
+            acc1 = _mm256_add_pd(acc1, _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)));
+        }
+        double sum = horizontalSum(_mm256_add_pd(acc0, acc1));
+        for (; i < n; ++i)
+            sum += data[i];
+        return sum;
+    }
+
+    void minMaxAVX2(const float* data, size_t n, float& minValue, float& maxValue)
+    {
+        if (n == 0)
+        {
+            minValue = maxValue = 0.0f;
+            return;
+        }
+
+        float lo = data[0];
+        float hi = data[0];
+        size_t i = 0;
+        if (n >= 8)
+        {
+            __m256 vmin = _mm256_loadu_ps(data);
+            __m256 vmax = vmin;
+            for (i = 8; i + 8 <= n; i += 8)
+            {
+                __m256 v = _mm256_loadu_ps(data + i);
+                vmin = _mm256_min_ps(vmin, v);
+                vmax = _mm256_max_ps(vmax, v);
+            }
+            alignas(32) float lanesMin[8], lanesMax[8];
+            _mm256_store_ps(lanesMin, vmin);
+            _mm256_store_ps(lanesMax, vmax);
+            lo = *std::min_element(lanesMin, lanesMin + 8);
+            hi = *std::max_element(lanesMax, lanesMax + 8);
+        }
+        for (; i < n; ++i)
+        {
+            lo = std::min(lo, data[i]);
+            hi = std::max(hi, data[i]);
+        }
+        minValue = lo;
+        maxValue = hi;
+    }
+
+    size_t countAboveAbsAVX2(const float* data, size_t n, float threshold)
+    {
+        const __m256 mask = absMask();
+        const __m256 limit = _mm256_set1_ps(threshold);
+        __m256i counts = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            __m256 magnitude = _mm256_and_ps(_mm256_loadu_ps(data + i), mask);
+            __m256 hit = _mm256_cmp_ps(magnitude, limit, _CMP_GT_OQ);
+            counts = _mm256_sub_epi32(counts, _mm256_castps_si256(hit));
+        }
+        alignas(32) int lanes[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), counts);
+        size_t count = 0;
+        for (int lane : lanes)
+            count += static_cast<size_t>(lane);
+        for (; i < n; ++i)
+            count += std::abs(data[i]) > threshold ? 1 : 0;
+        return count;
+    }
+
+    void scaleClampAVX2(float* data, size_t n, float gain, float offset, float lowest, float highest)
+    {
+        const __m256 g = _mm256_set1_ps(gain);
+        const __m256 o = _mm256_set1_ps(offset);
+        const __m256 lo = _mm256_set1_ps(lowest);
+        const __m256 hi = _mm256_set1_ps(highest);
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            __m256 v = _mm256_fmadd_ps(_mm256_loadu_ps(data + i), g, o);
+            _mm256_storeu_ps(data + i, _mm256_min_ps(hi, _mm256_max_ps(lo, v)));
+        }
+        for (; i < n; ++i)
+            data[i] = std::min(highest, std::max(lowest, data[i] * gain + offset));
+    }
+
+    void absoluteAVX2(const float* src, float* dest, size_t n)
+    {
+        const __m256 mask = absMask();
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+            _mm256_storeu_ps(dest + i, _mm256_and_ps(_mm256_loadu_ps(src + i), mask));
+        for (; i < n; ++i)
+            dest[i] = std::abs(src[i]);
+    }
+
+    void affineAVX2(const float* src, float* dest, size_t n, float scale, float offset)
+    {
+        const __m256 s = _mm256_set1_ps(scale);
+        const __m256 o = _mm256_set1_ps(offset);
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+            _mm256_storeu_ps(dest + i, _mm256_fmadd_ps(_mm256_loadu_ps(src + i), s, o));
+        for (; i < n; ++i)
+            dest[i] = src[i] * scale + offset;
+    }
+
+    void midSideAVX2(float* left, float* right, size_t n, float midGain, float sideGain)
+    {
+        const __m256 mg = _mm256_set1_ps(0.5f * midGain);
+        const __m256 sg = _mm256_set1_ps(0.5f * sideGain);
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            __m256 l = _mm256_loadu_ps(left + i);
+            __m256 r = _mm256_loadu_ps(right + i);
+            __m256 mid = _mm256_mul_ps(_mm256_add_ps(l, r), mg);
+            __m256 side = _mm256_mul_ps(_mm256_sub_ps(l, r), sg);
+            _mm256_storeu_ps(left + i, _mm256_add_ps(mid, side));
+            _mm256_storeu_ps(right + i, _mm256_sub_ps(mid, side));
+        }
+        for (; i < n; ++i)
+        {
+            float mid = (left[i] + right[i]) * 0.5f * midGain;
+            float side = (left[i] - right[i]) * 0.5f * sideGain;
+            left[i] = mid + side;
+            right[i] = mid - side;
+        }
+    }
+
+    void panMixAVX2(const float* src, float* left, float* right, size_t n, float leftGain, float rightGain)
+    {
+        const __m256 lg = _mm256_set1_ps(leftGain);
+        const __m256 rg = _mm256_set1_ps(rightGain);
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            __m256 s = _mm256_loadu_ps(src + i);
+            _mm256_storeu_ps(left + i, _mm256_fmadd_ps(s, lg, _mm256_loadu_ps(left + i)));
+            _mm256_storeu_ps(right + i, _mm256_fmadd_ps(s, rg, _mm256_loadu_ps(right + i)));
+        }
+        for (; i < n; ++i)
+        {
+            left[i] += src[i] * leftGain;
+            right[i] += src[i] * rightGain;
+        }
+    }
+
+    void matrixVectorAVX2(const float* matrix, const float* vector, float* out, size_t numRows, size_t numColumns)
+    {
+        size_t r = 0;
+        for (; r + 8 <= numRows; r += 8)
+        {
+            __m256 acc = _mm256_setzero_ps();
+            for (size_t c = 0; c < numColumns; ++c)
+                acc = _mm256_fmadd_ps(_mm256_loadu_ps(matrix + c * numRows + r), _mm256_set1_ps(vector[c]), acc);
+            _mm256_storeu_ps(out + r, acc);
+        }
+        for (; r < numRows; ++r)
+        {
+            float acc = 0.0f;
+            for (size_t c = 0; c < numColumns; ++c)
+                acc += matrix[c * numRows + r] * vector[c];
+            out[r] = acc;
+        }
+    }
+
+    void complexMagnitudeAVX2(const float* interleaved, float* magnitudes, size_t numBins)
+    {
+        size_t i = 0;
+        for (; i + 8 <= numBins; i += 8)
+        {
+            __m256 a = _mm256_loadu_ps(interleaved + 2 * i);
+            __m256 b = _mm256_loadu_ps(interleaved + 2 * i + 8);
+            // In-lane shuffles give bins [0 1 4 5 | 2 3 6 7]; the 64-bit permute restores order
+            __m256 re = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            __m256 im = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+            __m256 power = _mm256_fmadd_ps(re, re, _mm256_mul_ps(im, im));
+            __m256 magnitude = _mm256_sqrt_ps(power);
+            magnitude = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(magnitude), _MM_SHUFFLE(3, 1, 2, 0)));
+            _mm256_storeu_ps(magnitudes + i, magnitude);
+        }
+        for (; i < numBins; ++i)
+        {
+            float re = interleaved[2 * i];
+            float im = interleaved[2 * i + 1];
+            magnitudes[i] = std::sqrt(re * re + im * im);
+        }
+    }
+}
+
+const SimdKernels::KernelTable* getAVX2KernelTable()
+{
+    static const SimdKernels::KernelTable table = []
+    {
+        SimdKernels::KernelTable t;
+        t.isa = SimdKernels::Isa::AVX2;
+        t.dotProduct = dotProductAVX2;
+        t.sumOfSquares = sumOfSquaresAVX2;
+        t.sum = sumAVX2;
+        t.minMax = minMaxAVX2;
+        t.countAboveAbs = countAboveAbsAVX2;
+        t.scaleClamp = scaleClampAVX2;
+        t.absolute = absoluteAVX2;
+        t.affine = affineAVX2;
+        t.midSide = midSideAVX2;
+        t.panMix = panMixAVX2;
+        t.complexMagnitude = complexMagnitudeAVX2;
+        t.matrixVector = matrixVectorAVX2;
+        return t;
+    }();
+    return &table;
+}
+
+#else
+
+const SimdKernels::KernelTable* getAVX2KernelTable()
+{
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,242 @@
+#include "SimdKernels.h"
+
+// Built with AVX-512F code generation (see CMakeLists.txt); only reached after CPUID confirms support
+#if defined(__AVX512F__)
+
+#include <immintrin.h>
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Masked loads cover the tail, so none of these kernels need a scalar epilogue
+    inline __mmask16 tailMask(size_t remaining)
+    {
+        return remaining >= 16 ? static_cast<__mmask16>(0xFFFF)
+                               : static_cast<__mmask16>((1u << remaining) - 1u);
+    }
+
+    // Upper eight floats, without the AVX512DQ extract
+    inline __m256 upperHalf(__m512 v)
+    {
+        return _mm256_castsi256_ps(_mm512_extracti64x4_epi64(_mm512_castps_si512(v), 1));
+    }
+
+    inline __m512 absolute(__m512 v)
+    {
+        return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(v), _mm512_set1_epi32(0x7fffffff)));
+    }
+
+    float dotProductAVX512(const float* a, const float* b, size_t n)
+    {
+        __m512 acc0 = _mm512_setzero_ps();
+        __m512 acc1 = _mm512_setzero_ps();
+        size_t i = 0;
+        for (; i + 32 <= n; i += 32)
+        {
+            acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+            acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16), acc1);
+        }
+        for (; i < n; i += 16)
+        {
+            const __mmask16 m = tailMask(n - i);
+            acc0 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, a + i), _mm512_maskz_loadu_ps(m, b + i), acc0);
+        }
+        return _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+    }
+
+    // Each group of sixteen floats is widened into two eight-lane double vectors before accumulating
+    double sumOfSquaresAVX512(const float* data, size_t n)
+    {
+        __m512d acc0 = _mm512_setzero_pd();
+        __m512d acc1 = _mm512_setzero_pd();
+        for (size_t i = 0; i < n; i += 16)
+        {
+            const __m512 v = _mm512_maskz_loadu_ps(tailMask(n - i), data + i);
+            const __m512d lo = _mm512_cvtps_pd(_mm512_castps512_ps256(v));
+            const __m512d hi = _mm512_cvtps_pd(upperHalf(v));
+            acc0 = _mm512_fmadd_pd(lo, lo, acc0);
+            acc1 = _mm512_fmadd_pd(hi, hi, acc1);
+        }
+        return _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1));
+    }
+
+    double sumAVX512(const float* data, size_t n)
+    {
+        __m512d acc0 = _mm512_setzero_pd();
+        __m512d acc1 = _mm512_setzero_pd();
+        for (size_t i = 0; i < n; i += 16)
+        {
+            const __m512 v = _mm512_maskz_loadu_ps(tailMask(n - i), data + i);
+            acc0 = _mm512_add_pd(acc0, _mm512_cvtps_pd(_mm512_castps512_ps256(v)));
+            acc1 = _mm512_add_pd(acc1, _mm512_cvtps_pd(upperHalf(v)));
+        }
+        return _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1));
+    }
+
+    void minMaxAVX512(const float* data, size_t n, float& minValue, float& maxValue)
+    {
+        if (n == 0)
+        {
+            minValue = maxValue = 0.0f;
+            return;
+        }
+
+        // Masked-off lanes keep the seed value, which is always a real sample
+        __m512 vmin = _mm512_set1_ps(data[0]);
+        __m512 vmax = vmin;
+        for (size_t i = 0; i < n; i += 16)
+        {
+            const __mmask16 m = tailMask(n - i);
+            __m512 v = _mm512_mask_loadu_ps(vmin, m, data + i);
+            __m512 w = _mm512_mask_loadu_ps(vmax, m, data + i);
+            vmin = _mm512_min_ps(vmin, v);
+            vmax = _mm512_max_ps(vmax, w);
+        }
+        minValue = _mm512_reduce_min_ps(vmin);
+        maxValue = _mm512_reduce_max_ps(vmax);
+    }
+
+    size_t countAboveAbsAVX512(const float* data, size_t n, float threshold)
+    {
+        const __m512 limit = _mm512_set1_ps(threshold);
+        const __m512i one = _mm512_set1_epi32(1);
+        __m512i counts = _mm512_setzero_si512();
+        for (size_t i = 0; i < n; i += 16)
+        {
+            const __mmask16 m = tailMask(n - i);
+            __m512 magnitude = absolute(_mm512_maskz_loadu_ps(m, data + i));
+            const __mmask16 hit = _mm512_mask_cmp_ps_mask(m, magnitude, limit, _CMP_GT_OQ);
+            counts = _mm512_mask_add_epi32(counts, hit, counts, one);
+        }
+        return static_cast<size_t>(_mm512_reduce_add_epi32(counts));
+    }
+
+    void scaleClampAVX512(float* data, size_t n, float gain, float offset, float lowest, float highest)
+    {
+        const __m512 g = _mm512_set1_ps(gain);
+        const __m512 o = _mm512_set1_ps(offset);
+        const __m512 lo = _mm512_set1_ps(lowest);
+        const __m512 hi = _mm512_set1_ps(highest);
+        for (size_t i = 0; i < n; i += 16)
+        {
+            const __mmask16 m = tailMask(n - i);
+            __m512 v = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, data + i), g, o);
+            _mm512_mask_storeu_ps(data + i, m, _mm512_min_ps(hi, _mm512_max_ps(lo, v)));
+        }
+    }
+
+    void absoluteAVX512(const float* src, float* dest, size_t n)
+    {
+        for (size_t i = 0; i < n; i += 16)
+        {
+            const __mmask16 m = tailMask(n - i);
+            _mm512_mask_storeu_ps(dest + i, m, absolute(_mm512_maskz_loadu_ps(m, src + i)));
+        }
+    }
+
+    void affineAVX512(const float* src, float* dest, size_t n, float scale, float offset)
+    {
+        const __m512 s = _mm512_set1_ps(scale);
+        const __m512 o = _mm512_set1_ps(offset);
+        for (size_t i = 0; i < n; i += 16)
+        {
+            const __mmask16 m = tailMask(n - i);
+            _mm512_mask_storeu_ps(dest + i, m, _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, src + i), s, o));
+        }
+    }
+
+    void midSideAVX512(float* left, float* right, size_t n, float midGain, float sideGain)
+    {
+        const __m512 mg = _mm512_set1_ps(0.5f * midGain);
+        const __m512 sg = _mm512_set1_ps(0.5f * sideGain);
+        for (size_t i = 0; i < n; i += 16)
+        {
+            const __mmask16 m = tailMask(n - i);
+            __m512 l = _mm512_maskz_loadu_ps(m, left + i);
+            __m512 r = _mm512_maskz_loadu_ps(m, right + i);
+            __m512 mid = _mm512_mul_ps(_mm512_add_ps(l, r), mg);
+            __m512 side = _mm512_mul_ps(_mm512_sub_ps(l, r), sg);
+            _mm512_mask_storeu_ps(left + i, m, _mm512_add_ps(mid, side));
+            _mm512_mask_storeu_ps(right + i, m, _mm512_sub_ps(mid, side));
+        }
+    }
+
+    void panMixAVX512(const float* src, float* left, float* right, size_t n, float leftGain, float rightGain)
+    {
+        const __m512 lg = _mm512_set1_ps(leftGain);
+        const __m512 rg = _mm512_set1_ps(rightGain);
+        for (size_t i = 0; i < n; i += 16)
+        {
+            const __mmask16 m = tailMask(n - i);
+            __m512 s = _mm512_maskz_loadu_ps(m, src + i);
+            _mm512_mask_storeu_ps(left + i, m, _mm512_fmadd_ps(s, lg, _mm512_maskz_loadu_ps(m, left + i)));
+            _mm512_mask_storeu_ps(right + i, m, _mm512_fmadd_ps(s, rg, _mm512_maskz_loadu_ps(m, right + i)));
+        }
+    }
+
+    void matrixVectorAVX512(const float* matrix, const float* vector, float* out, size_t numRows, size_t numColumns)
+    {
+        for (size_t r = 0; r < numRows; r += 16)
+        {
+            const __mmask16 m = tailMask(numRows - r);
+            __m512 acc = _mm512_setzero_ps();
+            for (size_t c = 0; c < numColumns; ++c)
+                acc = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, matrix + c * numRows + r), _mm512_set1_ps(vector[c]), acc);
+            _mm512_mask_storeu_ps(out + r, m, acc);
+        }
+    }
+
+    void complexMagnitudeAVX512(const float* interleaved, float* magnitudes, size_t numBins)
+    {
+        const __m512i evenIndex = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+        const __m512i oddIndex = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+        size_t i = 0;
+        for (; i + 16 <= numBins; i += 16)
+        {
+            __m512 a = _mm512_loadu_ps(interleaved + 2 * i);
+            __m512 b = _mm512_loadu_ps(interleaved + 2 * i + 16);
+            __m512 re = _mm512_permutex2var_ps(a, evenIndex, b);
+            __m512 im = _mm512_permutex2var_ps(a, oddIndex, b);
+            _mm512_storeu_ps(magnitudes + i, _mm512_sqrt_ps(_mm512_fmadd_ps(re, re, _mm512_mul_ps(im, im))));
+        }
+        for (; i < numBins; ++i)
+        {
+            float re = interleaved[2 * i];
+            float im = interleaved[2 * i + 1];
+            magnitudes[i] = std::sqrt(re * re + im * im);
+        }
+    }
+}
+
+const SimdKernels::KernelTable* getAVX512KernelTable()
+{
+    static const SimdKernels::KernelTable table = []
+    {
+        SimdKernels::KernelTable t;
+        t.isa = SimdKernels::Isa::AVX512;
+        t.dotProduct = dotProductAVX512;
+        t.sumOfSquares = sumOfSquaresAVX512;
+        t.sum = sumAVX512;
+        t.minMax = minMaxAVX512;
+        t.countAboveAbs = countAboveAbsAVX512;
+        t.scaleClamp = scaleClampAVX512;
+        t.absolute = absoluteAVX512;
+        t.affine = affineAVX512;
+        t.midSide = midSideAVX512;
+        t.panMix = panMixAVX512;
+        t.complexMagnitude = complexMagnitudeAVX512;
+        t.matrixVector = matrixVectorAVX512;
+        return t;
+    }();
+    return &table;
+}
+
+#else
+
+const SimdKernels::KernelTable* getAVX512KernelTable()
+{
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,287 @@
+#include "SimdKernels.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+
+#include <emmintrin.h>
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    inline float horizontalSum(__m128 v)
+    {
+        __m128 shuffled = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+        __m128 sums = _mm_add_ps(v, shuffled);
+        shuffled = _mm_movehl_ps(shuffled, sums);
+        return _mm_cvtss_f32(_mm_add_ss(sums, shuffled));
+    }
+
+    inline double horizontalSum(__m128d v)
+    {
+        return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+    }
+
+    inline __m128 absMask()
+    {
+        return _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    }
+
+    float dotProductSSE2(const float* a, const float* b, size_t n)
+    {
+        // Two accumulators hide the add latency
+        __m128 acc0 = _mm_setzero_ps();
+        __m128 acc1 = _mm_setzero_ps();
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+        }
+        float sum = horizontalSum(_mm_add_ps(acc0, acc1));
+        for (; i < n; ++i)
+            sum += a[i] * b[i];
+        return sum;
+    }
+
+    // Each group of four floats is widened into two double lanes before accumulating
+    double sumOfSquaresSSE2(const float* data, size_t n)
+    {
+        __m128d acc0 = _mm_setzero_pd();
+        __m128d acc1 = _mm_setzero_pd();
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            const __m128 v = _mm_loadu_ps(data + i);
+            const __m128d lo = _mm_cvtps_pd(v);
+            const __m128d hi = _mm_cvtps_pd(_mm_movehl_ps(v, v));
+            acc0 = _mm_add_pd(acc0, _mm_mul_pd(lo, lo));
+            acc1 = _mm_add_pd(acc1, _mm_mul_pd(hi, hi));
+        }
+        double sum = horizontalSum(_mm_add_pd(acc0, acc1));
+        for (; i < n; ++i)
+            sum += static_cast<double>(data[i]) * data[i];
+        return sum;
+    }
+
+    double sumSSE2(const float* data, size_t n)
+    {
+        __m128d acc0 = _mm_setzero_pd();
+        __m128d acc1 = _mm_setzero_pd();
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            const __m128 v = _mm_loadu_ps(data + i);
+            acc0 = _mm_add_pd(acc0, _mm_cvtps_pd(v));
+            acc1 = _mm_add_pd(acc1, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+        }
+        double sum = horizontalSum(_mm_add_pd(acc0, acc1));
+        for (; i < n; ++i)
+            sum += data[i];
+        return sum;
+    }
+
+    void minMaxSSE2(const float* data, size_t n, float& minValue, float& maxValue)
+    {
+        if (n == 0)
+        {
+            minValue = maxValue = 0.0f;
+            return;
+        }
+
+        float lo = data[0];
+        float hi = data[0];
+        size_t i = 0;
+        if (n >= 4)
+        {
+            __m128 vmin = _mm_loadu_ps(data);
+            __m128 vmax = vmin;
+            for (i = 4; i + 4 <= n; i += 4)
+            {
+                __m128 v = _mm_loadu_ps(data + i);
+                vmin = _mm_min_ps(vmin, v);
+                vmax = _mm_max_ps(vmax, v);
+            }
+            alignas(16) float lanesMin[4], lanesMax[4];
+            _mm_store_ps(lanesMin, vmin);
+            _mm_store_ps(lanesMax, vmax);
+            lo = std::min(std::min(lanesMin[0], lanesMin[1]), std::min(lanesMin[2], lanesMin[3]));
+            hi = std::max(std::max(lanesMax[0], lanesMax[1]), std::max(lanesMax[2], lanesMax[3]));
+        }
+        for (; i < n; ++i)
+        {
+            lo = std::min(lo, data[i]);
+            hi = std::max(hi, data[i]);
+        }
+        minValue = lo;
+        maxValue = hi;
+    }
+
+    size_t countAboveAbsSSE2(const float* data, size_t n, float threshold)
+    {
+        const __m128 mask = absMask();
+        const __m128 limit = _mm_set1_ps(threshold);
+        // Comparison lanes are all-ones (-1) when true, so subtracting them counts hits
+        __m128i counts = _mm_setzero_si128();
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            __m128 magnitude = _mm_and_ps(_mm_loadu_ps(data + i), mask);
+            counts = _mm_sub_epi32(counts, _mm_castps_si128(_mm_cmpgt_ps(magnitude, limit)));
+        }
+        alignas(16) int lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), counts);
+        size_t count = static_cast<size_t>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+        for (; i < n; ++i)
+            count += std::abs(data[i]) > threshold ? 1 : 0;
+        return count;
+    }
+
+    void scaleClampSSE2(float* data, size_t n, float gain, float offset, float lowest, float highest)
+    {
+        const __m128 g = _mm_set1_ps(gain);
+        const __m128 o = _mm_set1_ps(offset);
+        const __m128 lo = _mm_set1_ps(lowest);
+        const __m128 hi = _mm_set1_ps(highest);
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            __m128 v = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(data + i), g), o);
+            _mm_storeu_ps(data + i, _mm_min_ps(hi, _mm_max_ps(lo, v)));
+        }
+        for (; i < n; ++i)
+            data[i] = std::min(highest, std::max(lowest, data[i] * gain + offset));
+    }
+
+    void absoluteSSE2(const float* src, float* dest, size_t n)
+    {
+        const __m128 mask = absMask();
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+            _mm_storeu_ps(dest + i, _mm_and_ps(_mm_loadu_ps(src + i), mask));
+        for (; i < n; ++i)
+            dest[i] = std::abs(src[i]);
+    }
+
+    void affineSSE2(const float* src, float* dest, size_t n, float scale, float offset)
+    {
+        const __m128 s = _mm_set1_ps(scale);
+        const __m128 o = _mm_set1_ps(offset);
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+            _mm_storeu_ps(dest + i, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(src + i), s), o));
+        for (; i < n; ++i)
+            dest[i] = src[i] * scale + offset;
+    }
+
+    void midSideSSE2(float* left, float* right, size_t n, float midGain, float sideGain)
+    {
+        const __m128 mg = _mm_set1_ps(0.5f * midGain);
+        const __m128 sg = _mm_set1_ps(0.5f * sideGain);
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            __m128 l = _mm_loadu_ps(left + i);
+            __m128 r = _mm_loadu_ps(right + i);
+            __m128 mid = _mm_mul_ps(_mm_add_ps(l, r), mg);
+            __m128 side = _mm_mul_ps(_mm_sub_ps(l, r), sg);
+            _mm_storeu_ps(left + i, _mm_add_ps(mid, side));
+            _mm_storeu_ps(right + i, _mm_sub_ps(mid, side));
+        }
+        for (; i < n; ++i)
+        {
+            float mid = (left[i] + right[i]) * 0.5f * midGain;
+            float side = (left[i] - right[i]) * 0.5f * sideGain;
+            left[i] = mid + side;
+            right[i] = mid - side;
+        }
+    }
+
+    void panMixSSE2(const float* src, float* left, float* right, size_t n, float leftGain, float rightGain)
+    {
+        const __m128 lg = _mm_set1_ps(leftGain);
+        const __m128 rg = _mm_set1_ps(rightGain);
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            __m128 s = _mm_loadu_ps(src + i);
+            _mm_storeu_ps(left + i, _mm_add_ps(_mm_loadu_ps(left + i), _mm_mul_ps(s, lg)));
+            _mm_storeu_ps(right + i, _mm_add_ps(_mm_loadu_ps(right + i), _mm_mul_ps(s, rg)));
+        }
+        for (; i < n; ++i)
+        {
+            left[i] += src[i] * leftGain;
+            right[i] += src[i] * rightGain;
+        }
+    }
+
+    void matrixVectorSSE2(const float* matrix, const float* vector, float* out, size_t numRows, size_t numColumns)
+    {
+        size_t r = 0;
+        for (; r + 4 <= numRows; r += 4)
+        {
+            __m128 acc = _mm_setzero_ps();
+            for (size_t c = 0; c < numColumns; ++c)
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(matrix + c * numRows + r), _mm_set1_ps(vector[c])));
+            _mm_storeu_ps(out + r, acc);
+        }
+        for (; r < numRows; ++r)
+        {
+            float acc = 0.0f;
+            for (size_t c = 0; c < numColumns; ++c)
+                acc += matrix[c * numRows + r] * vector[c];
+            out[r] = acc;
+        }
+    }
+
+    void complexMagnitudeSSE2(const float* interleaved, float* magnitudes, size_t numBins)
+    {
+        size_t i = 0;
+        for (; i + 4 <= numBins; i += 4)
+        {
+            __m128 a = _mm_loadu_ps(interleaved + 2 * i);     // r0 i0 r1 i1
+            __m128 b = _mm_loadu_ps(interleaved + 2 * i + 4); // r2 i2 r3 i3
+            __m128 re = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            __m128 im = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+            __m128 power = _mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im));
+            _mm_storeu_ps(magnitudes + i, _mm_sqrt_ps(power));
+        }
+        for (; i < numBins; ++i)
+        {
+            float re = interleaved[2 * i];
+            float im = interleaved[2 * i + 1];
+            magnitudes[i] = std::sqrt(re * re + im * im);
+        }
+    }
+}
+
+const SimdKernels::KernelTable* getSSE2KernelTable()
+{
+    static const SimdKernels::KernelTable table = []
+    {
+        SimdKernels::KernelTable t;
+        t.isa = SimdKernels::Isa::SSE2;
+        t.dotProduct = dotProductSSE2;
+        t.sumOfSquares = sumOfSquaresSSE2;
+        t.sum = sumSSE2;
+        t.minMax = minMaxSSE2;
+        t.countAboveAbs = countAboveAbsSSE2;
+        t.scaleClamp = scaleClampSSE2;
+        t.absolute = absoluteSSE2;
+        t.affine = affineSSE2;
+        t.midSide = midSideSSE2;
+        t.panMix = panMixSSE2;
+        t.complexMagnitude = complexMagnitudeSSE2;
+        t.matrixVector = matrixVectorSSE2;
+        return t;
+    }();
+    return &table;
+}
+
+#else
+
+const SimdKernels::KernelTable* getSSE2KernelTable()
+{
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,300 @@
+#include "SongArranger.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr float liftPerRepeat = 0.1f;
+    constexpr float maxVelocityLift = 0.3f;
+    constexpr int repeatsBeforeRegisterShift = 2; // the third time a section plays it moves up an octave
+    constexpr int registerShiftSemitones = 12;
+    constexpr double fillBeats = 1.0;
+
+    bool earlier(const juce::MidiMessage& a, const juce::MidiMessage& b)
+    {
+        return a.getTimeStamp() < b.getTimeStamp();
+    }
+}
+
+SongArranger::SongArranger(MemoryLedger* ledger)
+    : charge(ledger, MemoryLedger::Subsystem::PatternLibrary)
+{
+}
+
+SongArranger::~SongArranger() = default;
+
+void SongArranger::arrange(const std::vector<SectionPlan>& plan, AIMidiGenerator& generator, float songTempo, int beatsPerBar)
+{
+    clear();
+    tempo = songTempo > 0.0f ? songTempo : 120.0f;
+    beatSeconds = 60.0 / tempo;
+    beatsPerBar = std::max(1, beatsPerBar);
+
+    std::vector<int> timesPlayed;
+    double start = 0.0;
+
+    for (size_t i = 0; i < plan.size(); ++i)
+    {
+        auto sectionPlan = plan[i];
+        sectionPlan.bars = std::max(1, sectionPlan.bars);
+
+        SectionReference reference;
+        reference.name = sectionPlan.name;
+        reference.section = findOrGenerateSection(sectionPlan, generator, beatsPerBar);
+        reference.start = start;
+
+        if (sectionPlan.autoVariation)
+        {
+            timesPlayed.resize(sections.size(), 0);
+            const int repeat = timesPlayed[static_cast<size_t>(reference.section)]++;
+            reference.variation.velocityLift = std::min(maxVelocityLift, liftPerRepeat * static_cast<float>(repeat));
+            reference.variation.registerShift = repeat >= repeatsBeforeRegisterShift ? registerShiftSemitones : 0;
+
+            // Fills lead into a different section, never out of the last one
+            reference.variation.fillAtEnd = i + 1 < plan.size() && plan[i + 1].name != sectionPlan.name;
+        }
+        else
+        {
+            reference.variation = sectionPlan.variation;
+        }
+
+        if (reference.variation.fillAtEnd)
+            reference.fill = findOrGenerateFill(sectionPlan.mood, generator);
+
+        start += sections[static_cast<size_t>(reference.section)].length;
+        song.push_back(reference);
+    }
+
+    updateMemoryCharge();
+}
+
+void SongArranger::clear()
+{
+    sections.clear();
+    fills.clear();
+    song.clear();
+    updateMemoryCharge();
+}
+
+double SongArranger::getLengthSeconds() const
+{
+    if (song.empty())
+        return 0.0;
+    return song.back().start + sections[static_cast<size_t>(song.back().section)].length;
+}
+
+std::string SongArranger::getSectionNameAt(double seconds) const
+{
+    for (const auto& reference : song)
+        if (seconds >= reference.start && seconds < reference.start + sections[static_cast<size_t>(reference.section)].length)
+            return reference.name;
+    return {};
+}
+
+void SongArranger::render(double fromSeconds, double toSeconds, std::vector<juce::MidiMessage>& destination) const
+{
+    if (toSeconds <= fromSeconds || song.empty())
+        return;
+
+    const auto firstNew = destination.size();
+    const double fillSeconds = fillBeats * beatSeconds;
+
+    // Note-offs may sit exactly on a section's end, so a reference ending at fromSeconds still counts
+    auto reference = std::partition_point(song.begin(), song.end(), [this, fromSeconds](const SectionReference& r)
+    {
+        return r.start + sections[static_cast<size_t>(r.section)].length < fromSeconds;
+    });
+
+    for (; reference != song.end() && reference->start < toSeconds; ++reference)
+    {
+        const auto& section = sections[static_cast<size_t>(reference->section)];
+        const double fillStart = section.length - fillSeconds;
+        const bool hasFill = reference->fill >= 0;
+
+        juce::MidiMessage probe;
+        probe.setTimeStamp(fromSeconds - reference->start);
+        for (auto event = std::lower_bound(section.events.begin(), section.events.end(), probe, earlier);
+             event != section.events.end() && event->getTimeStamp() < toSeconds - reference->start; ++event)
+        {
+            // The fill replaces the drums it overlaps; stray note-offs are harmless
+            if (hasFill && event->isNoteOn() && isDrum(*event) && event->getTimeStamp() >= fillStart)
+                continue;
+            destination.push_back(applyVariation(*event, reference->variation, reference->start + event->getTimeStamp()));
+        }
+
+        if (hasFill)
+        {
+            for (const auto& event : fills[static_cast<size_t>(reference->fill)].events)
+            {
+                const double time = reference->start + fillStart + event.getTimeStamp();
+                if (time >= fromSeconds && time < toSeconds)
+                    destination.push_back(applyVariation(event, reference->variation, time));
+            }
+        }
+    }
+
+    std::stable_sort(destination.begin() + static_cast<std::ptrdiff_t>(firstNew), destination.end(), earlier);
+}
+
+std::vector<juce::MidiMessage> SongArranger::renderAll() const
+{
+    std::vector<juce::MidiMessage> events;
+    events.reserve(getStats().songEvents);
+    // Closed at the end, so note-offs on the last section's boundary are kept
+    render(0.0, std::nextafter(getLengthSeconds(), getLengthSeconds() + 1.0), events);
+    return events;
+}
+
+SongArranger::Stats SongArranger::getStats() const
+{
+    Stats stats;
+    stats.uniqueSections = sections.size();
+    stats.sectionReferences = song.size();
+
+    for (const auto& section : sections)
+        stats.storedEvents += section.events.size();
+    for (const auto& fill : fills)
+        stats.storedEvents += fill.events.size();
+
+    for (const auto& reference : song)
+    {
+        stats.songEvents += sections[static_cast<size_t>(reference.section)].events.size();
+        if (reference.fill >= 0)
+            stats.songEvents += fills[static_cast<size_t>(reference.fill)].events.size();
+    }
+    return stats;
+}
+
+std::vector<SongArranger::SectionPlan> SongArranger::createDefaultPlan(const std::string& mood)
+{
+    const std::pair<const char*, int> form[] = {
+        {"intro", 4}, {"verse", 16}, {"chorus", 8}, {"verse", 16}, {"chorus", 8},
+        {"bridge", 8}, {"chorus", 8}, {"chorus", 8}, {"outro", 4}
+    };
+
+    std::vector<SectionPlan> plan;
+    for (const auto& section : form)
+    {
+        SectionPlan sectionPlan;
+        sectionPlan.name = section.first;
+        sectionPlan.mood = mood;
+        sectionPlan.bars = section.second;
+        plan.push_back(sectionPlan);
+    }
+    return plan;
+}
+
+int SongArranger::findOrGenerateSection(const SectionPlan& plan, AIMidiGenerator& generator, int beatsPerBar)
+{
+    const auto key = plan.name + "|" + plan.mood + "|" + std::to_string(plan.bars);
+    for (size_t i = 0; i < sections.size(); ++i)
+        if (sections[i].key == key)
+            return static_cast<int>(i);
+
+    UniqueSection section;
+    section.key = key;
+    section.length = plan.bars * beatsPerBar * beatSeconds;
+
+    setContext(generator, plan.mood);
+    auto melody = generator.generateMoodPattern(plan.mood, section.length, "melody");
+    auto harmony = generator.generateHarmony(section.length);
+    auto rhythm = generator.generateRhythm(section.length, drumChannel);
+
+    section.events = std::move(melody.messages);
+    section.events.insert(section.events.end(), harmony.messages.begin(), harmony.messages.end());
+    section.events.insert(section.events.end(), rhythm.messages.begin(), rhythm.messages.end());
+    keepWithin(section.events, section.length);
+
+    sections.push_back(std::move(section));
+    return static_cast<int>(sections.size() - 1);
+}
+
+int SongArranger::findOrGenerateFill(const std::string& mood, AIMidiGenerator& generator)
+{
+    for (size_t i = 0; i < fills.size(); ++i)
+        if (fills[i].mood == mood)
+            return static_cast<int>(i);
+
+    const double fillSeconds = fillBeats * beatSeconds;
+    setContext(generator, mood);
+
+    Fill fill;
+    fill.mood = mood;
+    fill.events = generator.generateFill(fillSeconds, drumChannel).messages;
+    keepWithin(fill.events, fillSeconds);
+
+    fills.push_back(std::move(fill));
+    return static_cast<int>(fills.size() - 1);
+}
+
+void SongArranger::setContext(AIMidiGenerator& generator, const std::string& mood) const
+{
+    AIMidiGenerator::GenerationContext context;
+    context.primaryMood = mood;
+    context.secondaryMood = mood;
+    context.tempo = tempo;
+    generator.setGenerationContext(context);
+}
+
+void SongArranger::keepWithin(std::vector<juce::MidiMessage>& events, double length)
+{
+    // Notes starting past the end are dropped and notes still sounding are cut at it
+    events.erase(std::remove_if(events.begin(), events.end(), [length](const juce::MidiMessage& m)
+    {
+        return m.getTimeStamp() < 0.0 || (m.getTimeStamp() >= length && !m.isNoteOff());
+    }), events.end());
+
+    for (auto& event : events)
+        if (event.getTimeStamp() > length)
+            event.setTimeStamp(length);
+
+    std::stable_sort(events.begin(), events.end(), earlier);
+    events.shrink_to_fit();
+}
+
+juce::MidiMessage SongArranger::applyVariation(const juce::MidiMessage& message, const Variation& variation, double time)
+{
+    if (!message.isNoteOnOrOff())
+    {
+        auto copy = message;
+        copy.setTimeStamp(time);
+        return copy;
+    }
+
+    int note = message.getNoteNumber();
+    if (variation.registerShift != 0 && !isDrum(message))
+    {
+        // Notes the shift would push out of range keep their pitch, for note-ons and note-offs alike
+        const int shifted = note + variation.registerShift;
+        if (shifted >= 0 && shifted <= 127)
+            note = shifted;
+    }
+
+    juce::MidiMessage result;
+    if (message.isNoteOn())
+    {
+        const float velocity = static_cast<float>(message.getVelocity()) * (1.0f + variation.velocityLift);
+        result = juce::MidiMessage::noteOn(message.getChannel(), note,
+                                           static_cast<juce::uint8>(juce::jlimit(1, 127, juce::roundToInt(velocity))));
+    }
+    else
+    {
+        result = juce::MidiMessage::noteOff(message.getChannel(), note, message.getVelocity());
+    }
+    result.setTimeStamp(time);
+    return result;
+}
+
+void SongArranger::updateMemoryCharge()
+{
+    size_t bytes = sections.capacity() * sizeof(UniqueSection) + fills.capacity() * sizeof(Fill)
+                 + song.capacity() * sizeof(SectionReference);
+    for (const auto& section : sections)
+        bytes += section.key.capacity() + section.events.capacity() * sizeof(juce::MidiMessage);
+    for (const auto& fill : fills)
+        bytes += fill.mood.capacity() + fill.events.capacity() * sizeof(juce::MidiMessage);
+    for (const auto& reference : song)
+        bytes += reference.name.capacity();
+    charge.setBytes(bytes);
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <string>
+#include <vector>
+#include "AIMidiGenerator.h"
+#include "MemoryLedger.h"
+
+/**
+ * Song Arranger
+ * Builds whole songs from a section plan (intro, verse, chorus, ...). Each
+ * distinct section is generated once. A repeat is stored as a reference to it
+ * plus a small variation: a velocity lift, a register shift, or a drum fill
+ * into the next section. Events are only materialised when a time range is
+ * rendered for playback or export. A song therefore costs about as much
+ * memory and generation time as its unique sections, however often they repeat.
+ */
+class SongArranger
+{
+public:
+    static constexpr int drumChannel = 9; // the generator's own channel index, as the audition synth reads it
+
+    // Applied to a section reference while it is rendered; the stored section never changes
+    struct Variation
+    {
+        float velocityLift = 0.0f; // added share of each note-on velocity, e.g. 0.1 is 10% louder
+        int registerShift = 0;     // semitones, melodic channels only
+        bool fillAtEnd = false;    // replace the last beat's drums with a fill
+    };
+
+    struct SectionPlan
+    {
+        std::string name;       // sections with the same name, mood and length are generated once
+        std::string mood;
+        int bars = 8;
+        bool autoVariation = true; // derive the variation from the repeat count and what follows
+        Variation variation;       // used when autoVariation is off
+    };
+
+    struct Stats
+    {
+        size_t uniqueSections = 0;
+        size_t sectionReferences = 0;
+        size_t storedEvents = 0;   // events actually held, fills included
+        size_t songEvents = 0;     // events a fully materialised song would hold
+    };
+
+    // Stored sections are charged to the ledger's pattern library account when one is given
+    explicit SongArranger(MemoryLedger* ledger = nullptr);
+    ~SongArranger();
+
+    // Generates the plan's distinct sections with the generator; repeats become references.
+    // The generator's context is left set to the last section's mood.
+    void arrange(const std::vector<SectionPlan>& plan, AIMidiGenerator& generator, float tempo, int beatsPerBar = 4);
+    void clear();
+
+    double getLengthSeconds() const;
+    size_t getNumSections() const { return song.size(); }
+    float getTempo() const { return tempo; }
+
+    // Name of the section playing at a time in the song, or empty past the end
+    std::string getSectionNameAt(double seconds) const;
+
+    // Appends the events in [fromSeconds, toSeconds) with song-relative timestamps, in time order
+    void render(double fromSeconds, double toSeconds, std::vector<juce::MidiMessage>& destination) const;
+    std::vector<juce::MidiMessage> renderAll() const;
+
+    Stats getStats() const;
+
+    // Intro, two verse/chorus pairs, bridge, final chorus and outro in one mood
+    static std::vector<SectionPlan> createDefaultPlan(const std::string& mood);
+
+private:
+    struct UniqueSection
+    {
+        std::string key;
+        std::vector<juce::MidiMessage> events; // section-relative and sorted; nothing at or past length
+        double length = 0.0;
+    };
+
+    struct Fill
+    {
+        std::string mood;
+        std::vector<juce::MidiMessage> events; // fill-relative
+    };
+
+    struct SectionReference
+    {
+        std::string name;
+        int section = 0;
+        int fill = -1;
+        double start = 0.0;
+        Variation variation;
+    };
+
+    int findOrGenerateSection(const SectionPlan& plan, AIMidiGenerator& generator, int beatsPerBar);
+    int findOrGenerateFill(const std::string& mood, AIMidiGenerator& generator);
+    void setContext(AIMidiGenerator& generator, const std::string& mood) const;
+    void updateMemoryCharge();
+
+    static void keepWithin(std::vector<juce::MidiMessage>& events, double length);
+    static bool isDrum(const juce::MidiMessage& message) { return message.getChannel() % 16 == drumChannel; }
+    static juce::MidiMessage applyVariation(const juce::MidiMessage& message, const Variation& variation, double time);
+
+    float tempo = 120.0f;
+    double beatSeconds = 0.5;
+    std::vector<UniqueSection> sections;
+    std::vector<Fill> fills;
+    std::vector<SectionReference> song; // in play order, back to back
+
+    MemoryLedger::Charge charge;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SongArranger)
+};
@@ -0,0 +1,127 @@
+#include "StartupTimeline.h"
+
+#include <algorithm>
+#include <cstdio>
+
+StartupTimeline::ScopedPhase::ScopedPhase(StartupTimeline& timeline, const char* name)
+    : timeline(timeline), name(name), startMs(timeline.getElapsedMs()), depth(timeline.openDepth.fetch_add(1))
+{
+}
+
+StartupTimeline::ScopedPhase::~ScopedPhase()
+{
+    timeline.openDepth.fetch_sub(1);
+    timeline.addPhase(name, startMs, timeline.getElapsedMs(), depth);
+}
+
+StartupTimeline::StartupTimeline()
+    : origin(Clock::now())
+{
+}
+
+double StartupTimeline::getElapsedMs() const
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - origin).count();
+}
+
+void StartupTimeline::addPhase(const std::string& name, double startMs, double endMs, int depth)
+{
+    Phase phase;
+    phase.name = name;
+    phase.startMs = startMs;
+    phase.durationMs = endMs > startMs ? endMs - startMs : 0.0;
+    phase.depth = depth;
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        phases.push_back(phase);
+    }
+
+    trace(formatPhase(phase));
+}
+
+void StartupTimeline::markFirstPrediction()
+{
+    double expected = -1.0;
+    firstPredictionMs.compare_exchange_strong(expected, getElapsedMs());
+}
+
+std::vector<StartupTimeline::Phase> StartupTimeline::getPhases() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return phases;
+}
+
+double StartupTimeline::getPhaseTotalMs(const std::string& name) const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    double total = 0.0;
+    for (const auto& phase : phases)
+        if (phase.name == name)
+            total += phase.durationMs;
+    return total;
+}
+
+std::string StartupTimeline::describe() const
+{
+    // Phases are stored as they finish; list them in start order so parents precede their children
+    auto ordered = getPhases();
+    std::stable_sort(ordered.begin(), ordered.end(), [](const Phase& a, const Phase& b)
+    {
+        return a.startMs < b.startMs || (a.startMs == b.startMs && a.depth < b.depth);
+    });
+
+    std::string result;
+    for (const auto& phase : ordered)
+        result += formatPhase(phase) + "\n";
+
+    char line[96];
+    if (hasFirstPrediction())
+        std::snprintf(line, sizeof(line), "[startup] time to first prediction: %.2f ms\n", getTimeToFirstPredictionMs());
+    else
+        std::snprintf(line, sizeof(line), "[startup] no prediction yet\n");
+    return result + line;
+}
+
+void StartupTimeline::setTraceSink(std::function<void(const std::string&)> sink)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    traceSink = std::move(sink);
+}
+
+void StartupTimeline::traceFirstPredictionIfPending()
+{
+    if (!hasFirstPrediction())
+        return;
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (firstPredictionTraced)
+            return;
+        firstPredictionTraced = true;
+    }
+
+    char line[96];
+    std::snprintf(line, sizeof(line), "[startup] +%.2f ms first prediction", getTimeToFirstPredictionMs());
+    trace(line);
+}
+
+void StartupTimeline::trace(const std::string& line)
+{
+    std::function<void(const std::string&)> sink;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        sink = traceSink;
+    }
+
+    if (sink)
+        sink(line);
+}
+
+std::string StartupTimeline::formatPhase(const Phase& phase)
+{
+    char line[160];
+    std::snprintf(line, sizeof(line), "[startup] +%.2f ms %*s%s: %.2f ms",
+                  phase.startMs, phase.depth * 2, "", phase.name.c_str(), phase.durationMs);
+    return line;
+}
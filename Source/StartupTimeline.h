@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Startup Timeline
+ * Records how long each cold-start phase takes (processor construction,
+ * prepareToPlay, editor construction) against a high-resolution clock whose
+ * origin is the moment the timeline was created. Every finished phase is written
+ * to the trace sink. The first prediction is marked separately because it happens
+ * on the audio thread, so marking it only stores an atomic.
+ */
+class StartupTimeline
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Phase
+    {
+        std::string name;
+        double startMs = 0.0;
+        double durationMs = 0.0;
+        int depth = 0;
+    };
+
+    /**
+     * Times the enclosing scope as one phase. Scopes nested inside it are
+     * recorded one level deeper.
+     */
+    class ScopedPhase
+    {
+    public:
+        ScopedPhase(StartupTimeline& timeline, const char* name);
+        ~ScopedPhase();
+
+    private:
+        StartupTimeline& timeline;
+        const char* name;
+        double startMs;
+        int depth;
+
+        ScopedPhase(const ScopedPhase&) = delete;
+        ScopedPhase& operator=(const ScopedPhase&) = delete;
+    };
+
+    StartupTimeline();
+
+    // Milliseconds since the timeline was created
+    double getElapsedMs() const;
+
+    // Records a phase that has already finished; used for spans that begin before any scope can open
+    void addPhase(const std::string& name, double startMs, double endMs, int depth = 0);
+
+    // Realtime safe: only the first call has any effect
+    void markFirstPrediction();
+    bool hasFirstPrediction() const { return firstPredictionMs.load() >= 0.0; }
+    double getTimeToFirstPredictionMs() const { return firstPredictionMs.load(); }
+
+    std::vector<Phase> getPhases() const;
+    double getPhaseTotalMs(const std::string& name) const;
+
+    // Indented phase list followed by time-to-first-prediction when known
+    std::string describe() const;
+
+    // Receives one line per finished phase, e.g. "[startup] +12.40 ms prepareToPlay: 8.31 ms"
+    void setTraceSink(std::function<void(const std::string&)> sink);
+
+    // Call from a non-realtime thread: traces the first prediction once, after it has been marked
+    void traceFirstPredictionIfPending();
+
+private:
+    void trace(const std::string& line);
+    static std::string formatPhase(const Phase& phase);
+
+    const Clock::time_point origin;
+    std::atomic<double> firstPredictionMs { -1.0 };
+    std::atomic<int> openDepth { 0 };
+    bool firstPredictionTraced = false;
+
+    mutable std::mutex lock;
+    std::vector<Phase> phases;
+    std::function<void(const std::string&)> traceSink;
+
+    StartupTimeline(const StartupTimeline&) = delete;
+    StartupTimeline& operator=(const StartupTimeline&) = delete;
+};
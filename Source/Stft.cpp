@@ -0,0 +1,125 @@
+#include "Stft.h"
+#include "FastMath.h"
+#include "SimdKernels.h"
+
+#include <algorithm>
+
+Stft::Stft(MemoryLedger* ledger)
+    : inputRing(TrackedAllocator<float>(ledger, MemoryLedger::Subsystem::AudioHistory)),
+      window(TrackedAllocator<float>(ledger, MemoryLedger::Subsystem::AudioHistory)),
+      fftBuffer(TrackedAllocator<float>(ledger, MemoryLedger::Subsystem::AudioHistory)),
+      magnitudes(TrackedAllocator<float>(ledger, MemoryLedger::Subsystem::AudioHistory))
+{
+}
+
+Stft::~Stft() = default;
+
+void Stft::prepare(double newSampleRate, double windowSeconds, int hopDivisor)
+{
+    sampleRate = newSampleRate > 0.0 ? newSampleRate : 44100.0;
+
+    fftOrder = 0;
+    while ((1 << fftOrder) < static_cast<int>(sampleRate * windowSeconds))
+        ++fftOrder;
+    windowSize = 1 << fftOrder;
+    hopSize = std::max(1, windowSize / std::max(1, hopDivisor));
+
+    if (fft == nullptr || fft->getSize() != windowSize)
+        fft = std::make_unique<juce::dsp::FFT>(fftOrder);
+
+    inputRing.assign(static_cast<size_t>(windowSize), 0.0f);
+    window.resize(static_cast<size_t>(windowSize));
+    for (int i = 0; i < windowSize; ++i)
+        window[static_cast<size_t>(i)] = 0.5f - 0.5f * FastMath::cos2Pi(static_cast<float>(i) / static_cast<float>(windowSize));
+    fftBuffer.assign(static_cast<size_t>(2 * windowSize), 0.0f);
+    magnitudes.assign(static_cast<size_t>(getNumBins()), 0.0f);
+
+    reset();
+}
+
+void Stft::reset()
+{
+    std::fill(inputRing.begin(), inputRing.end(), 0.0f);
+    ringPosition = 0;
+    samplesUntilHop = hopSize;
+    samplesBuffered = 0;
+    totalSamples = 0;
+}
+
+void Stft::addListener(Listener* listener)
+{
+    if (listener != nullptr && std::find(listeners.begin(), listeners.end(), listener) == listeners.end())
+        listeners.push_back(listener);
+}
+
+void Stft::removeListener(Listener* listener)
+{
+    listeners.erase(std::remove(listeners.begin(), listeners.end(), listener), listeners.end());
+}
+
+int Stft::getBinForFrequency(float frequency) const
+{
+    if (windowSize == 0)
+        return 0;
+    const int bin = static_cast<int>(frequency * windowSize / sampleRate + 0.5);
+    return juce::jlimit(0, getNumBins() - 1, bin);
+}
+
+void Stft::process(const juce::AudioBuffer<float>& buffer)
+{
+    if (windowSize == 0 || listeners.empty())
+        return;
+
+    const int numChannels = buffer.getNumChannels();
+    const int numSamples = buffer.getNumSamples();
+    if (numChannels == 0)
+        return;
+
+    const float channelGain = 1.0f / static_cast<float>(numChannels);
+    int position = 0;
+
+    // Copy in runs that end at a hop or at the end of the ring, so each run is contiguous
+    while (position < numSamples)
+    {
+        const int run = std::min({ numSamples - position, samplesUntilHop, windowSize - ringPosition });
+        float* destination = inputRing.data() + ringPosition;
+
+        const float* first = buffer.getReadPointer(0, position);
+        for (int i = 0; i < run; ++i)
+            destination[i] = first[i] * channelGain;
+        for (int channel = 1; channel < numChannels; ++channel)
+        {
+            const float* source = buffer.getReadPointer(channel, position);
+            for (int i = 0; i < run; ++i)
+                destination[i] += source[i] * channelGain;
+        }
+
+        position += run;
+        totalSamples += run;
+        ringPosition = (ringPosition + run) % windowSize;
+        samplesBuffered = std::min(windowSize, samplesBuffered + run);
+        samplesUntilHop -= run;
+
+        if (samplesUntilHop == 0)
+        {
+            samplesUntilHop = hopSize;
+            if (samplesBuffered == windowSize)
+                transformFrame();
+        }
+    }
+}
+
+void Stft::transformFrame()
+{
+    // Windowed frame, oldest sample first
+    float* frame = fftBuffer.data();
+    for (int i = 0; i < windowSize; ++i)
+        frame[i] = inputRing[static_cast<size_t>((ringPosition + i) % windowSize)] * window[static_cast<size_t>(i)];
+
+    fft->performRealOnlyForwardTransform(frame, true);
+    SimdKernels::complexMagnitude(frame, magnitudes.data(), magnitudes.size());
+
+    const double frameTime = static_cast<double>(totalSamples) / sampleRate;
+    for (auto* listener : listeners)
+        listener->stftFrameReady(*this, magnitudes.data(), frameTime);
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "MemoryLedger.h"
+
+/**
+ * STFT
+ * Hop-based short-time Fourier transform of the downmixed input. Each
+ * completed hop windows the latest samples with a Hann window, transforms them
+ * once and hands the magnitude spectrum to every registered listener. This way
+ * several analysers can share the same transform instead of each running its
+ * own. All memory is allocated in prepare(), so process() is realtime safe.
+ */
+class Stft
+{
+public:
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+
+        // Audio thread: magnitudes holds getNumBins() values; frameTime is the end of the window in seconds
+        virtual void stftFrameReady(const Stft& stft, const float* magnitudes, double frameTime) = 0;
+    };
+
+    // Analysis buffers are charged to the ledger's audio history account when one is given
+    explicit Stft(MemoryLedger* ledger = nullptr);
+    ~Stft();
+
+    // Message thread: the window is the next power of two above windowSeconds; hopDivisor windows per hop
+    void prepare(double sampleRate, double windowSeconds, int hopDivisor);
+    void reset();
+
+    // Message thread, before processing starts; listeners must outlive the transform
+    void addListener(Listener* listener);
+    void removeListener(Listener* listener);
+
+    // Audio thread: downmixes every channel and transforms each completed hop
+    void process(const juce::AudioBuffer<float>& buffer);
+
+    double getSampleRate() const { return sampleRate; }
+    int getWindowSize() const { return windowSize; }
+    int getHopSize() const { return hopSize; }
+    int getNumBins() const { return windowSize / 2 + 1; }
+    double getHopSeconds() const { return hopSize / sampleRate; }
+
+    float getBinFrequency(int bin) const { return static_cast<float>(bin * sampleRate / windowSize); }
+    int getBinForFrequency(float frequency) const;
+
+private:
+    void transformFrame();
+
+    double sampleRate = 44100.0;
+    int fftOrder = 0;
+    int windowSize = 0;
+    int hopSize = 0;
+
+    std::unique_ptr<juce::dsp::FFT> fft;
+    TrackedVector<float> inputRing;   // windowSize samples, written circularly
+    TrackedVector<float> window;      // Hann
+    TrackedVector<float> fftBuffer;   // 2 * windowSize
+    TrackedVector<float> magnitudes;
+    int ringPosition = 0;
+    int samplesUntilHop = 0;
+    int samplesBuffered = 0;
+    std::int64_t totalSamples = 0;
+
+    std::vector<Listener*> listeners;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Stft)
+};
@@ -0,0 +1,186 @@
+#include "SyntheticDataset.h"
+#include "FeatureModelGraph.h"
+#include "ModelRunner.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace
+{
+    const char* const scales[] = { "major", "minor", "dorian" };
+
+    constexpr float minTempo = 70.0f;
+    constexpr float tempoSpan = 90.0f;
+    constexpr float minSetting = 0.2f;   // energy and complexity
+    constexpr float settingSpan = 0.7f;
+    constexpr float minPrimaryWeight = 0.4f;
+    constexpr float primaryWeightSpan = 0.4f;
+
+    // splitmix64 stream keyed by the run seed and job index
+    class JobRandom
+    {
+    public:
+        JobRandom(std::uint32_t runSeed, size_t index)
+            : state((static_cast<std::uint64_t>(runSeed) << 32) ^ static_cast<std::uint64_t>(index))
+        {
+        }
+
+        std::uint64_t next()
+        {
+            auto value = (state += 0x9e3779b97f4a7c15ull);
+            value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+            value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+            return value ^ (value >> 31);
+        }
+
+        float nextFloat() { return static_cast<float>(next() >> 40) / static_cast<float>(1 << 24); }
+        size_t nextIndex(size_t count) { return static_cast<size_t>(next() % count); }
+
+    private:
+        std::uint64_t state;
+    };
+}
+
+//==============================================================================
+SyntheticDataset::SyntheticDataset(const Settings& datasetSettings)
+    : settings(datasetSettings),
+      moods(ModelRunner::getMoodLabels()),
+      generator(std::make_unique<AIMidiGenerator>()),
+      graph(std::make_unique<FeatureModelGraph>())
+{
+    // Controller lanes carry no notes, so they would not change a row
+    generator->setControllerLanesEnabled(false);
+    predefinedHybrids = generator->getAvailableHybridMoods();
+}
+
+SyntheticDataset::~SyntheticDataset() = default;
+
+int SyntheticDataset::loadAuxiliaryModels(const juce::File& directory)
+{
+    return graph->loadAuxiliaryModels(directory);
+}
+
+size_t SyntheticDataset::getNumJobs() const
+{
+    return settings.patternsPerMood * moods.size() + settings.hybridPatterns
+         + settings.patternsPerPredefinedHybrid * predefinedHybrids.size();
+}
+
+SyntheticDataset::Job SyntheticDataset::makeJob(size_t index) const
+{
+    Job job;
+    JobRandom rng(settings.seed, index);
+
+    const size_t moodJobs = settings.patternsPerMood * moods.size();
+    if (index < moodJobs)
+    {
+        job.origin = Origin::Mood;
+        job.moods = { moods[index % moods.size()] };
+        job.weights = { 1.0f };
+    }
+    else if (index < moodJobs + settings.hybridPatterns)
+    {
+        // The leading mood cycles like the single-mood jobs; the others are distinct and share the rest
+        job.origin = Origin::Hybrid;
+        const size_t count = 2 + rng.nextIndex(2);
+        job.moods = { moods[(index - moodJobs) % moods.size()] };
+        while (job.moods.size() < count)
+        {
+            const auto& mood = moods[rng.nextIndex(moods.size())];
+            if (std::find(job.moods.begin(), job.moods.end(), mood) == job.moods.end())
+                job.moods.push_back(mood);
+        }
+
+        job.weights = { minPrimaryWeight + primaryWeightSpan * rng.nextFloat() };
+        float remaining = 1.0f - job.weights.front();
+        for (size_t i = 1; i < count; ++i)
+        {
+            const float weight = i + 1 < count ? remaining * (0.25f + 0.5f * rng.nextFloat()) : remaining;
+            job.weights.push_back(weight);
+            remaining -= weight;
+        }
+    }
+    else
+    {
+        job.origin = Origin::Predefined;
+        job.hybridName = predefinedHybrids[(index - moodJobs - settings.hybridPatterns) % predefinedHybrids.size()];
+        const auto info = generator->getHybridMoodInfo(job.hybridName);
+        job.moods = info.moods;
+        job.weights = info.weights;
+    }
+
+    auto& context = job.context;
+    context.primaryMood = job.moods.front();
+    context.secondaryMood = job.moods.size() > 1 ? job.moods[1] : job.moods.front();
+    context.tempo = minTempo + tempoSpan * rng.nextFloat();
+    context.key = static_cast<int>(rng.nextIndex(12));
+    context.scale = scales[rng.nextIndex(std::size(scales))];
+    context.energy = minSetting + settingSpan * rng.nextFloat();
+    context.complexity = minSetting + settingSpan * rng.nextFloat();
+    job.seed = static_cast<std::uint32_t>(rng.next());
+    return job;
+}
+
+std::optional<GrooveFeatures> SyntheticDataset::generate(const Job& job, std::vector<float>& moodWeights)
+{
+    generator->setRandomSeed(static_cast<juce::int64>(job.seed));
+    generator->setGenerationContext(job.context);
+
+    AIMidiGenerator::GeneratedPattern pattern;
+    switch (job.origin)
+    {
+        case Origin::Mood:
+            pattern = generator->generateMoodPattern(job.moods.front(), settings.patternSeconds);
+            break;
+        case Origin::Hybrid:
+            pattern = generator->generateHybridPattern(job.moods, job.weights, settings.patternSeconds);
+            break;
+        case Origin::Predefined:
+            pattern = generator->generatePredefinedHybrid(job.hybridName, settings.patternSeconds);
+            break;
+    }
+
+    // Blended patterns are not in time order; a stable sort keeps each note-on ahead of its note-off
+    messages = std::move(pattern.messages);
+    std::stable_sort(messages.begin(), messages.end(), [](const juce::MidiMessage& a, const juce::MidiMessage& b)
+    {
+        return a.getTimeStamp() < b.getTimeStamp();
+    });
+
+    // Repeated moods, as in the intensified hybrids, add up under one label
+    moodWeights.assign(moods.size(), 0.0f);
+    float total = 0.0f;
+    for (size_t i = 0; i < job.moods.size() && i < job.weights.size(); ++i)
+    {
+        const auto it = std::find(moods.begin(), moods.end(), job.moods[i]);
+        if (it == moods.end())
+            continue;
+        moodWeights[static_cast<size_t>(it - moods.begin())] += job.weights[i];
+        total += job.weights[i];
+    }
+    if (total > 0.0f)
+        for (auto& weight : moodWeights)
+            weight /= total;
+
+    auto features = FeatureExtractor::extractFeaturesFromNotes(NoteEvents::fromMidiMessages(messages), job.context.tempo);
+    if (!features)
+        return features;
+
+    // A missing forest passes the estimate through
+    graph->setInputs(*features);
+    graph->evaluate();
+    features->energy = graph->getEnergy();
+    features->swing = graph->getSwing();
+    return features;
+}
+
+const char* SyntheticDataset::getOriginName(Origin origin)
+{
+    switch (origin)
+    {
+        case Origin::Mood:       return "mood";
+        case Origin::Hybrid:     return "hybrid";
+        case Origin::Predefined: return "predefined";
+    }
+    return "mood";
+}
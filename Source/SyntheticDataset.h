@@ -0,0 +1,86 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "AIMidiGenerator.h"
+#include "FeatureExtractor.h"
+#include "NoteEvents.h"
+
+class FeatureModelGraph;
+
+/**
+ * Synthetic Dataset
+ * Labeled training rows generated by AIMidiGenerator. Every pattern's mood mix
+ * is known, so each row pairs its measured features with the mood weights it was
+ * generated from. There are three kinds of job. Single-mood patterns come from
+ * generateMoodPattern and cycle through the moods, so classes stay balanced.
+ * Random mixes of two or three moods come from generateHybridPattern, and the
+ * predefined hybrids from generatePredefinedHybrid. A job is a pure function of
+ * its index and the run seed, which sets the context's tempo, key, scale, energy
+ * and complexity and the generator's seed. Jobs can therefore run on any thread
+ * in any order and give the same rows. Energy and swing come from the plugin's
+ * forests when they are loaded, as in the plugin and the augmented rows. Each
+ * instance owns a generator and a model graph, so one instance serves one
+ * thread.
+ */
+class SyntheticDataset
+{
+public:
+    enum class Origin
+    {
+        Mood,
+        Hybrid,
+        Predefined
+    };
+
+    struct Settings
+    {
+        size_t patternsPerMood = 20000;
+        size_t hybridPatterns = 200000;
+        size_t patternsPerPredefinedHybrid = 2000;
+        double patternSeconds = 8.0;
+        std::uint32_t seed = 1;
+    };
+
+    struct Job
+    {
+        Origin origin = Origin::Mood;
+        std::vector<std::string> moods;
+        std::vector<float> weights;
+        std::string hybridName; // predefined hybrids only
+        AIMidiGenerator::GenerationContext context;
+        std::uint32_t seed = 0;
+    };
+
+    explicit SyntheticDataset(const Settings& settings);
+    ~SyntheticDataset();
+
+    // Loads energy_random_forest.onnx and swing_random_forest.onnx from the directory; returns how many loaded
+    int loadAuxiliaryModels(const juce::File& directory);
+
+    size_t getNumJobs() const;
+    Job makeJob(size_t index) const;
+
+    // Generates the job's pattern. moodWeights gets one weight per label from
+    // ModelRunner::getMoodLabels(), summing to one. Empty if the pattern has
+    // fewer than two notes.
+    std::optional<GrooveFeatures> generate(const Job& job, std::vector<float>& moodWeights);
+
+    const std::vector<std::string>& getMoodLabels() const { return moods; }
+    const std::vector<std::string>& getPredefinedHybrids() const { return predefinedHybrids; }
+    static const char* getOriginName(Origin origin);
+
+private:
+    const Settings settings;
+    std::vector<std::string> moods;
+    std::vector<std::string> predefinedHybrids;
+    std::unique_ptr<AIMidiGenerator> generator;
+    std::unique_ptr<FeatureModelGraph> graph;
+    std::vector<juce::MidiMessage> messages;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SyntheticDataset)
+};
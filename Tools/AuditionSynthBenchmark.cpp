@@ -0,0 +1,163 @@
+// CPU cost of the audition synth per voice.
+// Holds N sustained voices spread over every melodic patch family and renders
+// a few seconds of audio in host-sized blocks. Reports the cost per voice and
+// the share of one core each voice needs in realtime. It also checks that voice
+// stealing holds the pool at its size, and that a queued drum and chord pattern
+// produces sound. Exits non-zero if a check fails or 64 voices can't keep up
+// with realtime.
+//
+// Usage: AuditionSynthBenchmark [seconds] [blockSize]
+
+#include <JuceHeader.h>
+#include "../Source/AuditionSynth.h"
+#include "../Source/SimdKernels.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <memory>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+
+    // Sustaining programs so every voice stays alive for the whole run
+    const int sustainedPrograms[] = {16, 48, 56, 80, 88, 32, 64, 72};
+
+    void setUpChannels(AuditionSynth& synth)
+    {
+        for (int channel = 0; channel < AuditionSynth::numChannels; ++channel)
+        {
+            AIMidiGenerator::InstrumentPreset preset;
+            preset.program = sustainedPrograms[channel % 8];
+            preset.volume = 0.7f;
+            preset.pan = static_cast<float>(channel % 5) * 0.4f - 0.8f;
+            synth.setChannelPreset(channel, preset);
+        }
+    }
+
+    void holdNotes(juce::MidiBuffer& midi, int numNotes)
+    {
+        // Fifteen melodic channels, so every (channel, note) pair is distinct
+        for (int i = 0; i < numNotes; ++i)
+        {
+            int channel = i % 15;
+            if (channel >= AuditionSynth::drumChannel)
+                ++channel;
+            midi.addEvent(juce::MidiMessage::noteOn(channel + 1, 36 + (i / 15) * 3, static_cast<juce::uint8>(100)), 0);
+        }
+    }
+
+    // Returns seconds of CPU time spent rendering
+    double render(AuditionSynth& synth, juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& firstBlockMidi,
+                  int numBlocks, float& peak)
+    {
+        juce::MidiBuffer none;
+        peak = 0.0f;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            buffer.clear();
+            synth.renderNextBlock(buffer, block == 0 ? firstBlockMidi : none);
+            peak = std::max(peak, buffer.getMagnitude(0, buffer.getNumSamples()));
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+
+        return std::chrono::duration<double>(end - start).count();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const double seconds = argc > 1 ? std::atof(argv[1]) : 5.0;
+    const int blockSize = argc > 2 ? std::max(16, std::atoi(argv[2])) : 256;
+    const int numBlocks = static_cast<int>(seconds * sampleRate / blockSize);
+    const double audioSeconds = numBlocks * blockSize / sampleRate;
+
+    juce::AudioBuffer<float> buffer(2, blockSize);
+    bool allChecksPass = true;
+
+    std::printf("%.1f s of audio in %d-sample blocks at %.0f Hz, %s mixing\n\n",
+                audioSeconds, blockSize, sampleRate, SimdKernels::getIsaName(SimdKernels::getActiveIsa()));
+    std::printf("%8s %8s %14s %16s %14s %10s\n", "voices", "active", "realtime x", "ns/voice/sample", "% core/voice", "check");
+
+    for (int numVoices : {1, 16, 64, 128, 256})
+    {
+        auto synth = std::make_unique<AuditionSynth>();
+        synth->prepare(sampleRate, blockSize, numVoices);
+        setUpChannels(*synth);
+
+        juce::MidiBuffer midi;
+        holdNotes(midi, numVoices);
+
+        float peak = 0.0f;
+        const double cpuSeconds = render(*synth, buffer, midi, numBlocks, peak);
+        const int active = synth->getNumActiveVoices();
+
+        const double realtimeFactor = audioSeconds / cpuSeconds;
+        const double nsPerVoiceSample = cpuSeconds * 1.0e9 / (numVoices * audioSeconds * sampleRate);
+        const double corePercentPerVoice = 100.0 * cpuSeconds / (audioSeconds * numVoices);
+
+        // Every voice held, audible, and 64 voices at least keep up with realtime
+        const bool ok = active == numVoices && peak > 0.0f && (numVoices > 64 || realtimeFactor > 1.0);
+        allChecksPass = allChecksPass && ok;
+        std::printf("%8d %8d %14.1f %16.2f %14.4f %10s\n",
+                    numVoices, active, realtimeFactor, nsPerVoiceSample, corePercentPerVoice, ok ? "ok" : "FAIL");
+    }
+
+    // Voice stealing: 200 held notes on a 64-voice pool keep exactly 64 voices
+    {
+        auto synth = std::make_unique<AuditionSynth>();
+        synth->prepare(sampleRate, blockSize, 64);
+        setUpChannels(*synth);
+
+        juce::MidiBuffer midi;
+        holdNotes(midi, 200);
+
+        float peak = 0.0f;
+        render(*synth, buffer, midi, 8, peak);
+        const bool ok = synth->getNumActiveVoices() == 64;
+        allChecksPass = allChecksPass && ok;
+        std::printf("\nstealing: 200 notes on 64 voices -> %d active %s\n", synth->getNumActiveVoices(), ok ? "ok" : "FAIL");
+    }
+
+    // Generator-style pattern: channels numbered from 0 as AIMidiGenerator does, drums on 9
+    {
+        auto synth = std::make_unique<AuditionSynth>();
+        synth->prepare(sampleRate, blockSize, 64);
+
+        AIMidiGenerator::GeneratedPattern pattern;
+        pattern.duration = 2.0;
+        for (int beat = 0; beat < 8; ++beat)
+        {
+            const double time = beat * 0.25;
+            for (int note : {beat % 2 == 0 ? 36 : 38, 42})
+            {
+                auto hit = juce::MidiMessage::noteOn(9, note, static_cast<juce::uint8>(110));
+                hit.setTimeStamp(time);
+                pattern.messages.push_back(hit);
+            }
+        }
+        for (int note : {60, 64, 67})
+        {
+            auto on = juce::MidiMessage::noteOn(1, note, static_cast<juce::uint8>(90));
+            on.setTimeStamp(0.0);
+            auto off = juce::MidiMessage::noteOff(1, note);
+            off.setTimeStamp(1.5);
+            pattern.messages.push_back(on);
+            pattern.messages.push_back(off);
+        }
+
+        const bool queued = synth->queuePattern(pattern);
+        float peak = 0.0f;
+        const double cpuSeconds = render(*synth, buffer, juce::MidiBuffer(), static_cast<int>(2.5 * sampleRate / blockSize), peak);
+        const bool ok = queued && peak > 0.01f && peak < 4.0f;
+        allChecksPass = allChecksPass && ok;
+        std::printf("pattern: queued %s, peak %.3f, %.1fx realtime %s\n",
+                    queued ? "yes" : "no", peak, 2.5 / cpuSeconds, ok ? "ok" : "FAIL");
+    }
+
+    return allChecksPass ? 0 : 1;
+}
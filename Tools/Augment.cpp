@@ -0,0 +1,330 @@
+// Training-data augmentation for the mood model.
+// Expands every labeled MIDI file under a folder into transposed, tempo-scaled,
+// humanized, velocity-remapped and track-subset variants (see
+// Source/DataAugmenter.h). Each variant's features go straight into a feature
+// store (Source/FeatureStore.h) and no intermediate MIDI is written. A file's
+// mood comes from the primary_mood column of --labels (a CSV with
+// midi_file_name and primary_mood columns, such as the one written by the
+// labeling scripts). Without that, it comes from a parent folder named after a
+// mood. Files with neither are skipped. Energy and swing come from the
+// forests in --forests (energy_random_forest.onnx, swing_random_forest.onnx)
+// when given, as in the training CSVs, and from the scripts' fallback
+// estimates otherwise. Work is spread over every core. Row contents are
+// deterministic for a given --seed, but rows from different threads may be
+// stored in any order.
+//
+// Usage: AamatiAugment [--labels <csv>] [--forests <folder>] [--threads N] [--transpose N]
+//                      [--seed N] [--no-subsets] <input> <output.aafs>
+
+#include <JuceHeader.h>
+#include "../Source/DataAugmenter.h"
+#include "../Source/FeatureStore.h"
+#include "../Source/ModelRunner.h"
+#include "../Source/MoodRemixer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr size_t variantsPerTask = 256;
+    constexpr size_t rowsPerFlush = 4096;
+
+    void printUsage()
+    {
+        std::fprintf(stderr,
+                     "Usage: AamatiAugment [--labels <csv>] [--forests <folder>] [--threads N] [--transpose N]\n"
+                     "                     [--seed N] [--no-subsets] <input> <output.aafs>\n");
+    }
+
+    // File name to primary mood
+    bool readLabels(const std::string& path, std::map<std::string, std::string>& labels)
+    {
+        std::ifstream in(path);
+        std::string line;
+        if (!in || !std::getline(in, line))
+            return false;
+
+        const auto header = FeatureStore::splitCsvLine(line);
+        const auto nameColumn = std::find(header.begin(), header.end(), "midi_file_name") - header.begin();
+        const auto moodColumn = std::find(header.begin(), header.end(), "primary_mood") - header.begin();
+        if (nameColumn == static_cast<long>(header.size()) || moodColumn == static_cast<long>(header.size()))
+            return false;
+
+        while (std::getline(in, line))
+        {
+            const auto fields = FeatureStore::splitCsvLine(line);
+            if (static_cast<long>(fields.size()) > std::max(nameColumn, moodColumn))
+                labels[std::filesystem::path(fields[static_cast<size_t>(nameColumn)]).filename().string()]
+                    = fields[static_cast<size_t>(moodColumn)];
+        }
+        return true;
+    }
+
+    std::string findMood(const std::string& path, const std::map<std::string, std::string>& labels,
+                         const std::vector<std::string>& moods)
+    {
+        const std::filesystem::path file(path);
+        const auto label = labels.find(file.filename().string());
+        if (label != labels.end())
+            return label->second;
+
+        for (auto folder = file.parent_path(); folder.has_filename(); folder = folder.parent_path())
+            if (std::find(moods.begin(), moods.end(), folder.filename().string()) != moods.end())
+                return folder.filename().string();
+        return {};
+    }
+
+    struct Task
+    {
+        size_t source;
+        size_t firstVariant;
+        size_t endVariant;
+    };
+
+    void printProgress(size_t completed, size_t total, double seconds)
+    {
+        std::printf("\r%zu/%zu variants, %.0f variants/s", completed, total,
+                    seconds > 0.0 ? static_cast<double>(completed) / seconds : 0.0);
+        std::fflush(stdout);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    DataAugmenter::Settings settings;
+    std::string labelsPath, forestsPath;
+    int numThreads = 0;
+    std::vector<std::string> positional;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--labels") == 0 && hasValue)
+            labelsPath = argv[++i];
+        else if (std::strcmp(argv[i], "--forests") == 0 && hasValue)
+            forestsPath = argv[++i];
+        else if (std::strcmp(argv[i], "--threads") == 0 && hasValue)
+            numThreads = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--transpose") == 0 && hasValue)
+        {
+            const int range = std::max(0, std::atoi(argv[++i]));
+            settings.transpositions.clear();
+            for (int semitones = -range; semitones <= range; ++semitones)
+                settings.transpositions.push_back(semitones);
+        }
+        else if (std::strcmp(argv[i], "--seed") == 0 && hasValue)
+            settings.seed = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (std::strcmp(argv[i], "--no-subsets") == 0)
+            settings.trackSubsets = false;
+        else
+            positional.push_back(argv[i]);
+    }
+
+    if (positional.size() != 2)
+    {
+        printUsage();
+        return 2;
+    }
+
+    const auto moods = ModelRunner::getMoodLabels();
+    std::map<std::string, std::string> labels;
+    if (!labelsPath.empty() && !readLabels(labelsPath, labels))
+    {
+        std::fprintf(stderr, "Could not read midi_file_name and primary_mood from %s\n", labelsPath.c_str());
+        return 1;
+    }
+
+    const auto files = MoodRemixer::findMidiFiles(positional[0]);
+    if (files.empty())
+    {
+        std::fprintf(stderr, "No MIDI files found in %s\n", positional[0].c_str());
+        return 1;
+    }
+
+    if (numThreads <= 0)
+        numThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    // Sources are read once, in parallel, and shared read-only by the workers
+    std::vector<DataAugmenter::Source> loaded(files.size());
+    std::vector<char> usable(files.size(), 0);
+    std::vector<std::string> warnings(files.size());
+    {
+        std::atomic<size_t> nextFile { 0 };
+        std::vector<std::thread> loaders;
+        for (int t = 0; t < numThreads; ++t)
+            loaders.emplace_back([&]()
+            {
+                for (size_t index = nextFile.fetch_add(1); index < files.size(); index = nextFile.fetch_add(1))
+                {
+                    const auto mood = findMood(files[index], labels, moods);
+                    std::string error;
+                    if (std::find(moods.begin(), moods.end(), mood) == moods.end())
+                        warnings[index] = mood.empty() ? "no mood label" : "unknown mood " + mood;
+                    else if (!DataAugmenter::loadSource(files[index], loaded[index], error))
+                        warnings[index] = error;
+                    else
+                    {
+                        // Named by the path under the input folder, so same-named files stay apart
+                        loaded[index].name = MoodRemixer::getOutputPath(files[index], positional[0], "");
+                        loaded[index].mood = mood;
+                        usable[index] = 1;
+                    }
+                }
+            });
+        for (auto& loader : loaders)
+            loader.join();
+    }
+
+    std::vector<DataAugmenter::Source> sources;
+    for (size_t index = 0; index < files.size(); ++index)
+    {
+        if (usable[index])
+            sources.push_back(std::move(loaded[index]));
+        else
+            std::fprintf(stderr, "Skipping %s: %s\n", files[index].c_str(), warnings[index].c_str());
+    }
+    if (sources.empty())
+    {
+        std::fprintf(stderr, "No labeled MIDI files to augment\n");
+        return 1;
+    }
+
+    // Categorical columns store indices into these names
+    std::vector<FeatureStore::Column> columns;
+    for (const auto& name : FeatureExtractor::getFeatureNames())
+        columns.push_back({ name, {} });
+    const FeatureStore::Column moodColumn { "primary_mood", moods };
+    columns.push_back(moodColumn);
+    FeatureStore::Column sourceColumn { "source", {} };
+    for (const auto& source : sources)
+        sourceColumn.categories.push_back(source.name);
+    columns.push_back(sourceColumn);
+    columns.push_back({ "transpose", {} });
+    columns.push_back({ "tempo_scale", {} });
+    columns.push_back({ "humanize", {} });
+    FeatureStore::Column curveColumn { "velocity_curve", {} };
+    for (const auto curve : settings.velocityCurves)
+        curveColumn.categories.push_back(DataAugmenter::getVelocityCurveName(curve));
+    columns.push_back(curveColumn);
+    columns.push_back({ "left_out_track", {} });
+    const size_t width = columns.size();
+
+    FeatureStore::Writer store;
+    if (!store.open(positional[1], columns))
+    {
+        std::fprintf(stderr, "Could not create %s\n", positional[1].c_str());
+        return 1;
+    }
+
+    std::vector<std::vector<DataAugmenter::Variant>> variants(sources.size());
+    std::vector<Task> tasks;
+    size_t totalVariants = 0;
+    for (size_t s = 0; s < sources.size(); ++s)
+    {
+        variants[s] = DataAugmenter::enumerateVariants(sources[s], settings, static_cast<std::uint32_t>(s));
+        for (size_t first = 0; first < variants[s].size(); first += variantsPerTask)
+            tasks.push_back({ s, first, std::min(first + variantsPerTask, variants[s].size()) });
+        totalVariants += variants[s].size();
+    }
+
+    numThreads = static_cast<int>(std::min<size_t>(static_cast<size_t>(numThreads), tasks.size()));
+    std::printf("Augmenting %zu files into %zu variants on %d threads\n", sources.size(), totalVariants, numThreads);
+
+    std::atomic<size_t> nextTask { 0 };
+    std::atomic<size_t> completed { 0 };
+    std::atomic<size_t> dropped { 0 };
+    std::atomic<bool> writeFailed { false };
+    std::atomic<int> forestsLoaded { 0 };
+
+    const auto work = [&]()
+    {
+        DataAugmenter augmenter;
+        if (!forestsPath.empty())
+            forestsLoaded = augmenter.loadAuxiliaryModels(juce::File(forestsPath));
+
+        std::vector<float> rows;
+        rows.reserve(rowsPerFlush * width);
+
+        const auto flush = [&]()
+        {
+            if (!rows.empty() && !store.appendRows(rows.data(), rows.size() / width))
+                writeFailed = true;
+            rows.clear();
+        };
+
+        for (size_t index = nextTask.fetch_add(1); index < tasks.size(); index = nextTask.fetch_add(1))
+        {
+            const auto& task = tasks[index];
+            const auto& source = sources[task.source];
+            const auto mood = static_cast<float>(moodColumn.indexOf(source.mood));
+
+            for (size_t v = task.firstVariant; v < task.endVariant; ++v)
+            {
+                const auto& variant = variants[task.source][v];
+                const auto features = augmenter.extractVariantFeatures(source, variant);
+                if (!features)
+                {
+                    ++dropped;
+                    continue;
+                }
+
+                FeatureExtractor::appendFeatureRow(*features, rows);
+                rows.push_back(mood);
+                rows.push_back(static_cast<float>(task.source));
+                rows.push_back(static_cast<float>(variant.transpose));
+                rows.push_back(variant.tempoScale);
+                rows.push_back(variant.humanize);
+                rows.push_back(static_cast<float>(curveColumn.indexOf(DataAugmenter::getVelocityCurveName(variant.velocityCurve))));
+                rows.push_back(static_cast<float>(variant.leftOutTrack)); // a mask would lose low bits as a float
+
+                if (rows.size() >= rowsPerFlush * width)
+                    flush();
+            }
+            completed += task.endVariant - task.firstVariant;
+        }
+        flush();
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto elapsed = [&start]
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < numThreads; ++t)
+        workers.emplace_back(work);
+
+    while (completed.load() < totalVariants)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+        printProgress(completed.load(), totalVariants, elapsed());
+    }
+    for (auto& worker : workers)
+        worker.join();
+
+    const bool closed = store.close();
+    printProgress(completed.load(), totalVariants, elapsed());
+    std::printf("\n%llu rows written, %zu variants had too few notes and were left out\n",
+                static_cast<unsigned long long>(store.getRowsWritten()), dropped.load());
+    if (!forestsPath.empty())
+        std::printf("Energy and swing from %d of 2 forests in %s\n", forestsLoaded.load(), forestsPath.c_str());
+
+    if (writeFailed.load() || !closed)
+    {
+        std::fprintf(stderr, "Could not write %s\n", positional[1].c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,591 @@
+// Mood model evaluation.
+// Runs the ONNX mood model over a labeled feature table and reports how well and
+// how fast it classifies, in one pass, instead of running predict_groove_mood.py
+// row by row. The table is a feature store written by AamatiAugment or
+// AamatiSynthesize, or a CSV with the training scripts' column names. Either way
+// it needs tempo, swing, density, dynamic_range, energy and a primary_mood label.
+// Rows are split into batches and the batches are spread over threads. Each
+// thread has its own ModelRunner and calls predictBatch once per batch.
+//
+// With --forests, rows go through the plugin's model cascade
+// (Source/FeatureModelGraph.h) instead. The energy and swing forests in that
+// folder replace the table's energy and swing before the mood model runs. That
+// needs every feature column and runs one row per call, as the plugin does.
+//
+// Prints accuracy, per-class precision and recall, the confusion matrix and
+// per-call latency percentiles. --json writes all of it. --csv writes one row
+// per class with its metrics and its row of the confusion matrix.
+//
+// Usage: AamatiEvaluate --model <mood.onnx> [--forests <folder>] [--threads N] [--batch N]
+//                       [--json <file>] [--csv <file>] <table.aafs|table.csv>
+
+#include <JuceHeader.h>
+#include "../Source/FeatureExtractor.h"
+#include "../Source/FeatureModelGraph.h"
+#include "../Source/FeatureStore.h"
+#include "../Source/ModelRunner.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr size_t numMoods = ModelRunner::numMoods;
+    constexpr float lowConfidence = 0.1f; // below this, ModelRunner::chooseMood names no mood
+
+    // The mood model's inputs, in its order
+    const char* const moodInputColumns[] = { "tempo", "swing", "density", "dynamic_range", "energy" };
+
+    struct Table
+    {
+        std::vector<GrooveFeatures> rows;
+        std::vector<int> labels;     // index into ModelRunner::getMoodLabels()
+        size_t unlabeled = 0;        // rows left out for a missing or unknown mood
+    };
+
+    // Per thread, then summed
+    struct Results
+    {
+        std::array<std::array<size_t, numMoods>, numMoods> confusion {}; // [true][predicted]
+        size_t failedRows = 0;
+        size_t lowConfidenceRows = 0;
+        double energyError = 0.0, swingError = 0.0; // absolute, forests against the table
+        std::vector<double> callMicroseconds;
+        size_t rowsInCalls = 0;
+    };
+
+    void printUsage()
+    {
+        std::fprintf(stderr,
+                     "Usage: AamatiEvaluate --model <mood.onnx> [--forests <folder>] [--threads N] [--batch N]\n"
+                     "                      [--json <file>] [--csv <file>] <table.aafs|table.csv>\n");
+    }
+
+    int moodIndex(const std::string& mood)
+    {
+        static const auto moods = ModelRunner::getMoodLabels();
+        const auto it = std::find(moods.begin(), moods.end(), mood);
+        return it == moods.end() ? -1 : static_cast<int>(it - moods.begin());
+    }
+
+    // Fills features from named columns, in FeatureExtractor::getFeatureNames() order
+    void setFeature(GrooveFeatures& features, size_t index, double value)
+    {
+        double* const fields[] = { &features.tempo, &features.swing, &features.density, &features.dynamicRange,
+                                   &features.energy, &features.velocityMean, &features.velocityStd,
+                                   &features.pitchMean, &features.pitchRange, &features.avgPolyphony,
+                                   &features.syncopation, &features.onsetEntropy };
+        *fields[index] = value;
+    }
+
+    bool isRequired(const std::string& name, bool allFeatures)
+    {
+        return allFeatures || std::find_if(std::begin(moodInputColumns), std::end(moodInputColumns),
+                                           [&name](const char* column) { return name == column; })
+                                  != std::end(moodInputColumns);
+    }
+
+    bool loadStore(const std::string& path, bool allFeatures, Table& table, std::string& error)
+    {
+        FeatureStore::Reader reader;
+        if (!reader.open(path))
+        {
+            error = reader.getError();
+            return false;
+        }
+
+        const auto labelColumn = reader.findColumn("primary_mood");
+        if (labelColumn < 0 || reader.getColumns()[static_cast<size_t>(labelColumn)].categories.empty())
+        {
+            error = "no primary_mood labels in " + path;
+            return false;
+        }
+
+        std::vector<float> values;
+        reader.readColumn(labelColumn, values);
+        std::vector<int> categoryMoods;
+        for (const auto& category : reader.getColumns()[static_cast<size_t>(labelColumn)].categories)
+            categoryMoods.push_back(moodIndex(category));
+
+        std::vector<int> labels(values.size(), -1);
+        for (size_t row = 0; row < values.size(); ++row)
+        {
+            const auto category = static_cast<size_t>(values[row]);
+            if (values[row] >= 0.0f && category < categoryMoods.size())
+                labels[row] = categoryMoods[category];
+        }
+
+        std::vector<GrooveFeatures> rows(values.size(), GrooveFeatures {});
+        const auto names = FeatureExtractor::getFeatureNames();
+        for (size_t feature = 0; feature < names.size(); ++feature)
+        {
+            const auto column = reader.findColumn(names[feature]);
+            if (column < 0)
+            {
+                if (!isRequired(names[feature], allFeatures))
+                    continue;
+                error = "no " + names[feature] + " column in " + path;
+                return false;
+            }
+            if (!reader.readColumn(column, values))
+            {
+                error = reader.getError();
+                return false;
+            }
+            for (size_t row = 0; row < rows.size(); ++row)
+                setFeature(rows[row], feature, values[row]);
+        }
+
+        for (size_t row = 0; row < rows.size(); ++row)
+        {
+            if (labels[row] < 0)
+            {
+                ++table.unlabeled;
+                continue;
+            }
+            table.rows.push_back(rows[row]);
+            table.labels.push_back(labels[row]);
+        }
+        return true;
+    }
+
+    bool loadCsv(const std::string& path, bool allFeatures, Table& table, std::string& error)
+    {
+        std::ifstream in(path);
+        std::string line;
+        if (!in || !std::getline(in, line))
+        {
+            error = "could not read " + path;
+            return false;
+        }
+
+        const auto header = FeatureStore::splitCsvLine(line);
+        const auto find = [&header](const std::string& name)
+        {
+            const auto it = std::find(header.begin(), header.end(), name);
+            return it == header.end() ? -1 : static_cast<int>(it - header.begin());
+        };
+
+        const int labelColumn = find("primary_mood");
+        if (labelColumn < 0)
+        {
+            error = "no primary_mood column in " + path;
+            return false;
+        }
+
+        const auto names = FeatureExtractor::getFeatureNames();
+        std::vector<int> columns(names.size());
+        for (size_t feature = 0; feature < names.size(); ++feature)
+        {
+            columns[feature] = find(names[feature]);
+            if (columns[feature] < 0 && isRequired(names[feature], allFeatures))
+            {
+                error = "no " + names[feature] + " column in " + path;
+                return false;
+            }
+        }
+
+        while (std::getline(in, line))
+        {
+            const auto fields = FeatureStore::splitCsvLine(line);
+            const int label = labelColumn < static_cast<int>(fields.size())
+                                  ? moodIndex(fields[static_cast<size_t>(labelColumn)]) : -1;
+            if (label < 0)
+            {
+                ++table.unlabeled;
+                continue;
+            }
+
+            // Rows the training scripts would drop for a missing value are left out too
+            GrooveFeatures features {};
+            bool complete = true;
+            for (size_t feature = 0; feature < names.size() && complete; ++feature)
+            {
+                const int column = columns[feature];
+                if (column < 0)
+                    continue;
+                char* end = nullptr;
+                const char* text = column < static_cast<int>(fields.size()) ? fields[static_cast<size_t>(column)].c_str() : "";
+                const double value = std::strtod(text, &end);
+                complete = end != text && std::isfinite(value);
+                setFeature(features, feature, value);
+            }
+            if (!complete)
+            {
+                ++table.unlabeled;
+                continue;
+            }
+            table.rows.push_back(features);
+            table.labels.push_back(label);
+        }
+        return true;
+    }
+
+    double percentile(const std::vector<double>& sorted, double fraction)
+    {
+        if (sorted.empty())
+            return 0.0;
+        const auto index = static_cast<size_t>(std::min<double>(static_cast<double>(sorted.size() - 1),
+                                                                fraction * static_cast<double>(sorted.size())));
+        return sorted[index];
+    }
+
+    std::string escapeJson(const std::string& text)
+    {
+        std::string escaped;
+        for (const char c : text)
+        {
+            if (c == '"' || c == '\\')
+                escaped += '\\';
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    struct ClassMetrics
+    {
+        double precision = 0.0, recall = 0.0, f1 = 0.0;
+        size_t support = 0, predicted = 0;
+    };
+}
+
+int main(int argc, char* argv[])
+{
+    std::string modelPath, forestsPath, jsonPath, csvPath;
+    int numThreads = 0;
+    size_t batchSize = 256;
+    std::vector<std::string> positional;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--model") == 0 && hasValue)
+            modelPath = argv[++i];
+        else if (std::strcmp(argv[i], "--forests") == 0 && hasValue)
+            forestsPath = argv[++i];
+        else if (std::strcmp(argv[i], "--threads") == 0 && hasValue)
+            numThreads = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--batch") == 0 && hasValue)
+            batchSize = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        else if (std::strcmp(argv[i], "--json") == 0 && hasValue)
+            jsonPath = argv[++i];
+        else if (std::strcmp(argv[i], "--csv") == 0 && hasValue)
+            csvPath = argv[++i];
+        else
+            positional.push_back(argv[i]);
+    }
+
+    if (positional.size() != 1 || modelPath.empty())
+    {
+        printUsage();
+        return 2;
+    }
+
+    const bool cascade = !forestsPath.empty();
+    const auto& tablePath = positional[0];
+    const bool isCsv = juce::File(tablePath).hasFileExtension("csv");
+
+    Table table;
+    std::string error;
+    if (!(isCsv ? loadCsv(tablePath, cascade, table, error) : loadStore(tablePath, cascade, table, error)))
+    {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    if (table.rows.empty())
+    {
+        std::fprintf(stderr, "No labeled rows in %s\n", tablePath.c_str());
+        return 1;
+    }
+
+    // The cascade runs a row per call, as the plugin does
+    if (cascade)
+        batchSize = 1;
+    const size_t numBatches = (table.rows.size() + batchSize - 1) / batchSize;
+    if (numThreads <= 0)
+        numThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    numThreads = static_cast<int>(std::min<size_t>(static_cast<size_t>(numThreads), numBatches));
+    std::printf("Evaluating %zu rows (%zu left out) in batches of %zu on %d threads\n", table.rows.size(),
+                table.unlabeled, batchSize, numThreads);
+
+    std::vector<Results> results(static_cast<size_t>(numThreads));
+    std::atomic<size_t> nextBatch { 0 };
+    std::atomic<int> forestsLoaded { 0 };
+    std::atomic<bool> loadFailed { false };
+
+    const auto work = [&](Results& result)
+    {
+        ModelRunner runner(modelPath);
+        if (!runner.isModelLoaded())
+        {
+            loadFailed = true;
+            return;
+        }
+
+        std::unique_ptr<FeatureModelGraph> graph;
+        if (cascade)
+        {
+            graph = std::make_unique<FeatureModelGraph>();
+            forestsLoaded = graph->loadAuxiliaryModels(juce::File(forestsPath));
+            graph->setMoodFunction([&runner](const float* features, float* probabilities)
+            {
+                return runner.predictBatch(features, 1, probabilities);
+            });
+        }
+
+        std::vector<float> inputs(batchSize * FeatureModelGraph::numMoodFeatures);
+        std::vector<float> probabilities(batchSize * numMoods);
+        result.callMicroseconds.reserve(numBatches / static_cast<size_t>(numThreads) + 1);
+
+        for (size_t batch = nextBatch.fetch_add(1); batch < numBatches; batch = nextBatch.fetch_add(1))
+        {
+            const size_t first = batch * batchSize;
+            const size_t count = std::min(batchSize, table.rows.size() - first);
+            bool ok = true;
+
+            // A row repeating the last one's inputs would be served from the graph's cache and time as nothing
+            if (graph)
+                for (const auto node : { FeatureModelGraph::EnergyModel, FeatureModelGraph::SwingModel,
+                                         FeatureModelGraph::MoodModel })
+                    graph->invalidate(node);
+
+            const auto start = Clock::now();
+            if (graph)
+            {
+                graph->setInputs(table.rows[first]);
+                ok = graph->evaluate();
+                if (ok)
+                    std::copy_n(graph->getMoodProbabilities(), numMoods, probabilities.begin());
+            }
+            else
+            {
+                for (size_t row = 0; row < count; ++row)
+                {
+                    const auto& features = table.rows[first + row];
+                    const float values[] = { static_cast<float>(features.tempo), static_cast<float>(features.swing),
+                                             static_cast<float>(features.density),
+                                             static_cast<float>(features.dynamicRange),
+                                             static_cast<float>(features.energy) };
+                    std::copy(std::begin(values), std::end(values), inputs.begin() + static_cast<long>(row * FeatureModelGraph::numMoodFeatures));
+                }
+                ok = runner.predictBatch(inputs.data(), count, probabilities.data());
+            }
+            result.callMicroseconds.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+            result.rowsInCalls += count;
+
+            if (!ok)
+            {
+                result.failedRows += count;
+                continue;
+            }
+
+            if (graph)
+            {
+                result.energyError += std::abs(graph->getEnergy() - table.rows[first].energy);
+                result.swingError += std::abs(graph->getSwing() - table.rows[first].swing);
+            }
+
+            for (size_t row = 0; row < count; ++row)
+            {
+                const float* rowProbabilities = probabilities.data() + row * numMoods;
+                const auto best = std::max_element(rowProbabilities, rowProbabilities + numMoods);
+                if (*best < lowConfidence)
+                    ++result.lowConfidenceRows;
+                const auto truth = static_cast<size_t>(table.labels[first + row]);
+                ++result.confusion[truth][static_cast<size_t>(best - rowProbabilities)];
+            }
+        }
+    };
+
+    const auto start = Clock::now();
+    std::vector<std::thread> workers;
+    for (auto& result : results)
+        workers.emplace_back(work, std::ref(result));
+    for (auto& worker : workers)
+        worker.join();
+    const double wallSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    if (loadFailed.load())
+    {
+        std::fprintf(stderr, "Could not load %s\n", modelPath.c_str());
+        return 1;
+    }
+
+    // Merge the threads' results
+    Results total;
+    for (auto& result : results)
+    {
+        for (size_t t = 0; t < numMoods; ++t)
+            for (size_t p = 0; p < numMoods; ++p)
+                total.confusion[t][p] += result.confusion[t][p];
+        total.failedRows += result.failedRows;
+        total.lowConfidenceRows += result.lowConfidenceRows;
+        total.energyError += result.energyError;
+        total.swingError += result.swingError;
+        total.rowsInCalls += result.rowsInCalls;
+        total.callMicroseconds.insert(total.callMicroseconds.end(), result.callMicroseconds.begin(),
+                                      result.callMicroseconds.end());
+    }
+    std::sort(total.callMicroseconds.begin(), total.callMicroseconds.end());
+
+    const auto moods = ModelRunner::getMoodLabels();
+    std::array<ClassMetrics, numMoods> metrics;
+    size_t evaluated = 0, correct = 0;
+    for (size_t t = 0; t < numMoods; ++t)
+    {
+        for (size_t p = 0; p < numMoods; ++p)
+        {
+            metrics[t].support += total.confusion[t][p];
+            metrics[p].predicted += total.confusion[t][p];
+        }
+        correct += total.confusion[t][t];
+        evaluated += metrics[t].support;
+    }
+
+    double macroPrecision = 0.0, macroRecall = 0.0, macroF1 = 0.0;
+    size_t presentClasses = 0;
+    for (size_t c = 0; c < numMoods; ++c)
+    {
+        auto& m = metrics[c];
+        const double hits = static_cast<double>(total.confusion[c][c]);
+        m.precision = m.predicted > 0 ? hits / static_cast<double>(m.predicted) : 0.0;
+        m.recall = m.support > 0 ? hits / static_cast<double>(m.support) : 0.0;
+        m.f1 = m.precision + m.recall > 0.0 ? 2.0 * m.precision * m.recall / (m.precision + m.recall) : 0.0;
+        if (m.support > 0)
+        {
+            macroPrecision += m.precision;
+            macroRecall += m.recall;
+            macroF1 += m.f1;
+            ++presentClasses;
+        }
+    }
+    if (presentClasses > 0)
+    {
+        macroPrecision /= static_cast<double>(presentClasses);
+        macroRecall /= static_cast<double>(presentClasses);
+        macroF1 /= static_cast<double>(presentClasses);
+    }
+
+    const double accuracy = evaluated > 0 ? static_cast<double>(correct) / static_cast<double>(evaluated) : 0.0;
+    const auto& calls = total.callMicroseconds;
+    double callSum = 0.0;
+    for (const double micros : calls)
+        callSum += micros;
+    const double meanCall = calls.empty() ? 0.0 : callSum / static_cast<double>(calls.size());
+    const double perRow = total.rowsInCalls > 0 ? callSum / static_cast<double>(total.rowsInCalls) : 0.0;
+    const double rowsPerSecond = wallSeconds > 0.0 ? static_cast<double>(evaluated) / wallSeconds : 0.0;
+    const int loadedForests = forestsLoaded.load();
+    const size_t cascadeRows = evaluated > 0 ? evaluated : 1;
+
+    // Report
+    std::printf("\nAccuracy %.4f (%zu/%zu), macro precision %.4f, recall %.4f, F1 %.4f\n", accuracy, correct,
+                evaluated, macroPrecision, macroRecall, macroF1);
+    if (total.failedRows > 0 || total.lowConfidenceRows > 0)
+        std::printf("%zu rows failed inference, %zu below the %.2f confidence floor\n", total.failedRows,
+                    total.lowConfidenceRows, static_cast<double>(lowConfidence));
+    if (cascade)
+        std::printf("Cascade with %d of 2 forests, mean |energy - table| %.4f, |swing - table| %.4f\n", loadedForests,
+                    total.energyError / static_cast<double>(cascadeRows),
+                    total.swingError / static_cast<double>(cascadeRows));
+
+    std::printf("\n%-12s %9s %9s %9s %9s\n", "mood", "precision", "recall", "f1", "support");
+    for (size_t c = 0; c < numMoods; ++c)
+        std::printf("%-12s %9.4f %9.4f %9.4f %9zu\n", moods[c].c_str(), metrics[c].precision, metrics[c].recall,
+                    metrics[c].f1, metrics[c].support);
+
+    std::printf("\nConfusion (rows true, columns predicted)\n%-12s", "");
+    for (size_t p = 0; p < numMoods; ++p)
+        std::printf(" %7.7s", moods[p].c_str());
+    for (size_t t = 0; t < numMoods; ++t)
+    {
+        std::printf("\n%-12s", moods[t].c_str());
+        for (size_t p = 0; p < numMoods; ++p)
+            std::printf(" %7zu", total.confusion[t][p]);
+    }
+
+    std::printf("\n\nLatency per call (%zu rows): p50 %.1f us  p90 %.1f us  p99 %.1f us  max %.1f us  mean %.1f us\n",
+                batchSize, percentile(calls, 0.5), percentile(calls, 0.9), percentile(calls, 0.99),
+                calls.empty() ? 0.0 : calls.back(), meanCall);
+    std::printf("%.2f us per row, %.0f rows/s over %.2f s\n", perRow, rowsPerSecond, wallSeconds);
+
+    if (!jsonPath.empty())
+    {
+        std::ofstream json(jsonPath);
+        json << "{\n  \"model\": \"" << escapeJson(modelPath) << "\",\n  \"table\": \"" << escapeJson(tablePath)
+             << "\",\n  \"cascade\": " << (cascade ? "true" : "false") << ",\n  \"forests_loaded\": " << loadedForests
+             << ",\n  \"rows\": " << evaluated << ",\n  \"rows_left_out\": " << table.unlabeled
+             << ",\n  \"failed_rows\": " << total.failedRows << ",\n  \"low_confidence_rows\": "
+             << total.lowConfidenceRows << ",\n  \"accuracy\": " << accuracy << ",\n  \"macro_precision\": "
+             << macroPrecision << ",\n  \"macro_recall\": " << macroRecall << ",\n  \"macro_f1\": " << macroF1;
+        if (cascade)
+            json << ",\n  \"energy_mean_abs_difference\": " << total.energyError / static_cast<double>(cascadeRows)
+                 << ",\n  \"swing_mean_abs_difference\": " << total.swingError / static_cast<double>(cascadeRows);
+
+        json << ",\n  \"classes\": [";
+        for (size_t c = 0; c < numMoods; ++c)
+            json << (c > 0 ? ",\n" : "\n") << "    {\"mood\": \"" << moods[c] << "\", \"precision\": "
+                 << metrics[c].precision << ", \"recall\": " << metrics[c].recall << ", \"f1\": " << metrics[c].f1
+                 << ", \"support\": " << metrics[c].support << "}";
+
+        json << "\n  ],\n  \"confusion\": [";
+        for (size_t t = 0; t < numMoods; ++t)
+        {
+            json << (t > 0 ? ",\n" : "\n") << "    [";
+            for (size_t p = 0; p < numMoods; ++p)
+                json << (p > 0 ? ", " : "") << total.confusion[t][p];
+            json << "]";
+        }
+
+        json << "\n  ],\n  \"latency\": {\"batch_size\": " << batchSize << ", \"threads\": " << numThreads
+             << ", \"calls\": " << calls.size() << ", \"p50_us\": " << percentile(calls, 0.5)
+             << ", \"p90_us\": " << percentile(calls, 0.9) << ", \"p99_us\": " << percentile(calls, 0.99)
+             << ", \"max_us\": " << (calls.empty() ? 0.0 : calls.back()) << ", \"mean_us\": " << meanCall
+             << ", \"per_row_us\": " << perRow << ", \"rows_per_second\": " << rowsPerSecond
+             << ", \"wall_seconds\": " << wallSeconds << "}\n}\n";
+
+        if (!json)
+        {
+            std::fprintf(stderr, "Could not write %s\n", jsonPath.c_str());
+            return 1;
+        }
+    }
+
+    if (!csvPath.empty())
+    {
+        std::ofstream csv(csvPath);
+        csv << "mood,precision,recall,f1,support";
+        for (const auto& mood : moods)
+            csv << ",predicted_" << mood;
+        for (size_t c = 0; c < numMoods; ++c)
+        {
+            csv << "\n" << moods[c] << "," << metrics[c].precision << "," << metrics[c].recall << "," << metrics[c].f1
+                << "," << metrics[c].support;
+            for (size_t p = 0; p < numMoods; ++p)
+                csv << "," << total.confusion[c][p];
+        }
+        csv << "\n";
+
+        if (!csv)
+        {
+            std::fprintf(stderr, "Could not write %s\n", csvPath.c_str());
+            return 1;
+        }
+    }
+
+    return total.failedRows == 0 ? 0 : 1;
+}
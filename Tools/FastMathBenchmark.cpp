@@ -0,0 +1,161 @@
+// Accuracy and speed check for the FastMath approximations against libm.
+// Sweeps each function over its documented domain, reports the maximum error
+// and the throughput of both versions, and exits non-zero if any error bound
+// in FastMath.h is exceeded.
+//
+// Usage: FastMathBenchmark [numSamples] [iterations]
+
+#include "../Source/FastMath.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+    volatile float sink = 0.0f;
+
+    // Templated on the callable so both the libm and the fast loop are inlined
+    // and vectorized exactly as they would be at a call site
+    template <typename Function>
+    double timeMap(Function function, const std::vector<float>& input, std::vector<float>& output, int iterations)
+    {
+        auto run = [&]
+        {
+            for (size_t i = 0; i < input.size(); ++i)
+                output[i] = function(input[i]);
+            sink = output[input.size() / 2];
+        };
+
+        run(); // warm caches
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < iterations; ++i)
+            run();
+        auto end = std::chrono::high_resolution_clock::now();
+
+        return std::chrono::duration<double, std::nano>(end - start).count() / (iterations * static_cast<double>(input.size()));
+    }
+
+    struct Case
+    {
+        const char* name;
+        float (*fast)(float);
+        double (*reference)(double);
+        float low;
+        float high;
+        bool relative;
+        double bound;
+    };
+
+    float fastSin2Pi(float x) { return FastMath::sin2Pi(x); }
+    float fastCos2Pi(float x) { return FastMath::cos2Pi(x); }
+    float fastSin(float x) { return FastMath::sin(x); }
+    float fastCos(float x) { return FastMath::cos(x); }
+    float fastExp2(float x) { return FastMath::exp2(x); }
+    float fastExp(float x) { return FastMath::exp(x); }
+    float fastLog2(float x) { return FastMath::log2(x); }
+    float fastLog(float x) { return FastMath::log(x); }
+    float fastTanh(float x) { return FastMath::tanh(x); }
+    float fastWrapUnit(float x) { return FastMath::wrapUnit(x); }
+
+    double refSin2Pi(double x) { return std::sin(6.283185307179586 * x); }
+    double refCos2Pi(double x) { return std::cos(6.283185307179586 * x); }
+    double refSin(double x) { return std::sin(x); }
+    double refCos(double x) { return std::cos(x); }
+    double refExp2(double x) { return std::exp2(x); }
+    double refExp(double x) { return std::exp(x); }
+    double refLog2(double x) { return std::log2(x); }
+    double refLog(double x) { return std::log(x); }
+    double refTanh(double x) { return std::tanh(x); }
+    double refWrapUnit(double x) { return x - std::floor(x); }
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t numSamples = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 1 << 16;
+    const int iterations = argc > 2 ? std::atoi(argv[2]) : 500;
+
+    // Domains and bounds mirror the table documented in FastMath.h
+    const std::vector<Case> cases = {
+        {"sin2Pi", fastSin2Pi, refSin2Pi, -4096.0f, 4096.0f, false, 2e-7},
+        {"cos2Pi", fastCos2Pi, refCos2Pi, -4096.0f, 4096.0f, false, 2e-7},
+        {"sin", fastSin, refSin, -1000.0f, 1000.0f, false, 2e-7},
+        {"cos", fastCos, refCos, -1000.0f, 1000.0f, false, 2e-7},
+        {"exp2", fastExp2, refExp2, -120.0f, 120.0f, true, 3e-7},
+        {"exp", fastExp, refExp, -80.0f, 80.0f, true, 3e-7},
+        {"log2", fastLog2, refLog2, 1e-30f, 1e30f, false, 3e-7},
+        {"log", fastLog, refLog, 1e-30f, 1e30f, false, 3e-7},
+        {"tanh", fastTanh, refTanh, -12.0f, 12.0f, false, 3e-7},
+        {"wrapUnit", fastWrapUnit, refWrapUnit, -1000.0f, 1000.0f, false, 1e-7},
+    };
+
+    std::printf("%-10s %14s %12s %8s\n", "function", "max error", "bound", "check");
+
+    bool allWithinBounds = true;
+    const int sweepPoints = 2000000;
+    for (const auto& c : cases)
+    {
+        double maxError = 0.0;
+        for (int i = 0; i <= sweepPoints; ++i)
+        {
+            double t = static_cast<double>(i) / sweepPoints;
+            // Log-domain sweep for log functions so every exponent is covered
+            float x = c.low > 0.0f
+                ? static_cast<float>(std::exp(std::log(c.low) + t * (std::log(c.high) - std::log(c.low))))
+                : static_cast<float>(c.low + t * (c.high - c.low));
+
+            double expected = c.reference(static_cast<double>(x));
+            double error = std::abs(static_cast<double>(c.fast(x)) - expected);
+            // Absolute below 1, relative above, so large log results aren't judged on output rounding
+            error /= c.relative ? std::abs(expected) : std::max(1.0, std::abs(expected));
+            maxError = std::max(maxError, error);
+        }
+
+        bool ok = maxError <= c.bound;
+        allWithinBounds = allWithinBounds && ok;
+        std::printf("%-10s %14.3e %12.1e %8s\n", c.name, maxError, c.bound, ok ? "ok" : "FAIL");
+    }
+
+    // Throughput over a buffer, the shape of the hot loops that use these
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> phases(-8.0f, 8.0f);
+    std::uniform_real_distribution<float> positives(1e-3f, 1e3f);
+    std::vector<float> phaseData(numSamples), positiveData(numSamples), out(numSamples);
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+        phaseData[i] = phases(rng);
+        positiveData[i] = positives(rng);
+    }
+
+    std::printf("\n%-10s %14s %14s %10s\n", "function", "libm ns/elem", "fast ns/elem", "speedup");
+    auto report = [&](const char* name, double libmNs, double fastNs)
+    {
+        std::printf("%-10s %14.3f %14.3f %9.2fx\n", name, libmNs, fastNs, fastNs > 0.0 ? libmNs / fastNs : 0.0);
+    };
+
+    report("sin",
+           timeMap([](float x) { return std::sin(x); }, phaseData, out, iterations),
+           timeMap([](float x) { return FastMath::sin(x); }, phaseData, out, iterations));
+    report("sin2Pi",
+           timeMap([](float x) { return std::sin(x * FastMath::twoPi); }, phaseData, out, iterations),
+           timeMap([](float x) { return FastMath::sin2Pi(x); }, phaseData, out, iterations));
+    report("exp",
+           timeMap([](float x) { return std::exp(x); }, phaseData, out, iterations),
+           timeMap([](float x) { return FastMath::exp(x); }, phaseData, out, iterations));
+    report("log2",
+           timeMap([](float x) { return std::log2(x); }, positiveData, out, iterations),
+           timeMap([](float x) { return FastMath::log2(x); }, positiveData, out, iterations));
+    report("tanh",
+           timeMap([](float x) { return std::tanh(x); }, phaseData, out, iterations),
+           timeMap([](float x) { return FastMath::tanh(x); }, phaseData, out, iterations));
+    report("wrapUnit",
+           timeMap([](float x) { return std::fmod(x, 1.0f); }, phaseData, out, iterations),
+           timeMap([](float x) { return FastMath::wrapUnit(x); }, phaseData, out, iterations));
+
+    return allWithinBounds ? 0 : 1;
+}
@@ -0,0 +1,318 @@
+// Loopback benchmark for out-of-process inference.
+// Forks a server process, then runs N client threads in this one, each with its
+// own slot as N plugin instances would have. Each client sends its requests back
+// to back, or one every --interval-ms like an audio callback, and times every
+// round trip. Prints latency percentiles, aggregate throughput and the server's
+// batch sizes, next to the same inference called in process. With no model it
+// serves a small stand-in network, which measures the transport alone.
+// Exits non-zero if any request fails or times out. Linux only.
+//
+// Usage: AamatiInferenceBenchmark [numClients] [requestsPerClient] [--model path] [--interval-ms n] [--timeout-ms n]
+
+#include <JuceHeader.h>
+#include "../Source/InferenceIpc.h"
+#include "../Source/ModelRunner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if JUCE_LINUX
+ #include <sys/wait.h>
+ #include <unistd.h>
+#endif
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr int hiddenUnits = 16;
+    constexpr int inProcessCalls = 10000;
+
+    std::atomic<bool> stopRequested { false };
+
+    void requestStop(int)
+    {
+        stopRequested.store(true);
+    }
+
+    // 5 -> 16 -> 10 with fixed weights and a softmax: about as much arithmetic as the real model
+    struct StandInNetwork
+    {
+        std::vector<float> hidden, output;
+
+        StandInNetwork()
+        {
+            std::mt19937 generator(1234);
+            std::uniform_real_distribution<float> weight(-0.5f, 0.5f);
+            hidden.resize((InferenceIpc::numFeatures + 1) * hiddenUnits);
+            output.resize((hiddenUnits + 1) * InferenceIpc::numMoods);
+            for (auto& w : hidden)
+                w = weight(generator);
+            for (auto& w : output)
+                w = weight(generator);
+        }
+
+        bool operator()(const float* features, int numRows, float* probabilities) const
+        {
+            for (int row = 0; row < numRows; ++row)
+            {
+                const float* in = features + row * InferenceIpc::numFeatures;
+                float* out = probabilities + row * InferenceIpc::numMoods;
+
+                float units[hiddenUnits];
+                for (int h = 0; h < hiddenUnits; ++h)
+                {
+                    float sum = hidden[static_cast<size_t>(InferenceIpc::numFeatures * hiddenUnits + h)];
+                    for (int i = 0; i < InferenceIpc::numFeatures; ++i)
+                        sum += in[i] * hidden[static_cast<size_t>(i * hiddenUnits + h)];
+                    units[h] = std::max(0.0f, sum);
+                }
+
+                float total = 0.0f;
+                for (int m = 0; m < InferenceIpc::numMoods; ++m)
+                {
+                    float sum = output[static_cast<size_t>(hiddenUnits * InferenceIpc::numMoods + m)];
+                    for (int h = 0; h < hiddenUnits; ++h)
+                        sum += units[h] * output[static_cast<size_t>(h * InferenceIpc::numMoods + m)];
+                    out[m] = std::exp(std::min(sum, 30.0f));
+                    total += out[m];
+                }
+                for (int m = 0; m < InferenceIpc::numMoods; ++m)
+                    out[m] /= total;
+            }
+            return true;
+        }
+    };
+
+    // Features inside the ranges ModelRunner accepts
+    InferenceIpc::Features randomFeatures(std::mt19937& generator)
+    {
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        return { 60.0f + 140.0f * unit(generator), unit(generator), 10.0f * unit(generator),
+                 127.0f * unit(generator), unit(generator) };
+    }
+
+    double percentile(std::vector<double>& sorted, double fraction)
+    {
+        if (sorted.empty())
+            return 0.0;
+        const auto index = static_cast<size_t>(std::min<double>(static_cast<double>(sorted.size() - 1),
+                                                                fraction * static_cast<double>(sorted.size())));
+        return sorted[index];
+    }
+
+    void printLatencies(const char* name, std::vector<double>& microseconds)
+    {
+        std::sort(microseconds.begin(), microseconds.end());
+        std::printf("%-14s p50 %8.1f us  p90 %8.1f us  p99 %8.1f us  max %8.1f us\n", name,
+                    percentile(microseconds, 0.5), percentile(microseconds, 0.9), percentile(microseconds, 0.99),
+                    microseconds.empty() ? 0.0 : microseconds.back());
+    }
+}
+
+int main(int argc, char* argv[])
+{
+#if JUCE_LINUX
+    int numClients = 100;
+    int requestsPerClient = 1000;
+    int intervalMs = 0;
+    int timeoutMs = 50;
+    std::string modelPath;
+
+    int positional = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--model") == 0 && i + 1 < argc)
+            modelPath = argv[++i];
+        else if (std::strcmp(argv[i], "--interval-ms") == 0 && i + 1 < argc)
+            intervalMs = std::max(0, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--timeout-ms") == 0 && i + 1 < argc)
+            timeoutMs = std::max(1, std::atoi(argv[++i]));
+        else if (argv[i][0] != '-' && positional == 0 && ++positional)
+            numClients = juce::jlimit(1, InferenceIpc::maxClients, std::atoi(argv[i]));
+        else if (argv[i][0] != '-' && positional == 1 && ++positional)
+            requestsPerClient = std::max(1, std::atoi(argv[i]));
+        else
+        {
+            std::fprintf(stderr, "Usage: AamatiInferenceBenchmark [numClients] [requestsPerClient] [--model path] "
+                                 "[--interval-ms n] [--timeout-ms n]\n");
+            return 2;
+        }
+    }
+
+    // The model is only loaded in the processes that run it
+    const auto makeInference = [&modelPath](std::unique_ptr<ModelRunner>& runner) -> InferenceServer::BatchFunction
+    {
+        if (modelPath.empty())
+            return StandInNetwork();
+
+        runner = std::make_unique<ModelRunner>(modelPath);
+        if (!runner->isModelLoaded())
+            return {};
+        auto* session = runner.get();
+        return [session](const float* features, int numRows, float* probabilities)
+        {
+            return session->predictBatch(features, static_cast<size_t>(numRows), probabilities);
+        };
+    };
+
+    const pid_t serverPid = fork();
+    if (serverPid < 0)
+    {
+        std::fprintf(stderr, "fork failed\n");
+        return 1;
+    }
+
+    if (serverPid == 0)
+    {
+        std::signal(SIGTERM, requestStop);
+        std::unique_ptr<ModelRunner> runner;
+        const auto infer = makeInference(runner);
+        InferenceServer server;
+        if (!infer || !server.start())
+        {
+            std::fprintf(stderr, infer ? "Server could not start; is a daemon already running?\n" : "Could not load model\n");
+            _exit(1);
+        }
+
+        server.serve(infer, []() { return stopRequested.load(); });
+        const auto stats = server.getStats();
+        server.stop();
+        std::printf("server: %llu requests in %llu batches, mean batch %.1f, largest %d\n",
+                    static_cast<unsigned long long>(stats.requests), static_cast<unsigned long long>(stats.batches),
+                    stats.batches > 0 ? static_cast<double>(stats.requests) / static_cast<double>(stats.batches) : 0.0,
+                    stats.largestBatch);
+        std::fflush(stdout);
+        _exit(0);
+    }
+
+    // Wait for the server to come up
+    bool serverUp = false;
+    for (int attempt = 0; attempt < 500 && !serverUp; ++attempt)
+    {
+        InferenceClient probe;
+        serverUp = probe.connect();
+        if (!serverUp)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    if (!serverUp)
+    {
+        std::fprintf(stderr, "Server did not come up\n");
+        kill(serverPid, SIGTERM);
+        waitpid(serverPid, nullptr, 0);
+        return 1;
+    }
+
+    std::printf("%d clients x %d requests, %s, %s\n", numClients, requestsPerClient,
+                modelPath.empty() ? "stand-in network" : modelPath.c_str(),
+                intervalMs > 0 ? (std::to_string(intervalMs) + " ms apart").c_str() : "back to back");
+
+    std::vector<std::vector<double>> latencies(static_cast<size_t>(numClients));
+    std::atomic<int> failures { 0 };
+    std::atomic<int> ready { 0 };
+    std::atomic<bool> go { false };
+    std::vector<std::thread> clients;
+
+    for (int c = 0; c < numClients; ++c)
+    {
+        clients.emplace_back([&, c]()
+        {
+            auto& times = latencies[static_cast<size_t>(c)];
+            times.reserve(static_cast<size_t>(requestsPerClient));
+            std::mt19937 generator(static_cast<unsigned>(c + 1));
+
+            InferenceClient client;
+            const bool connected = client.connect();
+            ready.fetch_add(1);
+            while (!go.load())
+                std::this_thread::yield();
+
+            if (!connected)
+            {
+                failures.fetch_add(requestsPerClient);
+                return;
+            }
+
+            auto next = Clock::now();
+            InferenceIpc::Probabilities probabilities {};
+            for (int r = 0; r < requestsPerClient; ++r)
+            {
+                const auto features = randomFeatures(generator);
+                const auto start = Clock::now();
+                const bool answered = client.predict(features, probabilities, timeoutMs);
+                const auto end = Clock::now();
+
+                if (answered)
+                    times.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+                else
+                    failures.fetch_add(1);
+
+                if (intervalMs > 0)
+                {
+                    next += std::chrono::milliseconds(intervalMs);
+                    std::this_thread::sleep_until(next);
+                }
+            }
+        });
+    }
+
+    while (ready.load() < numClients)
+        std::this_thread::yield();
+
+    const auto start = Clock::now();
+    go.store(true);
+    for (auto& client : clients)
+        client.join();
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<double> all;
+    for (auto& times : latencies)
+        all.insert(all.end(), times.begin(), times.end());
+
+    printLatencies("out of process", all);
+    std::printf("throughput     %.0f requests/s over %.2f s, %d failed or timed out\n",
+                static_cast<double>(all.size()) / seconds, seconds, failures.load());
+
+    // The same work called directly, one row at a time, for comparison
+    {
+        std::unique_ptr<ModelRunner> runner;
+        const auto infer = makeInference(runner);
+        std::mt19937 generator(99);
+        std::vector<double> direct;
+        direct.reserve(inProcessCalls);
+        InferenceIpc::Probabilities probabilities {};
+        for (int i = 0; i < inProcessCalls && infer; ++i)
+        {
+            const auto features = randomFeatures(generator);
+            const auto callStart = Clock::now();
+            infer(features.data(), 1, probabilities.data());
+            direct.push_back(std::chrono::duration<double, std::micro>(Clock::now() - callStart).count());
+        }
+        printLatencies("in process", direct);
+    }
+
+    std::fflush(stdout);
+    kill(serverPid, SIGTERM);
+    int status = 0;
+    waitpid(serverPid, &status, 0);
+
+    return failures.load() == 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0 ? 0 : 1;
+#else
+    juce::ignoreUnused(argc, argv);
+    std::fprintf(stderr, "The inference daemon is Linux only\n");
+    return 1;
+#endif
+}
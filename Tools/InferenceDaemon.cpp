@@ -0,0 +1,105 @@
+// Local inference daemon.
+// Hosts one ModelRunner session and serves every Aamati instance on the machine
+// through shared memory (see Source/InferenceIpc.h). Plugin processes then don't
+// each load ONNX Runtime and the model. Instances look for the daemon in
+// prepareToPlay. If it stops, they load the model themselves. Linux only.
+//
+// Usage: AamatiInferenceDaemon [modelPath] [--stats seconds]
+
+#include <JuceHeader.h>
+#include "../Source/InferenceIpc.h"
+#include "../Source/ModelRunner.h"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace
+{
+    std::atomic<bool> stopRequested { false };
+
+    void requestStop(int)
+    {
+        stopRequested.store(true);
+    }
+
+    void printStats(const InferenceServer::Stats& stats)
+    {
+        const double meanBatch = stats.batches > 0 ? static_cast<double>(stats.requests) / static_cast<double>(stats.batches) : 0.0;
+        std::printf("%llu requests in %llu batches (mean %.1f, largest %d), %llu failed batches, %d clients\n",
+                    static_cast<unsigned long long>(stats.requests), static_cast<unsigned long long>(stats.batches),
+                    meanBatch, stats.largestBatch, static_cast<unsigned long long>(stats.failedBatches),
+                    stats.connectedClients);
+        std::fflush(stdout);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::string modelPath;
+    double statsSeconds = 10.0;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--stats") == 0 && i + 1 < argc)
+            statsSeconds = std::atof(argv[++i]);
+        else if (argv[i][0] != '-')
+            modelPath = argv[i];
+        else
+        {
+            std::fprintf(stderr, "Usage: AamatiInferenceDaemon [modelPath] [--stats seconds]\n");
+            return 2;
+        }
+    }
+
+    // Same place the plugin looks: Resources next to the executable
+    if (modelPath.empty())
+    {
+        auto exeDir = juce::File::getSpecialLocation(juce::File::currentExecutableFile).getParentDirectory();
+        modelPath = exeDir.getChildFile("Resources/groove_mood_model.onnx").getFullPathName().toStdString();
+    }
+
+    ModelRunner runner(modelPath);
+    if (!runner.isModelLoaded())
+    {
+        std::fprintf(stderr, "Could not load model: %s\n", modelPath.c_str());
+        return 1;
+    }
+
+    InferenceServer server;
+    if (!server.start())
+    {
+        std::fprintf(stderr, "Could not start: another daemon is running, or shared memory is unavailable\n");
+        return 1;
+    }
+
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+    std::printf("Serving %s\n", modelPath.c_str());
+    std::fflush(stdout);
+
+    using Clock = std::chrono::steady_clock;
+    auto lastReport = Clock::now();
+
+    server.serve([&runner](const float* features, int numRows, float* probabilities)
+                 {
+                     return runner.predictBatch(features, static_cast<size_t>(numRows), probabilities);
+                 },
+                 [&]()
+                 {
+                     if (statsSeconds > 0.0 && std::chrono::duration<double>(Clock::now() - lastReport).count() >= statsSeconds)
+                     {
+                         printStats(server.getStats());
+                         lastReport = Clock::now();
+                     }
+                     return stopRequested.load();
+                 });
+
+    server.stop();
+    printStats(server.getStats());
+    return 0;
+}
@@ -0,0 +1,162 @@
+// Batch MIDI compliance fixer, the native replacement for fixed_midi_compliance.py.
+// Moves tempo, time signature and key signature events into track 0 for one MIDI
+// file, or for every .mid/.midi file under a folder (see Source/MidiCompliance.h).
+// Fixed files are written under the output folder with their folder layout
+// mirrored. Clean files are left out, as the script did. The output folder may be
+// the input folder, which fixes files in place. Files are spread over worker
+// threads. Exits non-zero if any file could not be read or fixed.
+//
+// Usage: AamatiMidiCompliance [--threads N] [--verbose] <input> <outputFolder>
+
+#include "../Source/MidiCompliance.h"
+#include "../Source/MoodRemixer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    void printUsage()
+    {
+        std::fprintf(stderr, "Usage: AamatiMidiCompliance [--threads N] [--verbose] <input> <outputFolder>\n");
+    }
+
+    struct Totals
+    {
+        std::atomic<size_t> completed { 0 };
+        std::atomic<size_t> fixed { 0 };
+        std::atomic<size_t> clean { 0 };
+        std::atomic<size_t> skipped { 0 };
+        std::atomic<size_t> failed { 0 };
+        std::atomic<size_t> movedEvents { 0 };
+    };
+
+    void printProgress(const Totals& totals, size_t total, double seconds)
+    {
+        const auto completed = totals.completed.load();
+        std::printf("\r%zu/%zu files, %zu fixed, %zu clean, %zu skipped, %zu failed, %.0f files/s", completed, total,
+                    totals.fixed.load(), totals.clean.load(), totals.skipped.load(), totals.failed.load(),
+                    seconds > 0.0 ? static_cast<double>(completed) / seconds : 0.0);
+        std::fflush(stdout);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int numThreads = 0;
+    bool verbose = false;
+    std::vector<std::string> positional;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            numThreads = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--verbose") == 0)
+            verbose = true;
+        else
+            positional.push_back(argv[i]);
+    }
+
+    if (positional.size() != 2)
+    {
+        printUsage();
+        return 2;
+    }
+
+    const auto& inputRoot = positional[0];
+    const auto& outputRoot = positional[1];
+    const auto files = MoodRemixer::findMidiFiles(inputRoot);
+    if (files.empty())
+    {
+        std::fprintf(stderr, "No MIDI files found in %s\n", inputRoot.c_str());
+        return 1;
+    }
+
+    if (numThreads <= 0)
+        numThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    numThreads = static_cast<int>(std::min<size_t>(static_cast<size_t>(numThreads), files.size()));
+    std::printf("Checking %zu files on %d threads\n", files.size(), numThreads);
+
+    Totals totals;
+    std::atomic<size_t> nextFile { 0 };
+    std::mutex messagesLock;
+    std::vector<std::string> failures, details;
+
+    const auto work = [&]()
+    {
+        for (size_t index = nextFile.fetch_add(1); index < files.size(); index = nextFile.fetch_add(1))
+        {
+            const auto& path = files[index];
+            const auto report = MidiCompliance::normalizeFile(path, MoodRemixer::getOutputPath(path, inputRoot, outputRoot));
+
+            switch (report.result)
+            {
+                case MidiCompliance::Result::Fixed:
+                    ++totals.fixed;
+                    totals.movedEvents += static_cast<size_t>(report.movedEvents);
+                    if (verbose)
+                    {
+                        const std::lock_guard<std::mutex> lock(messagesLock);
+                        details.push_back(path + ": moved " + std::to_string(report.movedEvents) + " events, dropped "
+                                          + std::to_string(report.duplicatesDropped) + " duplicates, rewrote "
+                                          + std::to_string(report.rewrittenTracks) + " tracks");
+                    }
+                    break;
+                case MidiCompliance::Result::Clean:
+                    ++totals.clean;
+                    break;
+                case MidiCompliance::Result::Skipped:
+                    ++totals.skipped;
+                    if (verbose)
+                    {
+                        const std::lock_guard<std::mutex> lock(messagesLock);
+                        details.push_back(path + ": format 2, left alone");
+                    }
+                    break;
+                case MidiCompliance::Result::Failed:
+                {
+                    ++totals.failed;
+                    const std::lock_guard<std::mutex> lock(messagesLock);
+                    failures.push_back(path + ": " + report.error);
+                    break;
+                }
+            }
+            ++totals.completed;
+        }
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto elapsed = [&start]
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < numThreads; ++t)
+        workers.emplace_back(work);
+
+    while (totals.completed.load() < files.size())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+        printProgress(totals, files.size(), elapsed());
+    }
+    for (auto& worker : workers)
+        worker.join();
+    printProgress(totals, files.size(), elapsed());
+    std::printf("\n%zu events moved into track 0\n", totals.movedEvents.load());
+
+    for (const auto& line : details)
+        std::printf("%s\n", line.c_str());
+    for (const auto& failure : failures)
+        std::fprintf(stderr, "%s\n", failure.c_str());
+
+    return totals.failed.load() == 0 ? 0 : 1;
+}
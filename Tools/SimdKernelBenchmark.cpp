@@ -0,0 +1,169 @@
+// Per-ISA throughput benchmark for the SIMD kernel layer.
+// Runs every kernel through each instruction set this CPU supports, checks the
+// result against the scalar table and reports nanoseconds per sample.
+//
+// Usage: SimdKernelBenchmark [numSamples] [iterations]
+
+#include "../Source/SimdKernels.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace
+{
+    volatile float sink = 0.0f;
+
+    double timeKernel(const std::function<void()>& kernel, int iterations)
+    {
+        kernel(); // warm caches and the branch predictor
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < iterations; ++i)
+            kernel();
+        auto end = std::chrono::high_resolution_clock::now();
+
+        return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+    }
+
+    float relativeError(float value, float reference)
+    {
+        return std::abs(value - reference) / std::max(1.0f, std::abs(reference));
+    }
+
+    double relativeError(double value, double reference)
+    {
+        return std::abs(value - reference) / std::max(1.0, std::abs(reference));
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t numSamples = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 441000;
+    const int iterations = argc > 2 ? std::atoi(argv[2]) : 200;
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+    std::vector<float> a(numSamples), b(numSamples), work(numSamples), out(numSamples);
+    std::vector<float> left(numSamples), right(numSamples);
+    std::vector<float> spectrum(numSamples * 2);
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+        a[i] = dist(rng);
+        b[i] = dist(rng);
+    }
+    for (auto& value : spectrum)
+        value = dist(rng);
+
+    const auto& reference = *getScalarKernelTable();
+    const float refDot = reference.dotProduct(a.data(), b.data(), numSamples);
+    const double refSquares = reference.sumOfSquares(a.data(), numSamples);
+    const double refSum = reference.sum(a.data(), numSamples);
+    const size_t refCount = reference.countAboveAbs(a.data(), numSamples, 0.1f);
+    float refMin = 0.0f, refMax = 0.0f;
+    reference.minMax(a.data(), numSamples, refMin, refMax);
+    std::vector<float> refAffine(numSamples), refMagnitude(numSamples);
+    reference.affine(a.data(), refAffine.data(), numSamples, 64.0f, 64.0f);
+    reference.complexMagnitude(spectrum.data(), refMagnitude.data(), numSamples);
+    std::vector<float> refPanLeft(b), refPanRight(b);
+    reference.panMix(a.data(), refPanLeft.data(), refPanRight.data(), numSamples, 0.7f, 0.3f);
+
+    // Chroma-sized template matching: one row per sample, twelve columns
+    constexpr size_t numColumns = 12;
+    std::vector<float> matrix(numSamples * numColumns), columnWeights(numColumns), refProduct(numSamples);
+    for (auto& value : matrix)
+        value = dist(rng);
+    for (auto& value : columnWeights)
+        value = dist(rng);
+    reference.matrixVector(matrix.data(), columnWeights.data(), refProduct.data(), numSamples, numColumns);
+
+    auto matches = [](const std::vector<float>& x, const std::vector<float>& y)
+    {
+        for (size_t i = 0; i < x.size(); ++i)
+            if (relativeError(x[i], y[i]) > 1e-5f)
+                return false;
+        return true;
+    };
+
+    std::printf("Active ISA: %s, %zu samples, %d iterations\n\n",
+                SimdKernels::getIsaName(SimdKernels::getActiveIsa()), numSamples, iterations);
+    std::printf("%-8s %-18s %12s %10s %10s\n", "isa", "kernel", "ns/sample", "speedup", "check");
+
+    std::vector<std::pair<const char*, double>> scalarTimes;
+
+    for (auto isa : {SimdKernels::Isa::Scalar, SimdKernels::Isa::SSE2, SimdKernels::Isa::AVX2, SimdKernels::Isa::AVX512})
+    {
+        const auto* table = SimdKernels::getTableFor(isa);
+        if (table == nullptr)
+        {
+            std::printf("%-8s (not supported on this CPU/build)\n", SimdKernels::getIsaName(isa));
+            continue;
+        }
+
+        const auto& t = *table;
+        float vmin = 0.0f, vmax = 0.0f;
+        t.minMax(a.data(), numSamples, vmin, vmax);
+        t.affine(a.data(), out.data(), numSamples, 64.0f, 64.0f);
+        const bool affineOk = matches(out, refAffine);
+        t.complexMagnitude(spectrum.data(), out.data(), numSamples);
+        const bool magnitudeOk = matches(out, refMagnitude);
+        left = b;
+        right = b;
+        t.panMix(a.data(), left.data(), right.data(), numSamples, 0.7f, 0.3f);
+        const bool panMixOk = matches(left, refPanLeft) && matches(right, refPanRight);
+        t.matrixVector(matrix.data(), columnWeights.data(), out.data(), numSamples, numColumns);
+        bool matrixVectorOk = true;
+        for (size_t i = 0; i < numSamples; ++i)
+            matrixVectorOk = matrixVectorOk && std::abs(out[i] - refProduct[i]) < 1e-4f;
+        work = a;
+        left = a;
+        right = b;
+
+        struct Case
+        {
+            const char* name;
+            std::function<void()> run;
+            bool ok;
+        };
+
+        std::vector<Case> cases = {
+            {"dotProduct", [&] { sink = t.dotProduct(a.data(), b.data(), numSamples); },
+             relativeError(t.dotProduct(a.data(), b.data(), numSamples), refDot) < 1e-3f},
+            {"sumOfSquares", [&] { sink = static_cast<float>(t.sumOfSquares(a.data(), numSamples)); },
+             relativeError(t.sumOfSquares(a.data(), numSamples), refSquares) < 1e-9},
+            {"sum", [&] { sink = static_cast<float>(t.sum(a.data(), numSamples)); },
+             relativeError(t.sum(a.data(), numSamples), refSum) < 1e-9},
+            {"minMax", [&] { float lo, hi; t.minMax(a.data(), numSamples, lo, hi); sink = lo + hi; },
+             vmin == refMin && vmax == refMax},
+            {"countAboveAbs", [&] { sink = static_cast<float>(t.countAboveAbs(a.data(), numSamples, 0.1f)); },
+             t.countAboveAbs(a.data(), numSamples, 0.1f) == refCount},
+            // In-place kernels run on scratch copies with gains that keep the data stable across iterations
+            {"scaleClamp", [&] { t.scaleClamp(work.data(), numSamples, 1.0f, 0.0f, -0.9f, 0.9f); }, true},
+            {"affine", [&] { t.affine(a.data(), out.data(), numSamples, 64.0f, 64.0f); }, affineOk},
+            {"midSide", [&] { t.midSide(left.data(), right.data(), numSamples, 1.0f, 1.0f); }, true},
+            {"panMix", [&] { t.panMix(a.data(), left.data(), right.data(), numSamples, 0.0f, 0.0f); }, panMixOk},
+            {"complexMagnitude", [&] { t.complexMagnitude(spectrum.data(), out.data(), numSamples); }, magnitudeOk},
+            {"matrixVector", [&] { t.matrixVector(matrix.data(), columnWeights.data(), out.data(), numSamples, numColumns); }, matrixVectorOk},
+        };
+
+        for (size_t c = 0; c < cases.size(); ++c)
+        {
+            double ns = timeKernel(cases[c].run, iterations) / static_cast<double>(numSamples);
+            if (isa == SimdKernels::Isa::Scalar)
+                scalarTimes.emplace_back(cases[c].name, ns);
+
+            double speedup = c < scalarTimes.size() && ns > 0.0 ? scalarTimes[c].second / ns : 0.0;
+            std::printf("%-8s %-18s %12.4f %9.2fx %10s\n", SimdKernels::getIsaName(isa),
+                        cases[c].name, ns, speedup, cases[c].ok ? "ok" : "MISMATCH");
+        }
+        std::printf("\n");
+    }
+
+    return 0;
+}
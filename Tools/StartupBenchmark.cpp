@@ -0,0 +1,190 @@
+// Headless cold-start benchmark for the plugin.
+// Loads N instances the way a host restores a session: constructs every processor,
+// prepares them all, opens their editors (unless --no-editor), then feeds each a
+// click track until its model makes the first prediction. All instances stay alive
+// together and are fed block by block in turn, as a host would run them.
+//
+// Prints each instance's startup timeline, then the median and worst time per
+// phase against the startup targets below. Exits non-zero if a median goes over
+// its target.
+//
+// Usage: AamatiStartupBenchmark [numInstances] [blockSize] [--no-editor] [--trace]
+
+#include <JuceHeader.h>
+#include "../Source/PluginProcessor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Cold-start budgets per phase, in milliseconds
+    struct Target
+    {
+        const char* phase;
+        double budgetMs;
+    };
+
+    const Target targets[] = {
+        {"processor constructor", 5.0},
+        {"prepareToPlay", 150.0},
+        {"ONNX session creation", 120.0},
+        {"feature extractor", 10.0},
+        {"editor constructor", 150.0},
+        {"first prediction", 1500.0},
+    };
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int maxSecondsOfAudio = 10;
+
+    // Decaying noise bursts on every beat at 120 BPM, enough for the onset analysis to lock on
+    void fillClickTrack(juce::AudioBuffer<float>& buffer, juce::int64 startSample, juce::Random& random)
+    {
+        const juce::int64 samplesPerBeat = static_cast<juce::int64>(sampleRate * 0.5);
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+        {
+            auto sinceBeat = static_cast<float>((startSample + i) % samplesPerBeat);
+            float envelope = std::exp(-sinceBeat / 2000.0f);
+            float value = 0.8f * envelope * (random.nextFloat() * 2.0f - 1.0f);
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                buffer.setSample(channel, i, value);
+        }
+    }
+
+    double median(std::vector<double> values)
+    {
+        if (values.empty())
+            return 0.0;
+        std::sort(values.begin(), values.end());
+        size_t middle = values.size() / 2;
+        return values.size() % 2 == 1 ? values[middle] : 0.5 * (values[middle - 1] + values[middle]);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int numInstances = 8;
+    int blockSize = 512;
+    bool withEditor = true;
+    bool trace = false;
+
+    int positional = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--no-editor") == 0)
+            withEditor = false;
+        else if (std::strcmp(argv[i], "--trace") == 0)
+            trace = true;
+        else if (positional++ == 0)
+            numInstances = std::max(1, std::atoi(argv[i]));
+        else
+            blockSize = std::max(32, std::atoi(argv[i]));
+    }
+
+    // Editors need a message manager, but nothing is ever put on the desktop
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    std::map<std::string, std::vector<double>> phaseTimes;
+    int instancesWithoutPrediction = 0;
+
+    std::vector<std::unique_ptr<AamatiAudioProcessor>> processors;
+    std::vector<std::unique_ptr<juce::AudioProcessorEditor>> editors;
+
+    for (int instance = 0; instance < numInstances; ++instance)
+    {
+        processors.push_back(std::make_unique<AamatiAudioProcessor>());
+        if (trace)
+            processors.back()->getStartupTimeline().setTraceSink([instance](const std::string& line)
+            {
+                std::printf("#%d %s\n", instance, line.c_str());
+            });
+    }
+
+    for (auto& processor : processors)
+    {
+        processor->setPlayConfigDetails(2, 2, sampleRate, blockSize);
+        processor->prepareToPlay(sampleRate, blockSize);
+    }
+
+    if (withEditor)
+        for (auto& processor : processors)
+            editors.emplace_back(processor->createEditorIfNeeded());
+
+    juce::AudioBuffer<float> buffer(2, blockSize);
+    juce::MidiBuffer midi;
+    juce::Random random(1234);
+    const juce::int64 maxSamples = static_cast<juce::int64>(sampleRate) * maxSecondsOfAudio;
+
+    for (juce::int64 position = 0; position < maxSamples; position += blockSize)
+    {
+        bool anyWaiting = false;
+        for (auto& processor : processors)
+        {
+            if (processor->getStartupTimeline().hasFirstPrediction())
+                continue;
+
+            anyWaiting = true;
+            fillClickTrack(buffer, position, random);
+            processor->processBlock(buffer, midi);
+        }
+
+        if (!anyWaiting)
+            break;
+    }
+
+    for (int instance = 0; instance < numInstances; ++instance)
+    {
+        auto& timeline = processors[static_cast<size_t>(instance)]->getStartupTimeline();
+        timeline.traceFirstPredictionIfPending();
+
+        for (const auto& target : targets)
+            if (std::strcmp(target.phase, "first prediction") != 0)
+                phaseTimes[target.phase].push_back(timeline.getPhaseTotalMs(target.phase));
+
+        if (timeline.hasFirstPrediction())
+            phaseTimes["first prediction"].push_back(timeline.getTimeToFirstPredictionMs());
+        else
+            ++instancesWithoutPrediction;
+
+        if (!trace)
+            std::printf("instance %d\n%s\n", instance, timeline.describe().c_str());
+    }
+
+    // Editors go first, as they would in a host
+    editors.clear();
+    processors.clear();
+
+    std::printf("%d instances, %d-sample blocks at %.0f Hz, editors %s\n\n",
+                numInstances, blockSize, sampleRate, withEditor ? "on" : "off");
+    std::printf("%-24s %12s %12s %12s %8s\n", "phase", "median ms", "worst ms", "target ms", "check");
+
+    bool allWithinTargets = true;
+    for (const auto& target : targets)
+    {
+        const auto& times = phaseTimes[target.phase];
+        if (times.empty())
+        {
+            std::printf("%-24s %12s %12s %12.1f %8s\n", target.phase, "-", "-", target.budgetMs, "n/a");
+            continue;
+        }
+
+        double typical = median(times);
+        double worst = *std::max_element(times.begin(), times.end());
+        bool ok = typical <= target.budgetMs;
+        allWithinTargets = allWithinTargets && ok;
+        std::printf("%-24s %12.2f %12.2f %12.1f %8s\n", target.phase, typical, worst, target.budgetMs, ok ? "ok" : "OVER");
+    }
+
+    if (instancesWithoutPrediction > 0)
+        std::printf("\n%d instance(s) made no prediction within %d s of audio (is Resources/groove_mood_model.onnx next to the executable?)\n",
+                    instancesWithoutPrediction, maxSecondsOfAudio);
+
+    return allWithinTargets ? 0 : 1;
+}
@@ -0,0 +1,201 @@
+// Synthetic training data for the mood model.
+// Generates single-mood patterns, random hybrid mixes and the predefined hybrids
+// with AIMidiGenerator (see Source/SyntheticDataset.h). Each pattern's features
+// and the mood weights it was generated from go into a feature store
+// (Source/FeatureStore.h), and no MIDI touches disk. There is one weight_<mood>
+// column per mood, and primary_mood is the heaviest mood. Energy and swing come
+// from the forests in --forests (energy_random_forest.onnx,
+// swing_random_forest.onnx) when given, as in AamatiAugment, and from the
+// fallback estimates otherwise. Work is spread over every core. Row contents
+// are deterministic for a given --seed, but rows from different threads may be
+// stored in any order.
+//
+// Usage: AamatiSynthesize [--forests <folder>] [--threads N] [--per-mood N] [--hybrids N]
+//                         [--per-hybrid N] [--seconds S] [--seed N] <output.aafs>
+
+#include <JuceHeader.h>
+#include "../Source/FeatureStore.h"
+#include "../Source/SyntheticDataset.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr size_t jobsPerTask = 1024;
+    constexpr size_t rowsPerFlush = 4096;
+
+    void printUsage()
+    {
+        std::fprintf(stderr,
+                     "Usage: AamatiSynthesize [--forests <folder>] [--threads N] [--per-mood N] [--hybrids N]\n"
+                     "                        [--per-hybrid N] [--seconds S] [--seed N] <output.aafs>\n");
+    }
+
+    void printProgress(size_t completed, size_t total, double seconds)
+    {
+        const double rate = seconds > 0.0 ? static_cast<double>(completed) / seconds : 0.0;
+        std::printf("\r%zu/%zu patterns, %.0f patterns/s (%.2fM/hour)", completed, total, rate, rate * 3600.0 / 1.0e6);
+        std::fflush(stdout);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    SyntheticDataset::Settings settings;
+    std::string forestsPath;
+    int numThreads = 0;
+    std::vector<std::string> positional;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--forests") == 0 && hasValue)
+            forestsPath = argv[++i];
+        else if (std::strcmp(argv[i], "--threads") == 0 && hasValue)
+            numThreads = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--per-mood") == 0 && hasValue)
+            settings.patternsPerMood = std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--hybrids") == 0 && hasValue)
+            settings.hybridPatterns = std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--per-hybrid") == 0 && hasValue)
+            settings.patternsPerPredefinedHybrid = std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--seconds") == 0 && hasValue)
+            settings.patternSeconds = std::max(0.5, std::atof(argv[++i]));
+        else if (std::strcmp(argv[i], "--seed") == 0 && hasValue)
+            settings.seed = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else
+            positional.push_back(argv[i]);
+    }
+
+    if (positional.size() != 1)
+    {
+        printUsage();
+        return 2;
+    }
+
+    // The layout of the jobs and the store's categories come from one instance; workers make their own
+    const SyntheticDataset layout(settings);
+    const size_t numJobs = layout.getNumJobs();
+    if (numJobs == 0)
+    {
+        std::fprintf(stderr, "Nothing to generate\n");
+        return 1;
+    }
+
+    const auto& moods = layout.getMoodLabels();
+    std::vector<FeatureStore::Column> columns;
+    for (const auto& name : FeatureExtractor::getFeatureNames())
+        columns.push_back({ name, {} });
+    for (const auto& mood : moods)
+        columns.push_back({ "weight_" + mood, {} });
+    columns.push_back({ "primary_mood", moods });
+    columns.push_back({ "origin", { SyntheticDataset::getOriginName(SyntheticDataset::Origin::Mood),
+                                    SyntheticDataset::getOriginName(SyntheticDataset::Origin::Hybrid),
+                                    SyntheticDataset::getOriginName(SyntheticDataset::Origin::Predefined) } });
+    FeatureStore::Column hybridColumn { "hybrid", { "" } };
+    for (const auto& name : layout.getPredefinedHybrids())
+        hybridColumn.categories.push_back(name);
+    columns.push_back(hybridColumn);
+    const size_t width = columns.size();
+
+    FeatureStore::Writer store;
+    if (!store.open(positional[0], columns))
+    {
+        std::fprintf(stderr, "Could not create %s\n", positional[0].c_str());
+        return 1;
+    }
+
+    const size_t numTasks = (numJobs + jobsPerTask - 1) / jobsPerTask;
+    if (numThreads <= 0)
+        numThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    numThreads = static_cast<int>(std::min<size_t>(static_cast<size_t>(numThreads), numTasks));
+    std::printf("Generating %zu patterns on %d threads\n", numJobs, numThreads);
+
+    std::atomic<size_t> nextTask { 0 };
+    std::atomic<size_t> completed { 0 };
+    std::atomic<size_t> dropped { 0 };
+    std::atomic<bool> writeFailed { false };
+    std::atomic<int> forestsLoaded { 0 };
+
+    const auto work = [&]()
+    {
+        SyntheticDataset dataset(settings);
+        if (!forestsPath.empty())
+            forestsLoaded = dataset.loadAuxiliaryModels(juce::File(forestsPath));
+        std::vector<float> rows, weights;
+        rows.reserve(rowsPerFlush * width);
+
+        const auto flush = [&]()
+        {
+            if (!rows.empty() && !store.appendRows(rows.data(), rows.size() / width))
+                writeFailed = true;
+            rows.clear();
+        };
+
+        for (size_t task = nextTask.fetch_add(1); task < numTasks; task = nextTask.fetch_add(1))
+        {
+            const size_t end = std::min(numJobs, (task + 1) * jobsPerTask);
+            for (size_t index = task * jobsPerTask; index < end; ++index)
+            {
+                const auto job = dataset.makeJob(index);
+                const auto features = dataset.generate(job, weights);
+                if (!features)
+                {
+                    ++dropped;
+                    continue;
+                }
+
+                FeatureExtractor::appendFeatureRow(*features, rows);
+                rows.insert(rows.end(), weights.begin(), weights.end());
+                rows.push_back(static_cast<float>(std::max_element(weights.begin(), weights.end()) - weights.begin()));
+                rows.push_back(static_cast<float>(job.origin));
+                rows.push_back(static_cast<float>(std::max(0, hybridColumn.indexOf(job.hybridName))));
+
+                if (rows.size() >= rowsPerFlush * width)
+                    flush();
+            }
+            completed += end - task * jobsPerTask;
+        }
+        flush();
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto elapsed = [&start]
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < numThreads; ++t)
+        workers.emplace_back(work);
+
+    while (completed.load() < numJobs)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+        printProgress(completed.load(), numJobs, elapsed());
+    }
+    for (auto& worker : workers)
+        worker.join();
+
+    const bool closed = store.close();
+    printProgress(completed.load(), numJobs, elapsed());
+    std::printf("\n%llu rows written, %zu patterns had too few notes and were left out\n",
+                static_cast<unsigned long long>(store.getRowsWritten()), dropped.load());
+    if (!forestsPath.empty())
+        std::printf("Energy and swing from %d of 2 forests in %s\n", forestsLoaded.load(), forestsPath.c_str());
+
+    if (writeFailed.load() || !closed)
+    {
+        std::fprintf(stderr, "Could not write %s\n", positional[0].c_str());
+        return 1;
+    }
+    return 0;
+}